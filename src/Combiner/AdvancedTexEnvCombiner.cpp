@@ -26,6 +26,7 @@ using std::max;
 #include "CombinerStructs.h"
 #include "ExtensionChecker.h"
 #include "MultiTexturingExt.h"    //glActiveTextureARB
+#include "RenderDevice.h"
 
 #ifndef GL_ATI_texture_env_combine3
 #define GL_ATI_texture_env_combine3
@@ -140,8 +141,8 @@ void AdvancedTexEnvCombiner::beginTextureUpdate()
     //Disable all texture channels
     for (int i = 0; i <openGLMaxTextureUnits; i++)
     {
-        glActiveTextureARB(GL_TEXTURE0_ARB + i);
-        glDisable(GL_TEXTURE_2D );
+        RenderDevice::getSingleton().setActiveTexture( i );
+        RenderDevice::getSingleton().disable(GL_TEXTURE_2D );
     }
 }
 
@@ -156,8 +157,8 @@ void AdvancedTexEnvCombiner::endTextureUpdate(TexEnvCombiner* texEnv)
     //Enable texturing
     for (int i = 0; i <texEnv->usedUnits; i++)
     {
-        glActiveTextureARB( GL_TEXTURE0_ARB + i );
-        glEnable( GL_TEXTURE_2D );
+        RenderDevice::getSingleton().setActiveTexture( i );
+        RenderDevice::getSingleton().enable( GL_TEXTURE_2D );
     }
 }
 
@@ -176,8 +177,8 @@ void AdvancedTexEnvCombiner::setTextureEnviromentColors(TexEnvCombiner* texEnv)
     {
         this->getCombinerColor( color, texEnv->color[i].constant, texEnv->alpha[i].constant );
 
-        glActiveTextureARB(GL_TEXTURE0_ARB + i);
-        glTexEnvfv(GL_TEXTURE_ENV, GL_TEXTURE_ENV_COLOR, &color[0]);
+        RenderDevice::getSingleton().setActiveTexture( i );
+        RenderDevice::getSingleton().setTexEnvColor(&color[0]);
     }
 }
 
@@ -189,34 +190,36 @@ void AdvancedTexEnvCombiner::setTextureEnviromentColors(TexEnvCombiner* texEnv)
 //-----------------------------------------------------------------------------
 void AdvancedTexEnvCombiner::setTextureEnviroment(TexEnvCombiner* texEnv)
 {
+    RenderDevice& device = RenderDevice::getSingleton();
+
     const int openGLMaxTextureUnits = 8;
 
     for (int i=0; i<openGLMaxTextureUnits; ++i)
     {
-        glActiveTextureARB(GL_TEXTURE0_ARB + i);
+        device.setActiveTexture( i );
 
         if ( (i < texEnv->usedUnits ) || (i < 2 && texEnv->usesT1) )
         {
-            glEnable( GL_TEXTURE_2D );
-            glTexEnvi( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE,   GL_COMBINE_ARB );
-            glTexEnvi( GL_TEXTURE_ENV, GL_COMBINE_RGB_ARB,    texEnv->color[i].combine );
-            glTexEnvi( GL_TEXTURE_ENV, GL_SOURCE0_RGB_ARB,    texEnv->color[i].arg0.source );
-            glTexEnvi( GL_TEXTURE_ENV, GL_OPERAND0_RGB_ARB,   texEnv->color[i].arg0.operand );
-            glTexEnvi( GL_TEXTURE_ENV, GL_SOURCE1_RGB_ARB,    texEnv->color[i].arg1.source );
-            glTexEnvi( GL_TEXTURE_ENV, GL_OPERAND1_RGB_ARB,   texEnv->color[i].arg1.operand );
-            glTexEnvi( GL_TEXTURE_ENV, GL_SOURCE2_RGB_ARB,    texEnv->color[i].arg2.source );
-            glTexEnvi( GL_TEXTURE_ENV, GL_OPERAND2_RGB_ARB,   texEnv->color[i].arg2.operand );
-            glTexEnvi( GL_TEXTURE_ENV, GL_COMBINE_ALPHA_ARB,  texEnv->alpha[i].combine );
-            glTexEnvi( GL_TEXTURE_ENV, GL_SOURCE0_ALPHA_ARB,  texEnv->alpha[i].arg0.source );
-            glTexEnvi( GL_TEXTURE_ENV, GL_OPERAND0_ALPHA_ARB, texEnv->alpha[i].arg0.operand );
-            glTexEnvi( GL_TEXTURE_ENV, GL_SOURCE1_ALPHA_ARB,  texEnv->alpha[i].arg1.source );
-            glTexEnvi( GL_TEXTURE_ENV, GL_OPERAND1_ALPHA_ARB, texEnv->alpha[i].arg1.operand );
-            glTexEnvi( GL_TEXTURE_ENV, GL_SOURCE2_ALPHA_ARB,  texEnv->alpha[i].arg2.source );
-            glTexEnvi( GL_TEXTURE_ENV, GL_OPERAND2_ALPHA_ARB, texEnv->alpha[i].arg2.operand );
+            device.enable( GL_TEXTURE_2D );
+            device.setTexEnv( GL_TEXTURE_ENV_MODE,   GL_COMBINE_ARB );
+            device.setTexEnv( GL_COMBINE_RGB_ARB,    texEnv->color[i].combine );
+            device.setTexEnv( GL_SOURCE0_RGB_ARB,    texEnv->color[i].arg0.source );
+            device.setTexEnv( GL_OPERAND0_RGB_ARB,   texEnv->color[i].arg0.operand );
+            device.setTexEnv( GL_SOURCE1_RGB_ARB,    texEnv->color[i].arg1.source );
+            device.setTexEnv( GL_OPERAND1_RGB_ARB,   texEnv->color[i].arg1.operand );
+            device.setTexEnv( GL_SOURCE2_RGB_ARB,    texEnv->color[i].arg2.source );
+            device.setTexEnv( GL_OPERAND2_RGB_ARB,   texEnv->color[i].arg2.operand );
+            device.setTexEnv( GL_COMBINE_ALPHA_ARB,  texEnv->alpha[i].combine );
+            device.setTexEnv( GL_SOURCE0_ALPHA_ARB,  texEnv->alpha[i].arg0.source );
+            device.setTexEnv( GL_OPERAND0_ALPHA_ARB, texEnv->alpha[i].arg0.operand );
+            device.setTexEnv( GL_SOURCE1_ALPHA_ARB,  texEnv->alpha[i].arg1.source );
+            device.setTexEnv( GL_OPERAND1_ALPHA_ARB, texEnv->alpha[i].arg1.operand );
+            device.setTexEnv( GL_SOURCE2_ALPHA_ARB,  texEnv->alpha[i].arg2.source );
+            device.setTexEnv( GL_OPERAND2_ALPHA_ARB, texEnv->alpha[i].arg2.operand );
         }
         else
         {
-            glDisable(GL_TEXTURE_2D);
+            device.disable(GL_TEXTURE_2D);
         }            
     }
 }
@@ -23,6 +23,7 @@
 #include "DummyCombiner.h"
 #include "ExtensionChecker.h"
 #include "MultiTexturingExt.h"
+#include "RenderDevice.h"
 
 //-----------------------------------------------------------------------------
 //* Initialize
@@ -72,12 +73,14 @@ TexEnvCombiner* DummyCombiner::createNewTextureEnviroment(Combiner* colorCombine
 //-----------------------------------------------------------------------------
 void DummyCombiner::setTextureEnviroment(TexEnvCombiner* texEnv)
 {
+    RenderDevice& device = RenderDevice::getSingleton();
+
     //Enable Texturing
     if ( ARB_multitexture )
-        glActiveTextureARB( GL_TEXTURE0_ARB );
+        device.setActiveTexture( 0 );
 
     if ( texEnv->usesT0 )
-        glEnable( GL_TEXTURE_2D );
+        device.enable( GL_TEXTURE_2D );
     else
-        glDisable( GL_TEXTURE_2D );
+        device.disable( GL_TEXTURE_2D );
 }
@@ -23,6 +23,7 @@
 #include "ExtensionChecker.h"
 #include "MultiTexturingExt.h"
 #include "OpenGL.h"
+#include "RenderDevice.h"
 #include "SimpleTexEnvCombiner.h"
 #include "m64p.h"
 
@@ -84,16 +85,18 @@ void SimpleTexEnvCombiner::setTextureEnviromentColors(TexEnvCombiner* texEnv)
 //-----------------------------------------------------------------------------
 void SimpleTexEnvCombiner::setTextureEnviroment(TexEnvCombiner* texEnv)
 {
+    RenderDevice& device = RenderDevice::getSingleton();
+
     if ( ARB_multitexture )
-        glActiveTextureARB( GL_TEXTURE0_ARB );
+        device.setActiveTexture( 0 );
 
     if (texEnv->usesT0 || texEnv->usesT1)
-        glEnable( GL_TEXTURE_2D );
+        device.enable( GL_TEXTURE_2D );
     else
-        glDisable( GL_TEXTURE_2D );
+        device.disable( GL_TEXTURE_2D );
 
     //Set Mode
-    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, texEnv->mode);
+    device.setTexEnv( GL_TEXTURE_ENV_MODE, texEnv->mode);
 }
 
 //-----------------------------------------------------------------------------
@@ -0,0 +1,196 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#include "DisplayListCache.h"
+#include "Memory.h"
+
+//-----------------------------------------------------------------------------
+//! Constructor
+//-----------------------------------------------------------------------------
+DisplayListCache::DisplayListCache()
+{
+    m_memory = 0;
+    m_entries = 0;
+    m_numHits = 0;
+    m_numMisses = 0;
+    m_numInvalidations = 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Destructor
+//-----------------------------------------------------------------------------
+DisplayListCache::~DisplayListCache()
+{
+    dispose();
+}
+
+//-----------------------------------------------------------------------------
+//* Initialize
+//-----------------------------------------------------------------------------
+bool DisplayListCache::initialize(Memory* memory)
+{
+    dispose();
+
+    m_memory = memory;
+    m_entries = new Entry[CACHE_SIZE];
+    for (unsigned int i=0; i<CACHE_SIZE; ++i)
+    {
+        m_entries[i].valid = false;
+    }
+
+    m_numHits = 0;
+    m_numMisses = 0;
+    m_numInvalidations = 0;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//* Dispose
+//-----------------------------------------------------------------------------
+void DisplayListCache::dispose()
+{
+    if ( m_entries ) { delete[] m_entries; m_entries = 0; }
+}
+
+//-----------------------------------------------------------------------------
+//* Find
+//! @param address RDRAM address of display list
+//! @param RDRAMu32 RDRAM the list is verified against
+//! @param generation Current generation of GBI, lists compiled for another
+//!                   ucode are not used
+//! @return Entry (which may not be cacheable), or 0 if list must be compiled
+//-----------------------------------------------------------------------------
+const DisplayListCache::Entry* DisplayListCache::find(unsigned int address, unsigned int* RDRAMu32, unsigned int generation)
+{
+    if ( !m_entries ) {
+        return 0;
+    }
+
+    Entry& entry = m_entries[_getIndex(address)];
+    if ( !entry.valid || entry.address != address || entry.generation != generation ) {
+        return 0;
+    }
+
+    //Words changed since list was compiled? Not if their pages were not written to
+    if ( !entry.watched || m_memory->getGeneration(address, entry.numWords * 4) != entry.writeGeneration )
+    {
+        _watch(entry);
+        if ( _fingerprint(&RDRAMu32[address >> 2], entry.numWords) != entry.fingerprint )
+        {
+            m_numInvalidations++;
+            return 0;
+        }
+    }
+
+    if ( entry.cacheable ) {
+        m_numHits++;
+    }
+    return &entry;
+}
+
+//-----------------------------------------------------------------------------
+//* Compile
+//! Decodes the list up to G_ENDDL and replaces the entry the address maps to.
+//! The entry is marked as not cacheable if an instruction without
+//! GBI_CACHEABLE is found, so the list is not scanned again until it changes.
+//-----------------------------------------------------------------------------
+const DisplayListCache::Entry* DisplayListCache::compile(unsigned int address, unsigned int* RDRAMu32, unsigned int rdramSize, GBI* gbi)
+{
+    if ( !m_entries ) {
+        return 0;
+    }
+
+    m_numMisses++;
+
+    Entry& entry = m_entries[_getIndex(address)];
+    entry.valid           = true;
+    entry.cacheable       = false;
+    entry.address         = address;
+    entry.generation      = gbi->m_generation;
+    entry.numInstructions = 0;
+
+    unsigned int numWords = 0;
+    for (unsigned int i=0; i<MAX_INSTRUCTIONS; ++i)
+    {
+        //Stay inside RDRAM
+        if ( address + (i + 1) * 8 > rdramSize )
+        {
+            break;
+        }
+
+        MicrocodeArgument* ucodeArg = (MicrocodeArgument*)&RDRAMu32[(address >> 2) + i * 2];
+        numWords += 2;
+
+        if ( ucodeArg->cmd == (GBI::G_ENDDL & 0xFF) )
+        {
+            entry.cacheable = true;
+            break;
+        }
+        if ( !(gbi->m_flags[ucodeArg->cmd] & GBI_CACHEABLE) )
+        {
+            break;
+        }
+
+        DisplayListInstruction& instruction = entry.instructions[entry.numInstructions++];
+        instruction.func  = gbi->m_cmds[ucodeArg->cmd];
+        instruction.arg   = *ucodeArg;
+        instruction.flags = gbi->m_flags[ucodeArg->cmd];
+    }
+
+    entry.numWords    = numWords;
+    _watch(entry);
+    entry.fingerprint = _fingerprint(&RDRAMu32[address >> 2], numWords);
+    return &entry;
+}
+
+//-----------------------------------------------------------------------------
+//* Get Index
+//-----------------------------------------------------------------------------
+unsigned int DisplayListCache::_getIndex(unsigned int address)
+{
+    unsigned int hash = (address >> 3) * 2654435761U;
+    return (hash >> 16) & (CACHE_SIZE - 1);
+}
+
+//-----------------------------------------------------------------------------
+//* Watch
+//! Watches words of entry for writes, before they are hashed so no write
+//! can be missed. Words that can not be watched are always hashed.
+//-----------------------------------------------------------------------------
+void DisplayListCache::_watch(Entry& entry)
+{
+    entry.watched = m_memory && m_memory->watch(entry.address, entry.numWords * 4);
+    entry.writeGeneration = entry.watched ? m_memory->getGeneration(entry.address, entry.numWords * 4) : 0;
+}
+
+//-----------------------------------------------------------------------------
+//* Fingerprint
+//! FNV-1a over whole words, good enough to detect edited lists
+//-----------------------------------------------------------------------------
+unsigned int DisplayListCache::_fingerprint(const unsigned int* words, unsigned int numWords)
+{
+    unsigned int hash = 2166136261U;
+    for (unsigned int i=0; i<numWords; ++i)
+    {
+        hash = (hash ^ words[i]) * 16777619U;
+    }
+    return hash;
+}
@@ -0,0 +1,111 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef DISPLAYLIST_CACHE_H_
+#define DISPLAYLIST_CACHE_H_
+
+#include "GBI.h"
+#include "UCodeDefs.h"
+
+//Forward declarations
+class Memory;
+
+//-----------------------------------------------------------------------------
+//* Display List Instruction
+//! Pre-decoded instruction, handler and flags are looked up when compiled
+//-----------------------------------------------------------------------------
+struct DisplayListInstruction
+{
+    GBIFunc           func;   //!< Function executing the instruction
+    MicrocodeArgument arg;    //!< Copy of the instruction words
+    unsigned int      flags;  //!< GBIFlags of the instruction
+};
+
+//*****************************************************************************
+//* Display List Cache
+//! Stores display lists called with G_DL as arrays of pre-decoded
+//! instructions, so static lists submitted every frame do not have to be
+//! fetched and looked up again. Only lists made of instructions that depend
+//! on nothing but their own words (GBI_CACHEABLE) are compiled. Entries are
+//! keyed by RDRAM address and verified with a fingerprint of the words,
+//! which is skipped when RDRAM write tracking shows the words were not
+//! written to.
+//*****************************************************************************
+class DisplayListCache
+{
+public:
+
+    static const unsigned int MAX_INSTRUCTIONS = 128;  //!< Longer lists are not cached
+
+    //-----------------------------------------------------------------------------
+    //! Cache entry
+    //-----------------------------------------------------------------------------
+    struct Entry
+    {
+        bool valid;                       //!< Entry has been compiled
+        bool cacheable;                   //!< False if list has to be interpreted
+        unsigned int address;             //!< RDRAM address of list
+        unsigned int generation;          //!< Generation of GBI when compiled
+        unsigned int numWords;            //!< Number of words covered by fingerprint
+        unsigned int fingerprint;         //!< Hash of words in RDRAM
+        bool watched;                     //!< Words are watched for writes
+        unsigned int writeGeneration;     //!< Write generation of words when verified
+        unsigned int numInstructions;     //!< Instructions before G_ENDDL
+        DisplayListInstruction instructions[MAX_INSTRUCTIONS];
+    };
+
+public:
+
+    //Constructor / Destructor
+    DisplayListCache();
+    ~DisplayListCache();
+
+    bool initialize(Memory* memory);
+    void dispose();
+
+    //Lookup / Compile
+    const Entry* find(unsigned int address, unsigned int* RDRAMu32, unsigned int generation);
+    const Entry* compile(unsigned int address, unsigned int* RDRAMu32, unsigned int rdramSize, GBI* gbi);
+
+    //Statistics
+    unsigned int getNumHits()          { return m_numHits;          }
+    unsigned int getNumMisses()        { return m_numMisses;        }
+    unsigned int getNumInvalidations() { return m_numInvalidations; }
+
+private:
+
+    unsigned int _getIndex(unsigned int address);
+    static unsigned int _fingerprint(const unsigned int* words, unsigned int numWords);
+    void _watch(Entry& entry);
+
+private:
+
+    static const unsigned int CACHE_SIZE = 256;  //!< Number of entries, must be power of two
+
+    Memory* m_memory;                  //!< Tracks writes to RDRAM
+    Entry* m_entries;                  //!< Direct mapped cache entries
+    unsigned int m_numHits;            //!< Lists executed from cache
+    unsigned int m_numMisses;          //!< Lists compiled
+    unsigned int m_numInvalidations;   //!< Lists compiled again because their words changed
+
+};
+
+#endif
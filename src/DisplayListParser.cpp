@@ -77,7 +77,7 @@ DisplayListParser::~DisplayListParser()
 //-----------------------------------------------------------------------------
 //! Initialize
 //-----------------------------------------------------------------------------
-bool DisplayListParser::initialize(RSP* rsp, RDP* rdp, GBI* gbi, Memory* memory)
+bool DisplayListParser::initialize(RSP* rsp, RDP* rdp, GBI* gbi, Memory* memory, bool useCache)
 {
     //Save pointers
     m_rsp    = rsp;
@@ -85,6 +85,20 @@ bool DisplayListParser::initialize(RSP* rsp, RDP* rdp, GBI* gbi, Memory* memory)
     m_gbi    = gbi;
     m_memory = memory;
 
+    m_numInstructions = 0;
+    m_pendingTriangles = false;
+
+#ifdef DISPLAYLIST_PROFILER
+    m_profiler.initialize();
+#endif
+
+    //Compiled display lists
+    m_useCache = useCache;
+    if ( m_useCache && !m_cache.initialize(memory) )
+    {
+        return false;
+    }
+
     //Reset display list
     m_DListStackPointer = 0;
     for (int i=0; i<MAX_DL_STACK_SIZE; ++i)
@@ -112,7 +126,116 @@ void DisplayListParser::processDisplayList()
     m_DlistStack[m_DListStackPointer].pc = (unsigned int)task->t.data_ptr;
     m_DlistStack[m_DListStackPointer].countdown = MAX_DL_COUNT;
 
-    // The main loop
+#ifdef DISPLAYLIST_PROFILER
+    m_profiler.beginFrame(m_gbi->getUCode());
+#endif
+
+#ifdef DISPLAYLIST_COMPUTED_GOTO
+    _processThreaded();
+#else
+    _processPortable();
+#endif
+
+#ifdef DISPLAYLIST_PROFILER
+    m_profiler.endFrame();
+#endif
+
+    //Trigger interupts
+    m_rdp->triggerInterrupt();
+    m_rsp->triggerInterrupt();
+}
+
+//-----------------------------------------------------------------------------
+//* Process Threaded
+//! Interpreter loop using computed goto. Each instruction jumps directly to
+//! the handler for its class in GBI::m_flags, and triangles are rendered
+//! before the next instruction that flushes instead of peeking ahead.
+//-----------------------------------------------------------------------------
+void DisplayListParser::_processThreaded()
+{
+#ifdef DISPLAYLIST_COMPUTED_GOTO
+    //Indexed by GBI_DRAWS | GBI_FLUSHES
+    static void* const dispatch[4] = { &&execute, &&draw, &&flush, &&flush };
+
+    unsigned int* RDRAMu32 = m_memory->getRDRAMint32();
+    GBIFunc* cmds = m_gbi->m_cmds;
+    const unsigned char* flags = m_gbi->m_flags;
+    OpenGLRenderer& renderer = OpenGLRenderer::getSingleton();
+    MicrocodeArgument* ucodeArg;
+    unsigned int numInstructions = 0;
+    m_pendingTriangles = false;
+    PROFILE_DECLARE();
+
+    //Fetch next instruction and jump to its handler
+    #define DISPATCH()                                                                          \
+        if ( m_DListStackPointer >= 0 && --m_DlistStack[m_DListStackPointer].countdown < 0 )   \
+        {                                                                                       \
+            m_DListStackPointer--;                                                              \
+        }                                                                                       \
+        if ( m_DListStackPointer < 0 ) goto done;                                               \
+        ucodeArg = (MicrocodeArgument*)&RDRAMu32[(m_DlistStack[m_DListStackPointer].pc>>2)];    \
+        m_DlistStack[m_DListStackPointer].pc += 8;                                              \
+        numInstructions++;                                                                      \
+        goto *dispatch[flags[ucodeArg->cmd] & (GBI_DRAWS | GBI_FLUSHES)]
+
+    //First instruction (countdown is only decremented after an instruction)
+    ucodeArg = (MicrocodeArgument*)&RDRAMu32[(m_DlistStack[m_DListStackPointer].pc>>2)];
+    m_DlistStack[m_DListStackPointer].pc += 8;
+    numInstructions++;
+    goto *dispatch[flags[ucodeArg->cmd] & (GBI_DRAWS | GBI_FLUSHES)];
+
+flush:
+    if ( m_pendingTriangles )
+    {
+        PROFILE_BEGIN_RENDER();
+        renderer.render();
+        PROFILE_END_RENDER();
+        m_pendingTriangles = false;
+    }
+    //Fall through
+
+execute:
+    PROFILE_BEGIN(ucodeArg->cmd);
+    cmds[ucodeArg->cmd](ucodeArg);
+    PROFILE_END();
+
+    //Instructions may rewrite themselves into triangles (Conker)
+    if ( flags[ucodeArg->cmd] & GBI_DRAWS )
+    {
+        m_pendingTriangles = true;
+    }
+    DISPATCH();
+
+draw:
+    PROFILE_BEGIN(ucodeArg->cmd);
+    cmds[ucodeArg->cmd](ucodeArg);
+    PROFILE_END();
+    m_pendingTriangles = true;
+    DISPATCH();
+
+done:
+    #undef DISPATCH
+
+    if ( m_pendingTriangles )
+    {
+        PROFILE_BEGIN_RENDER();
+        renderer.render();
+        PROFILE_END_RENDER();
+        m_pendingTriangles = false;
+    }
+    m_numInstructions += numInstructions;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+//* Process Portable
+//! Interpreter loop for compilers without computed goto
+//-----------------------------------------------------------------------------
+void DisplayListParser::_processPortable()
+{
+    PROFILE_DECLARE();
+    m_pendingTriangles = false;
+
     while( m_DListStackPointer >= 0 )
     {
         //Cast memory pointer
@@ -125,28 +248,25 @@ void DisplayListParser::processDisplayList()
         //Increment program counter
         m_DlistStack[m_DListStackPointer].pc += 8;
 
+        //Render pending triangles and rectangles before the instruction changes states
+        if ( (m_gbi->m_flags[ucodeArg->cmd] & GBI_FLUSHES) && m_pendingTriangles )
+        {
+            PROFILE_BEGIN_RENDER();
+            OpenGLRenderer::getSingleton().render();
+            PROFILE_END_RENDER();
+            m_pendingTriangles = false;
+        }
+
         //Call function to execute command
+        PROFILE_BEGIN(ucodeArg->cmd);
         m_gbi->m_cmds[(ucodeArg->cmd)](ucodeArg);
+        PROFILE_END();
+        m_numInstructions++;
 
-        //Get next command        
-        MicrocodeArgument* ucodeNext =  (MicrocodeArgument*)&RDRAMu32[(m_DlistStack[m_DListStackPointer].pc>>2)];
-        
         //If this was a rendering command
-        if ( ucodeArg->cmd == GBI::G_TRI1 ||  
-             ucodeArg->cmd == GBI::G_TRI2 || 
-             ucodeArg->cmd == GBI::G_TRI4 || 
-             ucodeArg->cmd == GBI::G_QUAD || 
-             ucodeArg->cmd == GBI::G_DMA_TRI ) 
+        if ( m_gbi->m_flags[ucodeArg->cmd] & GBI_DRAWS )
         {
-            //If next is not a rendering command
-            if (  ucodeNext->cmd != GBI::G_TRI1 &&  
-                  ucodeNext->cmd != GBI::G_TRI2 && 
-                  ucodeNext->cmd != GBI::G_TRI4 && 
-                  ucodeNext->cmd != GBI::G_QUAD && 
-                  ucodeNext->cmd != GBI::G_DMA_TRI ) 
-            {
-                OpenGLRenderer::getSingleton().render();
-            }
+            m_pendingTriangles = true;
         }
 
         //??
@@ -156,9 +276,13 @@ void DisplayListParser::processDisplayList()
         }
     }
 
-    //Trigger interupts
-    m_rdp->triggerInterrupt();
-    m_rsp->triggerInterrupt();
+    if ( m_pendingTriangles )
+    {
+        PROFILE_BEGIN_RENDER();
+        OpenGLRenderer::getSingleton().render();
+        PROFILE_END_RENDER();
+        m_pendingTriangles = false;
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -184,12 +308,67 @@ void DisplayListParser::displayList(unsigned int segmentAddress)
 
     if ( m_DListStackPointer < (MAX_DL_STACK_SIZE - 1))
     {
+        //Static lists are executed from cache without pushing them
+        if ( m_useCache && _executeCached(address) )
+        {
+            return;
+        }
+
         m_DListStackPointer++;
         m_DlistStack[m_DListStackPointer].pc = address;
         m_DlistStack[m_DListStackPointer].countdown = MAX_DL_COUNT;
     }
 }
 
+//-----------------------------------------------------------------------------
+//* Execute Cached
+//! Executes a display list compiled by the display list cache, compiles it
+//! first if needed.
+//! @param address RDRAM address of display list
+//! @return False if list is not cacheable and has to be interpreted
+//-----------------------------------------------------------------------------
+bool DisplayListParser::_executeCached(unsigned int address)
+{
+    unsigned int* RDRAMu32 = m_memory->getRDRAMint32();
+
+    const DisplayListCache::Entry* entry = m_cache.find(address, RDRAMu32, m_gbi->m_generation);
+    if ( !entry )
+    {
+        entry = m_cache.compile(address, RDRAMu32, m_memory->getRDRAMSize(), m_gbi);
+    }
+    if ( !entry || !entry->cacheable )
+    {
+        return false;
+    }
+
+    OpenGLRenderer& renderer = OpenGLRenderer::getSingleton();
+    PROFILE_DECLARE();
+    for (unsigned int i=0; i<entry->numInstructions; ++i)
+    {
+        const DisplayListInstruction& instruction = entry->instructions[i];
+        if ( (instruction.flags & GBI_FLUSHES) && m_pendingTriangles )
+        {
+            PROFILE_BEGIN_RENDER();
+            renderer.render();
+            PROFILE_END_RENDER();
+            m_pendingTriangles = false;
+        }
+
+        //Functions get a copy so the compiled list stays unchanged
+        MicrocodeArgument ucodeArg = instruction.arg;
+        PROFILE_BEGIN(ucodeArg.cmd);
+        instruction.func(&ucodeArg);
+        PROFILE_END();
+
+        if ( instruction.flags & GBI_DRAWS )
+        {
+            m_pendingTriangles = true;
+        }
+    }
+    m_numInstructions += entry->numInstructions;
+    return true;
+}
+
 //-----------------------------------------------------------------------------
 //! Branch Display List
 //-----------------------------------------------------------------------------
@@ -22,6 +22,9 @@
 #ifndef DISPLAYLIST_PARSER_H_
 #define DISPLAYLIST_PARSER_H_
 
+#include "DisplayListCache.h"
+#include "DisplayListProfiler.h"
+
 //Forward declaration
 class Memory;
 class RSP;
@@ -30,6 +33,11 @@ class GBI;
 
 #define MAX_DL_COUNT               100000        //!< Maximum display list count
 #define TASK_ADDRESS_RELATIVE_DMEM 0x0FC0
+
+//! Dispatch with computed goto (GCC labels as values) unless disabled
+#if defined(__GNUC__) && !defined(NO_COMPUTED_GOTO)
+#define DISPLAYLIST_COMPUTED_GOTO 1
+#endif
 //-----------------------------------------------------------------------------
 //! The display list PC stack.
 //-----------------------------------------------------------------------------
@@ -51,7 +59,7 @@ public:
     ~DisplayListParser();
 
     //Initialize
-    bool initialize(RSP* rsp, RDP* rdp, GBI* gbi, Memory* memory);
+    bool initialize(RSP* rsp, RDP* rdp, GBI* gbi, Memory* memory, bool useCache);
 
     //Process/Parse the display list
     void processDisplayList();
@@ -78,6 +86,24 @@ public:
     //! Get Current Display List
     DListStack& getCurrentDlist() { return m_DlistStack[m_DListStackPointer]; }
 
+    //! Get number of instructions executed since start
+    unsigned int getNumInstructions() { return m_numInstructions; }
+
+    //! Get cache of compiled display lists
+    DisplayListCache* getCache() { return &m_cache; }
+
+#ifdef DISPLAYLIST_PROFILER
+    //! Get per-opcode profiler
+    DisplayListProfiler* getProfiler() { return &m_profiler; }
+#endif
+
+private:
+
+    //Interpreter loops
+    void _processThreaded();
+    void _processPortable();
+    bool _executeCached(unsigned int address);
+
 private:
 
     //Pointers
@@ -90,6 +116,17 @@ private:
     int m_DListStackPointer;                      //!< Current size of Display List stack 
     static const int MAX_DL_STACK_SIZE = 32;      //!< Maximum size of Display List stack 
     DListStack m_DlistStack[MAX_DL_STACK_SIZE];   //!< Stack used for processing the Display List
+
+    unsigned int m_numInstructions;               //!< Number of instructions executed
+    bool m_pendingTriangles;                      //!< Triangles or rectangles added but not rendered
+
+    //Compiled display lists
+    bool m_useCache;                              //!< Execute lists called with G_DL from cache?
+    DisplayListCache m_cache;                     //!< Cache of compiled display lists
+
+#ifdef DISPLAYLIST_PROFILER
+    DisplayListProfiler m_profiler;               //!< Times instructions per opcode
+#endif
 };
 
 #endif
@@ -0,0 +1,222 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#include "DisplayListProfiler.h"
+
+#ifdef DISPLAYLIST_PROFILER
+
+#include <cstdio>
+#include <cstring>
+
+#include "Logger.h"
+
+//! Number of instructions listed in reports
+#define PROFILE_TOP_COUNT 5
+
+//-----------------------------------------------------------------------------
+//! Constructor
+//-----------------------------------------------------------------------------
+DisplayListProfiler::DisplayListProfiler()
+{
+    initialize();
+}
+
+//-----------------------------------------------------------------------------
+//! Destructor
+//-----------------------------------------------------------------------------
+DisplayListProfiler::~DisplayListProfiler()
+{
+    dispose();
+}
+
+//-----------------------------------------------------------------------------
+//! Initialize, clears all counters
+//-----------------------------------------------------------------------------
+bool DisplayListProfiler::initialize()
+{
+    m_ucodeIndex = MAX_UCODES - 1;
+    memset(m_frameCount, 0, sizeof(m_frameCount));
+    memset(m_frameTicks, 0, sizeof(m_frameTicks));
+    m_frameRenderCount = 0;
+    m_frameRenderTicks = 0;
+
+    m_numFrames = 0;
+    memset(m_count, 0, sizeof(m_count));
+    memset(m_ticks, 0, sizeof(m_ticks));
+    memset(m_renderCount, 0, sizeof(m_renderCount));
+    memset(m_renderTicks, 0, sizeof(m_renderTicks));
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Dispose
+//-----------------------------------------------------------------------------
+void DisplayListProfiler::dispose()
+{
+}
+
+//-----------------------------------------------------------------------------
+//* Begin Frame
+//! @param ucode Id of ucode selected for this display list, -1 if unknown
+//-----------------------------------------------------------------------------
+void DisplayListProfiler::beginFrame(int ucode)
+{
+    m_ucodeIndex = ( ucode >= 0 && ucode < MAX_UCODES - 1 ) ? ucode : MAX_UCODES - 1;
+    memset(m_frameCount, 0, sizeof(m_frameCount));
+    memset(m_frameTicks, 0, sizeof(m_frameTicks));
+    m_frameRenderCount = 0;
+    m_frameRenderTicks = 0;
+}
+
+//-----------------------------------------------------------------------------
+//* End Frame
+//! Adds frame to cumulative totals and reports it
+//-----------------------------------------------------------------------------
+void DisplayListProfiler::endFrame()
+{
+    for (int i=0; i<256; ++i)
+    {
+        m_count[m_ucodeIndex][i] += m_frameCount[i];
+        m_ticks[m_ucodeIndex][i] += m_frameTicks[i];
+    }
+    m_renderCount[m_ucodeIndex] += m_frameRenderCount;
+    m_renderTicks[m_ucodeIndex] += m_frameRenderTicks;
+    m_numFrames++;
+
+    _printTop("Frame", M64MSG_VERBOSE, m_ucodeIndex, m_frameCount, m_frameTicks, m_frameRenderCount, m_frameRenderTicks);
+}
+
+//-----------------------------------------------------------------------------
+//* Print Summary
+//! Reports cumulative totals of every ucode that has been used
+//-----------------------------------------------------------------------------
+void DisplayListProfiler::printSummary()
+{
+    char msg[128];
+    sprintf(msg, "Profiled %u display lists", m_numFrames);
+    Logger::getSingleton().printMsg(msg, M64MSG_INFO);
+
+    for (int u=0; u<MAX_UCODES; ++u)
+    {
+        _printTop("Total", M64MSG_INFO, u, m_count[u], m_ticks[u], m_renderCount[u], m_renderTicks[u]);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//* Write CSV
+//! Writes cumulative totals, one line per ucode and executed opcode. Time
+//! spent rendering batched triangles is written with opcode "render",
+//! ticks of G_DL include lists it executed from DisplayListCache.
+//! @param filename File to write
+//! @return True if file was written
+//-----------------------------------------------------------------------------
+bool DisplayListProfiler::writeCSV(const char* filename)
+{
+    FILE* file = fopen(filename, "w");
+    if ( !file )
+    {
+        return false;
+    }
+
+    fprintf(file, "ucode,opcode,count,ticks,ticks_per_call\n");
+    for (int u=0; u<MAX_UCODES; ++u)
+    {
+        int ucode = ( u == MAX_UCODES - 1 ) ? -1 : u;
+        for (int i=0; i<256; ++i)
+        {
+            if ( m_count[u][i] == 0 )
+            {
+                continue;
+            }
+            fprintf(file, "%d,0x%02X,%llu,%llu,%.1f\n", ucode, i, m_count[u][i], m_ticks[u][i], 
+                    (double)m_ticks[u][i] / m_count[u][i]);
+        }
+        if ( m_renderCount[u] )
+        {
+            fprintf(file, "%d,render,%llu,%llu,%.1f\n", ucode, m_renderCount[u], m_renderTicks[u],
+                    (double)m_renderTicks[u] / m_renderCount[u]);
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//* Print Top
+//! Logs the instructions that used most ticks
+//-----------------------------------------------------------------------------
+void DisplayListProfiler::_printTop(const char* title, m64p_msg_level level, int ucode, const unsigned long long* count, const unsigned long long* ticks,
+                                    unsigned long long renderCount, unsigned long long renderTicks)
+{
+    //Total
+    unsigned long long totalCount = 0;
+    unsigned long long totalTicks = renderTicks;
+    for (int i=0; i<256; ++i)
+    {
+        totalCount += count[i];
+        totalTicks += ticks[i];
+    }
+    if ( totalCount == 0 )
+    {
+        return;
+    }
+
+    //Select most expensive opcodes
+    int top[PROFILE_TOP_COUNT];
+    int numTop = 0;
+    for (int i=0; i<256; ++i)
+    {
+        if ( count[i] == 0 )
+        {
+            continue;
+        }
+        int position = numTop;
+        while ( position > 0 && ticks[top[position-1]] < ticks[i] )
+        {
+            --position;
+        }
+        if ( position >= PROFILE_TOP_COUNT )
+        {
+            continue;
+        }
+        if ( numTop < PROFILE_TOP_COUNT )
+        {
+            numTop++;
+        }
+        for (int j=numTop-1; j>position; --j)
+        {
+            top[j] = top[j-1];
+        }
+        top[position] = i;
+    }
+
+    char msg[512];
+    int length = sprintf(msg, "%s ucode %d: %llu instructions, %llu ticks, render %llu/%llu ticks", 
+                         title, ( ucode == MAX_UCODES - 1 ) ? -1 : ucode, totalCount, totalTicks, renderCount, renderTicks);
+    for (int i=0; i<numTop; ++i)
+    {
+        length += sprintf(msg + length, ", 0x%02X %llu/%llu", top[i], count[top[i]], ticks[top[i]]);
+    }
+    Logger::getSingleton().printMsg(msg, level);
+}
+
+#endif //DISPLAYLIST_PROFILER
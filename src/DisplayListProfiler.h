@@ -0,0 +1,134 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef DISPLAYLIST_PROFILER_H_
+#define DISPLAYLIST_PROFILER_H_
+
+//! Build with -DDISPLAYLIST_PROFILER (make PROFILE=1) to time every GBI
+//! instruction. When not defined the profiler is not compiled at all.
+#ifdef DISPLAYLIST_PROFILER
+
+#include "m64p_types.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif !defined(__i386__) && !defined(__x86_64__)
+#include <time.h>
+#endif
+
+//*****************************************************************************
+//* Display List Profiler
+//! Counts and times executed GBI instructions per opcode, separately for
+//! each ucode. Reports the most expensive instructions of every frame
+//! through the logger and writes cumulative totals as CSV.
+//*****************************************************************************
+class DisplayListProfiler
+{
+public:
+
+    static const int MAX_UCODES = 32;  //!< Last slot is used for unknown ucodes
+
+public:
+
+    //Constructor / Destructor
+    DisplayListProfiler();
+    ~DisplayListProfiler();
+
+    bool initialize();
+    void dispose();
+
+    //Frame
+    void beginFrame(int ucode);
+    void endFrame();
+
+    //! Add time spent executing an instruction
+    void record(unsigned int cmd, unsigned long long ticks)
+    {
+        m_frameCount[cmd & 0xFF]++;
+        m_frameTicks[cmd & 0xFF] += ticks;
+    }
+
+    //! Add time spent rendering batched triangles
+    void recordRender(unsigned long long ticks)
+    {
+        m_frameRenderCount++;
+        m_frameRenderTicks += ticks;
+    }
+
+    //Report cumulative totals
+    void printSummary();
+    bool writeCSV(const char* filename);
+
+    //! Get cycle counter (time stamp counter where available)
+    static unsigned long long getTicks()
+    {
+#if defined(_MSC_VER)
+        return __rdtsc();
+#elif defined(__i386__) || defined(__x86_64__)
+        return __builtin_ia32_rdtsc();
+#else
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (unsigned long long)now.tv_sec * 1000000000ULL + now.tv_nsec;
+#endif
+    }
+
+private:
+
+    void _printTop(const char* title, m64p_msg_level level, int ucode, const unsigned long long* count, const unsigned long long* ticks,
+                   unsigned long long renderCount, unsigned long long renderTicks);
+
+private:
+
+    //Current frame
+    int m_ucodeIndex;                              //!< Slot of ucode used by current frame
+    unsigned long long m_frameCount[256];          //!< Instructions executed this frame
+    unsigned long long m_frameTicks[256];          //!< Ticks spent in instructions this frame
+    unsigned long long m_frameRenderCount;         //!< Batches rendered this frame
+    unsigned long long m_frameRenderTicks;         //!< Ticks spent rendering this frame
+
+    //Cumulative totals
+    unsigned int m_numFrames;                                   //!< Frames profiled
+    unsigned long long m_count[MAX_UCODES][256];                //!< Instructions executed per ucode
+    unsigned long long m_ticks[MAX_UCODES][256];                //!< Ticks spent in instructions per ucode
+    unsigned long long m_renderCount[MAX_UCODES];               //!< Batches rendered per ucode
+    unsigned long long m_renderTicks[MAX_UCODES];               //!< Ticks spent rendering per ucode
+
+};
+
+//! Helpers for the display list parser, expand to nothing without profiler
+#define PROFILE_DECLARE()     unsigned int profileCmd = 0; unsigned long long profileStart = 0
+#define PROFILE_BEGIN(cmd)    profileCmd = (cmd); profileStart = DisplayListProfiler::getTicks()
+#define PROFILE_END()         m_profiler.record(profileCmd, DisplayListProfiler::getTicks() - profileStart)
+#define PROFILE_BEGIN_RENDER() profileStart = DisplayListProfiler::getTicks()
+#define PROFILE_END_RENDER()  m_profiler.recordRender(DisplayListProfiler::getTicks() - profileStart)
+
+#else
+
+#define PROFILE_DECLARE()
+#define PROFILE_BEGIN(cmd)
+#define PROFILE_END()
+#define PROFILE_BEGIN_RENDER()
+#define PROFILE_END_RENDER()
+
+#endif //DISPLAYLIST_PROFILER
+
+#endif
@@ -19,41 +19,13 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  *****************************************************************************/
 
-#include <string.h>
-
 #include "ExtensionChecker.h"
-#include "OpenGL.h"
-#include "m64p.h"
+#include "RenderDevice.h"
 
 //-----------------------------------------------------------------------------
 //! Is Extension Supported
 //-----------------------------------------------------------------------------
 bool isExtensionSupported( const char *extension )
 {
-    const GLubyte *extensions = NULL;
-    const GLubyte *start;
-    GLubyte *where, *terminator;
-
-    where = (GLubyte *) strchr(extension, ' ');
-    if (where || *extension == '\0')
-        return false;
-
-    extensions = glGetString(GL_EXTENSIONS);
-
-    start = extensions;
-    for (;;)
-    {
-        where = (GLubyte *) strstr((const char *) start, extension);
-        if (!where)
-            break;
-
-        terminator = where + strlen(extension);
-        if (where == start || *(where - 1) == ' ')
-            if (*terminator == ' ' || *terminator == '\0')
-                return true;
-
-        start = terminator;
-    }
-
-    return false;
+    return RenderDevice::getSingleton().isExtensionSupported(extension);
 }
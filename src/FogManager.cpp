@@ -23,6 +23,7 @@
 #include "ExtensionChecker.h"
 #include "FogManager.h"
 #include "OpenGL.h"
+#include "RenderDevice.h"
 #include "m64p.h"
 
 #ifndef GL_GLEXT_VERSION
@@ -106,7 +107,7 @@ void FogManager::initialize()
         }        
     }
 
-    glFogi(GL_FOG_COORDINATE_SOURCE_EXT, GL_FOG_COORDINATE_EXT);
+    RenderDevice::getSingleton().setFogParameteri(GL_FOG_COORDINATE_SOURCE_EXT, GL_FOG_COORDINATE_EXT);
 }
 
 //-----------------------------------------------------------------------------
@@ -128,7 +129,7 @@ void FogManager::setFogCoordPointer(unsigned int type, int stride, const void* p
 {
     if ( m_fogExtensionsSupported )
     {
-        glFogCoordPointerEXT(type, stride, pointer);
+        RenderDevice::getSingleton().setFogCoordPointer(type, stride, pointer);
     }
 }
 
@@ -141,7 +142,7 @@ void FogManager::enableFogCoordArray()
 {
     if ( m_fogExtensionsSupported )
     {
-        glEnableClientState(GL_FOG_COORDINATE_ARRAY_EXT);
+        RenderDevice::getSingleton().enableClientState(GL_FOG_COORDINATE_ARRAY_EXT);
     }
 }
 
@@ -154,7 +155,7 @@ void FogManager::disableFogCoordArray()
 {
     if ( m_fogExtensionsSupported )
     {
-        glDisableClientState(GL_FOG_COORDINATE_ARRAY_EXT);
+        RenderDevice::getSingleton().disableClientState(GL_FOG_COORDINATE_ARRAY_EXT);
     }
 }
 
@@ -172,9 +173,10 @@ void FogManager::disableFogCoordArray()
 //-----------------------------------------------------------------------------
 void FogManager::setLinearFog(float start, float end)
 {
-    glFogi(GL_FOG_MODE, GL_LINEAR);
-    glFogf(GL_FOG_START, start);
-    glFogf(GL_FOG_END, end);
+    RenderDevice& device = RenderDevice::getSingleton();
+    device.setFogParameteri(GL_FOG_MODE, GL_LINEAR);
+    device.setFogParameterf(GL_FOG_START, start);
+    device.setFogParameterf(GL_FOG_END, end);
 }
 
 //-----------------------------------------------------------------------------
@@ -187,5 +189,5 @@ void FogManager::setLinearFog(float start, float end)
 void FogManager::setFogColor(float r, float g, float b, float a)
 {
     float fogColor[4] = { r,g,b,a };
-    glFogfv(GL_FOG_COLOR, fogColor );
+    RenderDevice::getSingleton().setFogColor(fogColor);
 }
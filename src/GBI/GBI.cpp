@@ -91,6 +91,8 @@ unsigned int GBI::G_MWO_aLIGHT_8, GBI::G_MWO_bLIGHT_8;
 GBI::GBI()
 {
     m_ucodeSelector = 0;
+    m_generation = 0;
+    m_ucode = -1;
 }
 
 //-----------------------------------------------------------------------------
@@ -166,6 +168,8 @@ bool GBI::initialize(RSP* rsp, RDP* rdp, Memory* memory, DisplayListParser* dlp)
     m_ucode10.initialize(this, m_rsp, m_rdp, memory, dlp);
 
     m_previusUCodeStart = -1;
+    m_ucode = -1;
+    _updateFlags();
 
     return true;
 }
@@ -196,6 +200,7 @@ void GBI::selectUCode( unsigned int ucStart,
 
     //Identify ucode
     unsigned int ucode = m_ucodeSelector->checkUCode(ucStart, ucDStart, ucSize, ucDSize);
+    m_ucode = (int)ucode;
 
     //Unsupported ucodes
     if ( ucode >= 6 || ucode == 3 )
@@ -234,6 +239,122 @@ void GBI::selectUCode( unsigned int ucStart,
             break;
     }
 
+    _updateFlags();
+}
+
+//-----------------------------------------------------------------------------
+//* Update Flags
+//! Classifies instructions of the current ucode. Everything flushes unless
+//! it is known not to, the triangle instructions are the same ones the
+//! display list parser has always batched.
+//-----------------------------------------------------------------------------
+void GBI::_updateFlags()
+{
+    for (int i=0; i<256; ++i)
+    {
+        m_flags[i] = GBI_FLUSHES | GBI_CHANGES_STATE;
+    }
+
+    //Syncs, no-ops and display list calls do not affect rendering
+    for (int i=0; i<256; ++i)
+    {
+        if ( m_cmds[i] == (GBIFunc)RDPInstructions::RDP_NoOp     || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_PipeSync || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_TileSync || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_LoadSync ) 
+        {
+            m_flags[i] = 0;
+        }
+    }
+    m_flags[G_SPNOOP & 0xFF] = 0;
+    m_flags[G_DL     & 0xFF] = 0;
+    m_flags[G_ENDDL  & 0xFF] = 0;
+
+    //Triangles
+    m_flags[G_TRI1    & 0xFF] = GBI_DRAWS;
+    m_flags[G_TRI2    & 0xFF] = GBI_DRAWS;
+    m_flags[G_TRI4    & 0xFF] = GBI_DRAWS;
+    m_flags[G_QUAD    & 0xFF] = GBI_DRAWS;
+    m_flags[G_DMA_TRI & 0xFF] = GBI_DRAWS;
+
+    //Rectangles are batched, the RDP renders them itself before states change
+    for (int i=0; i<256; ++i)
+    {
+        if ( m_cmds[i] == (GBIFunc)RDPInstructions::RDP_FillRect    || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_TexRect     || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_TexRectFlip ) 
+        {
+            m_flags[i] = GBI_DRAWS | GBI_CHANGES_STATE;
+        }
+        else if ( m_cmds[i] == (GBIFunc)UCode2::renderSky ) 
+        {
+            m_flags[i] |= GBI_DRAWS;
+        }
+    }
+
+    //Instructions that only use their own two words
+    const unsigned int cacheableRSP[] = { G_SPNOOP, G_VTX, G_TRI1, G_TRI2, G_TRI4, G_QUAD, 
+                                          G_MTX, G_POPMTX, G_TEXTURE, G_GEOMETRYMODE, 
+                                          G_SETGEOMETRYMODE, G_CLEARGEOMETRYMODE, 
+                                          G_SETOTHERMODE_H, G_SETOTHERMODE_L };
+    for (unsigned int i=0; i<sizeof(cacheableRSP)/sizeof(cacheableRSP[0]); ++i)
+    {
+        m_flags[cacheableRSP[i] & 0xFF] |= GBI_CACHEABLE;
+    }
+    for (int i=0; i<256; ++i)
+    {
+        if ( m_cmds[i] == (GBIFunc)RDPInstructions::RDP_SetZImg       || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_SetTImg       || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_SetTile       || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_LoadTile      || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_LoadBlock     || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_SetTileSize   || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_LoadTLUT      || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_FillRect      || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_SetEnvColor   || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_SetPrimColor  || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_SetBlendColor || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_SetFogColor   || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_SetFillColor  || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_SetCombine    || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_SetOtherMode  || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_SetPrimDepth  || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_SetScissor    || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_SetConvert    || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_SetKeyR       || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_SetKeyGB      || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_NoOp          || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_PipeSync      || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_TileSync      || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_LoadSync      ) 
+        {
+            m_flags[i] |= GBI_CACHEABLE;
+        }
+    }
+
+    //Never cache functions that read or move the program counter, 
+    //in case a command value above is left over from another ucode
+    for (int i=0; i<256; ++i)
+    {
+        if ( m_cmds[i] == m_cmds[G_DL & 0xFF]                         || 
+             m_cmds[i] == m_cmds[G_ENDDL & 0xFF]                      || 
+             m_cmds[i] == m_cmds[G_CULLDL & 0xFF]                     || 
+             m_cmds[i] == m_cmds[G_BRANCH_Z & 0xFF]                   || 
+             m_cmds[i] == m_cmds[G_DMA_DL & 0xFF]                     || 
+             m_cmds[i] == m_cmds[G_LOAD_UCODE & 0xFF]                 || 
+             m_cmds[i] == m_cmds[G_RDPHALF_1 & 0xFF]                  || 
+             m_cmds[i] == (GBIFunc)UCode0::F3D_MoveMem                || 
+             m_cmds[i] == (GBIFunc)UCode5::F3DEX2_MoveMem             || 
+             m_cmds[i] == (GBIFunc)UCode2::renderSky                  || 
+             m_cmds[i] == (GBIFunc)UCode10::ConkerBFD_Add4Triangles   || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_TexRect       || 
+             m_cmds[i] == (GBIFunc)RDPInstructions::RDP_TexRectFlip   ) 
+        {
+            m_flags[i] &= ~GBI_CACHEABLE;
+        }
+    }
+
+    m_generation++;
 }
 
 //-----------------------------------------------------------------------------
@@ -57,6 +57,19 @@ class UCodeSelector;
 //-----------------------------------------------------------------------------
 typedef void (*GBIFunc)( MicrocodeArgument* );
 
+//-----------------------------------------------------------------------------
+//* GBI Flags
+//! Describes what a GBI instruction does, used by the display list parser
+//! to decide when triangles have to be rendered.
+//-----------------------------------------------------------------------------
+enum GBIFlags
+{
+    GBI_DRAWS         = 0x01,  //!< Adds triangles to the renderer
+    GBI_FLUSHES       = 0x02,  //!< Pending triangles must be rendered before the instruction
+    GBI_CHANGES_STATE = 0x04,  //!< Changes state used when rendering
+    GBI_CACHEABLE     = 0x08,  //!< Only depends on its own words, can be executed from DisplayListCache
+};
+
 //-----------------------------------------------------------------------------
 //* GBI
 //! Defines the Graphical Binary Interface meaning how the graphic 
@@ -76,9 +89,18 @@ public:
                       unsigned int ucSize, 
                       unsigned int ucDSize);
 
+    //! Get id of selected ucode, -1 before first display list
+    int getUCode() { return m_ucode; }
+
     //Dummy instruction
     static void unknownInstruction(MicrocodeArgument* arg);
 
+private:
+
+    void _updateFlags();
+
+public:
+
     static unsigned int G_MOVEMEM, G_MOVEWORD;
     static unsigned int G_RDPHALF_1, G_RDPHALF_2, G_RDPHALF_CONT;
     static unsigned int G_SPNOOP;
@@ -132,6 +154,8 @@ public:
 
     //Function pointer list 
     GBIFunc m_cmds[256];  //! Function pointers to diffrent GBI instructions
+    unsigned char m_flags[256];  //!< GBIFlags for each instruction, updated when ucode changes
+    unsigned int m_generation;   //!< Increased when instructions change
 
     //Pointers
     RSP* m_rsp;           //!< Pointer to Reality Signal Processor 
@@ -157,6 +181,7 @@ public:
 
     //Previus ucode
     unsigned int m_previusUCodeStart;
+    int m_ucode;                       //!< Id of selected ucode (UCodeSelector)
 };
 
 
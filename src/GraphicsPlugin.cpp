@@ -23,7 +23,7 @@
 #include <sys/time.h>
 #include <ctime>
 
-#include "ConfigMap.h"           //Configuration
+#include "Config.h"              //Configuration
 #include "DisplayListParser.h"   //Displaylist parser
 #include "FogManager.h"          //Fog 
 #include "FrameBuffer.h"         //Framebuffer
@@ -35,8 +35,13 @@
 #include "OpenGLManager.h"
 #include "OpenGLRenderer.h"      //Renderer
 #include "RDP.h"                 //Reality Drawing Processor
+#include "RDPCommandParser.h"    //Low level RDP lists
 #include "RSP.h"                 //Reality Signal Processor
+#include "RenderDevice.h"        //Graphics API abstraction
 #include "RomDetector.h"
+#include "SharedFrameRing.h"       //Shared memory frame output
+#include "ThreadPool.h"          //Worker threads
+#include "TraceWriter.h"         //Display list capture
 #include "VI.h"                  //Video interface
 #include "m64p.h"
 #include "m64p_types.h"
@@ -54,6 +59,11 @@ GraphicsPlugin::GraphicsPlugin()
     m_initialized = false;
     m_updateConfig = false;
     m_fogManager = 0;
+    m_traceWriter = 0;
+    m_frameRing = 0;
+    m_memory = 0;
+    m_displayListParser = 0;
+    m_rdpCommandParser = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -79,6 +89,14 @@ bool GraphicsPlugin::initialize(GFX_INFO* graphicsInfo)
     //Save pointer to graphics info
     m_graphicsInfo = graphicsInfo;
 
+    //Select render device
+    RenderDevice::select(m_config->nullRenderDevice ? RENDER_DEVICE_NULL : RENDER_DEVICE_OPENGL);
+    if ( !RenderDevice::getSingleton().initialize() )
+    {
+        Logger::getSingleton().printMsg("Unable to initialize render device", M64MSG_ERROR);
+        return false;
+    }
+
     m_numDListProcessed = 0;
 
     //Detect what rom it is
@@ -115,6 +133,12 @@ bool GraphicsPlugin::initialize(GFX_INFO* graphicsInfo)
 
     CoreVideo_SetCaption("Arachnoid");
 
+    //Start worker threads
+    if ( !ThreadPool::getSingleton().initialize(m_config->workerThreads) )
+    {
+        Logger::getSingleton().printMsg("Unable to start worker threads, all work is done on emulation thread", M64MSG_WARNING);
+    }
+
     //Initialize Video Interface
     m_vi = new VI();
     m_vi->calcSize(m_graphicsInfo);
@@ -125,9 +149,23 @@ bool GraphicsPlugin::initialize(GFX_INFO* graphicsInfo)
     {
         return false;
     }
+
+    //Track RDRAM writes, only the part of RDRAM the emulator allocated
+    if ( m_config->rdramWriteTracking )
+    {
+        unsigned int rdramSize = m_memory->getRDRAMSize();
+        if ( m_graphicsInfo->version >= 2 && m_graphicsInfo->RDRAM_SIZE && *m_graphicsInfo->RDRAM_SIZE < rdramSize )
+        {
+            rdramSize = *m_graphicsInfo->RDRAM_SIZE;
+        }
+        if ( !m_memory->enableWriteTracking(rdramSize) )
+        {
+            Logger::getSingleton().printMsg("RDRAM write tracking not permitted, caches use hashing", M64MSG_WARNING);
+        }
+    }
     
     m_displayListParser = new DisplayListParser();
-    m_displayListParser->initialize(&m_rsp, &m_rdp, &m_gbi, m_memory);
+    m_displayListParser->initialize(&m_rsp, &m_rdp, &m_gbi, m_memory, m_config->displayListCache);
 
     //Init OpenGL
     if ( !m_openGLMgr.initialize(m_config->startFullscreen, m_config->fullscreenWidth, m_config->fullscreenHeight, m_config->fullscreenBitDepth, m_config->fullscreenRefreshRate, true, false) ) 
@@ -151,7 +189,7 @@ bool GraphicsPlugin::initialize(GFX_INFO* graphicsInfo)
     m_textureCache.setMipmap( m_config->mipmapping );
 
     //Initialize OpenGL Renderer
-    if ( !OpenGLRenderer::getSingleton().initialize(&m_rsp, &m_rdp, &m_textureCache, m_vi, m_fogManager) ) 
+    if ( !OpenGLRenderer::getSingleton().initialize(&m_rsp, &m_rdp, &m_textureCache, m_vi, m_fogManager, m_config->vertexBufferSize) ) 
     {
         Logger::getSingleton().printMsg("Unable to initialize OpenGL Renderer", M64MSG_ERROR);
         return false;
@@ -161,19 +199,99 @@ bool GraphicsPlugin::initialize(GFX_INFO* graphicsInfo)
     m_rdp.initialize(m_graphicsInfo, &m_rsp, m_memory, &m_gbi, &m_textureCache, m_vi, m_displayListParser, m_fogManager);
     m_rsp.initialize(m_graphicsInfo, &m_rdp, m_memory, m_vi, m_displayListParser, m_fogManager);
     m_gbi.initialize(&m_rsp, &m_rdp, m_memory, m_displayListParser);    
+
+    //Render color images other than the frame to textures
+    FrameBufferCache* frameBufferCache = 0;
+    if ( m_config->frameBufferTextures )
+    {
+        if ( m_frameBufferCache.initialize(m_memory) )
+        {
+            frameBufferCache = &m_frameBufferCache;
+        }
+        else
+        {
+            Logger::getSingleton().printMsg("Framebuffer objects not supported, color images are not rendered to textures", M64MSG_WARNING);
+        }
+    }
+    m_rdp.setFrameBufferCache(frameBufferCache);
+    m_textureCache.setFrameBufferCache(frameBufferCache);
+
+    //Initialize parser for low level RDP lists (uses RDP instructions set up by GBI)
+    m_rdpCommandParser = new RDPCommandParser();
+    m_rdpCommandParser->initialize(m_graphicsInfo, &m_rsp, &m_rdp, m_memory, m_vi);
         
 
     //Set Background color
     m_openGLMgr.setClearColor(0.0f, 0.0f, 0.0f);
     m_openGLMgr.setLighting(false);
-    glDisable(GL_LIGHTING);
+    RenderDevice::getSingleton().disable(GL_LIGHTING);
     m_openGLMgr.setCullMode(false, true);
     m_openGLMgr.setWireFrame(m_config->wireframe);   
+    m_openGLMgr.setFramePacing(m_config->framesInFlight, m_config->lowLatency);
+
+    //Initialize asynchronous ReadScreen2 and shared memory frame output, both copy frames through pixel buffers
+    if ( m_config->readScreenMode != READ_SCREEN_SYNC || m_config->frameRing )
+    {
+        m_screenReadback.initialize(m_config->readScreenBuffers, m_config->readScreenMode == READ_SCREEN_EXACT);
+        m_openGLMgr.setScreenReadback(&m_screenReadback);
+    }
+    if ( m_config->readbackWidth > 0 && m_config->readbackHeight > 0 )
+    {
+        if ( RenderDevice::getSingleton().isFramebufferSupported() )
+        {
+            m_screenReadback.setScale(m_config->readbackWidth, m_config->readbackHeight, m_config->readbackFilter == READBACK_FILTER_BOX);
+        }
+        else
+        {
+            Logger::getSingleton().printMsg("Framebuffer objects not supported, frames are read at window size", M64MSG_WARNING);
+        }
+    }
+    if ( m_config->frameRing )
+    {
+        int frameWidth  = m_screenReadback.isScaled() ? m_screenReadback.getScaleWidth()  : m_config->windowWidth;
+        int frameHeight = m_screenReadback.isScaled() ? m_screenReadback.getScaleHeight() : m_config->windowHeight;
+        m_frameRing = new SharedFrameRing();
+        unsigned int frameBytes = ((frameWidth * 3 + 3) & ~3) * frameHeight;
+        if ( m_frameRing->initialize(m_config->frameRingName, m_config->frameRingSlots, frameBytes) )
+        {
+            m_screenReadback.setFrameRing(m_frameRing);
+            m_screenReadback.start();
+        }
+        else
+        {
+            Logger::getSingleton().printMsg("Unable to create shared memory frame ring", M64MSG_WARNING);
+            delete m_frameRing;
+            m_frameRing = 0;
+        }
+    }
+
+    //Initialize trace capture
+    if ( m_config->traceCapture )
+    {
+        m_traceWriter = new TraceWriter();
+        if ( !m_traceWriter->initialize(m_config->traceFilename, m_graphicsInfo, m_memory) )
+        {
+            delete m_traceWriter;
+            m_traceWriter = 0;
+        }
+    }
 
     //Initialize framebuffer
     //framebuffer01.initialize(width, height);
    // framebuffer02.initialize(width, height);
 
+    //Move OpenGL calls to render thread
+    if ( m_config->threadedRendering && RenderDevice::getType() == RENDER_DEVICE_OPENGL )
+    {
+        RenderDevice::select(RENDER_DEVICE_THREADED);
+        if ( !RenderDevice::getSingleton().initialize() )
+        {
+            Logger::getSingleton().printMsg("Unable to start render thread, rendering on emulation thread", M64MSG_WARNING);
+            RenderDevice::select(RENDER_DEVICE_OPENGL);
+        }
+        OpenGLRenderer::getSingleton().setVertexArrays();
+    }
+
     m_initialized = true;
     return true;
 }
@@ -185,16 +303,25 @@ void GraphicsPlugin::dispose()
 {    
     //Dispose of Textures
     m_textureCache.dispose();
+    m_frameBufferCache.dispose();
+
+    m_openGLMgr.setScreenReadback(0);
+    m_screenReadback.dispose();
+    if ( m_frameRing )         { delete m_frameRing;         m_frameRing = 0;         }
 
     //Dispose of member objects
+    if ( m_traceWriter )       { delete m_traceWriter;       m_traceWriter = 0;       }
     if ( m_vi )                { delete m_vi;                m_vi = 0;                }
     if ( m_memory )            { delete m_memory;            m_memory = 0;            }
     if ( m_displayListParser ) { delete m_displayListParser; m_displayListParser = 0; }
+    if ( m_rdpCommandParser )  { delete m_rdpCommandParser;  m_rdpCommandParser = 0;  }
     if ( m_fogManager )        { delete m_fogManager;        m_fogManager = 0;        }
     
     m_gbi.dispose();
     m_rdp.dispose();
     m_rsp.dispose();
+    OpenGLRenderer::getSingleton().dispose();
+    ThreadPool::getSingleton().dispose();
     
     //Dispose of OpenGL
     //framebuffer01.dispose();
@@ -202,7 +329,10 @@ void GraphicsPlugin::dispose()
     m_openGLMgr.dispose();
 
     if (m_initialized)
+    {
+        RenderDevice::getSingleton().dispose();
         CoreVideo_Quit();
+    }
 
     m_initialized = false;
 }
@@ -320,13 +450,19 @@ void renderRedBox(float x, float y, float z, float width, float height,  float l
 //-----------------------------------------------------------------------------
 void GraphicsPlugin::processDisplayList()
 {
+    //Capture display list and memory before it is processed
+    if ( m_traceWriter )
+    {
+        m_traceWriter->captureDisplayList();
+    }
+
     if ( (m_numDListProcessed == 1 && m_romDetector->getClearType() == CT_AFTER_ONE_DISPLAY_LIST) ||
          (m_numDListProcessed == 2 && m_romDetector->getClearType() == CT_AFTER_TWO_DISPLAY_LIST) ||
          (m_numDListProcessed == 3 && m_romDetector->getClearType() == CT_AFTER_THREE_DISPLAY_LIST) )
     {
         bool scissors = OpenGLManager::getSingleton().getScissorEnabled();
         OpenGLManager::getSingleton().setScissorEnabled(false);
-        glClear(GL_COLOR_BUFFER_BIT);
+        RenderDevice::getSingleton().clear(GL_COLOR_BUFFER_BIT);
         m_numDListProcessed = 0;
         OpenGLManager::getSingleton().setScissorEnabled(scissors);
     }
@@ -365,7 +501,7 @@ void GraphicsPlugin::processDisplayList()
     //Render Scene
     OpenGLManager::getSingleton().beginRendering();        
     OpenGLManager::getSingleton().setTextureing2D(true);        
-    glEnable(GL_DEPTH_TEST);                        
+    RenderDevice::getSingleton().enable(GL_DEPTH_TEST);                        
     {    
         //glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);    
         m_rsp.reset();
@@ -383,14 +519,59 @@ void GraphicsPlugin::processDisplayList()
     //Take screenshot?
 }
 
+//-----------------------------------------------------------------------------
+//* Process RDP List
+//! Executes a low level RDP command list sent through the DP registers.
+//! RDP state is kept between lists, the command list decides what to reset.
+//-----------------------------------------------------------------------------
+void GraphicsPlugin::processRDPList()
+{
+    //Capture commands and memory before they are executed
+    if ( m_traceWriter )
+    {
+        m_traceWriter->captureRDPList();
+    }
+
+    //Get Video Interface Size
+    m_vi->calcSize(m_graphicsInfo);    
+    m_openGLMgr.calcViewScale(m_vi->getWidth(), m_vi->getHeight());
+
+    //Render commands
+    OpenGLManager::getSingleton().beginRendering();        
+    OpenGLManager::getSingleton().setTextureing2D(true);        
+    RenderDevice::getSingleton().enable(GL_DEPTH_TEST);                        
+    m_rdpCommandParser->processRDPList();
+
+    OpenGLManager::getSingleton().setDrawFlag();
+}
+
 //-----------------------------------------------------------------------------
 // Update Screen
 //-----------------------------------------------------------------------------
 void GraphicsPlugin::drawScreen()
 {
+    if ( m_traceWriter )
+    {
+        m_traceWriter->captureUpdateScreen();
+    }
+
+    m_frameBufferCache.endFrame();
     OpenGLManager::getSingleton().endRendering();
 }
 
+//-----------------------------------------------------------------------------
+//* Synchronize
+//! Waits until all rendering has been executed, needed before reading the
+//! frame buffer when rendering on a separate thread.
+//-----------------------------------------------------------------------------
+void GraphicsPlugin::synchronize()
+{
+    if ( m_initialized )
+    {
+        RenderDevice::getSingleton().synchronize();
+    }
+}
+
 void GraphicsPlugin::setDrawScreenSignal()
 {
     m_rdp.signalUpdate();
@@ -424,15 +605,15 @@ void GraphicsPlugin::toggleFullscreen()
 //-----------------------------------------------------------------------------
 void GraphicsPlugin::takeScreenshot(void *dest, int *width, int *height, int front)
 {
-    *width = m_config->windowWidth;
-    *height = m_config->windowHeight;
+    *width = m_screenReadback.isScaled() ? m_screenReadback.getScaleWidth() : m_config->windowWidth;
+    *height = m_screenReadback.isScaled() ? m_screenReadback.getScaleHeight() : m_config->windowHeight;
     if (dest)
     {
-        if (front)
-            glReadBuffer(GL_FRONT);
-        else
-            glReadBuffer(GL_BACK);
-        glReadPixels(0, 0, *width, *height, GL_RGB, GL_UNSIGNED_BYTE, dest);
+        //Asynchronous modes return a frame copied earlier instead
+        if ( m_config->readScreenMode == READ_SCREEN_SYNC || !m_screenReadback.read(dest, *width, *height) )
+        {
+            m_screenReadback.readPixels(dest, m_config->windowWidth, m_config->windowHeight, front != 0);
+        }
     }
 }
 
@@ -23,10 +23,12 @@
 #ifndef GRAPHICS_PLUGIN_H_
 #define GRAPHICS_PLUGIN_H_
 
+#include "FrameBufferCache.h"
 #include "GBI.h"
 #include "OpenGLManager.h"         //Initializes OpenGL and handles OpenGL states
 #include "RDP.h"
 #include "RSP.h"
+#include "ScreenReadback.h"
 #include "TextureCache.h"
 #include "m64p_plugin.h"
 
@@ -35,7 +37,10 @@ class DisplayListParser;
 class FogManager;
 class Memory;
 class OpenGLManager;
+class RDPCommandParser;
 class ROMDetector;
+class SharedFrameRing;
+class TraceWriter;
 //struct GFX_INFO;
 class VI;
 struct ConfigMap;
@@ -61,8 +66,10 @@ public:
     
     //Render
     void processDisplayList();
+    void processRDPList();
     void drawScreen();
     void setDrawScreenSignal();
+    void synchronize();
     
     //Toggle Fullscreen
     void toggleFullscreen();
@@ -76,6 +83,25 @@ public:
     //Function called when rom will be closed
     void dispose();
 
+    //Get Memory (used to restore segments when replaying traces)
+    Memory* getMemory() { return m_memory; }
+
+    //Get Texture Cache (used for statistics when replaying traces)
+    TextureCache* getTextureCache() { return &m_textureCache; }
+
+    //Get Display List Parser (used for statistics when replaying traces)
+    DisplayListParser* getDisplayListParser() { return m_displayListParser; }
+
+    //Get RDP Command Parser (used for statistics when replaying traces)
+    RDPCommandParser* getRDPCommandParser() { return m_rdpCommandParser; }
+
+    //Get Processors (used to drive single stages from the benchmarks)
+    RSP* getRSP() { return &m_rsp; }
+    RDP* getRDP() { return &m_rdp; }
+    ScreenReadback* getScreenReadback() { return &m_screenReadback; }
+    FrameBufferCache* getFrameBufferCache() { return &m_frameBufferCache; }
+    SharedFrameRing* getFrameRing() { return m_frameRing; }
+
 private:
 
     //Config Options
@@ -93,11 +119,16 @@ private:
     VI*                   m_vi;                  //!< Video Interface
     Memory*               m_memory;              //!< Handle RDRAM, Texture Memory and Segments
     TextureCache          m_textureCache;        //!< Save used texture for reuse
+    FrameBufferCache      m_frameBufferCache;    //!< Color images rendered to textures
+    ScreenReadback        m_screenReadback;      //!< Reads frames for ReadScreen2 without stalling
+    SharedFrameRing*      m_frameRing;           //!< Shared memory frame output, 0 if disabled
     ROMDetector*          m_romDetector;         //!< 
     OpenGLManager&        m_openGLMgr;           //!< Handles initialization of OpenGL and OpenGL states.
     DisplayListParser*    m_displayListParser;   //!< Parses and performs instructions from emulator
+    RDPCommandParser*     m_rdpCommandParser;    //!< Executes low level RDP command lists
     ConfigMap*            m_config;              //!< Settings from config dialog/file
     FogManager*           m_fogManager;          //!< Handles fog extension
+    TraceWriter*          m_traceWriter;         //!< Captures display lists when trace capture is enabled
     bool                  m_updateConfig;        //!< Does configuration need to be updated?
     bool                  m_initialized;         //!< Have graphics plugin been initialized?
     int                   m_numDListProcessed; 
@@ -19,19 +19,149 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  *****************************************************************************/
 
+#include <cstddef> //size_t
+
 #include "Memory.h"
 
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 //-----------------------------------------------------------------------------
 //* Static variables
 //-----------------------------------------------------------------------------
 unsigned long long Memory::m_TMEM[512] = {0};
 
+//! Memory whose RDRAM writes are tracked, faults are forwarded to it
+static Memory* volatile g_trackedMemory = 0;
+
+#ifdef WIN32
+
+static PVOID g_faultHandler = 0;
+
+//-----------------------------------------------------------------------------
+//! Catches writes to protected RDRAM pages, other faults are passed on
+//-----------------------------------------------------------------------------
+static LONG CALLBACK writeFaultHandler(PEXCEPTION_POINTERS info)
+{
+    PEXCEPTION_RECORD record = info->ExceptionRecord;
+    if ( record->ExceptionCode == EXCEPTION_ACCESS_VIOLATION &&
+         record->ExceptionInformation[0] == 1 &&
+         g_trackedMemory && g_trackedMemory->handleWriteFault((void*)record->ExceptionInformation[1]) )
+    {
+        return EXCEPTION_CONTINUE_EXECUTION;
+    }
+    return EXCEPTION_CONTINUE_SEARCH;
+}
+
+static bool protectPages(void* address, unsigned int size, bool writable)
+{
+    DWORD oldProtection;
+    return VirtualProtect(address, size, writable ? PAGE_READWRITE : PAGE_READONLY, &oldProtection) != 0;
+}
+
+#else
+
+static struct sigaction g_previousSEGV;
+#ifdef __APPLE__
+static struct sigaction g_previousBUS;
+#endif
+
+//-----------------------------------------------------------------------------
+//! Catches writes to protected RDRAM pages, other faults are passed on to
+//! the handler that was installed before
+//-----------------------------------------------------------------------------
+static void writeFaultHandler(int signal, siginfo_t* info, void* context)
+{
+    if ( g_trackedMemory && g_trackedMemory->handleWriteFault(info->si_addr) )
+    {
+        return;
+    }
+
+    struct sigaction* previous = &g_previousSEGV;
+#ifdef __APPLE__
+    if ( signal == SIGBUS ) previous = &g_previousBUS;
+#endif
+    if ( previous->sa_flags & SA_SIGINFO )
+    {
+        previous->sa_sigaction(signal, info, context);
+    }
+    else if ( previous->sa_handler == SIG_DFL || previous->sa_handler == SIG_IGN )
+    {
+        //Fault happens again when handler returns and is not caught this time
+        sigaction(signal, previous, 0);
+    }
+    else
+    {
+        previous->sa_handler(signal);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Is writeFaultHandler the handler currently installed for signal?
+//-----------------------------------------------------------------------------
+static bool isFaultHandlerInstalled(int signal)
+{
+    struct sigaction current;
+    return sigaction(signal, 0, &current) == 0 && 
+           (current.sa_flags & SA_SIGINFO) && current.sa_sigaction == writeFaultHandler;
+}
+
+//-----------------------------------------------------------------------------
+//! Installs writeFaultHandler for signal, unless it is still installed
+//! from an earlier time tracking was enabled
+//-----------------------------------------------------------------------------
+static bool installFaultHandler(int signal, struct sigaction* previous)
+{
+    if ( isFaultHandlerInstalled(signal) )
+    {
+        return true;
+    }
+
+    struct sigaction action;
+    action.sa_sigaction = writeFaultHandler;
+    action.sa_flags = SA_SIGINFO | SA_NODEFER;
+    sigemptyset(&action.sa_mask);
+    return sigaction(signal, &action, previous) == 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Restores handler that was installed before writeFaultHandler. If the core
+//! or another plugin has installed a handler since, that one is left in place
+//! so it is not lost. It may pass faults on to writeFaultHandler, which passes
+//! them on to the previous handler while nothing is tracked.
+//-----------------------------------------------------------------------------
+static void removeFaultHandler(int signal, const struct sigaction* previous)
+{
+    if ( isFaultHandlerInstalled(signal) )
+    {
+        sigaction(signal, previous, 0);
+    }
+}
+
+static bool protectPages(void* address, unsigned int size, bool writable)
+{
+    return mprotect(address, size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ) == 0;
+}
+
+#endif
+
 //-----------------------------------------------------------------------------
 //! Constructor
 //-----------------------------------------------------------------------------
 Memory::Memory()
 {
-
+    m_trackedBase = 0;
+    m_trackedOffset = 0;
+    m_pageSize = 0;
+    m_numPages = 0;
+    m_pageGenerations = 0;
+    m_pageProtected = 0;
+    m_numWriteFaults = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -39,7 +169,7 @@ Memory::Memory()
 //-----------------------------------------------------------------------------
 Memory::~Memory()
 {
-
+    disableWriteTracking();
 }
 
 //-----------------------------------------------------------------------------
@@ -70,3 +200,203 @@ bool Memory::initialize(unsigned char* RDRAM, unsigned char* DMEM)
     m_RDRAMSize = 0x800000;
     return true;
 }
+
+//-----------------------------------------------------------------------------
+//* Enable Write Tracking
+//! Installs fault handler and checks that a protected RDRAM page is caught
+//! when written to. Only whole host pages inside RDRAM can be watched.
+//! @param rdramSize Size of RDRAM allocated by emulator
+//! @return False if host does not allow RDRAM to be protected
+//-----------------------------------------------------------------------------
+bool Memory::enableWriteTracking(unsigned int rdramSize)
+{
+    disableWriteTracking();
+
+    //Only one RDRAM can be tracked
+    if ( g_trackedMemory || !m_RDRAM )
+    {
+        return false;
+    }
+
+#ifdef WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    m_pageSize = info.dwPageSize;
+#else
+    long pageSize = sysconf(_SC_PAGESIZE);
+    m_pageSize = ( pageSize > 0 ) ? (unsigned int)pageSize : 4096;
+#endif
+
+    //Whole pages inside RDRAM
+    unsigned long long first = ((unsigned long long)(size_t)m_RDRAM + m_pageSize - 1) / m_pageSize * m_pageSize;
+    m_trackedOffset = (unsigned int)(first - (size_t)m_RDRAM);
+    if ( m_trackedOffset >= rdramSize )
+    {
+        return false;
+    }
+    m_trackedBase = m_RDRAM + m_trackedOffset;
+    m_numPages = (rdramSize - m_trackedOffset) / m_pageSize;
+    if ( m_numPages == 0 )
+    {
+        return false;
+    }
+
+    m_pageGenerations = new unsigned int[m_numPages];
+    m_pageProtected = new bool[m_numPages];
+    for (unsigned int i=0; i<m_numPages; ++i)
+    {
+        m_pageGenerations[i] = 0;
+        m_pageProtected[i] = false;
+    }
+    m_numWriteFaults = 0;
+    g_trackedMemory = this;
+
+#ifdef WIN32
+    g_faultHandler = AddVectoredExceptionHandler(1, writeFaultHandler);
+    bool installed = ( g_faultHandler != 0 );
+#else
+    bool installed = installFaultHandler(SIGSEGV, &g_previousSEGV);
+#ifdef __APPLE__
+    installed = installed && installFaultHandler(SIGBUS, &g_previousBUS);
+#endif
+#endif
+
+    //Write same value to a protected page, it must be caught
+    if ( installed && protectPages(m_trackedBase, m_pageSize, false) )
+    {
+        m_pageProtected[0] = true;
+        volatile unsigned char* probe = m_trackedBase;
+        *probe = *probe;
+    }
+
+    if ( m_pageGenerations[0] != 1 || m_pageProtected[0] )
+    {
+        disableWriteTracking();
+        return false;
+    }
+    m_numWriteFaults = 0;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//* Disable Write Tracking
+//! Unprotects all pages and removes fault handler, must be called before
+//! emulator gets RDRAM back
+//-----------------------------------------------------------------------------
+void Memory::disableWriteTracking()
+{
+    if ( !m_pageGenerations )
+    {
+        return;
+    }
+
+    for (unsigned int i=0; i<m_numPages; ++i)
+    {
+        if ( m_pageProtected[i] )
+        {
+            protectPages(m_trackedBase + i * m_pageSize, m_pageSize, true);
+            m_pageProtected[i] = false;
+        }
+    }
+
+#ifdef WIN32
+    if ( g_faultHandler ) { RemoveVectoredExceptionHandler(g_faultHandler); g_faultHandler = 0; }
+#else
+    removeFaultHandler(SIGSEGV, &g_previousSEGV);
+#ifdef __APPLE__
+    removeFaultHandler(SIGBUS, &g_previousBUS);
+#endif
+#endif
+    g_trackedMemory = 0;
+
+    delete[] m_pageGenerations;
+    delete[] m_pageProtected;
+    m_pageGenerations = 0;
+    m_pageProtected = 0;
+    m_numPages = 0;
+}
+
+//-----------------------------------------------------------------------------
+//* Watch
+//! Write protects pages covering range so writes to it are counted
+//! @return False if range can not be watched and has to be hashed instead
+//-----------------------------------------------------------------------------
+bool Memory::watch(unsigned int address, unsigned int size)
+{
+    if ( !m_pageGenerations || size == 0 || address < m_trackedOffset )
+    {
+        return false;
+    }
+
+    unsigned int firstPage = (address - m_trackedOffset) / m_pageSize;
+    unsigned int lastPage = (address + size - 1 - m_trackedOffset) / m_pageSize;
+    if ( lastPage >= m_numPages )
+    {
+        return false;
+    }
+
+    for (unsigned int i=firstPage; i<=lastPage; ++i)
+    {
+        if ( !m_pageProtected[i] )
+        {
+            if ( !protectPages(m_trackedBase + i * m_pageSize, m_pageSize, false) )
+            {
+                return false;
+            }
+            m_pageProtected[i] = true;
+        }
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//* Get Generation
+//! Sum of page generations covering range, changes when range may have
+//! been written to. Only meaningful for ranges that could be watched.
+//-----------------------------------------------------------------------------
+unsigned int Memory::getGeneration(unsigned int address, unsigned int size)
+{
+    if ( !m_pageGenerations || size == 0 || address < m_trackedOffset )
+    {
+        return 0;
+    }
+
+    unsigned int firstPage = (address - m_trackedOffset) / m_pageSize;
+    unsigned int lastPage = (address + size - 1 - m_trackedOffset) / m_pageSize;
+    if ( lastPage >= m_numPages )
+    {
+        lastPage = m_numPages - 1;
+    }
+
+    unsigned int generation = 0;
+    for (unsigned int i=firstPage; i<=lastPage; ++i)
+    {
+        generation += m_pageGenerations[i];
+    }
+    return generation;
+}
+
+//-----------------------------------------------------------------------------
+//* Handle Write Fault
+//! Called from fault handler, counts write and unprotects page so the
+//! write can be completed. A page may already be unprotected when two
+//! threads write to it at the same time, it is only counted once.
+//! @return False if address is not in tracked RDRAM
+//-----------------------------------------------------------------------------
+bool Memory::handleWriteFault(void* hostAddress)
+{
+    unsigned char* address = (unsigned char*)hostAddress;
+    if ( !m_pageGenerations || address < m_trackedBase || address >= m_trackedBase + m_numPages * m_pageSize )
+    {
+        return false;
+    }
+
+    unsigned int page = (unsigned int)(address - m_trackedBase) / m_pageSize;
+    if ( m_pageProtected[page] )
+    {
+        m_pageGenerations[page]++;
+        m_numWriteFaults++;
+        m_pageProtected[page] = false;
+    }
+    return protectPages(m_trackedBase + page * m_pageSize, m_pageSize, true);
+}
@@ -25,6 +25,12 @@
 //*****************************************************************************
 //* Memory
 //! Handle RDRAM, Texture Memory and Segments
+//!
+//! Optionally tracks writes to RDRAM: pages holding cached data are write
+//! protected with watch(), the first write to a protected page is caught,
+//! counted in the generation of the page, and the page is unprotected.
+//! Caches compare generations instead of hashing memory again, and fall
+//! back to hashing when a range can not be watched.
 //*****************************************************************************
 class Memory
 {
@@ -37,6 +43,15 @@ public:
     //Initialize
     bool initialize(unsigned char* RDRAM, unsigned char* DMEM);
 
+    //Write tracking
+    bool enableWriteTracking(unsigned int rdramSize);
+    void disableWriteTracking();
+    bool getWriteTracking() { return m_pageGenerations != 0; }
+    bool watch(unsigned int address, unsigned int size);
+    unsigned int getGeneration(unsigned int address, unsigned int size);
+    unsigned int getNumWriteFaults() { return m_numWriteFaults; }
+    bool handleWriteFault(void* hostAddress);
+
     //Get RDRAM
 
     unsigned char*  getRDRAM(int address=0)                { return &m_RDRAM[address]; }
@@ -55,6 +70,8 @@ public:
         return (m_segments[(segmentAddress >> 24) & 0x0F] + (segmentAddress & 0x00FFFFFF)) & 0x00FFFFFF; 
     }
 
+    unsigned int getSegment(unsigned int address) { return ( address < 16 ) ? m_segments[address] : 0; }
+
     void setSegment(unsigned int address, unsigned int value)
     {
         if ( address >= 16 ) {
@@ -73,6 +90,15 @@ private:
     unsigned int           m_segments[16];    //!< Temporary memory for storing segment values
     unsigned int           m_RDRAMSize;       //!< Size of RDRAM
 
+    //Write tracking
+    unsigned char*         m_trackedBase;       //!< First whole page of RDRAM
+    unsigned int           m_trackedOffset;     //!< RDRAM address of first whole page
+    unsigned int           m_pageSize;          //!< Size of host memory pages
+    unsigned int           m_numPages;          //!< Number of whole pages in RDRAM
+    volatile unsigned int* m_pageGenerations;   //!< Writes caught for every page
+    volatile bool*         m_pageProtected;     //!< Is page write protected?
+    volatile unsigned int  m_numWriteFaults;    //!< Writes caught since tracking was enabled
+
 };
 
 #endif
@@ -21,16 +21,48 @@
  *****************************************************************************/
 
 #include <stddef.h>
+#ifndef WIN32
+#include <time.h>
+#endif
 
 #include "OpenGLManager.h"
+#include "ScreenReadback.h"
 #include "m64p.h"
 
+//-----------------------------------------------------------------------------
+// Get Time
+//! Monotonic time in milliseconds, used to measure fence waits
+//-----------------------------------------------------------------------------
+static double getTime()
+{
+#ifdef WIN32
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (double)counter.QuadPart * 1000.0 / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec * 1000.0 + (double)now.tv_nsec / 1000000.0;
+#endif
+}
+
 //-----------------------------------------------------------------------------
 //! Constructor
 //-----------------------------------------------------------------------------
 OpenGLManager::OpenGLManager()
 {
     m_forceDisableCulling = false;
+    m_numFrames = 0;
+    m_framesInFlight = 2;
+    m_lowLatency = false;
+    m_waitPending = false;
+    m_waitTime = 0;
+    m_frameWaitTime = 0;
+    m_totalWaitTime = 0;
+    m_screenReadback = NULL;
+    m_viWidth = 320;
+    m_viHeight = 240;
 }
 
 //-----------------------------------------------------------------------------
@@ -47,17 +79,23 @@ OpenGLManager::OpenGLManager()
 //-----------------------------------------------------------------------------
 bool OpenGLManager::initialize(bool fullscreen, int width, int height, int bitDepth, int refreshRate, bool vSync, bool hideCursor)
 {
+    RenderDevice& device = RenderDevice::getSingleton();
+
     m_width       = width;
     m_height      = height;
     m_bitDepth    = bitDepth;
     m_refreshRate = refreshRate;
     m_fullscreen  = fullscreen;
     m_renderingCallback = NULL;
+    m_waitPending = false;
+    m_waitTime = 0;
+    m_frameWaitTime = 0;
+    m_totalWaitTime = 0;
     //Set OpenGL Settings
     setClearColor(0.0f, 0.0f, 0.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_CULL_FACE);
+    device.clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+    device.enable(GL_DEPTH_TEST);
+    device.enable(GL_CULL_FACE);
     this->setViewport(0, 0, width, height);
 
     //Set render states
@@ -73,7 +111,7 @@ bool OpenGLManager::initialize(bool fullscreen, int width, int height, int bitDe
 //-----------------------------------------------------------------------------
 void OpenGLManager::setViewport( int x, int y, int width, int height, float zNear, float zFar )
 {
-    glViewport(x, y, width, height); 
+    RenderDevice::getSingleton().setViewport(x, y, width, height); 
 
     //glViewport( gSP.viewport.x * OGL.scaleX, 
     //           (VI.height - (gSP.viewport.y + gSP.viewport.height)) * OGL.scaleY + OGL.heightOffset, 
@@ -82,7 +120,7 @@ void OpenGLManager::setViewport( int x, int y, int width, int height, float zNea
     //         ); 
 
     //glDepthRange( 0.0f, 1.0f );//gSP.viewport.nearz, gSP.viewport.farz );
-    glDepthRange( zNear, zFar );
+    RenderDevice::getSingleton().setDepthRange( zNear, zFar );
 }
 
 //-----------------------------------------------------------------------------
@@ -97,7 +135,7 @@ void OpenGLManager::setViewport( int x, int y, int width, int height, float zNea
 //-----------------------------------------------------------------------------
 void OpenGLManager::setScissor(int x, int y, int width, int height)
 {
-    glScissor(x,y, width, height);
+    RenderDevice::getSingleton().setScissor(x,y, width, height);
 }
 
 
@@ -130,22 +168,75 @@ bool OpenGLManager::toggleFullscreen()
 //-----------------------------------------------------------------------------
 void OpenGLManager::beginRendering()
 {
-    glDepthMask( true );
+    //Low latency: previous frame has to be done before this one is recorded
+    if ( m_waitPending )
+    {
+        _waitFrameFence(0);
+        m_waitPending = false;
+    }
+
+    RenderDevice::getSingleton().setDepthMask( true );
     //glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 }
 
 //-----------------------------------------------------------------------------
 //* End Rendering
 //! Should be called after you have rendered everything with OpenGL
+//! @details The frame is fenced instead of finished. Normally the CPU then
+//!          waits for the fence of frame N-k, k being frames in flight. In
+//!          low latency mode nothing is waited for here, the next frame
+//!          waits for this fence in beginRendering so emulation between
+//!          frames overlaps with the GPU.
 //-----------------------------------------------------------------------------
 void OpenGLManager::endRendering()
 {
-    glFinish();
+    RenderDevice& device = RenderDevice::getSingleton();
     if (m_renderingCallback)
-        m_renderingCallback(m_drawFlag);
+        device.callRenderingCallback(m_renderingCallback, m_drawFlag);
 	m_drawFlag = 0;
-    CoreVideo_GL_SwapBuffers();
-    //glFlush();
+    if (m_screenReadback)
+        m_screenReadback->capture(m_width, m_height, m_viWidth, m_viHeight);
+    device.insertFrameFence();
+    device.swapBuffers();
+    m_numFrames++;
+
+    if ( m_lowLatency )
+    {
+        m_waitPending = true;
+    }
+    else
+    {
+        _waitFrameFence(m_framesInFlight);
+    }
+
+    m_frameWaitTime = m_waitTime;
+    m_waitTime = 0;
+}
+
+//-----------------------------------------------------------------------------
+//* Set Frame Pacing
+//! @param framesInFlight Frames the CPU may queue ahead of the GPU (1-3)
+//! @param lowLatency     Wait for the previous frame before recording the next
+//-----------------------------------------------------------------------------
+void OpenGLManager::setFramePacing(int framesInFlight, bool lowLatency)
+{
+    if ( framesInFlight < 1 ) framesInFlight = 1;
+    if ( framesInFlight > 3 ) framesInFlight = 3;
+    m_framesInFlight = framesInFlight;
+    m_lowLatency = lowLatency;
+    m_waitPending = false;
+}
+
+//-----------------------------------------------------------------------------
+// Wait Frame Fence
+//-----------------------------------------------------------------------------
+void OpenGLManager::_waitFrameFence(int maxPendingFrames)
+{
+    double start = getTime();
+    RenderDevice::getSingleton().waitFrameFence(maxPendingFrames);
+    double waited = getTime() - start;
+    m_waitTime += waited;
+    m_totalWaitTime += waited;
 }
 
 //-----------------------------------------------------------------------------
@@ -156,11 +247,11 @@ void OpenGLManager::setWireFrame(bool wireframe)
     m_wireframe = wireframe;
     if ( wireframe )
     {
-        glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
+        RenderDevice::getSingleton().setPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
     }
     else
     {
-        glPolygonMode( GL_FRONT_AND_BACK, GL_FILL );
+        RenderDevice::getSingleton().setPolygonMode( GL_FRONT_AND_BACK, GL_FILL );
     }
 }
 
@@ -171,11 +262,11 @@ void OpenGLManager::setZBufferEnabled(bool enable)
 {
     if ( enable ) 
     {
-        glEnable( GL_DEPTH_TEST );
+        RenderDevice::getSingleton().enable( GL_DEPTH_TEST );
     }
     else 
     {
-        glDisable( GL_DEPTH_TEST );
+        RenderDevice::getSingleton().disable( GL_DEPTH_TEST );
     }
 }
 
@@ -184,7 +275,7 @@ void OpenGLManager::setZBufferEnabled(bool enable)
 //-----------------------------------------------------------------------------
 bool OpenGLManager::getZBufferEnabled()
 {
-    return (glIsEnabled(GL_DEPTH_TEST) == GL_TRUE);
+    return RenderDevice::getSingleton().isEnabled(GL_DEPTH_TEST);
 }
 
 //-----------------------------------------------------------------------------
@@ -197,7 +288,7 @@ void OpenGLManager::setLighting(bool lighting)
         //glEnable(GL_LIGHTING);  We dont use this type of lighting (Nintendo 64 specific)
     }
     else {
-        glDisable(GL_LIGHTING);
+        RenderDevice::getSingleton().disable(GL_LIGHTING);
     }
 }
 
@@ -216,9 +307,9 @@ bool OpenGLManager::getLightingEnabled()
 void OpenGLManager::setFogEnabled(bool fog)
 {
     if ( fog ) 
-        glEnable(GL_FOG);
+        RenderDevice::getSingleton().enable(GL_FOG);
     else 
-        glDisable(GL_FOG);
+        RenderDevice::getSingleton().disable(GL_FOG);
 }
 
 //-----------------------------------------------------------------------------
@@ -226,7 +317,7 @@ void OpenGLManager::setFogEnabled(bool fog)
 //-----------------------------------------------------------------------------
 bool OpenGLManager::getFogEnabled()
 {
-    return (glIsEnabled(GL_FOG) == GL_TRUE);
+    return RenderDevice::getSingleton().isEnabled(GL_FOG);
 }
 
 //-----------------------------------------------------------------------------
@@ -235,9 +326,9 @@ bool OpenGLManager::getFogEnabled()
 void OpenGLManager::setTextureing2D(bool textureing)
 {
     if ( textureing ) 
-        glEnable(GL_TEXTURE_2D);
+        RenderDevice::getSingleton().enable(GL_TEXTURE_2D);
     else
-        glDisable(GL_TEXTURE_2D);
+        RenderDevice::getSingleton().disable(GL_TEXTURE_2D);
 }
 
 //-----------------------------------------------------------------------------
@@ -245,7 +336,7 @@ void OpenGLManager::setTextureing2D(bool textureing)
 //-----------------------------------------------------------------------------
 bool getTextureing2DEnabled()
 {
-    return (glIsEnabled(GL_TEXTURE_2D) == GL_TRUE);
+    return RenderDevice::getSingleton().isEnabled(GL_TEXTURE_2D);
 }
 
 //-----------------------------------------------------------------------------
@@ -254,9 +345,9 @@ bool getTextureing2DEnabled()
 void OpenGLManager::setAlphaTest(bool alphaTestEnable)
 {
     if ( alphaTestEnable )
-        glEnable(GL_ALPHA_TEST);
+        RenderDevice::getSingleton().enable(GL_ALPHA_TEST);
     else
-        glDisable(GL_ALPHA_TEST);
+        RenderDevice::getSingleton().disable(GL_ALPHA_TEST);
 }
 
 //-----------------------------------------------------------------------------
@@ -264,7 +355,7 @@ void OpenGLManager::setAlphaTest(bool alphaTestEnable)
 //-----------------------------------------------------------------------------
 bool getAlphaTestEnabled()
 {
-    return (glIsEnabled(GL_ALPHA_TEST) == GL_TRUE);
+    return RenderDevice::getSingleton().isEnabled(GL_ALPHA_TEST);
 }
 
 //-----------------------------------------------------------------------------
@@ -273,14 +364,14 @@ bool getAlphaTestEnabled()
 void OpenGLManager::setScissorEnabled(bool enable)
 {
     if ( enable )
-        glEnable(GL_SCISSOR_TEST);
+        RenderDevice::getSingleton().enable(GL_SCISSOR_TEST);
     else
-        glDisable(GL_SCISSOR_TEST);
+        RenderDevice::getSingleton().disable(GL_SCISSOR_TEST);
 }
 
 bool OpenGLManager::getScissorEnabled()
 {
-    return (glIsEnabled(GL_SCISSOR_TEST) == GL_TRUE); 
+    return RenderDevice::getSingleton().isEnabled(GL_SCISSOR_TEST); 
 }
 
 //-----------------------------------------------------------------------------
@@ -288,30 +379,32 @@ bool OpenGLManager::getScissorEnabled()
 //-----------------------------------------------------------------------------
 void OpenGLManager::setCullMode(bool cullFront, bool cullBack)
 {
+    RenderDevice& device = RenderDevice::getSingleton();
+
     if( cullFront && cullBack )
     {
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_FRONT_AND_BACK);        
+        device.enable(GL_CULL_FACE);
+        device.setCullFace(GL_FRONT_AND_BACK);        
     }
     else if( cullFront )
     {
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_FRONT);        
+        device.enable(GL_CULL_FACE);
+        device.setCullFace(GL_FRONT);        
     }
     else if( cullBack )
     {
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);        
+        device.enable(GL_CULL_FACE);
+        device.setCullFace(GL_BACK);        
     }
     else
     {
-        glDisable(GL_CULL_FACE);
+        device.disable(GL_CULL_FACE);
     }
 
     //Override Face Culling?
     if ( m_forceDisableCulling )
     {        
-        glDisable(GL_CULL_FACE);
+        device.disable(GL_CULL_FACE);
     }
 }
 
@@ -340,6 +433,8 @@ OpenGLManager::~OpenGLManager()
 //-----------------------------------------------------------------------------
 void OpenGLManager::calcViewScale(int viWidth, int viHeight)
 {
+    m_viWidth = viWidth;
+    m_viHeight = viHeight;
     m_scaleX = m_width / (float)viWidth;
     m_scaleY = m_height / (float)viHeight;
 }
@@ -25,8 +25,11 @@
 
 #include "OpenGL.h"
 //OpenGL includes
+#include "RenderDevice.h"
 #include "m64p.h"
 
+class ScreenReadback;
+
 //*****************************************************************************
 //* OpenGL Manager Class                                                        
 //! Singelton class for initializing OpenGL and contolling OpenGL states. 
@@ -89,7 +92,7 @@ public:
     void setScissor(int x, int y, int width, int height);
  
     //! Sets the backround color of OpenGL viewport 
-    void setClearColor(float r, float g, float b) { glClearColor(r, g, b, 1.0f); }
+    void setClearColor(float r, float g, float b) { RenderDevice::getSingleton().setClearColor(r, g, b, 1.0f); }
 
     //Set callback from the M64P core
     void setRenderingCallback(void(*callback)(int)) { m_renderingCallback = callback; }
@@ -97,12 +100,20 @@ public:
 	//Set draw flag for rendering callback
 	void setDrawFlag() { m_drawFlag = 1; }
 
+    //Frame pacing
+    void setFramePacing(int framesInFlight, bool lowLatency);
+
+    //! Set readback that copies every frame before it is swapped
+    void setScreenReadback(ScreenReadback* screenReadback) { m_screenReadback = screenReadback; }
+
 public:
 
     //N64 Specifics
     void calcViewScale(int viWidth, int viHeight);
     float getViewScaleX() { return m_scaleX; } 
     float getViewScaleY() { return m_scaleY; }
+    int getVIWidth() { return m_viWidth; }
+    int getVIHeight() { return m_viHeight; }
 
 public:
 
@@ -111,12 +122,17 @@ public:
     int getWidth() { return m_width; }
     int getHeight() { return m_height; }
     bool getFullscreen() { return m_fullscreen; }
+    unsigned int getNumFrames() { return m_numFrames; }
+    double getFrameWaitTime() { return m_frameWaitTime; }   //!< Milliseconds waited on fences by last frame
+    double getTotalWaitTime() { return m_totalWaitTime; }   //!< Milliseconds waited on fences by all frames
 
 private:
 
      //Constructor
     OpenGLManager();          
 
+    void _waitFrameFence(int maxPendingFrames);
+
 private:
 
     bool m_wireframe;            //!< Wireframe mode enabled?
@@ -127,8 +143,18 @@ private:
     int m_refreshRate;           //!< Fullscreen refresh rate 
     float m_scaleX;              //!< DisplayWidth aka WindowWidth / viWidth (n64 specific)
     float m_scaleY;              //!< DisplayHeight aka WindowHeight / viHeight (n64 specific)
+    int m_viWidth;               //!< Width of N64 frame (VI)
+    int m_viHeight;              //!< Height of N64 frame (VI)
     bool m_fullscreen;           //!< Fullscreen mode or window mode?
     bool m_forceDisableCulling;  //!< Culling cant be enabled if this is true
+    unsigned int m_numFrames;    //!< Number of frames shown by endRendering
+    int m_framesInFlight;        //!< Frames the CPU may queue ahead of the GPU (1-3)
+    bool m_lowLatency;           //!< Wait for previous frame in beginRendering instead?
+    bool m_waitPending;          //!< Low latency wait not done yet for this frame
+    double m_waitTime;           //!< Milliseconds waited so far by current frame
+    double m_frameWaitTime;      //!< Milliseconds waited by last frame
+    double m_totalWaitTime;      //!< Milliseconds waited by all frames
+    ScreenReadback* m_screenReadback;  //!< Asynchronous ReadScreen2, 0 if synchronous
     
     void (*m_renderingCallback)(int);  //Rendering callback from the core
 	int m_drawFlag;
@@ -25,6 +25,7 @@
 #include "CachedTexture.h"
 #include "DisplayListParser.h"
 #include "FogManager.h"
+#include "FrameBufferCache.h"
 #include "GBI.h"
 #include "GBIDefs.h"
 #include "Logger.h"
@@ -37,6 +38,7 @@
 #include "OpenGLRenderer.h"
 #include "RDP.h"
 #include "RSP.h"
+#include "RenderDevice.h"
 #include "RomDetector.h"
 #include "TextureCache.h"
 #include "VI.h"
@@ -74,7 +76,14 @@ RDP::RDP()
     m_combinerMgr        = 0;
     m_textureLoader      = 0;
     m_openGL2DRenderer   = 0;
+    m_frameBufferCache   = 0;
     m_screenUpdatePending= false;
+    m_numClearedRegions[0] = m_numClearedRegions[1] = 0;
+    m_clearDrawCalls     = 0;
+    m_clearFrame         = 0;
+    m_numClears          = 0;
+    m_numScissoredClears = 0;
+    m_numSkippedClears   = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -109,7 +118,19 @@ bool RDP::initialize(GFX_INFO* graphicsInfo, RSP* rsp, Memory* memory, GBI* gbi,
 
     //Create OpenGL 2D Renderer
     m_openGL2DRenderer = new OpenGL2DRenderer();
-    m_openGL2DRenderer->initialize(vi);
+    m_openGL2DRenderer->initialize();
+
+    //Scissor box covers window until game sets it
+    m_scissor[0] = 0;
+    m_scissor[1] = 0;
+    m_scissor[2] = OpenGLManager::getSingleton().getWidth();
+    m_scissor[3] = OpenGLManager::getSingleton().getHeight();
+
+    //Reset clear statistics
+    m_numClearedRegions[0] = m_numClearedRegions[1] = 0;
+    m_numClears          = 0;
+    m_numScissoredClears = 0;
+    m_numSkippedClears   = 0;
 
     return true;
 }
@@ -131,43 +152,45 @@ void RDP::dispose()
 //-----------------------------------------------------------------------------
 void RDP::updateStates()
 {
+    RenderDevice& device = RenderDevice::getSingleton();
+
     //Depth Compare
     if (m_otherMode.depthCompare)
-        glDepthFunc( GL_LEQUAL );
+        device.setDepthFunc( GL_LEQUAL );
     else
-        glDepthFunc( GL_ALWAYS );
+        device.setDepthFunc( GL_ALWAYS );
 
     //Depth Update
     if (m_otherMode.depthUpdate)
-        glDepthMask( true );
+        device.setDepthMask( true );
     else
-        glDepthMask( false );
+        device.setDepthMask( false );
 
     // Depth Mode
     if (m_otherMode.depthMode == ZMODE_DEC)
     {
-        glEnable( GL_POLYGON_OFFSET_FILL );
-        glPolygonOffset( -3.0f, -3.0f );
+        device.enable( GL_POLYGON_OFFSET_FILL );
+        device.setPolygonOffset( -3.0f, -3.0f );
     }
     else
     {
-        glDisable( GL_POLYGON_OFFSET_FILL );
+        device.disable( GL_POLYGON_OFFSET_FILL );
     }
 
     // Alpha Compare
     if ((m_otherMode.alphaCompare == G_AC_THRESHOLD) && !(m_otherMode.alphaCvgSel))
     {
-        glEnable( GL_ALPHA_TEST );
-        glAlphaFunc( (m_combinerMgr->getBlendColor()[3] > 0.0f) ? GL_GEQUAL : GL_GREATER, m_combinerMgr->getBlendColor()[3] );
+        device.enable( GL_ALPHA_TEST );
+        device.setAlphaFunc( (m_combinerMgr->getBlendColor()[3] > 0.0f) ? GL_GEQUAL : GL_GREATER, m_combinerMgr->getBlendColor()[3] );
     }
     // Used in TEX_EDGE and similar render modes
     else if (m_otherMode.cvgXAlpha)
     {
-        glEnable( GL_ALPHA_TEST );
-        glAlphaFunc( GL_GEQUAL, 0.5f );  // Arbitrary number -- gives nice results though
+        device.enable( GL_ALPHA_TEST );
+        device.setAlphaFunc( GL_GEQUAL, 0.5f );  // Arbitrary number -- gives nice results though
     }
     else
-        glDisable( GL_ALPHA_TEST );
+        device.disable( GL_ALPHA_TEST );
 
     //Combiner
     if ( m_updateCombiner )
@@ -201,11 +224,17 @@ void RDP::updateStates()
     {
         m_combinerMgr->beginTextureUpdate();
 
+        bool usesTexture0 = m_combinerMgr->getUsesTexture0();
+        bool usesTexture1 = m_combinerMgr->getUsesTexture1();
+
         //Update Texture channel 0
-        if ( m_combinerMgr->getUsesTexture0() )
+        if ( usesTexture0 )
         {
-            //Enable texture 0
-            m_textureCache->update(0);
+            //Enable texture 0 (and texture 1, both are hashed at the same time)
+            if ( usesTexture1 )
+                m_textureCache->updateBoth();
+            else
+                m_textureCache->update(0);
             m_rsp->setTexturesChanged(false);
             m_changedTiles = false;
             m_tmemChanged = false;
@@ -213,15 +242,16 @@ void RDP::updateStates()
         else
         {
             //Disable texture 0
-            glActiveTextureARB( GL_TEXTURE0_ARB + 0 );
-            glDisable(GL_TEXTURE_2D);  
+            device.setActiveTexture( 0 );
+            device.disable(GL_TEXTURE_2D);  
         }
 
         //Update Texture channel 1
-        if (  m_combinerMgr->getUsesTexture1() )
+        if ( usesTexture1 )
         {
             //Enable texture 1
-            m_textureCache->update(1);
+            if ( !usesTexture0 )
+                m_textureCache->update(1);
             m_rsp->setTexturesChanged(false);
             m_changedTiles = false;
             m_tmemChanged = false;
@@ -229,8 +259,8 @@ void RDP::updateStates()
         else
         {
             //Disable textureing 1
-            glActiveTextureARB( GL_TEXTURE0_ARB + 1 );
-            glDisable(GL_TEXTURE_2D); 
+            device.setActiveTexture( 1 );
+            device.disable(GL_TEXTURE_2D); 
         }
 
         m_combinerMgr->endTextureUpdate();
@@ -242,16 +272,16 @@ void RDP::updateStates()
             (m_otherMode.cycleType != G_CYC_FILL) &&
             !(m_otherMode.alphaCvgSel))
     {
-        glEnable( GL_BLEND );
+        device.enable( GL_BLEND );
         switch (m_otherMode.l >> 16)
         {
             case 0x0448: // Add
             case 0x055A:
-                glBlendFunc( GL_ONE, GL_ONE );
+                device.setBlendFunc( GL_ONE, GL_ONE );
                 break;
             case 0x0C08: // 1080 Sky
             case 0x0F0A: // Used LOTS of places
-                glBlendFunc( GL_ONE, GL_ZERO );
+                device.setBlendFunc( GL_ONE, GL_ZERO );
                 break;
             case 0xC810: // Blends fog
             case 0xC811: // Blends fog
@@ -259,24 +289,24 @@ void RDP::updateStates()
             case 0x0C19: // Used for antialiasing
             case 0x0050: // Standard interpolated blend
             case 0x0055: // Used for antialiasing
-                glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+                device.setBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
                 break;
             case 0x0FA5: // Seems to be doing just blend color - maybe combiner can be used for this?
             case 0x5055: // Used in Paper Mario intro, I'm not sure if this is right...
-                glBlendFunc( GL_ZERO, GL_ONE );
+                device.setBlendFunc( GL_ZERO, GL_ONE );
                 break;
             default:
-                glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+                device.setBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
                 break;
         }
     }
     else
-        glDisable( GL_BLEND );
+        device.disable( GL_BLEND );
 
     if (m_otherMode.cycleType == G_CYC_FILL)
     {
-        glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
-        glEnable( GL_BLEND );
+        device.setBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+        device.enable( GL_BLEND );
     }
 }
 
@@ -461,12 +491,16 @@ void RDP::RDP_SetScissor(int x0, int y0, int x1, int y1, int mode)
     int offset = 0; //TODO: height offset?
 
     //Set Scissor
-    OpenGLManager::getSingleton().setScissor( 
-               x0 * vsx, 
-               (m_vi->getHeight() - y1) * vsy + offset,
-               (x1 - x0) * vsx, 
-               (y1 - y0) * vsy 
-    );
+    m_scissor[0] = (int)(x0 * vsx);
+    m_scissor[1] = (int)((m_vi->getHeight() - y1) * vsy + offset);
+    m_scissor[2] = (int)((x1 - x0) * vsx);
+    m_scissor[3] = (int)((y1 - y0) * vsy);
+    OpenGLManager::getSingleton().setScissor(m_scissor[0], m_scissor[1], m_scissor[2], m_scissor[3]);
+
+    if ( m_frameBufferCache )
+    {
+        m_frameBufferCache->setScissor(y1);
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -501,39 +535,37 @@ void RDP::RDP_FillRect(unsigned int x0, unsigned int y0, unsigned int x1, unsign
     if ( m_depthImageInfo.rdramAddress == m_colorImageInfo.rdramAddress )
     {
         //Clear the Z Buffer
+        m_openGL2DRenderer->flush();
         updateStates();
-        glDepthMask( true );
-        glClear(GL_DEPTH_BUFFER_BIT);
+        RenderDevice::getSingleton().setDepthMask( true );
+        _clearRectangle(true, x0, y0, x1, y1, 0);
 
         // Depth update
         if (m_otherMode.depthUpdate)
         {
-            glDepthMask(GL_TRUE);
+            RenderDevice::getSingleton().setDepthMask(GL_TRUE);
         }
         else
         {
-            glDepthMask(GL_FALSE);
+            RenderDevice::getSingleton().setDepthMask(GL_FALSE);
         }
 
         return;
     }
 
-    //Clear Color Buffer?
+    //Clear Color Buffer? (fill cycle writes fill color without blending)
     if ( m_otherMode.cycleType == G_CYC_FILL)
     {
-        if ( x0 == 0 && y0 == 0 && x1 == m_vi->getWidth() && y1 == m_vi->getHeight() )
+        bool fullScreen = x0 == 0 && y0 == 0 && x1 >= m_vi->getWidth() && y1 >= m_vi->getHeight();
+        if ( fullScreen || !ROMDetector::getSingleton().getIgnoreFillRects() )
         {
-            const float* fillColor = m_combinerMgr->getFillColor();
-            glClearColor(fillColor[0], fillColor[1], fillColor[2], fillColor[3]);
-            bool scissor = OpenGLManager::getSingleton().getScissorEnabled();
-            OpenGLManager::getSingleton().setScissorEnabled(false);
-            glClear(GL_COLOR_BUFFER_BIT);
-            OpenGLManager::getSingleton().setScissorEnabled(scissor);
-            return;
+            _clearRectangle(false, x0, y0, x1, y1, m_combinerMgr->getFillColor());
         }
+        return;
     }
 
     //Update States
+    m_openGL2DRenderer->begin(false, _getStatesChanged());
     this->updateStates();   
 
     //Ignore fill rects?
@@ -542,27 +574,21 @@ void RDP::RDP_FillRect(unsigned int x0, unsigned int y0, unsigned int x1, unsign
         return;
     }
 
-    //Disable Scissor
-    glDisable( GL_SCISSOR_TEST );
-
     //Set Viewport
     //int oldViewport[4];
     //glGetIntegerv(GL_VIEWPORT, oldViewport);
     //glViewport(0, 0, OpenGLManager::getSingleton().getWidth(), OpenGLManager::getSingleton().getHeight() ); 
-    glDepthRange(0.0f, 1.0f);
+    RenderDevice::getSingleton().setDepthRange(0.0f, 1.0f);
 
     //Get depth and color
     float depth = m_otherMode.depthSource == 1 ? m_primitiveZ : 0;  //TODO: Use RSP viewport nearz?
     float* color = m_otherMode.cycleType == G_CYC_FILL ? m_combinerMgr->getFillColor() : m_combinerMgr->getPrimColor();
 
-    //Render rectangle
+    //Render rectangle (batched, rendered without scissor)
     m_openGL2DRenderer->renderQuad(color, x0, y0, x1, y1, depth);
 
     //Reset viewport
     //glViewport(oldViewport[0], oldViewport[1], oldViewport[2], oldViewport[3]);     
-
-    //Reset Scissor
-    glEnable( GL_SCISSOR_TEST );
 }
 
 //-----------------------------------------------------------------------------
@@ -608,6 +634,7 @@ void RDP::RDP_TexRectFlip(unsigned int dwXH, unsigned int dwYH, unsigned int dwX
     m_texRectHeight = (unsigned int)fT1;
 
     //Update States
+    m_openGL2DRenderer->begin(true, _getStatesChanged());
     this->updateStates();
 
     float t0u0 = 0, t0v0 = 0, t0u1 =0, t0v1 = 0;
@@ -637,7 +664,8 @@ void RDP::RDP_TexRect(unsigned int dwXH, unsigned int dwYH, unsigned int dwXL, u
 { 
     Logger::getSingleton().printMsg("RDP_TexRect");    
 
-    glEnable(GL_TEXTURE_2D);
+    m_openGL2DRenderer->begin(true, _getStatesChanged());
+    RenderDevice::getSingleton().enable(GL_TEXTURE_2D);
 
     //Convert to signed
     short s16S = *(short*)(&dwS);
@@ -672,17 +700,40 @@ void RDP::RDP_TexRect(unsigned int dwXH, unsigned int dwYH, unsigned int dwXL, u
 //-----------------------------------------------------------------------------
 void RDP::RDP_SetCImg(unsigned int format, unsigned int size, unsigned int width, unsigned int segmentAddress)
 { 
-    m_colorImageInfo.rdramAddress = m_memory->getRDRAMAddress( segmentAddress );
+    unsigned int rdramAddress = m_memory->getRDRAMAddress( segmentAddress );
+
+    //Cleared regions belong to previous render target
+    if ( rdramAddress != m_colorImageInfo.rdramAddress )
+    {
+        m_numClearedRegions[0] = m_numClearedRegions[1] = 0;
+    }
+
+    m_colorImageInfo.rdramAddress = rdramAddress;
     m_colorImageInfo.format       = format;
     m_colorImageInfo.size         = size;
     m_colorImageInfo.width        = width + 1; //Note: add plus one
     m_colorImageInfo.bpl          = m_colorImageInfo.width << m_colorImageInfo.size >> 1;
+
+    //Batched rectangles belong to previous color image
+    if ( m_frameBufferCache )
+    {
+        m_openGL2DRenderer->flush();
+    }
     
     if (m_screenUpdatePending)
     {
+        if ( m_frameBufferCache )
+        {
+            m_frameBufferCache->endFrame();
+        }
         OpenGLManager::getSingleton().endRendering();
         m_screenUpdatePending = false;
     }
+
+    if ( m_frameBufferCache )
+    {
+        m_frameBufferCache->setColorImage(m_colorImageInfo, m_depthImageInfo);
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -691,7 +742,15 @@ void RDP::RDP_SetCImg(unsigned int format, unsigned int size, unsigned int width
 //-----------------------------------------------------------------------------
 void RDP::RDP_SetZImg(unsigned int format, unsigned int size, unsigned int width, unsigned int segmentAddress)
 { 
-    m_depthImageInfo.rdramAddress = m_memory->getRDRAMAddress( segmentAddress );
+    unsigned int rdramAddress = m_memory->getRDRAMAddress( segmentAddress );
+
+    //Cleared depth regions belong to previous depth image
+    if ( rdramAddress != m_depthImageInfo.rdramAddress )
+    {
+        m_numClearedRegions[1] = 0;
+    }
+
+    m_depthImageInfo.rdramAddress = rdramAddress;
     m_depthImageInfo.format       = format;
     m_depthImageInfo.size         = size;
     m_depthImageInfo.width        = width + 1; //Note: add plus one
@@ -731,6 +790,16 @@ void RDP::RDP_LoadTile(int tile, int s0, int t0, int s1, int t1)
     m_textureLoader->loadTile(tile, s0, t0, s1, t1);
 
     m_textureMode = TM_NORMAL;
+    if ( m_frameBufferCache )
+    {
+        TextureImage* image = m_textureLoader->getTextureImage();
+        RDPTile* loadTile   = m_textureLoader->getTile(tile);
+        unsigned int address = image->address + loadTile->ult * image->bpl + (loadTile->uls << image->size >> 1);
+        if ( m_frameBufferCache->loadTexture(address, image->size) )
+        {
+            m_textureMode = TM_FRAMEBUFFER;
+        }
+    }
     m_loadType    = LOADTYPE_TILE;
     m_tmemChanged = true;    
 }    
@@ -744,6 +813,15 @@ void RDP::RDP_LoadBlock(int tile, int s0, int t0, int s1, int t1)
     m_textureLoader->loadBlock(tile, s0, t0, s1, t1);
 
     m_textureMode = TM_NORMAL;
+    if ( m_frameBufferCache )
+    {
+        TextureImage* image = m_textureLoader->getTextureImage();
+        unsigned int address = image->address + t0 * image->bpl + (s0 << image->size >> 1);
+        if ( m_frameBufferCache->loadTexture(address, image->size) )
+        {
+            m_textureMode = TM_FRAMEBUFFER;
+        }
+    }
     m_loadType    = LOADTYPE_BLOCK;
     m_tmemChanged = true;
 }
@@ -777,14 +855,134 @@ void RDP::RDP_LoadTLUT(int tile, int s0, int t0, int s1, int t1)
 // Private Functions
 //*****************************************************************************
 
+//-----------------------------------------------------------------------------
+//* Clear Rectangle
+//! Clears part of the color or depth buffer with glClear, the scissor box
+//! limits the clear unless the whole screen is cleared. Regions cleared 
+//! with the same value since anything was drawn are not cleared again.
+//! @param depth Clear depth buffer instead of color buffer
+//! @param color Clear color (unused for depth)
+//-----------------------------------------------------------------------------
+void RDP::_clearRectangle(bool depth, unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1, const float color[4])
+{
+    RenderDevice& device = RenderDevice::getSingleton();
+    int buffer = depth ? 1 : 0;
+
+    //Render batched rectangles first
+    m_openGL2DRenderer->flush();
+
+    //Clip to screen
+    unsigned int width  = m_vi->getWidth();
+    unsigned int height = m_vi->getHeight();
+    if ( x1 > width )  x1 = width;
+    if ( y1 > height ) y1 = height;
+    if ( x0 >= x1 || y0 >= y1 )
+    {
+        return;
+    }
+
+    //Forget cleared regions when something was drawn or a frame was shown
+    unsigned int drawCalls = OpenGLRenderer::getSingleton().getNumDrawCalls();
+    unsigned int frame     = OpenGLManager::getSingleton().getNumFrames();
+    if ( drawCalls != m_clearDrawCalls || frame != m_clearFrame )
+    {
+        m_numClearedRegions[0] = m_numClearedRegions[1] = 0;
+        m_clearDrawCalls = drawCalls;
+        m_clearFrame     = frame;
+    }
+
+    //Already cleared?
+    RDPClearedRegion* regions = m_clearedRegions[buffer];
+    for (int i=0; i<m_numClearedRegions[buffer]; ++i)
+    {
+        if ( x0 >= regions[i].x0 && y0 >= regions[i].y0 && x1 <= regions[i].x1 && y1 <= regions[i].y1 &&
+             (depth || (color[0] == regions[i].color[0] && color[1] == regions[i].color[1] && 
+                        color[2] == regions[i].color[2] && color[3] == regions[i].color[3])) )
+        {
+            m_numSkippedClears++;
+            return;
+        }
+    }
+
+    //Clear
+    bool fullScreen = x0 == 0 && y0 == 0 && x1 == width && y1 == height;
+    bool scissor = OpenGLManager::getSingleton().getScissorEnabled();
+    if ( fullScreen )
+    {
+        OpenGLManager::getSingleton().setScissorEnabled(false);
+    }
+    else
+    {
+        float vsx = OpenGLManager::getSingleton().getViewScaleX();
+        float vsy = OpenGLManager::getSingleton().getViewScaleY();
+        OpenGLManager::getSingleton().setScissor( (int)(x0 * vsx), (int)((height - y1) * vsy),
+                                                  (int)((x1 - x0) * vsx), (int)((y1 - y0) * vsy) );
+        OpenGLManager::getSingleton().setScissorEnabled(true);
+        m_numScissoredClears++;
+    }
+    if ( !depth )
+    {
+        device.setClearColor(color[0], color[1], color[2], color[3]);
+    }
+    device.clear(depth ? GL_DEPTH_BUFFER_BIT : GL_COLOR_BUFFER_BIT);
+    m_numClears++;
+
+    //Restore scissor
+    if ( !fullScreen )
+    {
+        OpenGLManager::getSingleton().setScissor(m_scissor[0], m_scissor[1], m_scissor[2], m_scissor[3]);
+    }
+    OpenGLManager::getSingleton().setScissorEnabled(scissor);
+
+    //Regions overlapped by a clear with another color are no longer known
+    int numRegions = 0;
+    for (int i=0; i<m_numClearedRegions[buffer]; ++i)
+    {
+        bool overlaps = x0 < regions[i].x1 && regions[i].x0 < x1 && y0 < regions[i].y1 && regions[i].y0 < y1;
+        if ( depth || !overlaps )
+        {
+            regions[numRegions++] = regions[i];
+        }
+    }
+    m_numClearedRegions[buffer] = numRegions;
+
+    //Remember region
+    if ( m_numClearedRegions[buffer] < MAX_CLEARED_REGIONS )
+    {
+        RDPClearedRegion& region = regions[m_numClearedRegions[buffer]++];
+        region.x0 = x0;
+        region.y0 = y0;
+        region.x1 = x1;
+        region.y1 = y1;
+        for (int i=0; i<4; ++i)
+        {
+            region.color[i] = depth ? 0.0f : color[i];
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//* Get States Changed
+//! Batched rectangles have to be rendered before updateStates changes the
+//! combiner or binds other textures. Texture changes are ignored while the
+//! combiner does not use textures, updateStates keeps them for later then.
+//-----------------------------------------------------------------------------
+bool RDP::_getStatesChanged()
+{
+    if ( m_updateCombiner || m_updateCombineColors )
+    {
+        return true;
+    }
+
+    bool texturesChanged = m_changedTiles || m_tmemChanged || m_rsp->getTexturesChanged();
+    return texturesChanged && (m_combinerMgr->getUsesTexture0() || m_combinerMgr->getUsesTexture1());
+}
+
 //-----------------------------------------------------------------------------
 // Texture Rectangle
 //-----------------------------------------------------------------------------
 void RDP::_textureRectangle(float ulx, float uly, float lrx, float lry, int tile, float s, float t, float dsdx, float dtdy,bool flip)
 {
-    bool zEnabled = OpenGLManager::getSingleton().getZBufferEnabled();
-    OpenGLManager::getSingleton().setZBufferEnabled(false);
-
     //Copy Mode
     if (  m_otherMode.cycleType == G_CYC_COPY )
     {
@@ -818,8 +1016,7 @@ void RDP::_textureRectangle(float ulx, float uly, float lrx, float lry, int tile
 
     //glViewport( 0, 0, OpenGLManager::getSingleton().getWidth(), OpenGLManager::getSingleton().getHeight() );
 
-    glDisable(GL_SCISSOR_TEST);
-
+    //Rectangle is batched and rendered without scissor and depth test
     if (lrs > s)
     {
         if (lrt > t)
@@ -841,9 +1038,6 @@ void RDP::_textureRectangle(float ulx, float uly, float lrx, float lry, int tile
     m_rsp->setTile( m_textureLoader->getTile(rspTile < 7 ? rspTile + 1 : rspTile), 1);
 
     //glViewport( 0, m_windowMgr->getHeightOffset(), OpenGLManager::getSingleton().getWidth(), OpenGLManager::getSingleton().getHeight() );
-
-    glEnable(GL_SCISSOR_TEST);
-    OpenGLManager::getSingleton().setZBufferEnabled(zEnabled);
 }
 
 //-----------------------------------------------------------------------------
@@ -852,9 +1046,7 @@ void RDP::_textureRectangle(float ulx, float uly, float lrx, float lry, int tile
 //-----------------------------------------------------------------------------
 void RDP::_textureRectangleFlip(int nX0, int nY0, int nX1, int nY1, float fS0, float fT0, float fS1, float fT1, int tile)
 {
-    //Disable z buffer
-    bool zEnabled = OpenGLManager::getSingleton().getZBufferEnabled();
-    OpenGLManager::getSingleton().setZBufferEnabled(false);
+    RenderDevice& device = RenderDevice::getSingleton();
 
     float widthDiv = (float)m_textureLoader->getTile( m_rsp->getTexture().tile )->getWidth();
     float heightDiv = (float)m_textureLoader->getTile( m_rsp->getTexture().tile )->getHeight();
@@ -904,15 +1096,12 @@ void RDP::_textureRectangleFlip(int nX0, int nY0, int nX1, int nY1, float fS0, f
 
     if (  m_otherMode.cycleType == G_CYC_COPY )
     {
-        glActiveTextureARB( GL_TEXTURE0_ARB );
-        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
-        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+        device.setActiveTexture( 0 );
+        device.setTextureParameter( GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+        device.setTextureParameter( GL_TEXTURE_MAG_FILTER, GL_NEAREST );
     }
 
-    //Disable Scissor
-    glDisable( GL_SCISSOR_TEST );
-
-    //Render Quad
+    //Render Quad (batched, rendered without scissor and depth test)
     m_openGL2DRenderer->renderFlippedTexturedQuad( color, secondaryColor,
                                                    (float)nX0, (float)nY0,
                                                    (float)nX1, (float)nY1,
@@ -921,8 +1110,4 @@ void RDP::_textureRectangleFlip(int nX0, int nY0, int nX1, int nY1, float fS0, f
                                                    t0u1, t0v1, 
                                                    t0u0, t0v0,
                                                    t0u1, t0v1 );
-
-    //Restore states
-    glEnable(GL_SCISSOR_TEST);
-    OpenGLManager::getSingleton().setZBufferEnabled(zEnabled);
 }
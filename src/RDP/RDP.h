@@ -34,6 +34,7 @@
 class AdvancedCombinerManager;
 class DisplayListParser;
 class FogManager;
+class FrameBufferCache;
 class GBI;
 class Memory;
 class OpenGL2DRenderer;
@@ -55,6 +56,16 @@ struct RDPSetImgInfo
     unsigned int bpl;
 };
 
+//*****************************************************************************
+//* RDPClearedRegion
+//! Part of the screen that was cleared and has not been drawn to since
+//*****************************************************************************
+struct RDPClearedRegion
+{
+    unsigned int x0, y0, x1, y1;   //!< Rectangle in N64 screen coordinates
+    float color[4];                //!< Clear color (unused for depth)
+};
+
 //*****************************************************************************
 //* OtherMode
 //! Struct used to get input to combiner
@@ -135,6 +146,9 @@ public:
 public:
     void signalUpdate() { m_screenUpdatePending = true; }
 
+    //! Render color images other than the frame to textures, 0 to disable
+    void setFrameBufferCache(FrameBufferCache* frameBufferCache) { m_frameBufferCache = frameBufferCache; }
+
     //Get Combiner Manager
     AdvancedCombinerManager* getCombinerMgr() { return m_combinerMgr; }
 
@@ -167,6 +181,11 @@ public:
     LoadType getLoadType()       { return m_loadType;     }
     bool getChangedTiles()       { return m_changedTiles; }
     bool getChangedTMEM()        { return m_tmemChanged;  }
+    void setTextureMode(TextureMode mode) { m_textureMode = mode; }
+
+    //Get Images
+    const RDPSetImgInfo& getColorImageInfo() { return m_colorImageInfo; }
+    const RDPSetImgInfo& getDepthImageInfo() { return m_depthImageInfo; }
 
     //Texture rectangle Size
     unsigned int getTexRectWidth() { return m_texRectWidth; }
@@ -187,6 +206,11 @@ public:
 
     void setUpdateCombiner(bool update) { m_updateCombiner = update; }
 
+    //Statistics
+    unsigned int getNumClears()          { return m_numClears;          }
+    unsigned int getNumScissoredClears() { return m_numScissoredClears; }
+    unsigned int getNumSkippedClears()   { return m_numSkippedClears;   }
+
 public:
 
     //Texture Rectangle
@@ -232,6 +256,14 @@ public:
     //Other
     void RDP_FullSync();
 
+protected:
+
+    //Will updateStates change textures or combiner?
+    bool _getStatesChanged();
+
+    //Clear part of color or depth buffer
+    void _clearRectangle(bool depth, unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1, const float color[4]);
+
 public:
 
     static Memory* m_memory;                       //!< Pointer to memory manager
@@ -257,6 +289,7 @@ protected:
     AdvancedCombinerManager* m_combinerMgr;        //!< Pointer to combiner manager
     TextureLoader*           m_textureLoader;      //!< Pointer to texture loader
     OpenGL2DRenderer*        m_openGL2DRenderer;   //!< Pointer to OpenGL 2D Renderer
+    FrameBufferCache*        m_frameBufferCache;   //!< Pointer to frame buffer cache, 0 if disabled
 
     //Prim Depth
     float m_primitiveZ;                //!< Z value assigned to vertices z value if depth source says so
@@ -286,6 +319,19 @@ protected:
     //Update on first CI
     bool m_screenUpdatePending;
 
+    //Scissor
+    int m_scissor[4];                  //!< Scissor box in window coordinates (x, y, width, height)
+
+    //Clears
+    static const int MAX_CLEARED_REGIONS = 8;
+    RDPClearedRegion m_clearedRegions[2][MAX_CLEARED_REGIONS];  //!< Cleared color [0] and depth [1] regions
+    int m_numClearedRegions[2];        //!< Number of cleared color and depth regions
+    unsigned int m_clearDrawCalls;     //!< Draw calls issued when cleared regions were valid
+    unsigned int m_clearFrame;         //!< Frame cleared regions belong to
+    unsigned int m_numClears;          //!< Number of glClear calls made for fill rectangles
+    unsigned int m_numScissoredClears; //!< Number of clears limited to part of the screen
+    unsigned int m_numSkippedClears;   //!< Number of clears dropped because region was already cleared
+
 };
  
 #endif
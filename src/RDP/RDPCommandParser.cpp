@@ -0,0 +1,601 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#include <cstdio>
+#include <cstring>
+
+#include "AdvancedCombinerManager.h"
+#include "GBIDefs.h"
+#include "Logger.h"
+#include "Memory.h"
+#include "OpenGLRenderer.h"
+#include "RDP.h"
+#include "RDPCommandParser.h"
+#include "RDPInstructions.h"
+#include "RDPUCodeStructs.h"
+#include "RSP.h"
+#include "RomDetector.h"
+#include "VI.h"
+#include "m64p_types.h"
+
+//-----------------------------------------------------------------------------
+//! Defines
+//-----------------------------------------------------------------------------
+#define DPC_STATUS_XBUS_DMEM_DMA  0x00000001  //!< Commands are read from DMEM
+#define DMEM_ADDRESS_MASK         0x00000FFF  //!< DMEM wraps at 4 KB
+#define RDRAM_ADDRESS_MASK        0x00FFFFF8  //!< Commands are 64 bit aligned
+
+//-----------------------------------------------------------------------------
+//! RDP Commands
+//-----------------------------------------------------------------------------
+enum RDPCommand
+{
+    RDP_NOOP              = 0x00,
+    RDP_TRI_FILL          = 0x08,
+    RDP_TRI_FILL_Z        = 0x09,
+    RDP_TRI_TEX           = 0x0A,
+    RDP_TRI_TEX_Z         = 0x0B,
+    RDP_TRI_SHADE         = 0x0C,
+    RDP_TRI_SHADE_Z       = 0x0D,
+    RDP_TRI_SHADE_TEX     = 0x0E,
+    RDP_TRI_SHADE_TEX_Z   = 0x0F,
+    RDP_TEXRECT           = 0x24,
+    RDP_TEXRECT_FLIP      = 0x25,
+    RDP_LOAD_SYNC         = 0x26,
+    RDP_PIPE_SYNC         = 0x27,
+    RDP_TILE_SYNC         = 0x28,
+    RDP_FULL_SYNC         = 0x29,
+    RDP_SET_KEY_GB        = 0x2A,
+    RDP_SET_KEY_R         = 0x2B,
+    RDP_SET_CONVERT       = 0x2C,
+    RDP_SET_SCISSOR       = 0x2D,
+    RDP_SET_PRIM_DEPTH    = 0x2E,
+    RDP_SET_OTHER_MODE    = 0x2F,
+    RDP_LOAD_TLUT         = 0x30,
+    RDP_SET_TILE_SIZE     = 0x32,
+    RDP_LOAD_BLOCK        = 0x33,
+    RDP_LOAD_TILE         = 0x34,
+    RDP_SET_TILE          = 0x35,
+    RDP_FILL_RECT         = 0x36,
+    RDP_SET_FILL_COLOR    = 0x37,
+    RDP_SET_FOG_COLOR     = 0x38,
+    RDP_SET_BLEND_COLOR   = 0x39,
+    RDP_SET_PRIM_COLOR    = 0x3A,
+    RDP_SET_ENV_COLOR     = 0x3B,
+    RDP_SET_COMBINE       = 0x3C,
+    RDP_SET_TEXTURE_IMAGE = 0x3D,
+    RDP_SET_DEPTH_IMAGE   = 0x3E,
+    RDP_SET_COLOR_IMAGE   = 0x3F,
+};
+
+//-----------------------------------------------------------------------------
+//! Constructor
+//-----------------------------------------------------------------------------
+RDPCommandParser::RDPCommandParser()
+{
+    m_graphicsInfo = 0;
+    m_rsp = 0;
+    m_rdp = 0;
+    m_memory = 0;
+    m_vi = 0;
+    m_words = 0;
+    m_numWords = 0;
+    m_batchTile = -1;
+    m_numLists = 0;
+    m_numCommands = 0;
+    m_numBytes = 0;
+    m_numTriangles = 0;
+    m_numRectangles = 0;
+    m_numBatches = 0;
+    m_numUnknownCommands = 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Destructor
+//-----------------------------------------------------------------------------
+RDPCommandParser::~RDPCommandParser()
+{
+    dispose();
+}
+
+//-----------------------------------------------------------------------------
+//* Initialize
+//! Saves pointers and allocates command buffer
+//-----------------------------------------------------------------------------
+bool RDPCommandParser::initialize(GFX_INFO* graphicsInfo, RSP* rsp, RDP* rdp, Memory* memory, VI* vi)
+{
+    dispose();
+
+    m_graphicsInfo = graphicsInfo;
+    m_rsp          = rsp;
+    m_rdp          = rdp;
+    m_memory       = memory;
+    m_vi           = vi;
+
+    m_words = new unsigned int[MAX_COMMAND_WORDS];
+    m_numWords = 0;
+    m_batchTile = -1;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//* Dispose
+//-----------------------------------------------------------------------------
+void RDPCommandParser::dispose()
+{
+    if ( m_words ) { delete[] m_words; m_words = 0; }
+    m_numWords = 0;
+}
+
+//-----------------------------------------------------------------------------
+//* Process RDP List
+//! Reads the commands between DPC_CURRENT_REG and DPC_END_REG from RDRAM 
+//! (or DMEM when the XBUS is used) and executes them. A command that is 
+//! cut off at the end is kept until the next list completes it.
+//-----------------------------------------------------------------------------
+void RDPCommandParser::processRDPList()
+{
+    if ( !m_words ) {
+        return;
+    }
+
+    m_numLists++;
+
+    unsigned int current = *m_graphicsInfo->DPC_CURRENT_REG & RDRAM_ADDRESS_MASK;
+    unsigned int end     = *m_graphicsInfo->DPC_END_REG & RDRAM_ADDRESS_MASK;
+    bool xbus = (*m_graphicsInfo->DPC_STATUS_REG & DPC_STATUS_XBUS_DMEM_DMA) != 0;
+
+    //Read commands
+    if ( end > current )
+    {
+        unsigned int numWords = (end - current) / 4;
+        if ( numWords > MAX_COMMAND_WORDS - m_numWords )
+        {
+            Logger::getSingleton().printMsg("RDPCommandParser - RDP list too long, commands skipped", M64MSG_WARNING);
+            numWords = MAX_COMMAND_WORDS - m_numWords;
+        }
+
+        if ( xbus )
+        {
+            for (unsigned int i=0; i<numWords; ++i)
+            {
+                m_words[m_numWords++] = *(unsigned int*)m_memory->getDMEM( (current + i * 4) & DMEM_ADDRESS_MASK );
+            }
+        }
+        else
+        {
+            if ( current + numWords * 4 > m_memory->getRDRAMSize() ) {
+                numWords = current < m_memory->getRDRAMSize() ? (m_memory->getRDRAMSize() - current) / 4 : 0;
+            }
+            memcpy(&m_words[m_numWords], m_memory->getRDRAM(current), numWords * 4);
+            m_numWords += numWords;
+        }
+        m_numBytes += numWords * 4;
+    }
+
+    //Execute complete commands and keep the rest
+    unsigned int numExecuted = _execute(m_words, m_numWords);
+    m_numWords -= numExecuted;
+    if ( m_numWords > 0 && numExecuted > 0 )
+    {
+        memmove(m_words, &m_words[numExecuted], m_numWords * 4);
+    }
+    if ( m_numWords == MAX_COMMAND_WORDS )
+    {
+        m_numWords = 0;
+    }
+
+    _flush();
+
+    //Everything has been read
+    *m_graphicsInfo->DPC_START_REG = *m_graphicsInfo->DPC_CURRENT_REG = *m_graphicsInfo->DPC_END_REG;
+}
+
+//-----------------------------------------------------------------------------
+//* Execute
+//! Executes complete commands in buffer
+//! @return Number of words executed
+//-----------------------------------------------------------------------------
+unsigned int RDPCommandParser::_execute(unsigned int* words, unsigned int numWords)
+{
+    unsigned int i = 0;
+    while ( i + 2 <= numWords )
+    {
+        unsigned int command = (words[i] >> 24) & 0x3F;
+        unsigned int size = _getCommandSize(command);
+        if ( i + size > numWords ) {
+            break;
+        }
+
+        MicrocodeArgument* arg = (MicrocodeArgument*)&words[i];
+        m_numCommands++;
+
+        switch ( command )
+        {
+            //Syncs are ignored (and do not end batches)
+            case RDP_NOOP      :
+            case RDP_LOAD_SYNC :
+            case RDP_PIPE_SYNC :
+            case RDP_TILE_SYNC :
+                break;
+
+            //Triangles
+            case RDP_TRI_FILL        :
+            case RDP_TRI_FILL_Z      :
+            case RDP_TRI_TEX         :
+            case RDP_TRI_TEX_Z       :
+            case RDP_TRI_SHADE       :
+            case RDP_TRI_SHADE_Z     :
+            case RDP_TRI_SHADE_TEX   :
+            case RDP_TRI_SHADE_TEX_Z :
+                _triangle(&words[i], (command & 0x04) != 0, (command & 0x02) != 0, (command & 0x01) != 0);
+                m_numTriangles++;
+                break;
+
+            //Rectangles
+            case RDP_TEXRECT      :
+            case RDP_TEXRECT_FLIP :
+                _flushTriangles();
+                _textureRectangle(&words[i], command == RDP_TEXRECT_FLIP);
+                m_batchTile = -1;
+                m_numRectangles++;
+                break;
+
+            case RDP_FILL_RECT :
+            {
+                RDPUCodeRectangle* rect = (RDPUCodeRectangle*)arg;
+                if ( !_fillRectangle(rect->x0, rect->y0, rect->x1, rect->y1) )
+                {
+                    _flushTriangles();
+                    RDPInstructions::RDP_FillRect(arg);
+                }
+                m_numRectangles++;
+                break;
+            }
+
+            //State changes, render batch before state is changed
+            case RDP_FULL_SYNC         : _flush(); RDPInstructions::RDP_FullSync(arg);      break;
+            case RDP_SET_KEY_GB        : _flush(); RDPInstructions::RDP_SetKeyGB(arg);      break;
+            case RDP_SET_KEY_R         : _flush(); RDPInstructions::RDP_SetKeyR(arg);       break;
+            case RDP_SET_CONVERT       : _flush(); RDPInstructions::RDP_SetConvert(arg);    break;
+            case RDP_SET_SCISSOR       : _flush(); RDPInstructions::RDP_SetScissor(arg);    break;
+            case RDP_SET_PRIM_DEPTH    : _flush(); RDPInstructions::RDP_SetPrimDepth(arg);  break;
+            case RDP_LOAD_TLUT         : _flush(); RDPInstructions::RDP_LoadTLUT(arg);      break;
+            case RDP_SET_TILE_SIZE     : _flush(); RDPInstructions::RDP_SetTileSize(arg);   break;
+            case RDP_LOAD_BLOCK        : _flush(); RDPInstructions::RDP_LoadBlock(arg);     break;
+            case RDP_LOAD_TILE         : _flush(); RDPInstructions::RDP_LoadTile(arg);      break;
+            case RDP_SET_TILE          : _flush(); RDPInstructions::RDP_SetTile(arg);       break;
+            case RDP_SET_FILL_COLOR    : _flush(); RDPInstructions::RDP_SetFillColor(arg);  break;
+            case RDP_SET_FOG_COLOR     : _flush(); RDPInstructions::RDP_SetFogColor(arg);   break;
+            case RDP_SET_BLEND_COLOR   : _flush(); RDPInstructions::RDP_SetBlendColor(arg); break;
+            case RDP_SET_PRIM_COLOR    : _flush(); RDPInstructions::RDP_SetPrimColor(arg);  break;
+            case RDP_SET_ENV_COLOR     : _flush(); RDPInstructions::RDP_SetEnvColor(arg);   break;
+            case RDP_SET_COMBINE       : _flush(); RDPInstructions::RDP_SetCombine(arg);    break;
+            case RDP_SET_TEXTURE_IMAGE : _flush(); RDPInstructions::RDP_SetTImg(arg);       break;
+            case RDP_SET_DEPTH_IMAGE   : _flush(); RDPInstructions::RDP_SetZImg(arg);       break;
+            case RDP_SET_COLOR_IMAGE   : _flush(); RDPInstructions::RDP_SetCImg(arg);       break;
+
+            case RDP_SET_OTHER_MODE :
+                _flush(); 
+                RDPInstructions::RDP_SetOtherMode(arg);
+                m_rdp->setUpdateCombiner(true);   //Cycle type may have changed
+                break;
+
+            default :
+                m_numUnknownCommands++;
+                break;
+        }
+
+        i += size;
+    }
+    return i;
+}
+
+//-----------------------------------------------------------------------------
+//* Get Command Size
+//! @return Size of command in words
+//-----------------------------------------------------------------------------
+unsigned int RDPCommandParser::_getCommandSize(unsigned int command)
+{
+    if ( command >= RDP_TRI_FILL && command <= RDP_TRI_SHADE_TEX_Z )
+    {
+        //Edge coefficients, followed by shade, texture and depth coefficients
+        return 8 + ((command & 0x04) ? 16 : 0) + ((command & 0x02) ? 16 : 0) + ((command & 0x01) ? 4 : 0);
+    }
+    if ( command == RDP_TEXRECT || command == RDP_TEXRECT_FLIP )
+    {
+        return 4;
+    }
+    return 2;
+}
+
+//-----------------------------------------------------------------------------
+//* Get Coefficient
+//! Shade and texture coefficients store the integer parts of four 
+//! components in two words, and the fractions four words later.
+//! @param words Words with integer parts
+//! @param component Component 0-3 (r,g,b,a or s,t,w)
+//-----------------------------------------------------------------------------
+float RDPCommandParser::_getCoefficient(const unsigned int* words, int component)
+{
+    int shift = (component & 1) ? 0 : 16;
+    int integer = (short)((words[component >> 1] >> shift) & 0xFFFF);
+    unsigned int fraction = (words[4 + (component >> 1)] >> shift) & 0xFFFF;
+    return (float)(integer * 65536.0 + fraction) / 65536.0f;
+}
+
+//-----------------------------------------------------------------------------
+//* Triangle
+//! Edge walking triangles are converted to a polygon of up to five 
+//! vertices: the ends of the major edge (H) and of the two minor edges 
+//! (M above YM, L below). Attributes are evaluated at each vertex from the
+//! start values and their derivatives along the major edge and x.
+//-----------------------------------------------------------------------------
+void RDPCommandParser::_triangle(const unsigned int* words, bool shade, bool texture, bool zbuffer)
+{
+    int tile = (words[0] >> 16) & 0x7;
+
+    //Y coordinates (s11.2)
+    float yl = ((int)(words[0] << 18) >> 18) / 4.0f;
+    float ym = ((int)(words[1] << 2)  >> 18) / 4.0f;
+    float yh = ((int)(words[1] << 18) >> 18) / 4.0f;
+    if ( yl <= yh ) {
+        return;
+    }
+    if ( ym < yh ) ym = yh;
+    if ( ym > yl ) ym = yl;
+
+    //X coordinates and slopes (s15.16), XH and XM are given at the scanline of YH
+    float xl    = (int)words[2] / 65536.0f;
+    float dxldy = (int)words[3] / 65536.0f;
+    float xh    = (int)words[4] / 65536.0f;
+    float dxhdy = (int)words[5] / 65536.0f;
+    float xm    = (int)words[6] / 65536.0f;
+    float dxmdy = (int)words[7] / 65536.0f;
+    float y0    = (float)((int)yh);
+
+    //Polygon outline, major edge first and back up along the minor edges
+    float x[5], y[5];
+    int numPoints = 0;
+    x[numPoints] = xh + dxhdy * (yh - y0); y[numPoints++] = yh;
+    x[numPoints] = xh + dxhdy * (yl - y0); y[numPoints++] = yl;
+    if ( ym < yl )
+    {
+        x[numPoints] = xl + dxldy * (yl - ym); y[numPoints++] = yl;
+        x[numPoints] = xl;                     y[numPoints++] = ym;
+    }
+    else
+    {
+        x[numPoints] = xm + dxmdy * (yl - y0); y[numPoints++] = yl;
+    }
+    if ( ym > yh )
+    {
+        x[numPoints] = xm + dxmdy * (yh - y0); y[numPoints++] = yh;
+    }
+
+    //Coefficients
+    const unsigned int* shadeWords   = words + 8;
+    const unsigned int* textureWords = shadeWords + (shade ? 16 : 0);
+    const unsigned int* depthWords   = textureWords + (texture ? 16 : 0);
+
+    bool fill = m_rdp->m_otherMode.cycleType == G_CYC_FILL;
+    bool perspective = texture && m_rdp->m_otherMode.texturePersp;
+    bool primDepth = !zbuffer || m_rdp->getDepthSource() == G_ZS_PRIM;
+    float depth = m_rdp->getDepthSource() == G_ZS_PRIM ? m_rdp->getPrimitiveZ() : 0.0f;
+
+    //Select tiles used by triangle
+    if ( texture && tile != m_batchTile )
+    {
+        _flush();
+        m_rsp->setTile( m_rdp->getTile(tile), 0 );
+        m_rsp->setTile( m_rdp->getTile(tile < 7 ? tile + 1 : tile), 1 );
+        m_rsp->setTexturesChanged(true);
+        m_batchTile = tile;
+    }
+
+    //Vertices
+    GLVertex vertices[5];
+    for (int i=0; i<numPoints; ++i)
+    {
+        GLVertex& vertex = vertices[i];
+        float dy = y[i] - y0;
+        float dx = x[i] - (xh + dxhdy * dy);
+
+        vertex.x = x[i];
+        vertex.y = y[i];
+        vertex.z = depth;
+        vertex.w = 1.0f;
+
+        //Color
+        if ( fill )
+        {
+            const float* fillColor = m_rdp->getCombinerMgr()->getFillColor();
+            vertex.color.r = fillColor[0];
+            vertex.color.g = fillColor[1];
+            vertex.color.b = fillColor[2];
+            vertex.color.a = fillColor[3];
+        }
+        else if ( shade )
+        {
+            float* color = &vertex.color.r;
+            for (int c=0; c<4; ++c)
+            {
+                float value = _getCoefficient(shadeWords, c) + _getCoefficient(shadeWords + 8, c) * dy + 
+                              _getCoefficient(shadeWords + 2, c) * dx;
+                color[c] = value < 0.0f ? 0.0f : (value > 255.0f ? 1.0f : value / 255.0f);
+            }
+        }
+        else
+        {
+            vertex.color.r = vertex.color.g = vertex.color.b = vertex.color.a = 1.0f;
+        }
+
+        //Depth (s15.16)
+        if ( !primDepth )
+        {
+            float z = (int)depthWords[0] / 65536.0f + (int)depthWords[2] / 65536.0f * dy + (int)depthWords[1] / 65536.0f * dx;
+            vertex.z = z < 0.0f ? 0.0f : (z > 32768.0f ? 1.0f : z / 32768.0f);
+        }
+
+        //Texture coordinates (s10.5), divided by w (s.15) when perspective correction is enabled
+        vertex.s0 = vertex.t0 = 0.0f;
+        if ( texture )
+        {
+            float s = (_getCoefficient(textureWords, 0) + _getCoefficient(textureWords + 8, 0) * dy + _getCoefficient(textureWords + 2, 0) * dx) / 32.0f;
+            float t = (_getCoefficient(textureWords, 1) + _getCoefficient(textureWords + 8, 1) * dy + _getCoefficient(textureWords + 2, 1) * dx) / 32.0f;
+            float w = (_getCoefficient(textureWords, 2) + _getCoefficient(textureWords + 8, 2) * dy + _getCoefficient(textureWords + 2, 2) * dx) / 32768.0f;
+            if ( perspective && w > 0.0f )
+            {
+                s /= w;
+                t /= w;
+
+                //Let OpenGL interpolate texture coordinates with perspective correction
+                vertex.w = 1.0f / w;
+                vertex.x *= vertex.w;
+                vertex.y *= vertex.w;
+                vertex.z *= vertex.w;
+            }
+            vertex.s0 = s;
+            vertex.t0 = t;
+        }
+        vertex.s1 = vertex.s0;
+        vertex.t1 = vertex.t0;
+    }
+
+    //Render polygon as triangle fan
+    for (int i=1; i+1<numPoints; ++i)
+    {
+        _addTriangle(&vertices[0], &vertices[i], &vertices[i + 1], !fill);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//* Fill Rectangle
+//! Batches rectangles filled with the fill color. Depth and screen clears
+//! and other cycle types are left to RDP.
+//! @return False if rectangle was not batched
+//-----------------------------------------------------------------------------
+bool RDPCommandParser::_fillRectangle(unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1)
+{
+    if ( m_rdp->m_otherMode.cycleType != G_CYC_FILL || ROMDetector::getSingleton().getIgnoreFillRects() ) {
+        return false;
+    }
+
+    //Clear depth buffer?
+    if ( m_rdp->getDepthImageInfo().rdramAddress == m_rdp->getColorImageInfo().rdramAddress ) {
+        return false;
+    }
+
+    //Fill mode includes lower right edge
+    x1++;
+    y1++;
+
+    //Clear screen?
+    if ( x0 == 0 && y0 == 0 && x1 == m_vi->getWidth() && y1 == m_vi->getHeight() ) {
+        return false;
+    }
+
+    const float* fillColor = m_rdp->getCombinerMgr()->getFillColor();
+    float depth = m_rdp->getDepthSource() == G_ZS_PRIM ? m_rdp->getPrimitiveZ() : 0.0f;
+
+    GLVertex vertices[4];
+    for (int i=0; i<4; ++i)
+    {
+        vertices[i].x = (float)((i == 1 || i == 2) ? x1 : x0);
+        vertices[i].y = (float)((i >= 2) ? y1 : y0);
+        vertices[i].z = depth;
+        vertices[i].w = 1.0f;
+        vertices[i].color.r = fillColor[0];
+        vertices[i].color.g = fillColor[1];
+        vertices[i].color.b = fillColor[2];
+        vertices[i].color.a = fillColor[3];
+        vertices[i].s0 = vertices[i].t0 = vertices[i].s1 = vertices[i].t1 = 0.0f;
+    }
+
+    _addTriangle(&vertices[0], &vertices[1], &vertices[2], false);
+    _addTriangle(&vertices[0], &vertices[2], &vertices[3], false);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//* Texture Rectangle
+//! Texture rectangles are 128 bit commands, the texture coordinates 
+//! follow directly instead of in RDPHALF instructions.
+//-----------------------------------------------------------------------------
+void RDPCommandParser::_textureRectangle(const unsigned int* words, bool flip)
+{
+    RDPUCodeTextureRectangle* rect = (RDPUCodeTextureRectangle*)words;
+
+    unsigned short s    = (unsigned short)(words[2] >> 16);
+    unsigned short t    = (unsigned short)(words[2] & 0xFFFF);
+    unsigned short dsdx = (unsigned short)(words[3] >> 16);
+    unsigned short dtdy = (unsigned short)(words[3] & 0xFFFF);
+
+    if ( flip )
+    {
+        m_rdp->RDP_TexRectFlip(rect->x1 / 4, rect->y1 / 4, rect->x0 / 4, rect->y0 / 4, rect->tile, 
+                               s, t, (short)dsdx, (short)dtdy);
+    }
+    else
+    {
+        m_rdp->RDP_TexRect(rect->x0 / 4, rect->y0 / 4, rect->x1 / 4, rect->y1 / 4, rect->tile, 
+                           s, t, dsdx, dtdy);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//* Add Triangle
+//! Adds a triangle to the current batch
+//-----------------------------------------------------------------------------
+void RDPCommandParser::_addTriangle(GLVertex* v0, GLVertex* v1, GLVertex* v2, bool combinerColor)
+{
+    GLVertex triangle[3] = { *v0, *v1, *v2 };
+    OpenGLRenderer::getSingleton().addScreenTriangle(triangle, combinerColor);
+}
+
+//-----------------------------------------------------------------------------
+//* Flush
+//! Renders batched primitives
+//-----------------------------------------------------------------------------
+void RDPCommandParser::_flush()
+{
+    OpenGLRenderer& renderer = OpenGLRenderer::getSingleton();
+    if ( renderer.getNumVertices() > 0 )
+    {
+        renderer.render();
+        m_numBatches++;
+    }
+    m_batchTile = -1;
+}
+
+//-----------------------------------------------------------------------------
+//* Flush Triangles
+//! Renders batched triangles before a rectangle command, rectangles are
+//! batched by the RDP and rendered when RDP states change.
+//-----------------------------------------------------------------------------
+void RDPCommandParser::_flushTriangles()
+{
+    if ( OpenGLRenderer::getSingleton().getVertexSpace() == VERTEX_SPACE_SCREEN )
+    {
+        _flush();
+    }
+}
+
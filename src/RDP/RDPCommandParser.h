@@ -0,0 +1,109 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef RDP_COMMAND_PARSER_H_
+#define RDP_COMMAND_PARSER_H_
+
+#define M64P_PLUGIN_PROTOTYPES 1
+#include "UCodeDefs.h"
+#include "m64p_plugin.h"
+
+//Forward declarations
+class Memory;
+class RDP;
+class RSP;
+class VI;
+struct GLVertex;
+
+//*****************************************************************************
+//* RDP Command Parser
+//! Executes low level RDP command lists sent through the DP registers 
+//! (ProcessRDPList). State commands are forwarded to RDPInstructions, 
+//! triangles and fill rectangles are set up in screen coordinates and 
+//! gathered in the vertex buffer of OpenGLRenderer, so consecutive 
+//! primitives are drawn with one draw call. The batch is rendered before
+//! any command that changes state.
+//*****************************************************************************
+class RDPCommandParser
+{
+public:
+
+    static const unsigned int MAX_COMMAND_WORDS = 0x10000;  //!< Size of command buffer in words
+
+    //Constructor / Destructor
+    RDPCommandParser();
+    ~RDPCommandParser();
+
+    //Initialize / Dispose
+    bool initialize(GFX_INFO* graphicsInfo, RSP* rsp, RDP* rdp, Memory* memory, VI* vi);
+    void dispose();
+
+    //Execute commands between DPC_CURRENT_REG and DPC_END_REG
+    void processRDPList();
+
+    //Statistics
+    unsigned int getNumLists()           { return m_numLists;           }
+    unsigned int getNumCommands()        { return m_numCommands;        }
+    unsigned int getNumBytes()           { return m_numBytes;           }
+    unsigned int getNumTriangles()       { return m_numTriangles;       }
+    unsigned int getNumRectangles()      { return m_numRectangles;      }
+    unsigned int getNumBatches()         { return m_numBatches;         }
+    unsigned int getNumUnknownCommands() { return m_numUnknownCommands; }
+
+private:
+
+    //Commands
+    unsigned int _execute(unsigned int* words, unsigned int numWords);
+    void _triangle(const unsigned int* words, bool shade, bool texture, bool zbuffer);
+    bool _fillRectangle(unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1);
+    void _textureRectangle(const unsigned int* words, bool flip);
+
+    //Batches
+    void _flush();
+    void _flushTriangles();
+    void _addTriangle(GLVertex* v0, GLVertex* v1, GLVertex* v2, bool combinerColor);
+
+    //Decoding
+    static unsigned int _getCommandSize(unsigned int command);
+    static float _getCoefficient(const unsigned int* words, int component);
+
+private:
+
+    GFX_INFO*     m_graphicsInfo;        //!< Access to DP registers, RDRAM and DMEM
+    RSP*          m_rsp;                 //!< Tiles used by triangles are selected on RSP
+    RDP*          m_rdp;                 //!< Reality Drawing Processor
+    Memory*       m_memory;              //!< Memory manager
+    VI*           m_vi;                  //!< Video interface, size of screen
+
+    unsigned int* m_words;               //!< Commands waiting to be executed
+    unsigned int  m_numWords;            //!< Number of words in command buffer
+    int           m_batchTile;           //!< Tile used by batched triangles, -1 if none
+
+    unsigned int  m_numLists;            //!< Number of times ProcessRDPList was called
+    unsigned int  m_numCommands;         //!< Number of commands executed
+    unsigned int  m_numBytes;            //!< Number of command bytes read
+    unsigned int  m_numTriangles;        //!< Number of triangle commands
+    unsigned int  m_numRectangles;       //!< Number of fill and texture rectangles
+    unsigned int  m_numBatches;          //!< Number of batches rendered
+    unsigned int  m_numUnknownCommands;  //!< Number of commands that were skipped
+};
+
+#endif
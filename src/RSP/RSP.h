@@ -145,6 +145,7 @@ public:
 
     RSPMatrixManager* getMatrixMgr() { return m_matrixMgr; }
     RSPVertexManager* getVertexMgr() { return m_vertexMgr; }
+    RSPLightManager* getLightMgr() { return m_lightMgr; }
 
 public:
 
@@ -19,6 +19,8 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  *****************************************************************************/
 
+#include <cstring>    //memcmp
+
 #include "GBI.h"
 #include "Logger.h"
 #include "MathLib.h"
@@ -49,6 +51,8 @@ bool RSPLightManager::initialize(Memory* memory)
     m_memory = memory;
     m_numLights = 0;
     m_lightEnabled = false;
+    m_generation = 0;
+    memset(m_lights, 0, sizeof(m_lights));
 
     return true;
 }
@@ -68,15 +72,23 @@ void RSPLightManager::setLight( unsigned int lightIndex, unsigned int rdramAddre
 
     if ( lightIndex < 8 ) //Only supports 8 lights
     {
-        m_lights[lightIndex].r = light->r * 0.0039215689f;  //Convert from 0-255 to 0-1
-        m_lights[lightIndex].g = light->g * 0.0039215689f;
-        m_lights[lightIndex].b = light->b * 0.0039215689f;
+        RSPLight newLight;
+        newLight.r = light->r * 0.0039215689f;  //Convert from 0-255 to 0-1
+        newLight.g = light->g * 0.0039215689f;
+        newLight.b = light->b * 0.0039215689f;
+
+        newLight.x = light->x;
+        newLight.y = light->y;
+        newLight.z = light->z;    
 
-        m_lights[lightIndex].x = light->x;
-        m_lights[lightIndex].y = light->y;
-        m_lights[lightIndex].z = light->z;    
+        Vec3Normalize( &newLight.x );
 
-        Vec3Normalize( &m_lights[lightIndex].x );
+        //Lights are set again for every object, only a real change is a new generation
+        if ( memcmp(&m_lights[lightIndex], &newLight, sizeof(RSPLight)) != 0 )
+        {
+            m_lights[lightIndex] = newLight;
+            m_generation++;
+        }
     }
 }
 
@@ -85,9 +97,10 @@ void RSPLightManager::setLight( unsigned int lightIndex, unsigned int rdramAddre
 //-----------------------------------------------------------------------------
 void RSPLightManager::setNumLights(int numLights)
 {
-    if (numLights <= 8) 
+    if (numLights <= 8 && numLights != m_numLights) 
     {
         m_numLights = numLights;    
+        m_generation++;
     }
 }
 
@@ -98,8 +111,15 @@ void RSPLightManager::setLightColor( unsigned int lightIndex, unsigned int packe
 {
     if (lightIndex < 8)
     {
-        m_lights[lightIndex].r = _SHIFTR( packedColor, 24, 8 ) * 0.0039215689f;
-        m_lights[lightIndex].g = _SHIFTR( packedColor, 16, 8 ) * 0.0039215689f;
-        m_lights[lightIndex].b = _SHIFTR( packedColor, 8, 8 ) * 0.0039215689f;
+        float r = _SHIFTR( packedColor, 24, 8 ) * 0.0039215689f;
+        float g = _SHIFTR( packedColor, 16, 8 ) * 0.0039215689f;
+        float b = _SHIFTR( packedColor, 8, 8 ) * 0.0039215689f;
+        if ( r != m_lights[lightIndex].r || g != m_lights[lightIndex].g || b != m_lights[lightIndex].b )
+        {
+            m_lights[lightIndex].r = r;
+            m_lights[lightIndex].g = g;
+            m_lights[lightIndex].b = b;
+            m_generation++;
+        }
     }
 }
@@ -74,6 +74,9 @@ public:
     const float* getLightColor(int lightIndex)      { return &m_lights[lightIndex].r; }
     const float* getLightDirection(int lightIndex)  { return &m_lights[lightIndex].x; }
 
+    //Generation (increased every time the contents of a light change)
+    unsigned int getGeneration()                    { return m_generation; }
+
 private:
 
     Memory* m_memory;
@@ -82,6 +85,7 @@ private:
     bool m_lightEnabled;
     RSPLight m_lights[8];
     int m_numLights;
+    unsigned int m_generation;   //!< Increased when lights change, lets users cache lighting results
 
 };
 
@@ -20,6 +20,7 @@
  *****************************************************************************/
 
 #include <cmath>      //modff
+#include <cstring>    //memcmp, memcpy
 
 #include "GBI.h"      //SHIFT
 #include "GBIDefs.h"  //_FIXED2FLOAT
@@ -49,6 +50,14 @@ bool RSPMatrixManager::initialize(Memory* memory)
 {
     m_memory = memory;
     m_rdramOffset = 0;
+    m_generation = 0;
+    m_generationDirty = true;
+    m_worldProjectDirty = true;
+
+    for (unsigned int i=0; i<NUM_DECODED_MATRICES; ++i)
+    {
+        m_decodedMatrices[i].address = ~0U;
+    }
     return true;
 }
 
@@ -79,8 +88,6 @@ void RSPMatrixManager::addMatrix(unsigned int segmentAddress, bool projectionMat
     {
         _setWorldView(temp, push, replace);
     }
-
-    _updateCombinedMatrix();
 }
 
 //-----------------------------------------------------------------------------
@@ -90,7 +97,12 @@ void RSPMatrixManager::insertMatrix(unsigned int where, unsigned int num)
 {
     float fraction, integer;
 
-    _updateCombinedMatrix();
+    //Matrix is edited in place, so make sure it is up to date
+    if ( m_worldProjectDirty )
+    {
+        _updateCombinedMatrix();
+    }
+    m_generationDirty = true;
 
     if ((where & 0x3) || (where > 0x3C))
     {
@@ -131,6 +143,8 @@ void RSPMatrixManager::insertMatrix(unsigned int where, unsigned int num)
 void RSPMatrixManager::ForceMatrix(unsigned int rdramAddress)
 {
     _loadMatrix(rdramAddress, m_worldProject);
+    m_worldProjectDirty = false;
+    m_generationDirty = true;
 }
         
 
@@ -145,7 +159,7 @@ void RSPMatrixManager::popMatrix()
         m_modelViewMatrixTop--;             //Pop Matrix from stack
     }
 
-    _updateCombinedMatrix();
+    _invalidateCombinedMatrix();
 }
 
 //-----------------------------------------------------------------------------
@@ -158,7 +172,7 @@ void RSPMatrixManager::popMatrixN(unsigned int num)
         m_modelViewMatrixTop -= num;
     }
 
-    _updateCombinedMatrix();
+    _invalidateCombinedMatrix();
 }
 
 //-----------------------------------------------------------------------------
@@ -196,7 +210,7 @@ void RSPMatrixManager::DMAMatrix( unsigned int rdramAddress, unsigned char index
     m_projectionMatrices[m_projectionMatrixTop] = Matrix4::IDENTITY;
 
     //Update Matrices
-    _updateCombinedMatrix();
+    _invalidateCombinedMatrix();
 }
 
 //-----------------------------------------------------------------------------
@@ -210,7 +224,7 @@ void RSPMatrixManager::resetMatrices()
     m_modelViewMatrixTop = 0;
     m_projectionMatrixTop = 0;
 
-    _updateCombinedMatrix();
+    _invalidateCombinedMatrix();
 }
 
 //-----------------------------------------------------------------------------
@@ -224,6 +238,13 @@ void RSPMatrixManager::_loadMatrix(unsigned int addr, Matrix4& out)
 
     unsigned char* RDRAM = m_memory->getRDRAM();
 
+    //Same matrices are often loaded many times per frame, reuse decoded matrix if data is unchanged
+    DecodedMatrix& decoded = m_decodedMatrices[(addr >> 6) & (NUM_DECODED_MATRICES - 1)];
+    if ( decoded.address == addr && memcmp(decoded.rdramData, RDRAM + addr, 64) == 0 )
+    {
+        out = decoded.matrix;
+        return;
+    }
 
     for (int i = 0; i < 4; i++)
     {
@@ -234,6 +255,10 @@ void RSPMatrixManager::_loadMatrix(unsigned int addr, Matrix4& out)
             out[i][j] = (float)((hi<<16) | (lo))/ 65536.0f;
         }
     }
+
+    decoded.address = addr;
+    memcpy(decoded.rdramData, RDRAM + addr, 64);
+    decoded.matrix = out;
 }
 
 //-----------------------------------------------------------------------------
@@ -257,7 +282,7 @@ void RSPMatrixManager::_setProjection(const Matrix4& mat, bool push, bool replac
         m_projectionMatrices[m_projectionMatrixTop] = mat * oldMatrix;        
     }
 
-    _updateCombinedMatrix();
+    _invalidateCombinedMatrix();
 }
 
 //-----------------------------------------------------------------------------
@@ -281,13 +306,47 @@ void RSPMatrixManager::_setWorldView(const Matrix4 & mat, bool push, bool replac
         m_modelViewMatrices[m_modelViewMatrixTop] = mat * oldMatrix;        
     }    
 
-    _updateCombinedMatrix();
+    _invalidateCombinedMatrix();
 }
 
 //-----------------------------------------------------------------------------
 //! Update Combined Matrix
+//! Called on first use after matrices have changed
 //-----------------------------------------------------------------------------
 void RSPMatrixManager::_updateCombinedMatrix()
 {
     m_worldProject = m_modelViewMatrices[m_modelViewMatrixTop] * m_projectionMatrices[m_projectionMatrixTop];
+    m_worldProjectDirty = false;
+}
+
+//-----------------------------------------------------------------------------
+//! Update Generation
+//! Games load the same matrices again every frame and for every object,
+//! so the generation is only increased if the matrices actually changed.
+//-----------------------------------------------------------------------------
+void RSPMatrixManager::_updateGeneration()
+{
+    if ( m_worldProjectDirty )
+    {
+        _updateCombinedMatrix();
+    }
+
+    const Matrix4* current[3] = { &m_modelViewMatrices[m_modelViewMatrixTop], 
+                                  &m_projectionMatrices[m_projectionMatrixTop], 
+                                  &m_worldProject };
+    bool changed = false;
+    for (int i=0; i<3; ++i)
+    {
+        if ( memcmp(&m_generationMatrices[i], current[i], sizeof(Matrix4)) != 0 )
+        {
+            m_generationMatrices[i] = *current[i];
+            changed = true;
+        }
+    }
+
+    if ( changed )
+    {
+        m_generation++;
+    }
+    m_generationDirty = false;
 }
@@ -48,7 +48,7 @@ public:
     void popMatrix();
     void popMatrixN(unsigned int num);
     void ForceMatrix( unsigned int segmentAddress );
-    void selectViewMatrix(unsigned int index) { m_modelViewMatrixTop = index; _updateCombinedMatrix(); }    
+    void selectViewMatrix(unsigned int index) { m_modelViewMatrixTop = index; _invalidateCombinedMatrix(); }    
     void DMAMatrix(unsigned int segmentAddress, unsigned char index, unsigned char multiply );
     //void RSP_ForceMatrix( unsigned int mptr );
     //void RSP_LookAt( unsigned int l );
@@ -62,14 +62,19 @@ public:
 
     float* getModelViewMatrix()      { return m_modelViewMatrices[m_modelViewMatrixTop]._m;   }
     float* getProjectionMatrix()     { return m_projectionMatrices[m_projectionMatrixTop]._m; }
-    float* getViewProjectionMatrix() { return m_worldProject._m;                              }
+    float* getViewProjectionMatrix() { if ( m_worldProjectDirty ) _updateCombinedMatrix(); return m_worldProject._m; }
+
+    //Generation (increased every time the contents of the matrices above change)
+    unsigned int getGeneration()     { if ( m_generationDirty ) _updateGeneration(); return m_generation; }
 
 private:
 
     void _loadMatrix(unsigned int addr, Matrix4& out);
     void _setProjection(const Matrix4& mat, bool push, bool replace);
     void _setWorldView(const Matrix4 & mat, bool push, bool replace);
+    void _invalidateCombinedMatrix() { m_worldProjectDirty = true; m_generationDirty = true; }
     void _updateCombinedMatrix();
+    void _updateGeneration();
 
 private:
 
@@ -83,10 +88,25 @@ private:
     unsigned int m_modelViewMatrixTop;
     unsigned int m_projectionMatrixTop;
 
+    unsigned int m_generation;   //!< Increased when matrices change, lets users cache transformed data
+    bool m_generationDirty;      //!< True if matrices must be compared with generation matrices
+
     //Matrices
     Matrix4 m_modelViewMatrices[NUM_STACK_MATRICES];   //!< Stack with projection matrices
     Matrix4 m_projectionMatrices[NUM_STACK_MATRICES];  //!< Stack with projection matrices
     Matrix4 m_worldProject;                            //!< Combined modelviewprojection matrix
+    bool m_worldProjectDirty;                          //!< True if combined matrix must be recalculated before use
+    Matrix4 m_generationMatrices[3];                   //!< Modelview, projection and combined matrix of current generation
+
+    //Decoded matrices
+    struct DecodedMatrix
+    {
+        unsigned int address;          //!< RDRAM address matrix was loaded from
+        unsigned char rdramData[64];   //!< Fixed point matrix data in RDRAM
+        Matrix4 matrix;                //!< Decoded matrix
+    };
+    static const unsigned int NUM_DECODED_MATRICES = 32;   //!< Must be power of two
+    DecodedMatrix m_decodedMatrices[NUM_DECODED_MATRICES];  //!< Direct mapped cache with decoded matrices
 };
 
 #endif
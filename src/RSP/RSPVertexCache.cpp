@@ -0,0 +1,148 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#include <cstring>  //memcmp, memcpy
+
+#include "RSPVertexCache.h"
+
+//-----------------------------------------------------------------------------
+//! Constructor
+//-----------------------------------------------------------------------------
+RSPVertexCache::RSPVertexCache()
+{
+    m_entries = 0;
+    m_useCount = 0;
+    m_numHits = 0;
+    m_numMisses = 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Destructor
+//-----------------------------------------------------------------------------
+RSPVertexCache::~RSPVertexCache()
+{
+    dispose();
+}
+
+//-----------------------------------------------------------------------------
+//* Initialize
+//-----------------------------------------------------------------------------
+bool RSPVertexCache::initialize()
+{
+    dispose();
+
+    m_entries = new Entry[CACHE_SIZE];
+    for (unsigned int i=0; i<CACHE_SIZE; ++i)
+    {
+        m_entries[i].valid = false;
+        m_entries[i].lastUsed = 0;
+    }
+
+    m_useCount = 0;
+    m_numHits = 0;
+    m_numMisses = 0;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//* Dispose
+//-----------------------------------------------------------------------------
+void RSPVertexCache::dispose()
+{
+    if ( m_entries ) { delete[] m_entries; m_entries = 0; }
+}
+
+//-----------------------------------------------------------------------------
+//* Find
+//! @param key State vertices are to be transformed with
+//! @param rdramData Vertex data in RDRAM
+//! @return Transformed vertices, or 0 if not found in cache
+//-----------------------------------------------------------------------------
+const SPVertex* RSPVertexCache::find(const RSPVertexCacheKey& key, const void* rdramData)
+{
+    if ( !m_entries || key.numVertices > MAX_CACHED_VERTICES ) {
+        return 0;
+    }
+
+    Entry* set = _getSet(key);
+    m_useCount++;
+
+    for (unsigned int i=0; i<CACHE_WAYS; ++i)
+    {
+        Entry& entry = set[i];
+        if ( entry.valid &&
+             memcmp(&entry.key, &key, sizeof(RSPVertexCacheKey)) == 0 &&
+             memcmp(entry.rdramData, rdramData, key.numVertices * VERTEX_SIZE) == 0 )
+        {
+            entry.lastUsed = m_useCount;
+            m_numHits++;
+            return entry.vertices;
+        }
+    }
+
+    m_numMisses++;
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//* Store
+//! Replaces an older load from the same address, otherwise the least recently used way
+//-----------------------------------------------------------------------------
+void RSPVertexCache::store(const RSPVertexCacheKey& key, const void* rdramData, const SPVertex* vertices)
+{
+    if ( !m_entries || key.numVertices > MAX_CACHED_VERTICES ) {
+        return;
+    }
+
+    Entry* set = _getSet(key);
+    Entry* replaced = &set[0];
+    for (unsigned int i=0; i<CACHE_WAYS; ++i)
+    {
+        if ( !set[i].valid || (set[i].key.address == key.address && set[i].key.numVertices == key.numVertices) )
+        {
+            replaced = &set[i];
+            break;
+        }
+        if ( set[i].lastUsed < replaced->lastUsed )
+        {
+            replaced = &set[i];
+        }
+    }
+
+    Entry& entry = *replaced;
+    entry.valid = true;
+    entry.lastUsed = m_useCount;
+    entry.key = key;
+    memcpy(entry.rdramData, rdramData, key.numVertices * VERTEX_SIZE);
+    memcpy(entry.vertices, vertices, key.numVertices * sizeof(SPVertex));
+}
+
+//-----------------------------------------------------------------------------
+//* Get Set
+//! Hashes address and size of the load, other state is verified on lookup.
+//! The top bits of the product are best mixed, so they are used as index.
+//-----------------------------------------------------------------------------
+RSPVertexCache::Entry* RSPVertexCache::_getSet(const RSPVertexCacheKey& key)
+{
+    unsigned int hash = (key.address >> 3) ^ (key.numVertices << 16);
+    hash *= 2654435761U;
+    return &m_entries[(hash >> (32 - CACHE_INDEX_BITS)) * CACHE_WAYS];
+}
@@ -0,0 +1,100 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef RSP_VERTEX_CACHE_H_
+#define RSP_VERTEX_CACHE_H_
+
+#include "RSPVertexManager.h"
+
+//-----------------------------------------------------------------------------
+//* RSP Vertex Cache Key
+//! State that decides how vertices loaded from RDRAM are transformed
+//-----------------------------------------------------------------------------
+struct RSPVertexCacheKey
+{
+    unsigned int address;           //!< RDRAM address of first vertex
+    unsigned int numVertices;       //!< Number of vertices loaded
+    unsigned int matrixGeneration;  //!< Generation of matrix manager when vertices was transformed
+    unsigned int lightGeneration;   //!< Generation of light manager when vertices was lit
+    unsigned int texCoordGenType;   //!< Texture coordinate generation mode
+    unsigned int flags;             //!< Lighting and z-buffer enabled
+};
+
+//*****************************************************************************
+//* RSP Vertex Cache
+//! Remembers transformed vertices so static geometry that is loaded again
+//! with the same matrices and lights does not have to be transformed again.
+//! Entries are verified against a copy of the vertex data in RDRAM.
+//*****************************************************************************
+class RSPVertexCache
+{
+public:
+
+    //Constructor / Destructor
+    RSPVertexCache();
+    ~RSPVertexCache();
+
+    bool initialize();
+    void dispose();
+
+    //Lookup / Store
+    const SPVertex* find(const RSPVertexCacheKey& key, const void* rdramData);
+    void store(const RSPVertexCacheKey& key, const void* rdramData, const SPVertex* vertices);
+
+    //Statistics
+    unsigned int getNumHits()   { return m_numHits;   }
+    unsigned int getNumMisses() { return m_numMisses; }
+
+public:
+
+    static const unsigned int MAX_CACHED_VERTICES = 64;  //!< Larger loads are not cached
+    static const unsigned int VERTEX_SIZE = 16;          //!< Size of a vertex in RDRAM
+
+private:
+
+    //-----------------------------------------------------------------------------
+    //! Cache entry
+    //-----------------------------------------------------------------------------
+    struct Entry
+    {
+        bool valid;
+        unsigned int lastUsed;   //!< Use count when entry was last found or stored
+        RSPVertexCacheKey key;
+        unsigned char rdramData[MAX_CACHED_VERTICES * VERTEX_SIZE];
+        SPVertex vertices[MAX_CACHED_VERTICES];
+    };
+
+    Entry* _getSet(const RSPVertexCacheKey& key);
+
+private:
+
+    static const unsigned int CACHE_WAYS = 2;                         //!< Entries each load can be stored in
+    static const unsigned int CACHE_INDEX_BITS = 5;                   //!< Bits of hash used as set index
+    static const unsigned int CACHE_SIZE = CACHE_WAYS << CACHE_INDEX_BITS;  //!< Number of entries
+
+    Entry* m_entries;           //!< Two-way set associative cache entries
+    unsigned int m_useCount;    //!< Increased on every lookup, decides which way is replaced
+    unsigned int m_numHits;     //!< Number of loads served from cache
+    unsigned int m_numMisses;   //!< Number of loads that had to be transformed
+
+};
+
+#endif
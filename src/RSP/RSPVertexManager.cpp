@@ -20,6 +20,10 @@
  *****************************************************************************/
 
 #include <cmath> //sqrt
+#include <cstring> //memcpy
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
 
 #include "GBI.h"
 #include "GBIDefs.h"   //hmm
@@ -31,7 +35,10 @@
 #include "OpenGLRenderer.h"
 #include "RSPLightManager.h"
 #include "RSPMatrixManager.h"
+#include "RSPVertexCache.h"
 #include "RSPVertexManager.h"
+#include "RenderDevice.h"
+#include "ThreadPool.h"
 #include "m64p_types.h"
 
 //Vertex
@@ -82,6 +89,7 @@ RSPVertexManager::RSPVertexManager()
     m_openGLMgr = 0;
     m_memory    = 0;
     m_matrixMgr = 0;
+    m_vertexCache = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -89,7 +97,7 @@ RSPVertexManager::RSPVertexManager()
 //-----------------------------------------------------------------------------
 RSPVertexManager::~RSPVertexManager()
 {
-
+    if ( m_vertexCache ) { delete m_vertexCache; m_vertexCache = 0; }
 }
 
 //-----------------------------------------------------------------------------
@@ -104,6 +112,18 @@ bool RSPVertexManager::initialize(OpenGLManager* openGLMgr, Memory* memory, RSPM
     m_texCoordGenType = TCGT_NONE;
     m_rdramOffset = 0;
     m_billboard = false;
+    m_lightSpaceMatrixGeneration = ~0U;
+    m_lightSpaceLightGeneration = ~0U;
+    m_zBufferEnabled = true;
+    m_viewProjection = 0;
+
+    //Initialize Vertex Cache
+    if ( !m_vertexCache ) {
+        m_vertexCache = new RSPVertexCache();
+    }
+    if ( !m_vertexCache->initialize() ) {
+        return false;
+    }
     return true;
 }
 
@@ -126,6 +146,26 @@ void RSPVertexManager::setVertices( unsigned int address, unsigned int numVertic
         return;
     }
 
+    //Static geometry is often loaded again with the same matrices and lights,
+    //reuse the transformed vertices then. Billboards depend on vertex 0 so they are not cached.
+    RSPVertexCacheKey key;
+    key.address          = address;
+    key.numVertices      = numVertices;
+    key.matrixGeneration = m_matrixMgr->getGeneration();
+    key.lightGeneration  = m_lightMgr->getGeneration();
+    key.texCoordGenType  = m_texCoordGenType;
+    key.flags            = (m_lightMgr->getLightEnabled() ? 1 : 0) | (OpenGLManager::getSingleton().getZBufferEnabled() ? 2 : 0);
+
+    if ( !m_billboard )
+    {
+        const SPVertex* cached = m_vertexCache->find(key, vertex);
+        if ( cached )
+        {
+            memcpy(&m_vertices[firstVertexIndex], cached, numVertices * sizeof(SPVertex));
+            return;
+        }
+    }
+
     //For each vertex
     for (unsigned int i=firstVertexIndex; i <numVertices+firstVertexIndex; ++i)
     {
@@ -151,9 +191,15 @@ void RSPVertexManager::setVertices( unsigned int address, unsigned int numVertic
             m_vertices[i].a = vertex->color.a * 0.0039215689f;
         }
 
-        _processVertex(i);
         vertex++;
     }
+
+    _processVertices(firstVertexIndex, numVertices);
+
+    if ( !m_billboard )
+    {
+        m_vertexCache->store(key, m_memory->getRDRAM(address), &m_vertices[firstVertexIndex]);
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -244,9 +290,10 @@ void RSPVertexManager::ciVertex(unsigned int segmentAddress, unsigned int numVer
             m_vertices[i].a = color[0] * 0.0039215689f;
         }
 
-        _processVertex( i );
         vertex++;
     }
+
+    _processVertices(firstVertexIndex, numVertices);
 }
 
 //-----------------------------------------------------------------------------
@@ -286,10 +333,10 @@ void RSPVertexManager::DMAVertex( unsigned int v, unsigned int numVertices, unsi
                 m_vertices[i].a = *(unsigned char*)&RDRAM[(address + 9) ^ 3] * 0.0039215689f;
             }
 
-            _processVertex( i );
-
             address += 10;
         }
+
+        _processVertices(firstVertexIndex, numVertices);
     }
 }
 
@@ -391,7 +438,7 @@ void RSPVertexManager::addDMATriangles( unsigned int tris, unsigned int n )
         //        gSP.geometryMode |= G_CULL_FRONT;
         //}
         //gSP.changed |= CHANGED_GEOMETRYMODE;
-        glDisable(GL_CULL_FACE);
+        RenderDevice::getSingleton().disable(GL_CULL_FACE);
         
         m_vertices[triangles->v0].s = _FIXED2FLOAT( triangles->s0, 5 );
         m_vertices[triangles->v0].t = _FIXED2FLOAT( triangles->t0, 5 );
@@ -425,114 +472,349 @@ void RSPVertexManager::add1Quadrangle( int v0, int v1, int v2, int v4 )
 }
 
 
-inline float DotProduct( float* v0, float* v1 )
+//-----------------------------------------------------------------------------
+//* Update Light Space
+//! Transforms light directions into model space so normals can be shaded
+//! without being transformed first. Since dot(M*n, L) = dot(n, M^T*L) only
+//! the length of M*n is needed, and it is given by the quadratic form of M^T*M.
+//-----------------------------------------------------------------------------
+void RSPVertexManager::_updateLightSpace()
 {
-    float    dot;
-    dot = v0[0] * v1[0] + v0[1] * v1[1] + v0[2] * v1[2];
-    return dot;
-}
-
+    const float* m = m_matrixMgr->getModelViewMatrix();
 
-void RSPVertexManager::_processVertex( unsigned int v )
-{
-//    float intensity;
-//    float r, g, b;
+    for (int i=0; i<m_lightMgr->getNumLights(); ++i)
+    {
+        const float* l = m_lightMgr->getLightDirection(i);
+        m_lightSpaceDirections[i][0] = Vec3Dot(&m[0], l);
+        m_lightSpaceDirections[i][1] = Vec3Dot(&m[4], l);
+        m_lightSpaceDirections[i][2] = Vec3Dot(&m[8], l);
+    }
 
-    transformVertex( m_matrixMgr->getViewProjectionMatrix(), &m_vertices[v].x, &m_vertices[v].x);
-    //TransformVertex( &m_vertices[v].x, m_worldProject );
+    m_normalMetric[0] = Vec3Dot(&m[0], &m[0]);
+    m_normalMetric[1] = Vec3Dot(&m[4], &m[4]);
+    m_normalMetric[2] = Vec3Dot(&m[8], &m[8]);
+    m_normalMetric[3] = Vec3Dot(&m[0], &m[4]) * 2.0f;
+    m_normalMetric[4] = Vec3Dot(&m[0], &m[8]) * 2.0f;
+    m_normalMetric[5] = Vec3Dot(&m[4], &m[8]) * 2.0f;
 
+    m_lightSpaceMatrixGeneration = m_matrixMgr->getGeneration();
+    m_lightSpaceLightGeneration = m_lightMgr->getGeneration();
+}
 
-    if ( m_billboard )
+//-----------------------------------------------------------------------------
+//* Light Vertices
+//! Calculates vertex colors from ambient light and all directional lights,
+//! using model space normals. Handles four vertices at once when SSE is available.
+//! Light-space directions are updated by _processVertices before this is called.
+//-----------------------------------------------------------------------------
+void RSPVertexManager::_lightVertices( unsigned int firstVertexIndex, unsigned int numVertices )
+{
+    const int numLights = m_lightMgr->getNumLights();
+    const float* ambient = m_lightMgr->getAmbientLight();
+    const float* g = m_normalMetric;
+    unsigned int i = firstVertexIndex;
+    unsigned int end = firstVertexIndex + numVertices;
+
+#ifdef __SSE__
+    for (; i + 4 <= end; i += 4)
     {
-        m_vertices[v].x += m_vertices[0].x;
-        m_vertices[v].y += m_vertices[0].y;
-        m_vertices[v].z += m_vertices[0].z;
-        m_vertices[v].w += m_vertices[0].w;
-    }
+        SPVertex* v = &m_vertices[i];
+        __m128 x = _mm_setr_ps(v[0].nx, v[1].nx, v[2].nx, v[3].nx);
+        __m128 y = _mm_setr_ps(v[0].ny, v[1].ny, v[2].ny, v[3].ny);
+        __m128 z = _mm_setr_ps(v[0].nz, v[1].nz, v[2].nz, v[3].nz);
+
+        //Squared length of transformed normals
+        __m128 lengthSq = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(_mm_mul_ps(x, x), _mm_set1_ps(g[0])),
+                       _mm_add_ps(_mm_mul_ps(_mm_mul_ps(y, y), _mm_set1_ps(g[1])),
+                                  _mm_mul_ps(_mm_mul_ps(z, z), _mm_set1_ps(g[2])))),
+            _mm_add_ps(_mm_mul_ps(_mm_mul_ps(x, y), _mm_set1_ps(g[3])),
+                       _mm_add_ps(_mm_mul_ps(_mm_mul_ps(x, z), _mm_set1_ps(g[4])),
+                                  _mm_mul_ps(_mm_mul_ps(y, z), _mm_set1_ps(g[5])))));
+
+        //Same threshold as Vec3Normalize, shorter normals are left as they are
+        __m128 invLength = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(lengthSq));
+        __m128 normalize = _mm_cmpgt_ps(lengthSq, _mm_set1_ps(0.00001f));
+        invLength = _mm_or_ps(_mm_and_ps(normalize, invLength), _mm_andnot_ps(normalize, _mm_set1_ps(1.0f)));
+
+        __m128 r = _mm_set1_ps(ambient[0]);
+        __m128 gr = _mm_set1_ps(ambient[1]);
+        __m128 b = _mm_set1_ps(ambient[2]);
+
+        for (int l=0; l<numLights; ++l)
+        {
+            const float* dir = m_lightSpaceDirections[l];
+            const float* color = m_lightMgr->getLightColor(l);
 
+            __m128 intensity = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(dir[0])),
+                               _mm_add_ps(_mm_mul_ps(y, _mm_set1_ps(dir[1])),
+                                          _mm_mul_ps(z, _mm_set1_ps(dir[2]))));
+            intensity = _mm_max_ps(_mm_mul_ps(intensity, invLength), _mm_setzero_ps());
 
-    if ( !OpenGLManager::getSingleton().getZBufferEnabled() )
-    {
-        m_vertices[v].z = -m_vertices[v].w;
-    }
+            r  = _mm_add_ps(r,  _mm_mul_ps(intensity, _mm_set1_ps(color[0])));
+            gr = _mm_add_ps(gr, _mm_mul_ps(intensity, _mm_set1_ps(color[1])));
+            b  = _mm_add_ps(b,  _mm_mul_ps(intensity, _mm_set1_ps(color[2])));
+        }
 
-    //Temporary variables
-    float intensity;
-    float r, g, b;
+        float rgb[3][4];
+        _mm_storeu_ps(rgb[0], r);
+        _mm_storeu_ps(rgb[1], gr);
+        _mm_storeu_ps(rgb[2], b);
 
-    if ( m_lightMgr->getLightEnabled() )
+        for (int j=0; j<4; ++j)
+        {
+            v[j].r = rgb[0][j];
+            v[j].g = rgb[1][j];
+            v[j].b = rgb[2][j];
+        }
+    }
+#endif
+
+    //Remaining vertices
+    for (; i < end; ++i)
     {
-        //Transform normal
-        transformVector( m_matrixMgr->getModelViewMatrix(), &m_vertices[v].nx, &m_vertices[v].nx );
-        Vec3Normalize( &m_vertices[v].nx );
+        SPVertex* v = &m_vertices[i];
+        float x = v->nx;
+        float y = v->ny;
+        float z = v->nz;
+
+        float lengthSq = x*x*g[0] + y*y*g[1] + z*z*g[2] + x*y*g[3] + x*z*g[4] + y*z*g[5];
+        float invLength = ( lengthSq > 0.00001f ) ? 1.0f / sqrtf(lengthSq) : 1.0f;
 
         //Get Ambient Color
-        const float* ambientColor = m_lightMgr->getAmbientLight();
-        r = ambientColor[0];
-        g = ambientColor[1];
-        b = ambientColor[2];
+        float r = ambient[0];
+        float gr = ambient[1];
+        float b = ambient[2];
 
-        for (int i=0; i<m_lightMgr->getNumLights(); ++i)
+        for (int l=0; l<numLights; ++l)
         {
-            intensity = DotProduct( (float*)&m_vertices[v].nx, (float*)m_lightMgr->getLightDirection(i) );
+            float intensity = Vec3Dot(&v->nx, m_lightSpaceDirections[l]) * invLength;
 
             if (intensity < 0.0f) intensity = 0.0f;
 
-            const float* lightColor = m_lightMgr->getLightColor(i);
-            r += lightColor[0] * intensity;
-            g += lightColor[1] * intensity;
-            b += lightColor[2] * intensity;
+            const float* lightColor = m_lightMgr->getLightColor(l);
+            r  += lightColor[0] * intensity;
+            gr += lightColor[1] * intensity;
+            b  += lightColor[2] * intensity;
         }
 
         //Set Color
-        m_vertices[v].r = r;
-        m_vertices[v].g = g;
-        m_vertices[v].b = b;    
+        v->r = r;
+        v->g = gr;
+        v->b = b;
     }
+}
 
-    //Texture Generation
-    if ( m_texCoordGenType != TCGT_NONE )
+#ifdef __SSE__
+//-----------------------------------------------------------------------------
+//* Transform Normals
+//! Transforms four normals by upper 3x3 part of matrix, then normalizes them
+//! the same way as Vec3Normalize.
+//-----------------------------------------------------------------------------
+static inline void transformNormals4(const float* m, __m128& x, __m128& y, __m128& z)
+{
+    __m128 tx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(m[0])), _mm_mul_ps(y, _mm_set1_ps(m[4]))), _mm_mul_ps(z, _mm_set1_ps(m[8])));
+    __m128 ty = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(m[1])), _mm_mul_ps(y, _mm_set1_ps(m[5]))), _mm_mul_ps(z, _mm_set1_ps(m[9])));
+    __m128 tz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(m[2])), _mm_mul_ps(y, _mm_set1_ps(m[6]))), _mm_mul_ps(z, _mm_set1_ps(m[10])));
+
+    __m128 lengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, tx), _mm_mul_ps(ty, ty)), _mm_mul_ps(tz, tz));
+    __m128 invLength = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(lengthSq));
+    __m128 normalize = _mm_cmpgt_ps(lengthSq, _mm_set1_ps(0.00001f));
+    invLength = _mm_or_ps(_mm_and_ps(normalize, invLength), _mm_andnot_ps(normalize, _mm_set1_ps(1.0f)));
+
+    x = _mm_mul_ps(tx, invLength);
+    y = _mm_mul_ps(ty, invLength);
+    z = _mm_mul_ps(tz, invLength);
+}
+#endif
+
+//-----------------------------------------------------------------------------
+//* Generate Texture Coordinates
+//! Calculates texture coordinates from normals (used for environment mapping).
+//! Handles four vertices at once when SSE is available.
+//-----------------------------------------------------------------------------
+void RSPVertexManager::_generateTexCoords( unsigned int firstVertexIndex, unsigned int numVertices )
+{
+    //Lighting works in model space, so normals are transformed here
+    bool transformToViewSpace = m_lightMgr->getLightEnabled();
+    float* modelView = m_matrixMgr->getModelViewMatrix();
+    float* projection = m_matrixMgr->getProjectionMatrix();
+    unsigned int i = firstVertexIndex;
+    unsigned int end = firstVertexIndex + numVertices;
+
+#ifdef __SSE__
+    for (; i + 4 <= end; i += 4)
+    {
+        SPVertex* v = &m_vertices[i];
+        __m128 x = _mm_setr_ps(v[0].nx, v[1].nx, v[2].nx, v[3].nx);
+        __m128 y = _mm_setr_ps(v[0].ny, v[1].ny, v[2].ny, v[3].ny);
+        __m128 z = _mm_setr_ps(v[0].nz, v[1].nz, v[2].nz, v[3].nz);
+
+        if ( transformToViewSpace )
+        {
+            transformNormals4(modelView, x, y, z);
+        }
+        transformNormals4(projection, x, y, z);
+
+        __m128 s, t;
+        if ( m_texCoordGenType == TCGT_LINEAR )
+        {
+            s = _mm_mul_ps(fastAcos4(x), _mm_set1_ps(325.94931f));
+            t = _mm_mul_ps(fastAcos4(y), _mm_set1_ps(325.94931f));
+        }
+        else // TGT_GEN
+        {
+            s = _mm_mul_ps(_mm_add_ps(x, _mm_set1_ps(1.0f)), _mm_set1_ps(512.0f));
+            t = _mm_mul_ps(_mm_add_ps(y, _mm_set1_ps(1.0f)), _mm_set1_ps(512.0f));
+        }
+
+        float out[5][4];
+        _mm_storeu_ps(out[0], x);
+        _mm_storeu_ps(out[1], y);
+        _mm_storeu_ps(out[2], z);
+        _mm_storeu_ps(out[3], s);
+        _mm_storeu_ps(out[4], t);
+
+        for (int j=0; j<4; ++j)
+        {
+            v[j].nx = out[0][j];
+            v[j].ny = out[1][j];
+            v[j].nz = out[2][j];
+            v[j].s  = out[3][j];
+            v[j].t  = out[4][j];
+        }
+    }
+#endif
+
+    //Remaining vertices
+    for (; i < end; ++i)
     {
-        transformVector( m_matrixMgr->getProjectionMatrix(), &m_vertices[v].nx, &m_vertices[v].nx );
+        SPVertex* v = &m_vertices[i];
+
+        if ( transformToViewSpace )
+        {
+            transformVector( modelView, &v->nx, &v->nx );
+            Vec3Normalize( &v->nx );
+        }
 
-        Vec3Normalize( &m_vertices[v].nx );
+        transformVector( projection, &v->nx, &v->nx );
+        Vec3Normalize( &v->nx );
 
         if ( m_texCoordGenType == TCGT_LINEAR )
         {   
-            m_vertices[v].s = acosf(m_vertices[v].nx) * 325.94931f;
-            m_vertices[v].t = acosf(m_vertices[v].ny) * 325.94931f;
+            v->s = fastAcos(v->nx) * 325.94931f;
+            v->t = fastAcos(v->ny) * 325.94931f;
         }
         else // TGT_GEN
         {
-            m_vertices[v].s = (m_vertices[v].nx + 1.0f) * 512.0f;
-            m_vertices[v].t = (m_vertices[v].ny + 1.0f) * 512.0f;
+            v->s = (v->nx + 1.0f) * 512.0f;
+            v->t = (v->ny + 1.0f) * 512.0f;
         }
     }
+}
+
+//-----------------------------------------------------------------------------
+//* Process Vertices
+//! Transforms, lights and clips a range of vertices loaded from RDRAM.
+//! Large loads are split between worker threads, vertices are independent
+//! of each other except for billboards which are relative to vertex 0.
+//-----------------------------------------------------------------------------
+void RSPVertexManager::_processVertices( unsigned int firstVertexIndex, unsigned int numVertices )
+{
+    m_zBufferEnabled = OpenGLManager::getSingleton().getZBufferEnabled();
+
+    //Matrices and lighting state are updated lazily, do it here so workers only read them
+    m_viewProjection = m_matrixMgr->getViewProjectionMatrix();
+    if ( m_lightMgr->getLightEnabled() &&
+         ( m_matrixMgr->getGeneration() != m_lightSpaceMatrixGeneration ||
+           m_lightMgr->getGeneration() != m_lightSpaceLightGeneration ) )
+    {
+        _updateLightSpace();
+    }
 
-    //Clipping
-    if (m_vertices[v].x < -m_vertices[v].w)  
-        m_vertices[v].xClip = -1.0f;
-    else if (m_vertices[v].x > m_vertices[v].w)
-        m_vertices[v].xClip = 1.0f;
-    else
-        m_vertices[v].xClip = 0.0f;
-
-    if (m_vertices[v].y < -m_vertices[v].w)
-        m_vertices[v].yClip = -1.0f;
-    else if (m_vertices[v].y > m_vertices[v].w)
-        m_vertices[v].yClip = 1.0f;
-    else
-        m_vertices[v].yClip = 0.0f;
-
-    if (m_vertices[v].w <= 0.0f)
-        m_vertices[v].zClip = -1.0f;
-    else if (m_vertices[v].z < -m_vertices[v].w)
-        m_vertices[v].zClip = -0.1f;
-    else if (m_vertices[v].z > m_vertices[v].w)
-        m_vertices[v].zClip = 1.0f;
-    else
-        m_vertices[v].zClip = 0.0f;
+    if ( numVertices < PARALLEL_VERTEX_THRESHOLD || m_billboard )
+    {
+        _processVertexRange(firstVertexIndex, numVertices);
+        return;
+    }
 
+    ThreadPool::getSingleton().parallelFor(firstVertexIndex, firstVertexIndex + numVertices,
+                                           PARALLEL_VERTEX_GRAIN, _processVertexRange, this);
+}
+
+//-----------------------------------------------------------------------------
+//* Process Vertex Range
+//! Called by thread pool for a part of the vertices being processed
+//-----------------------------------------------------------------------------
+void RSPVertexManager::_processVertexRange(void* vertexMgr, unsigned int begin, unsigned int end)
+{
+    ((RSPVertexManager*)vertexMgr)->_processVertexRange(begin, end - begin);
+}
+
+//-----------------------------------------------------------------------------
+//* Process Vertex Range
+//! Transforms, lights and clips vertices
+//-----------------------------------------------------------------------------
+void RSPVertexManager::_processVertexRange( unsigned int firstVertexIndex, unsigned int numVertices )
+{
+    unsigned int end = firstVertexIndex + numVertices;
+    bool zBufferEnabled = m_zBufferEnabled;
+    float* viewProjection = m_viewProjection;
+
+    for (unsigned int v=firstVertexIndex; v<end; ++v)
+    {
+        transformVertex( viewProjection, &m_vertices[v].x, &m_vertices[v].x);
+
+        if ( m_billboard )
+        {
+            m_vertices[v].x += m_vertices[0].x;
+            m_vertices[v].y += m_vertices[0].y;
+            m_vertices[v].z += m_vertices[0].z;
+            m_vertices[v].w += m_vertices[0].w;
+        }
+
+        if ( !zBufferEnabled )
+        {
+            m_vertices[v].z = -m_vertices[v].w;
+        }
+    }
+
+    if ( m_lightMgr->getLightEnabled() )
+    {
+        _lightVertices(firstVertexIndex, numVertices);
+    }
+
+    if ( m_texCoordGenType != TCGT_NONE )
+    {
+        _generateTexCoords(firstVertexIndex, numVertices);
+    }
+
+    for (unsigned int v=firstVertexIndex; v<end; ++v)
+    {
+        //Clipping
+        if (m_vertices[v].x < -m_vertices[v].w)  
+            m_vertices[v].xClip = -1.0f;
+        else if (m_vertices[v].x > m_vertices[v].w)
+            m_vertices[v].xClip = 1.0f;
+        else
+            m_vertices[v].xClip = 0.0f;
+
+        if (m_vertices[v].y < -m_vertices[v].w)
+            m_vertices[v].yClip = -1.0f;
+        else if (m_vertices[v].y > m_vertices[v].w)
+            m_vertices[v].yClip = 1.0f;
+        else
+            m_vertices[v].yClip = 0.0f;
+
+        if (m_vertices[v].w <= 0.0f)
+            m_vertices[v].zClip = -1.0f;
+        else if (m_vertices[v].z < -m_vertices[v].w)
+            m_vertices[v].zClip = -0.1f;
+        else if (m_vertices[v].z > m_vertices[v].w)
+            m_vertices[v].zClip = 1.0f;
+        else
+            m_vertices[v].zClip = 0.0f;
+    }
 }
 
 
@@ -550,6 +832,11 @@ void RSPVertexManager::addConkerVertices(unsigned int segmentAddress, unsigned i
     //Get vertex from rdram
     Vertex *vertex = (Vertex*) m_memory->getRDRAM(address);
 
+    //Avoid overflow. There can only be MAX_VERTICES in size.
+    if ( numVertices+firstVertexIndex >= MAX_VERTICES)
+    {
+        return;
+    }
 
     //For each vertex
     for (unsigned int i=firstVertexIndex; i <numVertices+firstVertexIndex; ++i)
@@ -576,7 +863,8 @@ void RSPVertexManager::addConkerVertices(unsigned int segmentAddress, unsigned i
             m_vertices[i].a = vertex->color.a * 0.0039215689f;
         }
 
-        _processVertex(i);
         vertex++;
     }
+
+    _processVertices(firstVertexIndex, numVertices);
 }
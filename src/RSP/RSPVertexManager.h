@@ -27,6 +27,7 @@ class Memory;
 class RSPMatrixManager;
 class RSPLightManager;
 class OpenGLManager;
+class RSPVertexCache;
 
 enum TexCoordGenType
 {
@@ -95,10 +96,16 @@ public:
 public:
 
     SPVertex* getVertex(unsigned int index) { return &m_vertices[index]; }
+    RSPVertexCache* getVertexCache() { return m_vertexCache; }
 
 private:
 
-    void _processVertex( unsigned int v );
+    void _processVertices( unsigned int firstVertexIndex, unsigned int numVertices );
+    void _processVertexRange( unsigned int firstVertexIndex, unsigned int numVertices );
+    static void _processVertexRange(void* vertexMgr, unsigned int begin, unsigned int end);
+    void _updateLightSpace();
+    void _lightVertices( unsigned int firstVertexIndex, unsigned int numVertices );
+    void _generateTexCoords( unsigned int firstVertexIndex, unsigned int numVertices );
 
 private:
 
@@ -111,6 +118,12 @@ private:
     static const unsigned int MAX_VERTICES = 300;
     SPVertex m_vertices[MAX_VERTICES];
 
+    //Parallel processing (grain is a multiple of four so SSE groups are not split)
+    static const unsigned int PARALLEL_VERTEX_THRESHOLD = 32;  //!< Smaller loads are processed by calling thread
+    static const unsigned int PARALLEL_VERTEX_GRAIN = 8;       //!< Vertices processed by each task
+    bool m_zBufferEnabled;                                     //!< Depth test state vertices are processed with
+    float* m_viewProjection;                                   //!< Combined matrix vertices are processed with
+
     unsigned int m_colorBaseRDRAMAddress;  //!< Address in RDRAM where colors for vertices are located (used by Perfect Dark)
 
     unsigned int m_rdramOffset;
@@ -119,6 +132,14 @@ private:
     TexCoordGenType m_texCoordGenType;  //!< Texture Coordinate Generation Technique
 
     unsigned int m_conkerRDRAMAddress;
+
+    //Light-space lighting
+    float m_lightSpaceDirections[8][3];  //!< Light directions transformed into model space (M^T * L)
+    float m_normalMetric[6];             //!< Upper triangle of M^T * M, gives length of transformed normals
+    unsigned int m_lightSpaceMatrixGeneration;  //!< Matrix generation light directions was transformed with
+    unsigned int m_lightSpaceLightGeneration;   //!< Light generation light directions was transformed with
+
+    RSPVertexCache* m_vertexCache;       //!< Previously transformed vertices
 };
 
 #endif
@@ -0,0 +1,686 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+//*****************************************************************************
+//* Arachnoid Bench
+//! Microbenchmarks for the hot kernels of the plugin: texture hashing,
+//! texel decoding, texture loading, vertex processing, matrix multiplies,
+//! combiner selection and TMEM copies. The plugin is started with the null
+//! render device so no OpenGL context is needed. Results are written to
+//! stdout as JSON so runs can be compared across commits.
+//*****************************************************************************
+
+#define M64P_PLUGIN_PROTOTYPES 1
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include "AdvancedCombinerManager.h"
+#include "CRCCalculator2.h"
+#include "ConfigMap.h"
+#include "GBIDefs.h"
+#include "GraphicsPlugin.h"
+#include "ImageFormatSelector.h"
+#include "Logger.h"
+#include "Matrix4.h"
+#include "Memory.h"
+#include "RDP.h"
+#include "RSP.h"
+#include "RSPLightManager.h"
+#include "RSPVertexManager.h"
+#include "TextureCache.h"
+#include "assembler.h"
+#include "m64p.h"
+
+//Plugin state defined in main.cpp
+extern GraphicsPlugin g_graphicsPlugin;
+
+//Plugin API functions defined in main.cpp
+extern "C"
+{
+    EXPORT BOOL CALL InitiateGFX(GFX_INFO Gfx_Info);
+    EXPORT int  CALL RomOpen();
+    EXPORT void CALL RomClosed();
+}
+
+#define BENCH_RDRAM_SIZE   0x800000
+#define BENCH_TEXTURE_ADDR 0x100000     //!< RDRAM address of texture images
+#define BENCH_PALETTE_ADDR 0x180000     //!< RDRAM address of palettes
+#define BENCH_VERTEX_ADDR  0x200000     //!< RDRAM address of vertices
+#define BENCH_LIGHT_ADDR   0x210000     //!< RDRAM address of lights
+#define BENCH_NUM_VERTICES 32           //!< Vertices loaded per setVertices call (max for F3DEX)
+#define BENCH_LOAD_TILE    7            //!< Tile used for loading TMEM
+#define BENCH_RENDER_TILE  0            //!< Tile used for rendering
+
+//-----------------------------------------------------------------------------
+// Emulator state
+//-----------------------------------------------------------------------------
+
+static unsigned char g_rdram[BENCH_RDRAM_SIZE];
+static unsigned char g_dmem[0x1000];
+static unsigned char g_romHeader[64];
+static unsigned int  g_registers[10];
+static unsigned int  g_viRegisters[14];
+static unsigned int  g_rdramSize = BENCH_RDRAM_SIZE;
+
+static void benchCheckInterrupts() {}
+
+//-----------------------------------------------------------------------------
+// Video Extension (nothing to do, null render device)
+//-----------------------------------------------------------------------------
+
+static m64p_error benchVideoInit()                                                                               { return M64ERR_SUCCESS; }
+static m64p_error benchVideoQuit()                                                                               { return M64ERR_SUCCESS; }
+static m64p_error benchListFullscreenModes(m64p_2d_size* sizes, int* numSizes)                                   { *numSizes = 0; return M64ERR_SUCCESS; }
+static m64p_error benchSetVideoMode(int width, int height, int bpp, m64p_video_mode mode, m64p_video_flags flags) { return M64ERR_SUCCESS; }
+static m64p_error benchSetCaption(const char* title)                                                             { return M64ERR_SUCCESS; }
+static m64p_error benchToggleFullScreen()                                                                        { return M64ERR_SUCCESS; }
+static m64p_error benchResizeWindow(int width, int height)                                                       { return M64ERR_SUCCESS; }
+static m64p_error benchSetAttribute(m64p_GLattr attribute, int value)                                            { return M64ERR_SUCCESS; }
+static m64p_function benchGetProcAddress(const char* name)                                                       { return 0; }
+static m64p_error benchSwapBuffers()                                                                             { return M64ERR_SUCCESS; }
+
+static void benchDebugCallback(void* context, int level, const char* message)
+{
+    if ( level <= M64MSG_WARNING )
+    {
+        fprintf(stderr, "arachnoid: %s\n", message);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Timing and output
+//-----------------------------------------------------------------------------
+
+typedef void (*BenchFunc)(unsigned int iterations);
+
+static double       g_minTime     = 0.25;   //!< Seconds each benchmark should run
+static const char*  g_filter      = 0;      //!< Only run benchmarks containing this string
+static int          g_workerThreads = 0;    //!< Threads sharing large vertex loads, 0 = one per processor
+static unsigned int g_numResults  = 0;
+static volatile unsigned int g_sink = 0;    //!< Keeps results alive so loops are not removed
+
+static double getTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+//-----------------------------------------------------------------------------
+//* Run Benchmark
+//! Doubles the number of iterations until the run takes at least g_minTime,
+//! then prints one JSON object.
+//! @param name Name of benchmark, stable across commits
+//! @param func Function running the kernel a number of times
+//! @param bytesPerOp Bytes processed per iteration, 0 if throughput makes no sense
+//-----------------------------------------------------------------------------
+static void runBenchmark(const char* name, BenchFunc func, unsigned int bytesPerOp)
+{
+    if ( g_filter && !strstr(name, g_filter) )
+    {
+        return;
+    }
+
+    //Warm up caches
+    func(1);
+
+    unsigned int iterations = 1;
+    double elapsed = 0.0;
+    for (;;)
+    {
+        double start = getTime();
+        func(iterations);
+        elapsed = getTime() - start;
+        if ( elapsed >= g_minTime || iterations >= 0x40000000 )
+        {
+            break;
+        }
+        iterations <<= 1;
+    }
+
+    double nsPerOp = elapsed * 1e9 / iterations;
+    printf("%s    {\"name\": \"%s\", \"iterations\": %u, \"ns_per_op\": %.2f",
+           g_numResults > 0 ? ",\n" : "", name, iterations, nsPerOp);
+    if ( bytesPerOp > 0 )
+    {
+        printf(", \"bytes_per_op\": %u, \"mb_per_s\": %.2f", bytesPerOp, bytesPerOp * 1e3 / nsPerOp);
+    }
+    printf("}");
+    fflush(stdout);
+    g_numResults++;
+}
+
+//-----------------------------------------------------------------------------
+// CRC
+//-----------------------------------------------------------------------------
+
+static CRCCalculator2 g_crcCalculator;
+
+static void benchCRCTMEM(unsigned int iterations)
+{
+    unsigned int crc = 0;
+    for (unsigned int i=0; i<iterations; ++i)
+    {
+        crc = g_crcCalculator.calcCRC(crc, Memory::getTextureMemory(), 4096);
+    }
+    g_sink = crc;
+}
+
+static void benchCRCLine(unsigned int iterations)
+{
+    //Texture cache hashes one line of 64 bytes at a time
+    unsigned int crc = 0;
+    for (unsigned int i=0; i<iterations; ++i)
+    {
+        for (unsigned int y=0; y<64; ++y)
+        {
+            crc = g_crcCalculator.calcCRC(crc, Memory::getTextureMemory(y << 3), 64);
+        }
+    }
+    g_sink = crc;
+}
+
+static void benchCRCPalette(unsigned int iterations)
+{
+    unsigned int crc = 0;
+    for (unsigned int i=0; i<iterations; ++i)
+    {
+        crc = g_crcCalculator.calcPaletteCRC(crc, Memory::getTextureMemory(256), 256);
+    }
+    g_sink = crc;
+}
+
+//-----------------------------------------------------------------------------
+// Texel decoding
+//-----------------------------------------------------------------------------
+
+static GetTexelFunc  g_getTexel  = 0;
+static unsigned int  g_lineWords = 0;
+
+//! Decodes a 32x32 block from TMEM the same way TextureCache::_loadTexture does
+static void benchDecode(unsigned int iterations)
+{
+    unsigned int sum = 0;
+    for (unsigned int n=0; n<iterations; ++n)
+    {
+        for (unsigned short y=0; y<32; ++y)
+        {
+            unsigned long long* src = Memory::getTextureMemory((g_lineWords * y) & 511);
+            unsigned short i = (y & 1) << 1;
+            for (unsigned short x=0; x<32; ++x)
+            {
+                sum += g_getTexel(src, x, i, 0);
+            }
+        }
+    }
+    g_sink = sum;
+}
+
+static void runDecodeBenchmarks()
+{
+    static const char* sizeNames[4]   = { "4b", "8b", "16b", "32b" };
+    static const char* formatNames[5] = { "rgba", "yuv", "ci", "ia", "i" };
+    GetTexelFunc getNone = ImageFormatSelector::imageFormats[1][1].Get16;
+
+    for (int size=0; size<4; ++size)
+    {
+        for (int format=0; format<5; ++format)
+        {
+            const ImageFormat& imageFormat = ImageFormatSelector::imageFormats[size][format];
+            for (int bits=16; bits<=32; bits+=16)
+            {
+                g_getTexel = (bits == 16) ? imageFormat.Get16 : imageFormat.Get32;
+                if ( g_getTexel == getNone )
+                {
+                    continue;
+                }
+
+                //Formats sharing a decoder are only measured once
+                bool duplicate = false;
+                for (int f=0; f<format; ++f)
+                {
+                    const ImageFormat& other = ImageFormatSelector::imageFormats[size][f];
+                    duplicate |= (bits == 16 ? other.Get16 : other.Get32) == g_getTexel;
+                }
+                if ( duplicate )
+                {
+                    continue;
+                }
+
+                char name[64];
+                sprintf(name, "decode_%s%s_to_%s", formatNames[format], sizeNames[size], bits == 16 ? "16" : "32");
+                g_lineWords = (32 << size >> 1) >> 3;
+                runBenchmark(name, benchDecode, 32 * 32 * (bits >> 3));
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Texture loading
+//-----------------------------------------------------------------------------
+
+//*****************************************************************************
+//* Bench Texture
+//! Tile descriptor loaded into TMEM for the texture cache benchmarks
+//*****************************************************************************
+struct BenchTexture
+{
+    const char* name;
+    int format, size;
+    int widthShift, heightShift;
+};
+
+static const BenchTexture g_textures[] = {
+    { "rgba16_32x32", G_IM_FMT_RGBA, G_IM_SIZ_16b, 5, 5 },
+    { "rgba32_32x32", G_IM_FMT_RGBA, G_IM_SIZ_32b, 5, 5 },
+    { "ci4_64x64",    G_IM_FMT_CI,   G_IM_SIZ_4b,  6, 6 },
+    { "ci8_32x32",    G_IM_FMT_CI,   G_IM_SIZ_8b,  5, 5 },
+    { "ia8_64x32",    G_IM_FMT_IA,   G_IM_SIZ_8b,  6, 5 },
+    { "ia16_32x32",   G_IM_FMT_IA,   G_IM_SIZ_16b, 5, 5 },
+    { "i4_64x64",     G_IM_FMT_I,    G_IM_SIZ_4b,  6, 6 },
+};
+
+//-----------------------------------------------------------------------------
+//* Setup Texture
+//! Loads a texture and its palette into TMEM the way a display list does,
+//! with SetTImg, SetTile, LoadBlock/LoadTLUT and SetTileSize.
+//-----------------------------------------------------------------------------
+static void setupTexture(RDP* rdp, const BenchTexture& texture)
+{
+    unsigned int width  = 1 << texture.widthShift;
+    unsigned int height = 1 << texture.heightShift;
+    unsigned int lineBytes = width << texture.size >> 1;
+    unsigned int lineWords = lineBytes >> 3;
+    unsigned int dxt = (2048 + lineWords - 1) / lineWords;
+
+    //Palette for color indexed textures
+    if ( texture.format == G_IM_FMT_CI )
+    {
+        rdp->setTextureLUT(G_TT_RGBA16);
+        rdp->RDP_SetTImg(G_IM_FMT_RGBA, G_IM_SIZ_16b, 0, BENCH_PALETTE_ADDR);
+        rdp->RDP_SetTile(0, 0, 0, 256, BENCH_LOAD_TILE, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+        rdp->RDP_LoadTLUT(BENCH_LOAD_TILE, 0, 0, 255 << 2, 0);
+    }
+    else
+    {
+        rdp->setTextureLUT(0);
+    }
+
+    //Texels
+    rdp->RDP_SetTImg(texture.format, texture.size, width - 1, BENCH_TEXTURE_ADDR);
+    rdp->RDP_SetTile(texture.format, texture.size, 0, 0, BENCH_LOAD_TILE, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    rdp->RDP_LoadBlock(BENCH_LOAD_TILE, 0, 0, width * height - 1, dxt);
+
+    //Render tile
+    unsigned int line = (texture.size == G_IM_SIZ_32b) ? lineWords >> 1 : lineWords;
+    rdp->RDP_SetTile(texture.format, texture.size, line, 0, BENCH_RENDER_TILE, 0, 0, 0, 0, 0,
+                     texture.widthShift, texture.heightShift, 0, 0);
+    rdp->RDP_SetTileSize(BENCH_RENDER_TILE, 0, 0, (width - 1) << 2, (height - 1) << 2);
+}
+
+static void benchTextureMiss(unsigned int iterations)
+{
+    TextureCache* textureCache = g_graphicsPlugin.getTextureCache();
+    unsigned int* tmem = (unsigned int*)Memory::getTextureMemory();
+    for (unsigned int i=0; i<iterations; ++i)
+    {
+        //Change one texel so the hash differs and the texture is decoded again
+        tmem[0]++;
+        textureCache->update(0);
+    }
+    g_sink = textureCache->getNumMisses();
+}
+
+static void benchTextureHit(unsigned int iterations)
+{
+    TextureCache* textureCache = g_graphicsPlugin.getTextureCache();
+    for (unsigned int i=0; i<iterations; ++i)
+    {
+        textureCache->update(0);
+    }
+    g_sink = textureCache->getNumHits();
+}
+
+static void runTextureBenchmarks()
+{
+    RDP* rdp = g_graphicsPlugin.getRDP();
+    g_graphicsPlugin.getRSP()->RSP_Texture(1.0f, 1.0f, 0, BENCH_RENDER_TILE, 1);
+
+    for (unsigned int t=0; t<sizeof(g_textures)/sizeof(g_textures[0]); ++t)
+    {
+        const BenchTexture& texture = g_textures[t];
+        unsigned int texels = 1 << (texture.widthShift + texture.heightShift);
+        char name[64];
+
+        setupTexture(rdp, texture);
+        sprintf(name, "texture_load_%s", texture.name);
+        runBenchmark(name, benchTextureMiss, texels << texture.size >> 1);
+        sprintf(name, "texture_hit_%s", texture.name);
+        runBenchmark(name, benchTextureHit, 0);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Vertices
+//-----------------------------------------------------------------------------
+
+static bool         g_modifyVertices = true;   //!< Defeat the vertex cache
+static unsigned int g_numVertices    = 0;      //!< Vertices per setVertices call
+
+static void benchVertices(unsigned int iterations)
+{
+    RSPVertexManager* vertexMgr = g_graphicsPlugin.getRSP()->getVertexMgr();
+    unsigned char* flag = &g_rdram[BENCH_VERTEX_ADDR + 4];
+    for (unsigned int i=0; i<iterations; ++i)
+    {
+        if ( g_modifyVertices )
+        {
+            (*flag)++;
+        }
+        vertexMgr->setVertices(BENCH_VERTEX_ADDR, g_numVertices, 0);
+    }
+    g_sink = *flag;
+}
+
+static void runVertexBenchmarks()
+{
+    RSP* rsp = g_graphicsPlugin.getRSP();
+    RSPLightManager* lightMgr = rsp->getLightMgr();
+    RSPVertexManager* vertexMgr = rsp->getVertexMgr();
+
+    //Vertices on a sphere so normals are unit length
+    short* vertex = (short*)&g_rdram[BENCH_VERTEX_ADDR];
+    for (int i=0; i<BENCH_NUM_VERTICES; ++i, vertex += 8)
+    {
+        signed char* normal = (signed char*)&vertex[6];
+        normal[3] = (signed char)(rand() % 127);      //x
+        normal[2] = (signed char)(rand() % 63);       //y
+        normal[1] = (signed char)(rand() % 31 + 64);  //z
+        normal[0] = (signed char)255;                 //a
+        vertex[1] = normal[3] * 8;                    //x
+        vertex[0] = normal[2] * 8;                    //y
+        vertex[3] = normal[1] * 8;                    //z
+        vertex[5] = (short)(rand() & 0x7FF);          //s
+        vertex[4] = (short)(rand() & 0x7FF);          //t
+    }
+
+    //Two directional lights and an ambient light
+    RDRAMLight* lights = (RDRAMLight*)&g_rdram[BENCH_LIGHT_ADDR];
+    for (int i=0; i<3; ++i)
+    {
+        lights[i].r = lights[i].r2 = 200;
+        lights[i].g = lights[i].g2 = 180;
+        lights[i].b = lights[i].b2 = 160;
+        lights[i].x = (char)(i == 0 ? 127 : 0);
+        lights[i].y = (char)(i == 1 ? 127 : 0);
+        lights[i].z = 0;
+    }
+    lightMgr->setNumLights(2);
+    for (int i=0; i<3; ++i)
+    {
+        lightMgr->setLight(i, BENCH_LIGHT_ADDR + i * sizeof(RDRAMLight));
+    }
+
+    g_numVertices = BENCH_NUM_VERTICES;
+    g_modifyVertices = true;
+    lightMgr->setLightEnabled(false);
+    vertexMgr->setTexCoordGenType(TCGT_NONE);
+    runBenchmark("vertex_transform_32", benchVertices, 0);
+
+    lightMgr->setLightEnabled(true);
+    runBenchmark("vertex_lighting_32", benchVertices, 0);
+
+    vertexMgr->setTexCoordGenType(TCGT_LINEAR);
+    runBenchmark("vertex_lighting_texgen_linear_32", benchVertices, 0);
+
+    vertexMgr->setTexCoordGenType(TCGT_GEN);
+    runBenchmark("vertex_lighting_texgen_32", benchVertices, 0);
+
+    g_modifyVertices = false;
+    runBenchmark("vertex_cache_hit_32", benchVertices, 0);
+
+    lightMgr->setLightEnabled(false);
+    vertexMgr->setTexCoordGenType(TCGT_NONE);
+}
+
+//-----------------------------------------------------------------------------
+// Matrix
+//-----------------------------------------------------------------------------
+
+static void benchMatrixMultiply(unsigned int iterations)
+{
+    //Rotation about an arbitrary axis keeps the product bounded
+    Matrix4 rotation( 0.936f, 0.289f, -0.201f, 0.0f,
+                     -0.275f, 0.956f,  0.098f, 0.0f,
+                      0.220f,-0.036f,  0.975f, 0.0f,
+                      0.0f,   0.0f,    0.0f,   1.0f );
+    Matrix4 result;
+    for (unsigned int i=0; i<iterations; ++i)
+    {
+        result = result * rotation;
+    }
+    g_sink = (unsigned int)(result[0][0] * 1000.0f);
+}
+
+//-----------------------------------------------------------------------------
+// Combiner
+//-----------------------------------------------------------------------------
+
+//! Muxes seen in commercial games, first cycle only and two cycle
+static const unsigned int g_muxes[][3] = {
+    { 0x00FFFFFF, 0xFFFE793C, G_CYC_1CYCLE },   //Shade
+    { 0x00121824, 0xFF33FFFF, G_CYC_1CYCLE },   //Texture * shade
+    { 0x00127E24, 0xFFFFF9FC, G_CYC_1CYCLE },   //Texture * shade, alpha texture
+    { 0x00FFFE04, 0xFF5BFFF8, G_CYC_1CYCLE },   //Primitive
+    { 0x0011FE04, 0xFFFFF7F8, G_CYC_1CYCLE },   //Texture * primitive
+    { 0x00262A60, 0x150C937F, G_CYC_2CYCLE },   //Two textures blended by LOD
+    { 0x00127E60, 0xFFFFF3F8, G_CYC_2CYCLE },   //Texture * shade, then combined
+    { 0x0030B3FF, 0xFF5BFFF8, G_CYC_2CYCLE },   //Environment blend
+    { 0x00267E04, 0x1F0CFDFF, G_CYC_2CYCLE },   //Decal with shade alpha
+    { 0x00FFFFFF, 0xFFFCF279, G_CYC_2CYCLE },   //Fog
+    { 0x00272C04, 0x1F1093FF, G_CYC_2CYCLE },   //Multitexture with env
+    { 0x00121603, 0xFF5BFFF8, G_CYC_1CYCLE },   //Texture * environment
+};
+
+static void benchCombinerUpdate(unsigned int iterations)
+{
+    AdvancedCombinerManager* combinerMgr = g_graphicsPlugin.getRDP()->getCombinerMgr();
+    unsigned int numMuxes = sizeof(g_muxes) / sizeof(g_muxes[0]);
+    for (unsigned int i=0; i<iterations; ++i)
+    {
+        const unsigned int* mux = g_muxes[i % numMuxes];
+        combinerMgr->setMux(mux[0], mux[1], mux[2]);
+        combinerMgr->update(mux[2]);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// TMEM copies
+//-----------------------------------------------------------------------------
+
+static void benchUnswapCopy(unsigned int iterations)
+{
+    for (unsigned int i=0; i<iterations; ++i)
+    {
+        UnswapCopy(&g_rdram[BENCH_TEXTURE_ADDR + (i & 4)], Memory::getTextureMemory(), 4096);
+    }
+}
+
+static void benchDWordInterleave(unsigned int iterations)
+{
+    for (unsigned int i=0; i<iterations; ++i)
+    {
+        DWordInterleave(Memory::getTextureMemory(), 512);
+    }
+}
+
+static void benchQWordInterleave(unsigned int iterations)
+{
+    for (unsigned int i=0; i<iterations; ++i)
+    {
+        QWordInterleave(Memory::getTextureMemory(), 512);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//* Initialize Plugin
+//! Starts the plugin with the null render device and an empty RDRAM
+//-----------------------------------------------------------------------------
+static bool initializePlugin(ConfigMap* config)
+{
+    memset(config, 0, sizeof(ConfigMap));
+    config->fullscreenWidth    = config->windowWidth  = 640;
+    config->fullscreenHeight   = config->windowHeight = 480;
+    config->fullscreenBitDepth = 32;
+    config->textureCacheSize   = 4 * 1024 * 1024;
+    config->vertexBufferSize   = 8192;
+    config->fog                = true;
+    config->nullRenderDevice   = true;
+    config->workerThreads      = g_workerThreads;
+
+    CoreVideo_Init                = benchVideoInit;
+    CoreVideo_Quit                = benchVideoQuit;
+    CoreVideo_ListFullscreenModes = benchListFullscreenModes;
+    CoreVideo_SetVideoMode        = benchSetVideoMode;
+    CoreVideo_SetCaption          = benchSetCaption;
+    CoreVideo_ToggleFullScreen    = benchToggleFullScreen;
+    CoreVideo_ResizeWindow        = benchResizeWindow;
+    CoreVideo_GL_GetProcAddress   = benchGetProcAddress;
+    CoreVideo_GL_SetAttribute     = benchSetAttribute;
+    CoreVideo_GL_SwapBuffers      = benchSwapBuffers;
+
+    Logger::getSingleton().initialize(benchDebugCallback, 0);
+    g_graphicsPlugin.setConfig(config);
+
+    //320x240 video mode
+    g_viRegisters[2]  = 320;          //VI_WIDTH
+    g_viRegisters[9]  = 0x006C02EC;   //VI_H_START
+    g_viRegisters[10] = 0x002501FF;   //VI_V_START
+    g_viRegisters[12] = 0x00000200;   //VI_X_SCALE
+    g_viRegisters[13] = 0x00000400;   //VI_Y_SCALE
+
+    GFX_INFO graphicsInfo;
+    memset(&graphicsInfo, 0, sizeof(graphicsInfo));
+    graphicsInfo.HEADER                = g_romHeader;
+    graphicsInfo.RDRAM                 = g_rdram;
+    graphicsInfo.DMEM                  = g_dmem;
+    graphicsInfo.MI_INTR_REG           = &g_registers[0];
+    graphicsInfo.DPC_START_REG         = &g_registers[1];
+    graphicsInfo.DPC_END_REG           = &g_registers[2];
+    graphicsInfo.DPC_CURRENT_REG       = &g_registers[3];
+    graphicsInfo.DPC_STATUS_REG        = &g_registers[4];
+    graphicsInfo.DPC_CLOCK_REG         = &g_registers[5];
+    graphicsInfo.DPC_BUFBUSY_REG       = &g_registers[6];
+    graphicsInfo.DPC_PIPEBUSY_REG      = &g_registers[7];
+    graphicsInfo.DPC_TMEM_REG          = &g_registers[8];
+    graphicsInfo.SP_STATUS_REG         = &g_registers[9];
+    graphicsInfo.VI_STATUS_REG         = &g_viRegisters[0];
+    graphicsInfo.VI_ORIGIN_REG         = &g_viRegisters[1];
+    graphicsInfo.VI_WIDTH_REG          = &g_viRegisters[2];
+    graphicsInfo.VI_INTR_REG           = &g_viRegisters[3];
+    graphicsInfo.VI_V_CURRENT_LINE_REG = &g_viRegisters[4];
+    graphicsInfo.VI_TIMING_REG         = &g_viRegisters[5];
+    graphicsInfo.VI_V_SYNC_REG         = &g_viRegisters[6];
+    graphicsInfo.VI_H_SYNC_REG         = &g_viRegisters[7];
+    graphicsInfo.VI_LEAP_REG           = &g_viRegisters[8];
+    graphicsInfo.VI_H_START_REG        = &g_viRegisters[9];
+    graphicsInfo.VI_V_START_REG        = &g_viRegisters[10];
+    graphicsInfo.VI_V_BURST_REG        = &g_viRegisters[11];
+    graphicsInfo.VI_X_SCALE_REG        = &g_viRegisters[12];
+    graphicsInfo.VI_Y_SCALE_REG        = &g_viRegisters[13];
+    graphicsInfo.CheckInterrupts       = benchCheckInterrupts;
+    graphicsInfo.RDRAM_SIZE            = &g_rdramSize;
+
+    InitiateGFX(graphicsInfo);
+    return RomOpen() != 0;
+}
+
+static void printUsage()
+{
+    printf("Usage: arachnoid-bench [options] [filter]\n");
+    printf("  -t seconds       Minimum time for each benchmark (default 0.25)\n");
+    printf("  -w threads       Worker threads, 1 disables them (default 0, one per processor)\n");
+    printf("  filter           Only run benchmarks whose name contains filter\n");
+}
+
+//-----------------------------------------------------------------------------
+//* Main
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    for (int i=1; i<argc; ++i)
+    {
+        if ( strcmp(argv[i], "-t") == 0 && i + 1 < argc )
+        {
+            g_minTime = atof(argv[++i]);
+        }
+        else if ( strcmp(argv[i], "-w") == 0 && i + 1 < argc )
+        {
+            g_workerThreads = atoi(argv[++i]);
+        }
+        else if ( argv[i][0] != '-' && !g_filter )
+        {
+            g_filter = argv[i];
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    //Same data for every run so results can be compared
+    srand(1);
+    for (unsigned int i=0; i<BENCH_RDRAM_SIZE; ++i)
+    {
+        g_rdram[i] = (unsigned char)rand();
+    }
+
+    ConfigMap config;
+    if ( !initializePlugin(&config) )
+    {
+        fprintf(stderr, "arachnoid-bench: could not initialize plugin\n");
+        return 1;
+    }
+    memcpy(Memory::getTextureMemory(), &g_rdram[BENCH_TEXTURE_ADDR], 4096);
+
+    printf("{\n  \"benchmarks\": [\n");
+
+    runBenchmark("crc_tmem_4096", benchCRCTMEM, 4096);
+    runBenchmark("crc_lines_64x64", benchCRCLine, 4096);
+    runBenchmark("crc_palette_256", benchCRCPalette, 256 * 2);
+    runDecodeBenchmarks();
+    runTextureBenchmarks();
+    runVertexBenchmarks();
+    runBenchmark("matrix4_multiply", benchMatrixMultiply, 0);
+    runBenchmark("combiner_update_corpus", benchCombinerUpdate, 0);
+    runBenchmark("unswap_copy_4096", benchUnswapCopy, 4096);
+    runBenchmark("dword_interleave_4096", benchDWordInterleave, 4096);
+    runBenchmark("qword_interleave_4096", benchQWordInterleave, 4096);
+
+    printf("\n  ]\n}\n");
+
+    RomClosed();
+    return 0;
+}
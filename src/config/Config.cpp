@@ -21,8 +21,10 @@
  *****************************************************************************/
 
 #include <cstdio> 
+#include <cstring>
 
 #include "Config.h"
+#include "FrameRingFormat.h"
 #include "GraphicsPlugin.h"
 #include "Logger.h"
 #include "m64p.h"
@@ -61,6 +63,25 @@ bool Config::initialize()
     ConfigSetDefaultBool(m_videoArachnoidSection, "Fog", false, "Render fog?");
     ConfigSetDefaultInt(m_videoArachnoidSection, "MultiSampling", 0, "Use MultiSampling? 0=no 2,4,8,16=quality");
     ConfigSetDefaultInt(m_videoArachnoidSection, "Mipmapping", 0, "Use Mipmapping? 0=no, 1=nearest, 2=bilinear, 3=trilinear");
+    ConfigSetDefaultInt(m_videoArachnoidSection, "VertexBufferSize", 8192, "Number of vertices buffered before a draw call is forced");
+    ConfigSetDefaultBool(m_videoArachnoidSection, "TraceCapture", false, "Capture display lists and the memory they use to a trace file for offline replay?");
+    ConfigSetDefaultString(m_videoArachnoidSection, "TraceFile", "arachnoid.trace", "Name of trace file written when TraceCapture is enabled");
+    ConfigSetDefaultBool(m_videoArachnoidSection, "NullRenderDevice", false, "Skip all OpenGL calls and only count them? (for benchmarking)");
+    ConfigSetDefaultBool(m_videoArachnoidSection, "DisplayListCache", true, "Execute display lists that do not change from a cache of pre-decoded instructions?");
+    ConfigSetDefaultBool(m_videoArachnoidSection, "ThreadedRendering", false, "Call OpenGL from a separate render thread? (experimental, the frontend must allow its context to be moved)");
+    ConfigSetDefaultBool(m_videoArachnoidSection, "RDRAMWriteTracking", false, "Write protect RDRAM pages used by caches to detect changes without hashing? (experimental, falls back to hashing if not permitted)");
+    ConfigSetDefaultInt(m_videoArachnoidSection, "FramesInFlight", 2, "Frames the CPU may queue ahead of the GPU before waiting on a fence (1-3)");
+    ConfigSetDefaultBool(m_videoArachnoidSection, "LowLatency", false, "Wait for the previous frame before the next one is recorded instead of queueing frames ahead?");
+    ConfigSetDefaultInt(m_videoArachnoidSection, "ReadScreenMode", READ_SCREEN_SYNC, "How ReadScreen2 reads frames: 0 - synchronously, 1 - latest completed frame (async, never waits), 2 - exact frame (async, fixed latency of ReadScreenBuffers-1 frames)");
+    ConfigSetDefaultInt(m_videoArachnoidSection, "ReadScreenBuffers", 3, "Pixel buffers used by asynchronous ReadScreenMode (2-3)");
+    ConfigSetDefaultInt(m_videoArachnoidSection, "ReadbackWidth", 0, "Width ReadScreen2 and the frame ring return frames at, downscaled on the GPU (0 = window width)");
+    ConfigSetDefaultInt(m_videoArachnoidSection, "ReadbackHeight", 0, "Height ReadScreen2 and the frame ring return frames at, downscaled on the GPU (0 = window height)");
+    ConfigSetDefaultInt(m_videoArachnoidSection, "ReadbackFilter", READBACK_FILTER_BILINEAR, "Filter used when downscaling read frames: 0 - bilinear, 1 - box (averages every pixel)");
+    ConfigSetDefaultBool(m_videoArachnoidSection, "FrameBufferTextures", false, "Render color images other than the shown frame to textures and sample them directly when they are used as textures (pause screens, reflections, motion blur)?");
+    ConfigSetDefaultBool(m_videoArachnoidSection, "FrameRing", false, "Write every frame into a POSIX shared memory ring for external consumers (encoders, streamers)?");
+    ConfigSetDefaultString(m_videoArachnoidSection, "FrameRingName", FRAME_RING_DEFAULT_NAME, "Name of shared memory object written when FrameRing is enabled");
+    ConfigSetDefaultInt(m_videoArachnoidSection, "FrameRingSlots", 4, "Frames kept in the shared memory ring (2-8)");
+    ConfigSetDefaultInt(m_videoArachnoidSection, "WorkerThreads", 0, "Threads sharing large vertex loads and other parallel work: 0 - one per processor, 1 - no worker threads");
 #ifdef WIN32
     ConfigSetDefaultInt(m_videoArachnoidSection, "ScreenUpdateSetting", SCREEN_UPDATE_CI, "When to update the screen: 1 - on VI, 2 - on first CI");
 #else
@@ -84,4 +105,25 @@ void Config::load()
     m_cfg.multiSampling         = ConfigGetParamBool(m_videoArachnoidSection, "MultiSampling");
     m_cfg.mipmapping             = ConfigGetParamInt(m_videoArachnoidSection, "Mipmapping");
     m_cfg.screenUpdateSetting   = ConfigGetParamInt(m_videoArachnoidSection, "ScreenUpdateSetting");
+    m_cfg.vertexBufferSize      = ConfigGetParamInt(m_videoArachnoidSection, "VertexBufferSize");
+    m_cfg.traceCapture          = ConfigGetParamBool(m_videoArachnoidSection, "TraceCapture");
+    strncpy(m_cfg.traceFilename, ConfigGetParamString(m_videoArachnoidSection, "TraceFile"), sizeof(m_cfg.traceFilename) - 1);
+    m_cfg.traceFilename[sizeof(m_cfg.traceFilename) - 1] = 0;
+    m_cfg.nullRenderDevice      = ConfigGetParamBool(m_videoArachnoidSection, "NullRenderDevice");
+    m_cfg.displayListCache      = ConfigGetParamBool(m_videoArachnoidSection, "DisplayListCache");
+    m_cfg.threadedRendering     = ConfigGetParamBool(m_videoArachnoidSection, "ThreadedRendering");
+    m_cfg.workerThreads         = ConfigGetParamInt(m_videoArachnoidSection, "WorkerThreads");
+    m_cfg.rdramWriteTracking    = ConfigGetParamBool(m_videoArachnoidSection, "RDRAMWriteTracking");
+    m_cfg.framesInFlight        = ConfigGetParamInt(m_videoArachnoidSection, "FramesInFlight");
+    m_cfg.lowLatency            = ConfigGetParamBool(m_videoArachnoidSection, "LowLatency");
+    m_cfg.readScreenMode        = ConfigGetParamInt(m_videoArachnoidSection, "ReadScreenMode");
+    m_cfg.readScreenBuffers     = ConfigGetParamInt(m_videoArachnoidSection, "ReadScreenBuffers");
+    m_cfg.readbackWidth         = ConfigGetParamInt(m_videoArachnoidSection, "ReadbackWidth");
+    m_cfg.readbackHeight        = ConfigGetParamInt(m_videoArachnoidSection, "ReadbackHeight");
+    m_cfg.readbackFilter        = ConfigGetParamInt(m_videoArachnoidSection, "ReadbackFilter");
+    m_cfg.frameBufferTextures   = ConfigGetParamBool(m_videoArachnoidSection, "FrameBufferTextures");
+    m_cfg.frameRing             = ConfigGetParamBool(m_videoArachnoidSection, "FrameRing");
+    strncpy(m_cfg.frameRingName, ConfigGetParamString(m_videoArachnoidSection, "FrameRingName"), sizeof(m_cfg.frameRingName) - 1);
+    m_cfg.frameRingName[sizeof(m_cfg.frameRingName) - 1] = 0;
+    m_cfg.frameRingSlots        = ConfigGetParamInt(m_videoArachnoidSection, "FrameRingSlots");
 }
@@ -76,4 +76,17 @@ enum
     SCREEN_UPDATE_CI = 2
 };
 
+enum
+{
+    READ_SCREEN_SYNC   = 0,
+    READ_SCREEN_LATEST = 1,
+    READ_SCREEN_EXACT  = 2
+};
+
+enum
+{
+    READBACK_FILTER_BILINEAR = 0,
+    READBACK_FILTER_BOX      = 1
+};
+
 #endif
@@ -41,6 +41,25 @@ struct ConfigMap
     int  multiSampling;          //!< Use MultiSampling? 0=no 2,4,8,16=quality      default = 0
     int  mipmapping;              //!< Use Mipmapping? 0=no, 1=nearest, 2=bilinear, 3=trilinear default = 0
     int  screenUpdateSetting;    //!< When to redraw the screen                     default = SCREEN_UPDATE_VI
+    int  vertexBufferSize;       //!< Vertices buffered before a draw call is forced, default = 8192
+    bool traceCapture;           //!< Capture display lists to trace file?          default = false
+    char traceFilename[256];     //!< Name of trace file,                           default = arachnoid.trace
+    bool nullRenderDevice;       //!< Count render calls instead of using OpenGL?   default = false
+    bool displayListCache;       //!< Execute static display lists from cache?     default = true
+    bool threadedRendering;      //!< Call OpenGL from a separate render thread?    default = false
+    int  workerThreads;          //!< Threads sharing parallel work, 0=auto         default = 0
+    bool rdramWriteTracking;     //!< Detect RDRAM writes with page protection?    default = false
+    int  framesInFlight;         //!< Frames queued ahead of the GPU (1-3)         default = 2
+    bool lowLatency;             //!< Wait for previous frame before recording?    default = false
+    int  readScreenMode;         //!< Sync, latest or exact frame ReadScreen2       default = READ_SCREEN_SYNC
+    int  readScreenBuffers;      //!< Pixel buffers for async ReadScreen2 (2-3)    default = 3
+    int  readbackWidth;          //!< Width frames are read at, 0 = window         default = 0
+    int  readbackHeight;         //!< Height frames are read at, 0 = window        default = 0
+    int  readbackFilter;         //!< Bilinear or box filter for read frames       default = READBACK_FILTER_BILINEAR
+    bool frameBufferTextures;    //!< Render other color images to textures?       default = false
+    bool frameRing;              //!< Write frames to shared memory ring?          default = false
+    char frameRingName[256];     //!< Name of shared memory object,                default = /arachnoid-frames
+    int  frameRingSlots;         //!< Frames kept in shared memory ring (2-8)      default = 4
 };
 
 #endif
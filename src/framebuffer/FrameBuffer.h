@@ -22,53 +22,59 @@
 #ifndef FRAME_BUFFER_H_
 #define FRAME_BUFFER_H_
 
+#include "CachedTexture.h"
 
 //*****************************************************************************
 //* FrameBuffer
-//! A Texture that we can render to.
+//! A color image that is rendered to a texture instead of the window.
+//! @details The texture covers the image with the same scale as the window
+//!          covers the VI screen, so viewport and scissor are the same for
+//!          both. Rows are stored bottom up like in the window.
 //*****************************************************************************
 class FrameBuffer
 {
 public:
 
-    //Get Singleton
-    //static FrameBuffer& getSingleton() {
-    //    static FrameBuffer instance;
-    //    return instance;
-    //}
-
     //Constructor
     FrameBuffer();
 
     //Destructor
     ~FrameBuffer();
 
-    void initialize(int width, int height);
+    void initialize(unsigned int target, int width, int height);
     void dispose();
     void resize(int width, int height);
     void beginRendering();
     void endRendering();
-    void render();
-    void render2();
-
-protected:
-
-    void _activate();
-    void _deactivate();
 
-private:
+    //! Does texel at address belong to drawn part of color image?
+    bool contains(unsigned int rdramAddress)
+    {
+        return rdramAddress >= address && rdramAddress < address + bpl * height;
+    }
 
+public:
 
+    unsigned int  address;        //!< RDRAM address of color image
+    unsigned int  format;         //!< Color image format
+    unsigned int  size;           //!< Color image pixel size
+    unsigned int  width;          //!< Width of color image in N64 pixels
+    unsigned int  bpl;            //!< Bytes per line of color image
+    unsigned int  rows;           //!< Rows covered by texture (VI height)
+    unsigned int  height;         //!< Rows drawn to, from scissor
+    unsigned int  crc;            //!< Sampled hash of RDRAM when rendering ended
+    unsigned int  lastUsed;       //!< When buffer was last bound, for replacing
+    CachedTexture texture;        //!< Texture coordinates used when sampled
 
 protected:
 
-    unsigned int m_id;       //!< TextureID, Used mainly for OpenGL (so it can keep track of textures)
-    int m_width;             //!< Width of framebuffer
-    int m_height;            //!< Height of framebuffer 
-
-    int m_oldViewport[4];
-
+    unsigned int m_target;   //!< Render target index in render device, 0 if unused
+    int m_width;             //!< Width of texture in window pixels
+    int m_height;            //!< Height of texture in window pixels
+    float m_scaleX;          //!< Window pixels per N64 pixel when created
+    float m_scaleY;          //!< Window pixels per N64 pixel when created
 
+    friend class FrameBufferCache;
 };
 
 #endif
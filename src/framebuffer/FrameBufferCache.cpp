@@ -0,0 +1,377 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#include "FrameBufferCache.h"
+#include "Memory.h"
+#include "OpenGLManager.h"
+#include "RDP.h"
+#include "RenderDevice.h"
+
+//-----------------------------------------------------------------------------
+//! Constructor
+//-----------------------------------------------------------------------------
+FrameBufferCache::FrameBufferCache()
+{
+    m_memory          = 0;
+    m_current         = 0;
+    m_textureBuffer   = 0;
+    m_textureAddress  = 0;
+    m_scissorLry      = 0;
+    m_useCount        = 0;
+    m_numBuffers      = 0;
+    m_numTextureLoads = 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Destructor
+//-----------------------------------------------------------------------------
+FrameBufferCache::~FrameBufferCache()
+{
+    dispose();
+}
+
+//-----------------------------------------------------------------------------
+//* Initialize
+//! @return false if render device can not render to textures
+//-----------------------------------------------------------------------------
+bool FrameBufferCache::initialize(Memory* memory)
+{
+    m_memory          = memory;
+    m_current         = 0;
+    m_textureBuffer   = 0;
+    m_scissorLry      = 0;
+    m_useCount        = 0;
+    m_numBuffers      = 0;
+    m_numTextureLoads = 0;
+    return RenderDevice::getSingleton().isFramebufferSupported();
+}
+
+//-----------------------------------------------------------------------------
+// Dispose
+//-----------------------------------------------------------------------------
+void FrameBufferCache::dispose()
+{
+    endFrame();
+    for (unsigned int i=0; i<MAX_FRAME_BUFFERS; ++i)
+    {
+        m_frameBuffers[i].dispose();
+    }
+    m_textureBuffer = 0;
+}
+
+//-----------------------------------------------------------------------------
+//* Set Color Image
+//! Selects where following rendering goes. Called when RDP changes color
+//! image, after batched rendering has been flushed.
+//-----------------------------------------------------------------------------
+void FrameBufferCache::setColorImage(const RDPSetImgInfo& colorImage, const RDPSetImgInfo& depthImage)
+{
+    _endRendering();
+
+    //Depth buffer is cleared by drawing to it as color image, the depth
+    //image belongs to the frame rendered to window
+    if ( colorImage.rdramAddress == depthImage.rdramAddress )
+    {
+        RenderDevice::getSingleton().bindRenderTarget(0);
+        return;
+    }
+
+    //Frame is rendered to window
+    OpenGLManager& openGLMgr = OpenGLManager::getSingleton();
+    if ( openGLMgr.getVIWidth() <= 0 || colorImage.width == (unsigned int)openGLMgr.getVIWidth() )
+    {
+        RenderDevice::getSingleton().bindRenderTarget(0);
+        return;
+    }
+
+    FrameBuffer* buffer = _findBuffer(colorImage);
+    if ( !buffer )
+    {
+        buffer = _addBuffer(colorImage);
+    }
+    else if ( buffer->m_scaleX != openGLMgr.getViewScaleX() || buffer->m_scaleY != openGLMgr.getViewScaleY() ||
+              buffer->m_height != openGLMgr.getHeight() )
+    {
+        //VI or window size changed
+        buffer->m_scaleX = openGLMgr.getViewScaleX();
+        buffer->m_scaleY = openGLMgr.getViewScaleY();
+        buffer->rows     = openGLMgr.getVIHeight();
+        buffer->resize((int)(buffer->width * buffer->m_scaleX + 0.5f), openGLMgr.getHeight());
+    }
+
+    buffer->lastUsed = ++m_useCount;
+    buffer->beginRendering();
+    m_current = buffer;
+
+    //Scissor is usually set before the color image
+    setScissor(m_scissorLry);
+}
+
+//-----------------------------------------------------------------------------
+//* Set Scissor
+//! Rows inside the scissor box of a buffer are taken to be drawn
+//! @param lry Bottom of scissor box in N64 pixels
+//-----------------------------------------------------------------------------
+void FrameBufferCache::setScissor(unsigned int lry)
+{
+    m_scissorLry = lry;
+    if ( m_current && lry > m_current->height )
+    {
+        m_current->height = lry < m_current->rows ? lry : m_current->rows;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//* End Frame
+//! Called before frame is swapped, rendering goes to window again
+//-----------------------------------------------------------------------------
+void FrameBufferCache::endFrame()
+{
+    _endRendering();
+}
+
+//-----------------------------------------------------------------------------
+//* Load Texture
+//! Called when texture memory is loaded from RDRAM
+//! @param rdramAddress Address of first texel loaded
+//! @param size Pixel size of texture image
+//! @return true if texel belongs to a buffer, it is sampled by getTexture
+//!         instead of loading RDRAM then
+//-----------------------------------------------------------------------------
+bool FrameBufferCache::loadTexture(unsigned int rdramAddress, unsigned int size)
+{
+    m_textureBuffer = 0;
+
+    for (unsigned int i=0; i<MAX_FRAME_BUFFERS; ++i)
+    {
+        FrameBuffer* buffer = &m_frameBuffers[i];
+        if ( buffer->m_target == 0 || buffer->size != size || !buffer->contains(rdramAddress) )
+        {
+            continue;
+        }
+
+        //Sampling buffer while rendering to it is undefined
+        if ( buffer == m_current )
+        {
+            return false;
+        }
+
+        //CPU wrote to buffer
+        if ( _calculateCRC(buffer) != buffer->crc )
+        {
+            _removeBuffer(buffer);
+            return false;
+        }
+
+        m_textureBuffer  = buffer;
+        m_textureAddress = rdramAddress;
+        m_numTextureLoads++;
+        return true;
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//* Get Texture
+//! Sets up texture of buffer last texture was loaded from
+//! @param tile Tile texture coordinates are relative to
+//! @return Texture to bind, 0 if no texture was loaded from a buffer
+//-----------------------------------------------------------------------------
+CachedTexture* FrameBufferCache::getTexture(RDPTile* tile)
+{
+    FrameBuffer* buffer = m_textureBuffer;
+    if ( !buffer )
+    {
+        return 0;
+    }
+
+    //Position of first loaded texel in color image
+    unsigned int offset = m_textureAddress - buffer->address;
+    float row    = (float)(offset / buffer->bpl);
+    float column = (float)(((offset % buffer->bpl) << 1) >> buffer->size);
+
+    CachedTexture& texture = buffer->texture;
+    texture.frameBufferTexture = true;
+    texture.address     = buffer->address;
+    texture.format      = buffer->format;
+    texture.size        = buffer->size;
+    texture.width       = buffer->width;
+    texture.height      = buffer->rows;
+    texture.clampWidth  = buffer->width;
+    texture.clampHeight = buffer->rows;
+    texture.clampS      = texture.clampT  = 1;
+    texture.maskS       = texture.maskT   = 0;
+    texture.mirrorS     = texture.mirrorT = 0;
+    texture.realWidth   = buffer->m_width;
+    texture.realHeight  = buffer->m_height;
+
+    //Rows are bottom up, t is mirrored around top of texture
+    texture.scaleS  = buffer->m_scaleX / buffer->m_width;
+    texture.scaleT  = -buffer->m_scaleY / buffer->m_height;
+    texture.offsetS = column;
+    texture.offsetT = row - buffer->m_height / buffer->m_scaleY;
+
+    texture.shiftScaleS = 1.0f;
+    texture.shiftScaleT = 1.0f;
+    if (tile->shifts > 10)
+        texture.shiftScaleS = (float)(1 << (16 - tile->shifts));
+    else if (tile->shifts > 0)
+        texture.shiftScaleS /= (float)(1 << tile->shifts);
+
+    if (tile->shiftt > 10)
+        texture.shiftScaleT = (float)(1 << (16 - tile->shiftt));
+    else if (tile->shiftt > 0)
+        texture.shiftScaleT /= (float)(1 << tile->shiftt);
+
+    return &texture;
+}
+
+//-----------------------------------------------------------------------------
+// Find Buffer
+//! Buffers overlapping color image in another format are dropped
+//-----------------------------------------------------------------------------
+FrameBuffer* FrameBufferCache::_findBuffer(const RDPSetImgInfo& colorImage)
+{
+    FrameBuffer* found = 0;
+    for (unsigned int i=0; i<MAX_FRAME_BUFFERS; ++i)
+    {
+        FrameBuffer* buffer = &m_frameBuffers[i];
+        if ( buffer->m_target == 0 )
+        {
+            continue;
+        }
+
+        if ( buffer->address == colorImage.rdramAddress && buffer->format == colorImage.format &&
+             buffer->size == colorImage.size && buffer->width == colorImage.width )
+        {
+            found = buffer;
+        }
+        else if ( buffer->address == colorImage.rdramAddress || buffer->contains(colorImage.rdramAddress) )
+        {
+            _removeBuffer(buffer);
+        }
+    }
+    return found;
+}
+
+//-----------------------------------------------------------------------------
+// Add Buffer
+//! Uses a free buffer, or the one bound longest ago
+//-----------------------------------------------------------------------------
+FrameBuffer* FrameBufferCache::_addBuffer(const RDPSetImgInfo& colorImage)
+{
+    FrameBuffer* buffer = 0;
+    for (unsigned int i=0; i<MAX_FRAME_BUFFERS; ++i)
+    {
+        if ( m_frameBuffers[i].m_target == 0 )
+        {
+            buffer = &m_frameBuffers[i];
+            break;
+        }
+        if ( !buffer || m_frameBuffers[i].lastUsed < buffer->lastUsed )
+        {
+            buffer = &m_frameBuffers[i];
+        }
+    }
+    _removeBuffer(buffer);
+
+    OpenGLManager& openGLMgr = OpenGLManager::getSingleton();
+    buffer->address  = colorImage.rdramAddress;
+    buffer->format   = colorImage.format;
+    buffer->size     = colorImage.size;
+    buffer->width    = colorImage.width;
+    buffer->bpl      = colorImage.bpl;
+    buffer->rows     = openGLMgr.getVIHeight();
+    buffer->height   = 0;
+    buffer->crc      = 0;
+    buffer->m_scaleX = openGLMgr.getViewScaleX();
+    buffer->m_scaleY = openGLMgr.getViewScaleY();
+
+    int width = (int)(buffer->width * buffer->m_scaleX + 0.5f);
+    buffer->initialize((unsigned int)(buffer - m_frameBuffers) + 1, width > 0 ? width : 1, openGLMgr.getHeight());
+    m_numBuffers++;
+    return buffer;
+}
+
+//-----------------------------------------------------------------------------
+// Remove Buffer
+//! Textures still pointing to buffer are unbound when used
+//-----------------------------------------------------------------------------
+void FrameBufferCache::_removeBuffer(FrameBuffer* buffer)
+{
+    if ( buffer == m_current )
+    {
+        buffer->endRendering();
+        m_current = 0;
+    }
+    if ( buffer == m_textureBuffer )
+    {
+        m_textureBuffer = 0;
+    }
+    buffer->dispose();
+}
+
+//-----------------------------------------------------------------------------
+// End Rendering
+//! Stops rendering to current buffer, remembers its RDRAM contents
+//-----------------------------------------------------------------------------
+void FrameBufferCache::_endRendering()
+{
+    if ( m_current )
+    {
+        m_current->crc = _calculateCRC(m_current);
+        m_current->endRendering();
+        m_current = 0;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Calculate CRC
+//! Hashes CRC_SAMPLES words spread over the drawn rows of buffer
+//-----------------------------------------------------------------------------
+unsigned int FrameBufferCache::_calculateCRC(FrameBuffer* buffer)
+{
+    unsigned int begin = buffer->address & ~3;
+    unsigned int end   = buffer->address + buffer->bpl * buffer->height;
+    if ( end > m_memory->getRDRAMSize() )
+    {
+        end = m_memory->getRDRAMSize();
+    }
+
+    if ( end <= begin )
+    {
+        return 0;
+    }
+
+    unsigned int step = ((end - begin) / CRC_SAMPLES) & ~3;
+    if ( step < 4 )
+    {
+        step = 4;
+    }
+
+    unsigned int crc = 0;
+    unsigned char* rdram = m_memory->getRDRAM();
+    for (unsigned int i=begin; i + 4 <= end; i += step)
+    {
+        crc = crc * 31 + *(unsigned int*)&rdram[i];
+    }
+    return crc;
+}
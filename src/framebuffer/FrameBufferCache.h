@@ -0,0 +1,93 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef FRAME_BUFFER_CACHE_H_
+#define FRAME_BUFFER_CACHE_H_
+
+#include "FrameBuffer.h"
+
+//Forward declarations
+class Memory;
+struct RDPSetImgInfo;
+struct RDPTile;
+
+//*****************************************************************************
+//* Frame Buffer Cache
+//! Renders color images other than the shown frame into textures, and lets
+//! textures loaded from them sample the rendered image directly.
+//! @details Buffers are found by RDRAM address, format and width of the
+//!          color image. A color image with the VI width is taken to be the
+//!          frame and rendered to the window as before. When rendering to a
+//!          buffer ends a sampled hash of its RDRAM is stored, if the CPU
+//!          writes the memory the buffer is dropped and the texture is
+//!          loaded from RDRAM again.
+//*****************************************************************************
+class FrameBufferCache
+{
+public:
+
+    static const unsigned int MAX_FRAME_BUFFERS = 8;   //!< Render targets of render device
+    static const unsigned int CRC_SAMPLES = 256;       //!< Words hashed to detect CPU writes
+
+public:
+
+    //Constructor / Destructor
+    FrameBufferCache();
+    ~FrameBufferCache();
+
+    bool initialize(Memory* memory);
+    void dispose();
+
+    //Color image
+    void setColorImage(const RDPSetImgInfo& colorImage, const RDPSetImgInfo& depthImage);
+    void setScissor(unsigned int lry);
+    void endFrame();
+
+    //Textures
+    bool loadTexture(unsigned int rdramAddress, unsigned int size);
+    CachedTexture* getTexture(RDPTile* tile);
+
+    //Statistics
+    unsigned int getNumBuffers()       { return m_numBuffers;       }
+    unsigned int getNumTextureLoads()  { return m_numTextureLoads;  }
+
+private:
+
+    FrameBuffer* _findBuffer(const RDPSetImgInfo& colorImage);
+    FrameBuffer* _addBuffer(const RDPSetImgInfo& colorImage);
+    void _removeBuffer(FrameBuffer* buffer);
+    void _endRendering();
+    unsigned int _calculateCRC(FrameBuffer* buffer);
+
+private:
+
+    Memory*      m_memory;                             //!< Pointer to memory manager (RDRAM)
+    FrameBuffer  m_frameBuffers[MAX_FRAME_BUFFERS];    //!< Buffers, kept so textures can point to them
+    FrameBuffer* m_current;                            //!< Buffer rendered to, 0 for window
+    FrameBuffer* m_textureBuffer;                      //!< Buffer last texture was loaded from
+    unsigned int m_textureAddress;                     //!< RDRAM address last texture was loaded from
+    unsigned int m_scissorLry;                         //!< Bottom of scissor in N64 pixels
+    unsigned int m_useCount;                           //!< Incremented when a buffer is bound
+    unsigned int m_numBuffers;                         //!< Buffers created
+    unsigned int m_numTextureLoads;                    //!< Textures sampled from buffers
+};
+
+#endif
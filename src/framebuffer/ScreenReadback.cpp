@@ -0,0 +1,305 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#include <cstring>
+
+#include "ScreenReadback.h"
+#include "RenderDevice.h"
+#include "SharedFrameRing.h"
+
+//-----------------------------------------------------------------------------
+//! Constructor
+//-----------------------------------------------------------------------------
+ScreenReadback::ScreenReadback()
+{
+    m_numBuffers = 0;
+    m_exactFrame = false;
+    m_capturing  = false;
+    m_next       = 0;
+    m_numCaptured = 0;
+    m_latency    = 0;
+    m_lastFrame  = 0;
+    m_lastWidth  = 0;
+    m_lastHeight = 0;
+    m_lastFrameNumber = 0;
+    m_frameRing  = 0;
+    m_nextStreamFrame = 0;
+    m_scaleWidth  = 0;
+    m_scaleHeight = 0;
+    m_boxFilter   = false;
+    m_captureTime = 0;
+    m_numTimed    = 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Destructor
+//-----------------------------------------------------------------------------
+ScreenReadback::~ScreenReadback()
+{
+    dispose();
+}
+
+//-----------------------------------------------------------------------------
+//* Initialize
+//! @param numBuffers Frames in ring, 2 or 3
+//! @param exactFrame Return oldest frame with fixed latency instead of newest
+//!                   finished frame
+//-----------------------------------------------------------------------------
+bool ScreenReadback::initialize(int numBuffers, bool exactFrame)
+{
+    if ( numBuffers < 2 )           numBuffers = 2;
+    if ( numBuffers > MAX_BUFFERS ) numBuffers = MAX_BUFFERS;
+
+    m_numBuffers  = numBuffers;
+    m_exactFrame  = exactFrame;
+    m_capturing   = false;
+    m_next        = 0;
+    m_numCaptured = 0;
+    m_latency     = 0;
+    m_lastWidth   = 0;
+    m_nextStreamFrame = 0;
+    m_captureTime = 0;
+    m_numTimed    = 0;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Dispose
+//-----------------------------------------------------------------------------
+void ScreenReadback::dispose()
+{
+    //Last frames are still in buffers
+    if ( m_frameRing && m_capturing )
+    {
+        _stream(true);
+    }
+
+    if ( m_lastFrame )
+    {
+        delete[] m_lastFrame;
+        m_lastFrame = 0;
+    }
+    m_lastWidth = m_lastHeight = 0;
+
+    m_numBuffers = 0;
+    m_capturing  = false;
+    m_frameRing  = 0;
+    m_scaleWidth = m_scaleHeight = 0;
+}
+
+//-----------------------------------------------------------------------------
+//* Set Scale
+//! @param width  Width frames are read at, 0 to read window size
+//! @param height Height frames are read at, 0 to read window size
+//! @param box    Average 2x2 blocks down to the size instead of a single
+//!               bilinear step, slower but does not skip pixels
+//-----------------------------------------------------------------------------
+void ScreenReadback::setScale(int width, int height, bool box)
+{
+    if ( width <= 0 || height <= 0 )
+    {
+        width = height = 0;
+    }
+    m_scaleWidth  = width;
+    m_scaleHeight = height;
+    m_boxFilter   = box;
+}
+
+//-----------------------------------------------------------------------------
+//* Read Pixels
+//! Synchronous read used when no captured frame can be returned
+//-----------------------------------------------------------------------------
+void ScreenReadback::readPixels(void* dest, int windowWidth, int windowHeight, bool front)
+{
+    RenderDevice& device = RenderDevice::getSingleton();
+    if ( !isScaled() )
+    {
+        device.readPixels(dest, windowWidth, windowHeight, front);
+        return;
+    }
+
+    device.downscale(front, windowWidth, windowHeight, m_scaleWidth, m_scaleHeight, m_boxFilter);
+    device.readPixels(dest, m_scaleWidth, m_scaleHeight, front);
+    device.endDownscale();
+}
+
+//-----------------------------------------------------------------------------
+//* Capture
+//! Called by OpenGLManager before the frame is swapped
+//-----------------------------------------------------------------------------
+void ScreenReadback::capture(int width, int height, int viWidth, int viHeight)
+{
+    if ( !m_capturing )
+    {
+        return;
+    }
+
+    unsigned long long start = SharedFrameRing::getTimestamp();
+
+    //Earlier frames have to reach the ring before their buffer is reused
+    if ( m_frameRing )
+    {
+        _stream(false);
+    }
+
+    RenderDevice& device = RenderDevice::getSingleton();
+    if ( isScaled() )
+    {
+        device.downscale(false, width, height, m_scaleWidth, m_scaleHeight, m_boxFilter);
+        width  = m_scaleWidth;
+        height = m_scaleHeight;
+    }
+    device.readPixelsAsync(m_next, width, height);
+    if ( isScaled() )
+    {
+        device.endDownscale();
+    }
+
+    m_widths[m_next]     = width;
+    m_heights[m_next]    = height;
+    m_viWidths[m_next]   = viWidth;
+    m_viHeights[m_next]  = viHeight;
+    m_timestamps[m_next] = SharedFrameRing::getTimestamp();
+    m_next = (m_next + 1) % m_numBuffers;
+    m_numCaptured++;
+
+    m_captureTime += m_timestamps[(m_next + m_numBuffers - 1) % m_numBuffers] - start;
+    m_numTimed++;
+}
+
+//-----------------------------------------------------------------------------
+// Stream
+//! Writes copied frames to the frame ring in order. Stops at the first copy
+//! the GPU has not finished, except for the buffer captured into next.
+//! @param flush Wait for all copies
+//-----------------------------------------------------------------------------
+void ScreenReadback::_stream(bool flush)
+{
+    RenderDevice& device = RenderDevice::getSingleton();
+
+    //Frames whose buffers were reused are lost
+    if ( m_numCaptured - m_nextStreamFrame > (unsigned int)m_numBuffers )
+    {
+        m_nextStreamFrame = m_numCaptured - m_numBuffers;
+    }
+
+    while ( m_nextStreamFrame < m_numCaptured )
+    {
+        int buffer = m_nextStreamFrame % m_numBuffers;
+        //Ring rows are padded to 4 bytes, consumers get the stride with each frame
+        int stride = (m_widths[buffer] * 3 + 3) & ~3;
+
+        unsigned char* pixels = m_frameRing->beginFrame(stride * m_heights[buffer]);
+        if ( !pixels )
+        {
+            m_nextStreamFrame++;
+            continue;
+        }
+
+        if ( !device.getAsyncPixels(buffer, pixels, flush || buffer == m_next, stride) )
+        {
+            m_frameRing->cancelFrame();
+            break;
+        }
+        m_frameRing->endFrame(m_nextStreamFrame, m_widths[buffer], m_heights[buffer], stride,
+                              m_viWidths[buffer], m_viHeights[buffer], m_timestamps[buffer]);
+        m_nextStreamFrame++;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//* Read
+//! Copies a captured frame to dest
+//! @return false if no captured frame can be used, dest has to be read
+//!         synchronously then
+//-----------------------------------------------------------------------------
+bool ScreenReadback::read(void* dest, int width, int height)
+{
+    if ( m_numBuffers == 0 )
+    {
+        return false;
+    }
+    if ( !m_capturing )
+    {
+        m_capturing = true;
+        return false;
+    }
+
+    RenderDevice& device = RenderDevice::getSingleton();
+    unsigned int numValid = m_numCaptured < (unsigned int)m_numBuffers ? m_numCaptured : m_numBuffers;
+
+    //Newest finished frame, never waits
+    if ( !m_exactFrame )
+    {
+        for (unsigned int age=0; age<numValid; ++age)
+        {
+            int buffer = (m_next + m_numBuffers - 1 - age) % m_numBuffers;
+            if ( m_widths[buffer] == width && m_heights[buffer] == height &&
+                 device.getAsyncPixels(buffer, dest, false, width * 3) )
+            {
+                _keepLastFrame(dest, width, height, age);
+                m_latency = age;
+                return true;
+            }
+        }
+
+        //No copy finished, the last image returned is still the newest one
+        if ( m_lastWidth == width && m_lastHeight == height )
+        {
+            memcpy(dest, m_lastFrame, width * 3 * height);
+            m_latency = m_numCaptured - m_lastFrameNumber;
+            return true;
+        }
+        return false;
+    }
+
+    //Oldest frame, waits if GPU has not copied it yet
+    if ( numValid > 0 )
+    {
+        int buffer = (m_next + m_numBuffers - numValid) % m_numBuffers;
+        if ( m_widths[buffer] == width && m_heights[buffer] == height &&
+             device.getAsyncPixels(buffer, dest, true, width * 3) )
+        {
+            m_latency = numValid - 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+// Keep Last Frame
+//! Copies image returned in latest-complete mode, returned again while no
+//! newer copy has finished
+//! @param age Frames image is behind newest captured frame
+//-----------------------------------------------------------------------------
+void ScreenReadback::_keepLastFrame(const void* pixels, int width, int height, unsigned int age)
+{
+    if ( m_lastWidth != width || m_lastHeight != height )
+    {
+        delete[] m_lastFrame;
+        m_lastFrame  = new unsigned char[width * 3 * height];
+        m_lastWidth  = width;
+        m_lastHeight = height;
+    }
+    memcpy(m_lastFrame, pixels, width * 3 * height);
+    m_lastFrameNumber = m_numCaptured - age;
+}
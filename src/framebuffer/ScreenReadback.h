@@ -0,0 +1,120 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef SCREEN_READBACK_H_
+#define SCREEN_READBACK_H_
+
+class SharedFrameRing;
+
+//*****************************************************************************
+//* Screen Readback
+//! Reads shown frames back through a ring of pixel pack buffers so
+//! ReadScreen2 does not stall the pipeline.
+//! @details Every frame is copied into the next buffer by the GPU just before
+//!          it is swapped. Capturing starts with the first read, that read
+//!          is done synchronously by the caller. In latest-complete mode
+//!          the newest finished copy is returned, or the image returned
+//!          before if no copy has finished yet, so reading never waits. In
+//!          exact-frame mode the oldest copy is returned, waiting for it if
+//!          needed, so the image is always exactly numBuffers-1 frames old.
+//!          With a frame ring every copied frame is also written to the
+//!          ring, in order, before its buffer is reused.
+//!          With a scale set frames are downscaled on the GPU first, so
+//!          only the small image is copied and read.
+//*****************************************************************************
+class ScreenReadback
+{
+public:
+
+    static const int MAX_BUFFERS = 3;   //!< Triple buffering at most
+
+public:
+
+    //Constructor / Destructor
+    ScreenReadback();
+    ~ScreenReadback();
+
+    bool initialize(int numBuffers, bool exactFrame);
+    void dispose();
+
+    //! Start copying frames without waiting for first read
+    void start() { m_capturing = m_numBuffers > 0; }
+
+    //! Write every copied frame to ring, 0 to stop
+    void setFrameRing(SharedFrameRing* frameRing) { m_frameRing = frameRing; }
+
+    //Downscale frames to width x height before they are read, 0 for window size
+    void setScale(int width, int height, bool box);
+    bool isScaled() { return m_scaleWidth > 0; }
+    int getScaleWidth() { return m_scaleWidth; }
+    int getScaleHeight() { return m_scaleHeight; }
+    bool isBoxFilter() { return m_boxFilter; }
+
+    //Read frame synchronously, scaled if a scale is set
+    void readPixels(void* dest, int windowWidth, int windowHeight, bool front);
+
+    //Start copying frame about to be swapped
+    void capture(int width, int height, int viWidth, int viHeight);
+
+    //Get a previously copied frame
+    bool read(void* dest, int width, int height);
+
+    //! Get how many frames the image returned by last read was behind
+    unsigned int getLatency() { return m_latency; }
+
+    //! Get average CPU time spent starting each copy in milliseconds
+    double getCaptureTime() { return m_numTimed > 0 ? m_captureTime / 1000000.0 / m_numTimed : 0.0; }
+
+private:
+
+    void _stream(bool flush);
+    void _keepLastFrame(const void* pixels, int width, int height, unsigned int age);
+
+private:
+
+    int          m_numBuffers;             //!< Buffers in ring, 0 if disabled
+    bool         m_exactFrame;             //!< Always return oldest frame?
+    bool         m_capturing;              //!< Has a read started capturing?
+    int          m_next;                   //!< Buffer next frame is copied into
+    unsigned int m_numCaptured;            //!< Frames copied since capturing started
+    int          m_widths[MAX_BUFFERS];    //!< Width of frame in each buffer
+    int          m_heights[MAX_BUFFERS];   //!< Height of frame in each buffer
+    unsigned int m_latency;                //!< Frames last read image was behind
+
+    unsigned char* m_lastFrame;            //!< Copy of image last read in latest-complete mode
+    int            m_lastWidth;            //!< Width of m_lastFrame, 0 if none
+    int            m_lastHeight;           //!< Height of m_lastFrame
+    unsigned int   m_lastFrameNumber;      //!< Frames captured up to and including m_lastFrame
+
+    SharedFrameRing*   m_frameRing;                    //!< Ring frames are streamed to, 0 if none
+    unsigned int       m_nextStreamFrame;              //!< First copied frame not written to ring
+    int                m_viWidths[MAX_BUFFERS];        //!< VI width of frame in each buffer
+    int                m_viHeights[MAX_BUFFERS];       //!< VI height of frame in each buffer
+    unsigned long long m_timestamps[MAX_BUFFERS];      //!< When frame in each buffer was swapped
+
+    int                m_scaleWidth;               //!< Width frames are read at, 0 for window size
+    int                m_scaleHeight;              //!< Height frames are read at, 0 for window size
+    bool               m_boxFilter;                //!< Average 2x2 blocks instead of one bilinear step?
+    unsigned long long m_captureTime;              //!< Nanoseconds spent in capture
+    unsigned int       m_numTimed;                 //!< Captures measured by m_captureTime
+};
+
+#endif
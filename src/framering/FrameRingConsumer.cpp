@@ -0,0 +1,376 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+//*****************************************************************************
+//* Arachnoid Frame Consumer
+//! Reference consumer for the shared memory frame ring (FrameRing=True).
+//! Frames are read in place from the mapped ring, checked with the slot
+//! sequence numbers and timed against the swap timestamps. With -b a
+//! writer process producing synthetic frames is forked first, so latency
+//! and throughput of the ring can be measured without the emulator.
+//*****************************************************************************
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "FrameRingFormat.h"
+#include "SharedFrameRing.h"
+
+#define BENCH_WIDTH   640
+#define BENCH_HEIGHT  480
+
+//-----------------------------------------------------------------------------
+// Reader
+//-----------------------------------------------------------------------------
+
+struct ConsumerStats
+{
+    unsigned int frames;             //!< Frames read
+    unsigned int skipped;            //!< Frames overwritten before they were read
+    unsigned int torn;               //!< Frames rewritten while they were read
+    double       totalLatency;       //!< Sum of swap to read latencies (ms)
+    double       maxLatency;         //!< Worst swap to read latency (ms)
+    double       bytes;              //!< Pixel bytes read
+    unsigned int checksum;           //!< Checksum of last frame
+};
+
+static const FrameRingHeader* openRing(const char* name, double timeout, unsigned int* size)
+{
+    double waited = 0.0;
+    for (;;)
+    {
+        int fd = shm_open(name, O_RDONLY, 0);
+        if ( fd >= 0 )
+        {
+            struct stat info;
+            if ( fstat(fd, &info) == 0 && info.st_size >= (off_t)sizeof(FrameRingHeader) )
+            {
+                void* memory = mmap(0, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+                close(fd);
+                if ( memory == MAP_FAILED )
+                {
+                    return 0;
+                }
+                const FrameRingHeader* header = (const FrameRingHeader*)memory;
+                if ( header->magic == FRAME_RING_MAGIC && header->version == FRAME_RING_VERSION &&
+                     sizeof(FrameRingHeader) + (unsigned long long)header->numSlots * header->slotSize <= (unsigned long long)info.st_size )
+                {
+                    *size = (unsigned int)info.st_size;
+                    return header;
+                }
+                munmap(memory, info.st_size);
+            }
+            else
+            {
+                close(fd);
+            }
+        }
+
+        //Writer has not created ring yet
+        if ( waited >= timeout )
+        {
+            return 0;
+        }
+        usleep(10000);
+        waited += 0.01;
+    }
+}
+
+static const FrameRingSlotHeader* getSlot(const FrameRingHeader* header, unsigned int index)
+{
+    return (const FrameRingSlotHeader*)((const unsigned char*)header + sizeof(FrameRingHeader) + 
+                                        (index % header->numSlots) * header->slotSize);
+}
+
+//-----------------------------------------------------------------------------
+//* Consume
+//! Reads every published frame in order until the writer closes the ring
+//! or maxFrames frames were read. Polls the write count, so no system calls
+//! are made while frames are arriving.
+//-----------------------------------------------------------------------------
+static void consume(const FrameRingHeader* header, unsigned int maxFrames, bool quiet, ConsumerStats* stats)
+{
+    memset(stats, 0, sizeof(ConsumerStats));
+    unsigned int next = header->writeCount;
+    unsigned int idle = 0;
+
+    if ( !quiet )
+    {
+        printf("frame,width,height,vi_width,vi_height,latency_ms\n");
+    }
+
+    while ( maxFrames == 0 || stats->frames < maxFrames )
+    {
+        unsigned int written = header->writeCount;
+        if ( next == written )
+        {
+            if ( header->closed )
+            {
+                break;
+            }
+            //Spin briefly, then sleep so an idle ring does not use a core
+            if ( ++idle < 1000 )
+            {
+                sched_yield();
+            }
+            else
+            {
+                usleep(200);
+            }
+            continue;
+        }
+        idle = 0;
+
+        //Writer lapped us, oldest frames are gone
+        if ( written - next > header->numSlots )
+        {
+            stats->skipped += written - header->numSlots - next;
+            next = written - header->numSlots;
+        }
+
+        const FrameRingSlotHeader* slot = getSlot(header, next);
+        unsigned int sequence = slot->sequence;
+        __sync_synchronize();
+        if ( sequence & 1 )
+        {
+            stats->skipped++;
+            next++;
+            continue;
+        }
+
+        //Latency is measured when frame is seen, before it is processed
+        double latency = (SharedFrameRing::getTimestamp() - slot->timestamp) / 1000000.0;
+
+        //Process pixels where they are, a real consumer would encode them here
+        unsigned int width = slot->width, height = slot->height, stride = slot->stride;
+        unsigned int frame = slot->frame;
+        unsigned int viWidth = slot->viWidth, viHeight = slot->viHeight;
+        const unsigned int* pixels = (const unsigned int*)(slot + 1);
+        unsigned int checksum = 0;
+        if ( stride * height <= header->maxPixelBytes )
+        {
+            for (unsigned int i=0; i<stride*height/4; ++i)
+            {
+                checksum = checksum * 31 + pixels[i];
+            }
+        }
+
+        __sync_synchronize();
+        if ( slot->sequence != sequence )
+        {
+            stats->torn++;
+            next++;
+            continue;
+        }
+
+        stats->frames++;
+        stats->totalLatency += latency;
+        if ( latency > stats->maxLatency ) stats->maxLatency = latency;
+        stats->bytes += (double)width * height * 3;
+        stats->checksum = checksum;
+        next++;
+
+        if ( !quiet )
+        {
+            printf("%u,%u,%u,%u,%u,%.3f\n", frame, width, height, viWidth, viHeight, latency);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//* Write Synthetic Frames
+//! Writer side of -b, runs in a forked process
+//-----------------------------------------------------------------------------
+static void writeFrames(SharedFrameRing* ring, unsigned int numFrames, double fps)
+{
+    const unsigned int stride = (BENCH_WIDTH * 3 + 3) & ~3;
+    unsigned long long interval = fps > 0.0 ? (unsigned long long)(1000000000.0 / fps) : 0;
+    unsigned long long nextTime = SharedFrameRing::getTimestamp();
+
+    for (unsigned int i=0; i<numFrames; ++i)
+    {
+        if ( interval )
+        {
+            while ( SharedFrameRing::getTimestamp() < nextTime )
+            {
+                usleep(100);
+            }
+            nextTime += interval;
+        }
+
+        unsigned long long timestamp = SharedFrameRing::getTimestamp();
+        unsigned char* pixels = ring->beginFrame(stride * BENCH_HEIGHT);
+        if ( !pixels )
+        {
+            return;
+        }
+        memset(pixels, i & 0xFF, stride * BENCH_HEIGHT);
+        ring->endFrame(i, BENCH_WIDTH, BENCH_HEIGHT, stride, BENCH_WIDTH / 2, BENCH_HEIGHT / 2, timestamp);
+    }
+}
+
+static void printUsage()
+{
+    printf("Usage: arachnoid-frame-consumer [options] [name]\n");
+    printf("  -q               Only print summary\n");
+    printf("  -n frames        Stop after reading this many frames\n");
+    printf("  -t seconds       Time to wait for the ring to be created (default 10)\n");
+    printf("  -b               Benchmark: fork a writer of synthetic %dx%d frames\n", BENCH_WIDTH, BENCH_HEIGHT);
+    printf("  -f fps           Frame rate of benchmark writer, 0 = unthrottled (default 60)\n");
+    printf("  -s slots         Slots in benchmark ring (default 4)\n");
+    printf("  name             Shared memory object (default %s)\n", FRAME_RING_DEFAULT_NAME);
+}
+
+//-----------------------------------------------------------------------------
+//* Main
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    const char* name = 0;
+    bool quiet = false;
+    bool bench = false;
+    unsigned int maxFrames = 0;
+    double timeout = 10.0;
+    double fps = 60.0;
+    int numSlots = 4;
+
+    for (int i=1; i<argc; ++i)
+    {
+        if ( strcmp(argv[i], "-q") == 0 )
+        {
+            quiet = true;
+        }
+        else if ( strcmp(argv[i], "-b") == 0 )
+        {
+            bench = true;
+        }
+        else if ( strcmp(argv[i], "-n") == 0 && i + 1 < argc )
+        {
+            maxFrames = atoi(argv[++i]);
+        }
+        else if ( strcmp(argv[i], "-t") == 0 && i + 1 < argc )
+        {
+            timeout = atof(argv[++i]);
+        }
+        else if ( strcmp(argv[i], "-f") == 0 && i + 1 < argc )
+        {
+            fps = atof(argv[++i]);
+        }
+        else if ( strcmp(argv[i], "-s") == 0 && i + 1 < argc )
+        {
+            numSlots = atoi(argv[++i]);
+        }
+        else if ( argv[i][0] != '-' && !name )
+        {
+            name = argv[i];
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    //Benchmark writer uses its own ring so a running emulator is not disturbed
+    char benchName[64];
+    SharedFrameRing benchRing;
+    pid_t writer = -1;
+    if ( bench )
+    {
+        if ( !name )
+        {
+            sprintf(benchName, "/arachnoid-frames-bench-%d", (int)getpid());
+            name = benchName;
+        }
+        if ( maxFrames == 0 )
+        {
+            maxFrames = 600;
+        }
+        if ( !benchRing.initialize(name, numSlots, ((BENCH_WIDTH * 3 + 3) & ~3) * BENCH_HEIGHT) )
+        {
+            fprintf(stderr, "arachnoid-frame-consumer: could not create ring '%s'\n", name);
+            return 1;
+        }
+    }
+    if ( !name )
+    {
+        name = FRAME_RING_DEFAULT_NAME;
+    }
+
+    unsigned int size = 0;
+    const FrameRingHeader* header = openRing(name, timeout, &size);
+    if ( !header )
+    {
+        fprintf(stderr, "arachnoid-frame-consumer: could not open ring '%s'\n", name);
+        return 1;
+    }
+
+    if ( bench )
+    {
+        fflush(stdout);
+        writer = fork();
+        if ( writer == 0 )
+        {
+            //Give consumer a moment to start polling before the first frame
+            usleep(10000);
+            writeFrames(&benchRing, maxFrames, fps);
+            benchRing.dispose();
+            _exit(0);
+        }
+        if ( writer < 0 )
+        {
+            fprintf(stderr, "arachnoid-frame-consumer: could not start writer\n");
+            return 1;
+        }
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    ConsumerStats stats;
+    consume(header, maxFrames, quiet, &stats);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+
+    if ( writer > 0 )
+    {
+        waitpid(writer, 0, 0);
+    }
+
+    printf("ring: %s (%u slots, %u bytes)\n", name, header->numSlots, size);
+    printf("frames: %u skipped: %u torn: %u\n", stats.frames, stats.skipped, stats.torn);
+    if ( stats.frames > 0 && seconds > 0.0 )
+    {
+        printf("latency ms avg: %.3f max: %.3f\n", stats.totalLatency / stats.frames, stats.maxLatency);
+        printf("fps: %.1f\n", stats.frames / seconds);
+        printf("MB/s: %.1f\n", stats.bytes / seconds / (1024.0 * 1024.0));
+        printf("last checksum: %08x\n", stats.checksum);
+    }
+    munmap((void*)header, size);
+    return 0;
+}
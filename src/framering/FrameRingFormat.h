@@ -0,0 +1,89 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef FRAME_RING_FORMAT_H_
+#define FRAME_RING_FORMAT_H_
+
+//*****************************************************************************
+//* Frame Ring Format
+//! Layout of the shared memory object completed frames are written to, so
+//! other processes (encoders, streamers) can read them in place.
+//!
+//! Object: FrameRingHeader | slot 0 | slot 1 | ... numSlots slots
+//! Slot:   FrameRingSlotHeader | pixels, slotSize bytes in total
+//!
+//! Pixels are RGB8, rows bottom-up and stride bytes apart (OpenGL layout).
+//! Slots are written in order, the newest frame is in slot
+//! (writeCount - 1) % numSlots. A slot's sequence is odd while it is
+//! written, readers compare sequence before and after reading a slot and
+//! discard the frame if it changed. Timestamps are CLOCK_MONOTONIC
+//! nanoseconds taken when the frame was swapped.
+//! All values are stored in host byte order.
+//*****************************************************************************
+
+#define FRAME_RING_MAGIC          0x47524641    //!< "AFRG"
+#define FRAME_RING_VERSION        1
+#define FRAME_RING_MAX_SLOTS      8
+#define FRAME_RING_ALIGNMENT      64            //!< Alignment of headers and pixels
+#define FRAME_RING_DEFAULT_NAME   "/arachnoid-frames"
+
+//-----------------------------------------------------------------------------
+//! Pixel formats
+//-----------------------------------------------------------------------------
+enum FrameRingPixelFormat
+{
+    FRAME_RING_RGB8 = 1,   //!< 3 bytes per pixel, rows bottom-up
+};
+
+//-----------------------------------------------------------------------------
+//! Header at start of shared memory object
+//-----------------------------------------------------------------------------
+struct FrameRingHeader
+{
+    unsigned int magic;                  //!< FRAME_RING_MAGIC
+    unsigned int version;                //!< FRAME_RING_VERSION
+    unsigned int numSlots;               //!< Slots following header
+    unsigned int slotSize;               //!< Bytes per slot including its header
+    unsigned int maxPixelBytes;          //!< Largest frame a slot can hold
+    unsigned int pixelFormat;            //!< FrameRingPixelFormat
+    volatile unsigned int writeCount;    //!< Frames published since ring was created
+    volatile unsigned int closed;        //!< Set when writer has stopped
+    unsigned char reserved[32];
+};
+
+//-----------------------------------------------------------------------------
+//! Header at start of every slot
+//-----------------------------------------------------------------------------
+struct FrameRingSlotHeader
+{
+    volatile unsigned int sequence;      //!< Odd while slot is being written
+    unsigned int frame;                  //!< Frame number counted by writer, gaps are dropped frames
+    unsigned int width;                  //!< Width of frame in pixels
+    unsigned int height;                 //!< Height of frame in pixels
+    unsigned int stride;                 //!< Bytes between rows
+    unsigned int viWidth;                //!< Native N64 (VI) width of frame
+    unsigned int viHeight;               //!< Native N64 (VI) height of frame
+    unsigned int reserved0;
+    unsigned long long timestamp;        //!< When frame was swapped (ns)
+    unsigned char reserved[24];
+};
+
+#endif
@@ -0,0 +1,242 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#include <string.h>
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include "SharedFrameRing.h"
+
+//! Slot writes have to be visible before sequence and write count change
+#if defined(__GNUC__)
+    #define FRAME_RING_BARRIER() __sync_synchronize()
+#else
+    #define FRAME_RING_BARRIER()
+#endif
+
+//-----------------------------------------------------------------------------
+//! Constructor
+//-----------------------------------------------------------------------------
+SharedFrameRing::SharedFrameRing()
+{
+    m_name[0]      = 0;
+    m_memory       = 0;
+    m_size         = 0;
+    m_header       = 0;
+    m_writeSlot    = 0;
+    m_numPublished = 0;
+    m_numDropped   = 0;
+    m_nextFrame    = 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Destructor
+//-----------------------------------------------------------------------------
+SharedFrameRing::~SharedFrameRing()
+{
+    dispose();
+}
+
+//-----------------------------------------------------------------------------
+//* Initialize
+//! Creates (or replaces) the shared memory object
+//! @param name          Name of object, starting with '/'
+//! @param numSlots      Frames kept in ring, 2 to FRAME_RING_MAX_SLOTS
+//! @param maxPixelBytes Size of largest frame that will be written
+//-----------------------------------------------------------------------------
+bool SharedFrameRing::initialize(const char* name, int numSlots, unsigned int maxPixelBytes)
+{
+    dispose();
+
+#ifdef WIN32
+    return false;
+#else
+    if ( numSlots < 2 )                    numSlots = 2;
+    if ( numSlots > FRAME_RING_MAX_SLOTS ) numSlots = FRAME_RING_MAX_SLOTS;
+
+    unsigned int slotSize = sizeof(FrameRingSlotHeader) + maxPixelBytes;
+    slotSize = (slotSize + FRAME_RING_ALIGNMENT - 1) & ~(FRAME_RING_ALIGNMENT - 1);
+    unsigned int size = sizeof(FrameRingHeader) + slotSize * numSlots;
+
+    strncpy(m_name, name, sizeof(m_name) - 1);
+    m_name[sizeof(m_name) - 1] = 0;
+
+    int fd = shm_open(m_name, O_CREAT | O_RDWR, 0600);
+    if ( fd < 0 )
+    {
+        return false;
+    }
+    if ( ftruncate(fd, size) != 0 )
+    {
+        close(fd);
+        shm_unlink(m_name);
+        return false;
+    }
+    void* memory = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if ( memory == MAP_FAILED )
+    {
+        shm_unlink(m_name);
+        return false;
+    }
+
+    m_memory = (unsigned char*)memory;
+    m_size   = size;
+
+    //Object may be left over from an earlier run, readers check magic last
+    m_header = (FrameRingHeader*)m_memory;
+    memset(m_header, 0, sizeof(FrameRingHeader));
+    FRAME_RING_BARRIER();
+    m_header->version       = FRAME_RING_VERSION;
+    m_header->numSlots      = numSlots;
+    m_header->slotSize      = slotSize;
+    m_header->maxPixelBytes = maxPixelBytes;
+    m_header->pixelFormat   = FRAME_RING_RGB8;
+    m_header->writeCount    = 0;
+    m_header->closed        = 0;
+    for (int i=0; i<numSlots; ++i)
+    {
+        memset(_getSlot(i), 0, sizeof(FrameRingSlotHeader));
+    }
+    FRAME_RING_BARRIER();
+    m_header->magic = FRAME_RING_MAGIC;
+
+    m_writeSlot    = 0;
+    m_numPublished = 0;
+    m_numDropped   = 0;
+    m_nextFrame    = 0;
+    return true;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+//* Dispose
+//! Marks ring as closed and removes the object. Readers that mapped it keep
+//! their mapping.
+//-----------------------------------------------------------------------------
+void SharedFrameRing::dispose()
+{
+#ifndef WIN32
+    if ( m_memory )
+    {
+        m_header->closed = 1;
+        munmap(m_memory, m_size);
+        shm_unlink(m_name);
+    }
+#endif
+    m_memory    = 0;
+    m_header    = 0;
+    m_writeSlot = 0;
+    m_size      = 0;
+}
+
+//-----------------------------------------------------------------------------
+//* Begin Frame
+//! Gets the pixels of the next slot to write a frame into. Readers ignore
+//! the slot until endFrame.
+//! @return 0 if ring is not initialized or frame does not fit
+//-----------------------------------------------------------------------------
+unsigned char* SharedFrameRing::beginFrame(unsigned int numBytes)
+{
+    if ( !m_memory || numBytes > m_header->maxPixelBytes )
+    {
+        return 0;
+    }
+
+    m_writeSlot = _getSlot(m_header->writeCount % m_header->numSlots);
+    m_writeSlot->sequence++;
+    FRAME_RING_BARRIER();
+    return (unsigned char*)(m_writeSlot + 1);
+}
+
+//-----------------------------------------------------------------------------
+//* End Frame
+//! Publishes the frame written since beginFrame
+//-----------------------------------------------------------------------------
+void SharedFrameRing::endFrame(unsigned int frame, int width, int height, int stride, int viWidth, int viHeight, unsigned long long timestamp)
+{
+    if ( !m_writeSlot )
+    {
+        return;
+    }
+
+    m_writeSlot->frame     = frame;
+    m_writeSlot->width     = width;
+    m_writeSlot->height    = height;
+    m_writeSlot->stride    = stride;
+    m_writeSlot->viWidth   = viWidth;
+    m_writeSlot->viHeight  = viHeight;
+    m_writeSlot->timestamp = timestamp;
+    FRAME_RING_BARRIER();
+    m_writeSlot->sequence++;
+    FRAME_RING_BARRIER();
+    m_header->writeCount++;
+    m_writeSlot = 0;
+
+    if ( m_numPublished > 0 && frame > m_nextFrame )
+    {
+        m_numDropped += frame - m_nextFrame;
+    }
+    m_nextFrame = frame + 1;
+    m_numPublished++;
+}
+
+//-----------------------------------------------------------------------------
+//* Cancel Frame
+//! Gives up writing the slot from beginFrame, its previous frame stays valid
+//! if no pixels were written.
+//-----------------------------------------------------------------------------
+void SharedFrameRing::cancelFrame()
+{
+    if ( m_writeSlot )
+    {
+        FRAME_RING_BARRIER();
+        m_writeSlot->sequence++;
+        m_writeSlot = 0;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//* Get Timestamp
+//-----------------------------------------------------------------------------
+unsigned long long SharedFrameRing::getTimestamp()
+{
+#ifdef WIN32
+    return 0;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long)now.tv_sec * 1000000000ULL + now.tv_nsec;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// Get Slot
+//-----------------------------------------------------------------------------
+FrameRingSlotHeader* SharedFrameRing::_getSlot(unsigned int index)
+{
+    return (FrameRingSlotHeader*)(m_memory + sizeof(FrameRingHeader) + index * m_header->slotSize);
+}
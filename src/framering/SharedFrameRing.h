@@ -0,0 +1,76 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef SHARED_FRAME_RING_H_
+#define SHARED_FRAME_RING_H_
+
+#include "FrameRingFormat.h"
+
+//*****************************************************************************
+//* Shared Frame Ring
+//! Writes completed frames into a POSIX shared memory ring (see
+//! FrameRingFormat.h). Frames are written straight into a slot, readers map
+//! the same memory, so no copies or system calls are needed per frame.
+//! @details Only available where shm_open exists, initialize fails on
+//!          other platforms.
+//*****************************************************************************
+class SharedFrameRing
+{
+public:
+
+    //Constructor / Destructor
+    SharedFrameRing();
+    ~SharedFrameRing();
+
+    bool initialize(const char* name, int numSlots, unsigned int maxPixelBytes);
+    void dispose();
+
+    //Write frame
+    unsigned char* beginFrame(unsigned int numBytes);
+    void endFrame(unsigned int frame, int width, int height, int stride, int viWidth, int viHeight, unsigned long long timestamp);
+    void cancelFrame();
+
+    //! Get time in nanoseconds on the clock used for frame timestamps
+    static unsigned long long getTimestamp();
+
+public:
+
+    //Get Statistics
+    unsigned int getNumPublished() { return m_numPublished; }
+    unsigned int getNumDropped()   { return m_numDropped;   }
+
+private:
+
+    FrameRingSlotHeader* _getSlot(unsigned int index);
+
+private:
+
+    char             m_name[256];          //!< Name of shared memory object
+    unsigned char*   m_memory;             //!< Mapped object, 0 if not initialized
+    unsigned int     m_size;               //!< Bytes mapped
+    FrameRingHeader* m_header;             //!< Header at start of m_memory
+    FrameRingSlotHeader* m_writeSlot;      //!< Slot between beginFrame and endFrame
+    unsigned int     m_numPublished;       //!< Frames written
+    unsigned int     m_numDropped;         //!< Frames missing between written frame numbers
+    unsigned int     m_nextFrame;          //!< Frame number expected next
+};
+
+#endif
@@ -96,10 +96,89 @@ unsigned int CRCCalculator2::calcPaletteCRC(unsigned int crc, void *buffer, unsi
     return crc ^ orig;
 }
 
+//-----------------------------------------------------------------------------
+//* Calculate Rows Matrix
+//! CRC is linear, so calcCRC(crc, row, count) == M * crc ^ calcCRC(0, row, count)
+//! where M is a 32x32 bit matrix that only depends on count. Calculates
+//! M^numRows, which gives the crc of numRows rows starting from crc:
+//! multiplyMatrix(matrix, crc) ^ (crc of same rows starting from 0).
+//! Matrices are stored as 32 columns, column i is the product of bit i.
+//-----------------------------------------------------------------------------
+void CRCCalculator2::calcRowsMatrix(unsigned int count, unsigned int numRows, unsigned int matrix[32])
+{
+    unsigned int zeroByte[32];
+    unsigned int row[32];
+
+    //Shifting one zero byte through crc register, using the table since
+    //it is not built like the standard reflected CRC-32 table
+    for (int i=0; i<32; ++i)
+    {
+        unsigned int bit = 1U << i;
+        zeroByte[i] = (bit >> 8) ^ m_crcTable[bit & 0xFF];
+    }
+
+    //calcCRC xors result with crc it started from
+    _powerMatrix(zeroByte, count, row);
+    for (int i=0; i<32; ++i)
+    {
+        row[i] ^= 1U << i;
+    }
+    _powerMatrix(row, numRows, matrix);
+}
+
+//-----------------------------------------------------------------------------
+//* Multiply Matrix
+//! Multiplies crc by matrix from calcRowsMatrix
+//-----------------------------------------------------------------------------
+unsigned int CRCCalculator2::multiplyMatrix(const unsigned int matrix[32], unsigned int crc)
+{
+    unsigned int result = 0;
+    for (int i=0; crc; ++i, crc >>= 1)
+    {
+        if ( crc & 1 )
+        {
+            result ^= matrix[i];
+        }
+    }
+    return result;
+}
+
 //*****************************************************************************
 // Private Functions
 //*****************************************************************************
 
+//-----------------------------------------------------------------------------
+//* Power Matrix
+//! Raises matrix to power by repeated squaring
+//-----------------------------------------------------------------------------
+void CRCCalculator2::_powerMatrix(const unsigned int matrix[32], unsigned int power, unsigned int result[32])
+{
+    unsigned int square[32];
+    unsigned int temp[32];
+
+    for (int i=0; i<32; ++i)
+    {
+        result[i] = 1U << i;
+        square[i] = matrix[i];
+    }
+
+    while ( power )
+    {
+        if ( power & 1 )
+        {
+            for (int i=0; i<32; ++i) temp[i] = multiplyMatrix(square, result[i]);
+            for (int i=0; i<32; ++i) result[i] = temp[i];
+        }
+
+        power >>= 1;
+        if ( power )
+        {
+            for (int i=0; i<32; ++i) temp[i] = multiplyMatrix(square, square[i]);
+            for (int i=0; i<32; ++i) square[i] = temp[i];
+        }
+    }
+}
+
 //-----------------------------------------------------------------------------
 //* Reflect
 //! Help function when creating the CRC Table
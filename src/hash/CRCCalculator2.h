@@ -46,11 +46,18 @@ public:
     unsigned int calcCRC(unsigned int crc, void *buffer, unsigned int count);
     unsigned int calcPaletteCRC(unsigned int crc, void *buffer, unsigned int count);
 
+    //Functions for combining crc values of rows calculated separately
+    void calcRowsMatrix(unsigned int count, unsigned int numRows, unsigned int matrix[32]);
+    static unsigned int multiplyMatrix(const unsigned int matrix[32], unsigned int crc);
+
 private:
 
     //Help function used to build hash table
     unsigned int _reflect(unsigned int ref, char ch);
 
+    //Help function used to combine crc values
+    static void _powerMatrix(const unsigned int matrix[32], unsigned int power, unsigned int result[32]);
+
 private:   
 
     static unsigned int m_crcTable[256];   //!< Hash table that associates keys with values
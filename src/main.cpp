@@ -24,8 +24,10 @@
 #define M64P_PLUGIN_PROTOTYPES 1
 #include <stdio.h>
 #include <string.h>
+#include <string>
 
 #include "ConfigMap.h"
+#include "DisplayListParser.h"
 #include "GraphicsPlugin.h"        //Main class
 #include "Logger.h"                //Debug logger
 #include "MemoryLeakDetector.h"    //For detecting memory leaks
@@ -279,6 +281,23 @@ EXPORT void CALL ResizeVideoOutput(int Width, int Height)
 EXPORT void CALL RomClosed()
 {
     //Logger::getSingleton().printMsg("RomClosed\n");
+
+#ifdef DISPLAYLIST_PROFILER
+    //Report instruction profile
+    if ( g_graphicsPlugin.getDisplayListParser() )
+    {
+        DisplayListProfiler* profiler = g_graphicsPlugin.getDisplayListParser()->getProfiler();
+        profiler->printSummary();
+
+        std::string filename = ConfigGetUserCachePath ? ConfigGetUserCachePath() : "";
+        filename += "arachnoid-profile.csv";
+        if ( !profiler->writeCSV(filename.c_str()) )
+        {
+            Logger::getSingleton().printMsg("Could not write display list profile", M64MSG_WARNING);
+        }
+    }
+#endif
+
     //Destroy 
     g_graphicsPlugin.dispose();
 }
@@ -335,12 +354,17 @@ EXPORT void CALL ProcessDList()
 //-----------------------------------------------------------------------------
 //* ProcessRDPList
 //! This function is called when there is a Dlist to be processed. (Low level GFX list)
-//! @todo ProcessRDPList
+//! Commands between DPC_CURRENT_REG and DPC_END_REG are executed.
 //-----------------------------------------------------------------------------
 EXPORT void CALL ProcessRDPList()
 {
     Logger::getSingleton().printMsg("ProcessRDPList\n");
-    //TODO
+
+    if ( !g_graphicsPlugin.getRDPCommandParser() )
+    {
+        return;
+    }
+    g_graphicsPlugin.processRDPList();
 }
 
 //-----------------------------------------------------------------------------
@@ -411,6 +435,7 @@ EXPORT void CALL ChangeWindow()
 //-----------------------------------------------------------------------------
 EXPORT void CALL ReadScreen2(void *dest, int *width, int *height, int front)
 {
+    //Reading pixels waits for the render thread
     g_graphicsPlugin.takeScreenshot(dest, width, height, front);
 }
 
@@ -430,6 +455,9 @@ EXPORT void CALL SetRenderingCallback(void (*callback)(int))
 //-----------------------------------------------------------------------------
 EXPORT void CALL FBRead(unsigned int addr)
 {
+    //Rendering has to be finished before frame buffer can be read
+    g_graphicsPlugin.synchronize();
+
     //TODO
 }
 
@@ -23,6 +23,9 @@
 #define MATH_LIBRARY_H_
 
 #include <cmath>     //sqrtf
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
 
 #include "m64p.h"  
 
@@ -67,6 +70,58 @@ inline void transformVector( float* m, float* v, float* out )
 
 
 
+//-----------------------------------------------------------------------------
+//* Fast Arc Cosine
+//! Polynomial approximation of acos (Abramowitz & Stegun 4.4.46).
+//! Max error compared to acosf is less than FAST_ACOS_MAX_ERROR radians
+//! over [-1, 1] (checked by make math-test), input outside that range is clamped.
+//-----------------------------------------------------------------------------
+#define FAST_ACOS_MAX_ERROR  5e-7f
+
+inline float fastAcos(float x)
+{
+    float a = fabsf(x);
+    if ( a > 1.0f ) a = 1.0f;
+
+    float p = -0.0012624911f;
+    p = p * a + 0.0066700901f;
+    p = p * a - 0.0170881256f;
+    p = p * a + 0.0308918810f;
+    p = p * a - 0.0501743046f;
+    p = p * a + 0.0889789874f;
+    p = p * a - 0.2145988016f;
+    p = p * a + 1.5707963050f;
+
+    float r = sqrtf(1.0f - a) * p;
+    return ( x < 0.0f ) ? 3.14159265f - r : r;
+}
+
+#ifdef __SSE__
+//-----------------------------------------------------------------------------
+//* Fast Arc Cosine (4 values)
+//! SSE version of fastAcos, gives the same result for each value.
+//-----------------------------------------------------------------------------
+inline __m128 fastAcos4(__m128 x)
+{
+    __m128 signMask = _mm_set1_ps(-0.0f);
+    __m128 a = _mm_min_ps(_mm_andnot_ps(signMask, x), _mm_set1_ps(1.0f));
+
+    __m128 p = _mm_set1_ps(-0.0012624911f);
+    p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps( 0.0066700901f));
+    p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps(-0.0170881256f));
+    p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps( 0.0308918810f));
+    p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps(-0.0501743046f));
+    p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps( 0.0889789874f));
+    p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps(-0.2145988016f));
+    p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps( 1.5707963050f));
+
+    __m128 r = _mm_mul_ps(_mm_sqrt_ps(_mm_sub_ps(_mm_set1_ps(1.0f), a)), p);
+    __m128 negative = _mm_cmplt_ps(x, _mm_setzero_ps());
+    return _mm_or_ps(_mm_and_ps(negative, _mm_sub_ps(_mm_set1_ps(3.14159265f), r)),
+                     _mm_andnot_ps(negative, r));
+}
+#endif
+
 //-----------------------------------------------------------------------------
 // Random Float
 //-----------------------------------------------------------------------------
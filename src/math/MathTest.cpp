@@ -0,0 +1,128 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+//*****************************************************************************
+//* Arachnoid Math Test
+//! Checks the fast approximations in MathLib.h. fastAcos is compared with
+//! acosf over [-1, 1] and must stay within FAST_ACOS_MAX_ERROR, fastAcos4
+//! must give the same result as fastAcos for each lane. Returns non-zero
+//! if a check fails.
+//*****************************************************************************
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "MathLib.h"
+
+#define SWEEP_STEPS  (1 << 24)
+
+static unsigned int g_numFailures = 0;
+
+//-----------------------------------------------------------------------------
+//* Check Scalar
+//! Sweeps [-1, 1] and tracks max error compared to acosf
+//-----------------------------------------------------------------------------
+static void checkFastAcos()
+{
+    float maxError = 0.0f;
+    float maxErrorInput = 0.0f;
+    for (int i=0; i<=SWEEP_STEPS; ++i)
+    {
+        float x = -1.0f + 2.0f * (float)i / (float)SWEEP_STEPS;
+        float error = fabsf(fastAcos(x) - acosf(x));
+        if ( error > maxError )
+        {
+            maxError = error;
+            maxErrorInput = x;
+        }
+    }
+
+    //Input outside [-1, 1] is clamped
+    if ( fastAcos(1.5f) != fastAcos(1.0f) || fastAcos(-1.5f) != fastAcos(-1.0f) )
+    {
+        printf("FAIL fastAcos does not clamp input outside [-1, 1]\n");
+        g_numFailures++;
+    }
+
+    if ( maxError > FAST_ACOS_MAX_ERROR )
+    {
+        printf("FAIL fastAcos max error %g at %.9g, bound is %g\n", maxError, maxErrorInput, FAST_ACOS_MAX_ERROR);
+        g_numFailures++;
+    }
+    else
+    {
+        printf("ok   fastAcos max error %g at %.9g (bound %g)\n", maxError, maxErrorInput, FAST_ACOS_MAX_ERROR);
+    }
+}
+
+#ifdef __SSE__
+//-----------------------------------------------------------------------------
+//* Check SSE
+//! Every lane of fastAcos4 must be bitwise equal to fastAcos
+//-----------------------------------------------------------------------------
+static void checkFastAcos4()
+{
+    unsigned int mismatches = 0;
+    float firstMismatch = 0.0f;
+    for (int i=0; i<=SWEEP_STEPS + 8; i += 4)
+    {
+        //Last group also covers input outside [-1, 1]
+        float in[4], out[4];
+        for (int j=0; j<4; ++j)
+        {
+            in[j] = -1.0f + 2.0f * (float)(i + j) / (float)SWEEP_STEPS;
+        }
+        _mm_storeu_ps(out, fastAcos4(_mm_loadu_ps(in)));
+
+        for (int j=0; j<4; ++j)
+        {
+            float expected = fastAcos(in[j]);
+            if ( memcmp(&out[j], &expected, sizeof(float)) != 0 )
+            {
+                if ( mismatches == 0 ) firstMismatch = in[j];
+                mismatches++;
+            }
+        }
+    }
+
+    if ( mismatches > 0 )
+    {
+        printf("FAIL fastAcos4 differs from fastAcos for %u values, first at %.9g\n", mismatches, firstMismatch);
+        g_numFailures++;
+    }
+    else
+    {
+        printf("ok   fastAcos4 matches fastAcos in every lane\n");
+    }
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// Main
+//-----------------------------------------------------------------------------
+int main()
+{
+    checkFastAcos();
+#ifdef __SSE__
+    checkFastAcos4();
+#endif
+    return g_numFailures > 0 ? 1 : 0;
+}
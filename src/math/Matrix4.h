@@ -25,6 +25,9 @@
 #include <stddef.h>
 #include <iostream>
 #include <ostream>
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
 
 //*****************************************************************************
 //* Matrix4
@@ -73,6 +76,22 @@ public:
     inline Matrix4 operator * ( const Matrix4 &m2 ) const
     {
         Matrix4 r;
+#ifdef __SSE__
+        //Each row of the result is a linear combination of the rows in m2,
+        //summed in the same order as the scalar version.
+        __m128 b0 = _mm_loadu_ps(m2.m[0]);
+        __m128 b1 = _mm_loadu_ps(m2.m[1]);
+        __m128 b2 = _mm_loadu_ps(m2.m[2]);
+        __m128 b3 = _mm_loadu_ps(m2.m[3]);
+        for (int i=0; i<4; ++i)
+        {
+            __m128 row = _mm_mul_ps(_mm_set1_ps(m[i][0]), b0);
+            row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(m[i][1]), b1));
+            row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(m[i][2]), b2));
+            row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(m[i][3]), b3));
+            _mm_storeu_ps(r.m[i], row);
+        }
+#else
         r.m[0][0] = m[0][0] * m2.m[0][0] + m[0][1] * m2.m[1][0] + m[0][2] * m2.m[2][0] + m[0][3] * m2.m[3][0];
         r.m[0][1] = m[0][0] * m2.m[0][1] + m[0][1] * m2.m[1][1] + m[0][2] * m2.m[2][1] + m[0][3] * m2.m[3][1];
         r.m[0][2] = m[0][0] * m2.m[0][2] + m[0][1] * m2.m[1][2] + m[0][2] * m2.m[2][2] + m[0][3] * m2.m[3][2];
@@ -92,7 +111,7 @@ public:
         r.m[3][1] = m[3][0] * m2.m[0][1] + m[3][1] * m2.m[1][1] + m[3][2] * m2.m[2][1] + m[3][3] * m2.m[3][1];
         r.m[3][2] = m[3][0] * m2.m[0][2] + m[3][1] * m2.m[1][2] + m[3][2] * m2.m[2][2] + m[3][3] * m2.m[3][2];
         r.m[3][3] = m[3][0] * m2.m[0][3] + m[3][1] * m2.m[1][3] + m[3][2] * m2.m[2][3] + m[3][3] * m2.m[3][3];
-
+#endif
         return r;
     }
 
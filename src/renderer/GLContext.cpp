@@ -0,0 +1,196 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#include "GLContext.h"
+
+#if defined(WIN32)
+#include <windows.h>
+#elif defined(__MACOSX__)
+#include <OpenGL/OpenGL.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#if !defined(WIN32) && !defined(__MACOSX__)
+
+//-----------------------------------------------------------------------------
+// EGL and GLX entry points, handles are passed as pointers
+//-----------------------------------------------------------------------------
+#define GLCONTEXT_EGL_DRAW 0x3059
+#define GLCONTEXT_EGL_READ 0x305A
+
+typedef void*        (*PFNEGLGETCURRENTCONTEXT)(void);
+typedef void*        (*PFNEGLGETCURRENTDISPLAY)(void);
+typedef void*        (*PFNEGLGETCURRENTSURFACE)(int readdraw);
+typedef unsigned int (*PFNEGLMAKECURRENT)(void* display, void* draw, void* read, void* context);
+
+typedef void*         (*PFNGLXGETCURRENTCONTEXT)(void);
+typedef void*         (*PFNGLXGETCURRENTDISPLAY)(void);
+typedef unsigned long (*PFNGLXGETCURRENTDRAWABLE)(void);
+typedef int           (*PFNGLXMAKECURRENT)(void* display, unsigned long drawable, void* context);
+
+//-----------------------------------------------------------------------------
+//! Finds function in any library loaded by the process
+//-----------------------------------------------------------------------------
+static void* getProcAddress(const char* name)
+{
+    return dlsym(RTLD_DEFAULT, name);
+}
+
+#endif
+
+//-----------------------------------------------------------------------------
+//! Constructor
+//-----------------------------------------------------------------------------
+GLContext::GLContext()
+{
+    m_api         = CONTEXT_NONE;
+    m_display     = 0;
+    m_context     = 0;
+    m_drawSurface = 0;
+    m_readSurface = 0;
+    m_drawable    = 0;
+}
+
+//-----------------------------------------------------------------------------
+//* Capture
+//! Remembers the context that is current on the calling thread
+//! @return False if no context is current or platform API is unknown
+//-----------------------------------------------------------------------------
+bool GLContext::capture()
+{
+    m_api = CONTEXT_NONE;
+
+#if defined(WIN32)
+    m_context = wglGetCurrentContext();
+    m_display = wglGetCurrentDC();
+    if ( m_context )
+    {
+        m_api = CONTEXT_WGL;
+    }
+#elif defined(__MACOSX__)
+    m_context = CGLGetCurrentContext();
+    if ( m_context )
+    {
+        m_api = CONTEXT_CGL;
+    }
+#else
+    //EGL (Wayland, GLES, offscreen)
+    PFNEGLGETCURRENTCONTEXT eglGetCurrentContext = (PFNEGLGETCURRENTCONTEXT)getProcAddress("eglGetCurrentContext");
+    PFNEGLGETCURRENTDISPLAY eglGetCurrentDisplay = (PFNEGLGETCURRENTDISPLAY)getProcAddress("eglGetCurrentDisplay");
+    PFNEGLGETCURRENTSURFACE eglGetCurrentSurface = (PFNEGLGETCURRENTSURFACE)getProcAddress("eglGetCurrentSurface");
+    if ( eglGetCurrentContext && eglGetCurrentDisplay && eglGetCurrentSurface && eglGetCurrentContext() )
+    {
+        m_context     = eglGetCurrentContext();
+        m_display     = eglGetCurrentDisplay();
+        m_drawSurface = eglGetCurrentSurface(GLCONTEXT_EGL_DRAW);
+        m_readSurface = eglGetCurrentSurface(GLCONTEXT_EGL_READ);
+        m_api = CONTEXT_EGL;
+        return true;
+    }
+
+    //GLX (X11)
+    PFNGLXGETCURRENTCONTEXT  glXGetCurrentContext  = (PFNGLXGETCURRENTCONTEXT)getProcAddress("glXGetCurrentContext");
+    PFNGLXGETCURRENTDISPLAY  glXGetCurrentDisplay  = (PFNGLXGETCURRENTDISPLAY)getProcAddress("glXGetCurrentDisplay");
+    PFNGLXGETCURRENTDRAWABLE glXGetCurrentDrawable = (PFNGLXGETCURRENTDRAWABLE)getProcAddress("glXGetCurrentDrawable");
+    if ( glXGetCurrentContext && glXGetCurrentDisplay && glXGetCurrentDrawable && glXGetCurrentContext() )
+    {
+        m_context  = glXGetCurrentContext();
+        m_display  = glXGetCurrentDisplay();
+        m_drawable = glXGetCurrentDrawable();
+        m_api = CONTEXT_GLX;
+    }
+#endif
+
+    return m_api != CONTEXT_NONE;
+}
+
+//-----------------------------------------------------------------------------
+//* Make Current
+//! Makes captured context current on calling thread
+//-----------------------------------------------------------------------------
+bool GLContext::makeCurrent()
+{
+    switch ( m_api )
+    {
+#if defined(WIN32)
+        case CONTEXT_WGL :
+            return wglMakeCurrent((HDC)m_display, (HGLRC)m_context) != FALSE;
+#elif defined(__MACOSX__)
+        case CONTEXT_CGL :
+            return CGLSetCurrentContext((CGLContextObj)m_context) == kCGLNoError;
+#else
+        case CONTEXT_EGL :
+        {
+            PFNEGLMAKECURRENT eglMakeCurrent = (PFNEGLMAKECURRENT)getProcAddress("eglMakeCurrent");
+            return eglMakeCurrent && eglMakeCurrent(m_display, m_drawSurface, m_readSurface, m_context);
+        }
+        case CONTEXT_GLX :
+        {
+            PFNGLXMAKECURRENT glXMakeCurrent = (PFNGLXMAKECURRENT)getProcAddress("glXMakeCurrent");
+            return glXMakeCurrent && glXMakeCurrent(m_display, m_drawable, m_context);
+        }
+#endif
+        default : 
+            return false;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//* Release
+//! Makes no context current on calling thread
+//-----------------------------------------------------------------------------
+void GLContext::release()
+{
+    switch ( m_api )
+    {
+#if defined(WIN32)
+        case CONTEXT_WGL :
+            wglMakeCurrent(0, 0);
+            break;
+#elif defined(__MACOSX__)
+        case CONTEXT_CGL :
+            CGLSetCurrentContext(0);
+            break;
+#else
+        case CONTEXT_EGL :
+        {
+            PFNEGLMAKECURRENT eglMakeCurrent = (PFNEGLMAKECURRENT)getProcAddress("eglMakeCurrent");
+            if ( eglMakeCurrent ) 
+            {
+                eglMakeCurrent(m_display, 0, 0, 0);
+            }
+            break;
+        }
+        case CONTEXT_GLX :
+        {
+            PFNGLXMAKECURRENT glXMakeCurrent = (PFNGLXMAKECURRENT)getProcAddress("glXMakeCurrent");
+            if ( glXMakeCurrent ) 
+            {
+                glXMakeCurrent(m_display, 0, 0);
+            }
+            break;
+        }
+#endif
+        default : 
+            break;
+    }
+}
@@ -0,0 +1,69 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef GL_CONTEXT_H_
+#define GL_CONTEXT_H_
+
+//*****************************************************************************
+//* GL Context
+//! Moves the OpenGL context created by the core between threads.
+//! @details The core only creates and makes the context current on the
+//!          emulation thread, so the platform API (EGL, GLX, WGL or CGL) is
+//!          used directly to release it there and make it current on another
+//!          thread. EGL and GLX are looked up at runtime so the plugin does
+//!          not link against either.
+//*****************************************************************************
+class GLContext
+{
+public:
+
+    //Constructor
+    GLContext();
+
+    //Remember context current on calling thread
+    bool capture();
+
+    //Make captured context current on / release it from calling thread
+    bool makeCurrent();
+    void release();
+
+private:
+
+    //! Platform API owning the captured context
+    enum ContextAPI
+    {
+        CONTEXT_NONE,
+        CONTEXT_EGL,
+        CONTEXT_GLX,
+        CONTEXT_WGL,
+        CONTEXT_CGL,
+    };
+
+    ContextAPI    m_api;           //!< API of captured context
+    void*         m_display;       //!< EGL display, X display or device context
+    void*         m_context;       //!< Context handle
+    void*         m_drawSurface;   //!< EGL draw surface
+    void*         m_readSurface;   //!< EGL read surface
+    unsigned long m_drawable;      //!< GLX drawable
+
+};
+
+#endif
@@ -0,0 +1,200 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#include <cstdio>
+#include <cstring>
+
+#include "Logger.h"
+#include "NullRenderDevice.h"
+#include "OpenGL.h"
+#include "m64p.h"
+#include "m64p_types.h"
+
+//-----------------------------------------------------------------------------
+//! Constructor
+//-----------------------------------------------------------------------------
+NullRenderDevice::NullRenderDevice()
+{
+    _reset();
+}
+
+//-----------------------------------------------------------------------------
+//! Initialize
+//-----------------------------------------------------------------------------
+bool NullRenderDevice::initialize()
+{
+    _reset();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//* Dispose
+//! Reports what would have been sent to the graphics card
+//-----------------------------------------------------------------------------
+void NullRenderDevice::dispose()
+{
+    char msg[256];
+    sprintf(msg, "NullRenderDevice - %u draw calls, %u vertices, %u state changes, %u clears", 
+            m_numDrawCalls, m_numVertices, m_numStateChanges, m_numClears);
+    Logger::getSingleton().printMsg(msg, M64MSG_INFO);
+    sprintf(msg, "NullRenderDevice - %u texture uploads (%u bytes), %u texture binds", 
+            m_numTextureUploads, m_numTextureBytes, m_numTextureBinds);
+    Logger::getSingleton().printMsg(msg, M64MSG_INFO);
+}
+
+//-----------------------------------------------------------------------------
+//* Enable
+//! Remembers capability so it can be queried with isEnabled
+//-----------------------------------------------------------------------------
+void NullRenderDevice::enable(unsigned int capability)
+{
+    m_numStateChanges++;
+
+    if ( capability == GL_TEXTURE_2D )
+    {
+        m_texture2D[m_activeTextureUnit] = true;
+        return;
+    }
+
+    for (int i=0; i<m_numCapabilities; ++i)
+    {
+        if ( m_capabilities[i] == capability )
+        {
+            return;
+        }
+    }
+
+    if ( m_numCapabilities < MAX_CAPABILITIES )
+    {
+        m_capabilities[m_numCapabilities++] = capability;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Disable
+//-----------------------------------------------------------------------------
+void NullRenderDevice::disable(unsigned int capability)
+{
+    m_numStateChanges++;
+
+    if ( capability == GL_TEXTURE_2D )
+    {
+        m_texture2D[m_activeTextureUnit] = false;
+        return;
+    }
+
+    for (int i=0; i<m_numCapabilities; ++i)
+    {
+        if ( m_capabilities[i] == capability )
+        {
+            m_capabilities[i] = m_capabilities[--m_numCapabilities];
+            return;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Is Enabled
+//-----------------------------------------------------------------------------
+bool NullRenderDevice::isEnabled(unsigned int capability)
+{
+    if ( capability == GL_TEXTURE_2D )
+    {
+        return m_texture2D[m_activeTextureUnit];
+    }
+
+    for (int i=0; i<m_numCapabilities; ++i)
+    {
+        if ( m_capabilities[i] == capability )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//! Upload Texture
+//-----------------------------------------------------------------------------
+void NullRenderDevice::uploadTexture(int internalFormat, int width, int height, unsigned int format, unsigned int type, 
+                                     const void* pixels, unsigned int numBytes)
+{
+    m_numTextureUploads++;
+    m_numTextureBytes += numBytes;
+}
+
+//-----------------------------------------------------------------------------
+//! Draw Triangles
+//-----------------------------------------------------------------------------
+void NullRenderDevice::drawTriangles(int numVertices)
+{
+    m_numDrawCalls++;
+    m_numVertices += numVertices;
+}
+
+//-----------------------------------------------------------------------------
+//! Draw Quad
+//-----------------------------------------------------------------------------
+void NullRenderDevice::drawQuad(const RenderQuadVertex vertices[4], const float color[4], const float* secondaryColor, bool textured)
+{
+    m_numDrawCalls++;
+    m_numVertices += 4;
+}
+
+//-----------------------------------------------------------------------------
+//* Read Pixels
+//! There is no framebuffer, so the image is black
+//-----------------------------------------------------------------------------
+void NullRenderDevice::readPixels(void* dest, int width, int height, bool front)
+{
+    memset(dest, 0, width * height * 3);
+}
+
+//-----------------------------------------------------------------------------
+//* Swap Buffers
+//! Still goes through the core so frontends see every frame
+//-----------------------------------------------------------------------------
+void NullRenderDevice::swapBuffers()
+{
+    CoreVideo_GL_SwapBuffers();
+}
+
+//-----------------------------------------------------------------------------
+//! Reset counters and states
+//-----------------------------------------------------------------------------
+void NullRenderDevice::_reset()
+{
+    m_numCapabilities = 0;
+    for (unsigned int i=0; i<MAX_TEXTURE_UNITS; ++i)
+    {
+        m_texture2D[i] = false;
+    }
+    m_activeTextureUnit = 0;
+    m_lastTextureID = 0;
+
+    m_numDrawCalls = 0;
+    m_numVertices = 0;
+    m_numStateChanges = 0;
+    m_numClears = 0;
+    m_numTextureUploads = 0;
+    m_numTextureBinds = 0;
+    m_numTextureBytes = 0;
+}
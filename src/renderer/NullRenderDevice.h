@@ -0,0 +1,154 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef NULL_RENDER_DEVICE_H_
+#define NULL_RENDER_DEVICE_H_
+
+#include "RenderDevice.h"
+
+//*****************************************************************************
+//* Null Render Device
+//! Render device that never touches OpenGL.
+//! @details Counts draw calls, state changes and texture uploads so display
+//!          list processing can be measured without a GPU or a window. 
+//!          Enable state is tracked so code reading it back keeps working.
+//*****************************************************************************
+class NullRenderDevice : public RenderDevice
+{
+public:
+
+    //Constructor
+    NullRenderDevice();
+
+    //Initialize / Dispose
+    virtual bool initialize();
+    virtual void dispose();
+
+    //Extensions
+    virtual bool isExtensionSupported(const char* extension) { return true; }
+
+    //Capabilities
+    virtual void enable(unsigned int capability);
+    virtual void disable(unsigned int capability);
+    virtual bool isEnabled(unsigned int capability);
+    virtual void enableClientState(unsigned int array)  { m_numStateChanges++; }
+    virtual void disableClientState(unsigned int array) { m_numStateChanges++; }
+
+    //States
+    virtual void setBlendFunc(unsigned int sourceFactor, unsigned int destinationFactor) { m_numStateChanges++; }
+    virtual void setDepthFunc(unsigned int func)                      { m_numStateChanges++; }
+    virtual void setDepthMask(bool write)                             { m_numStateChanges++; }
+    virtual void setDepthRange(float zNear, float zFar)               { m_numStateChanges++; }
+    virtual void setAlphaFunc(unsigned int func, float reference)     { m_numStateChanges++; }
+    virtual void setPolygonOffset(float factor, float units)          { m_numStateChanges++; }
+    virtual void setPolygonMode(unsigned int face, unsigned int mode) { m_numStateChanges++; }
+    virtual void setCullFace(unsigned int face)                       { m_numStateChanges++; }
+    virtual void setViewport(int x, int y, int width, int height)     { m_numStateChanges++; }
+    virtual void setScissor(int x, int y, int width, int height)      { m_numStateChanges++; }
+
+    //Fog
+    virtual void setFogParameteri(unsigned int name, int value)       { m_numStateChanges++; }
+    virtual void setFogParameterf(unsigned int name, float value)     { m_numStateChanges++; }
+    virtual void setFogColor(const float color[4])                    { m_numStateChanges++; }
+    virtual void setFogCoordPointer(unsigned int type, int stride, const void* pointer) {}
+
+    //Clear
+    virtual void setClearColor(float r, float g, float b, float a)    { m_numStateChanges++; }
+    virtual void clear(unsigned int mask)                             { m_numClears++;       }
+
+    //Matrices
+    virtual void setMatrixMode(unsigned int mode) {}
+    virtual void loadIdentity() {}
+    virtual void pushMatrix() {}
+    virtual void popMatrix() {}
+    virtual void ortho(double left, double right, double bottom, double top, double zNear, double zFar) {}
+
+    //Textures
+    virtual void generateTexture(unsigned int* id)    { *id = ++m_lastTextureID; }
+    virtual void deleteTexture(unsigned int* id)      { *id = 0;                 }
+    virtual void bindTexture(unsigned int id)         { m_numTextureBinds++;     }
+    virtual void setActiveTexture(unsigned int unit)  { m_activeTextureUnit = unit < MAX_TEXTURE_UNITS ? unit : 0; }
+    virtual void setTextureParameter(unsigned int name, int value) { m_numStateChanges++; }
+    virtual void uploadTexture(int internalFormat, int width, int height, unsigned int format, unsigned int type, 
+                               const void* pixels, unsigned int numBytes);
+    virtual void setTexEnv(unsigned int name, int value)  { m_numStateChanges++; }
+    virtual void setTexEnvColor(const float color[4])     { m_numStateChanges++; }
+
+    //Geometry
+    virtual void setVertexArrays(GLVertex* vertices, bool secondaryColor) {}
+    virtual void drawTriangles(int numVertices);
+    virtual void drawQuad(const RenderQuadVertex vertices[4], const float color[4], const float* secondaryColor, bool textured);
+
+    //Frame
+    virtual void finish() {}
+    virtual void readPixels(void* dest, int width, int height, bool front);
+    virtual void callRenderingCallback(void (*callback)(int), int drawFlag) { callback(drawFlag); }
+    virtual void swapBuffers();
+    virtual void synchronize() {}
+    virtual void insertFrameFence() {}
+    virtual void waitFrameFence(int maxPendingFrames) {}
+    virtual void readPixelsAsync(unsigned int buffer, int width, int height) {}
+    virtual bool getAsyncPixels(unsigned int buffer, void* dest, bool wait, unsigned int stride) { return false; }
+    virtual bool isFramebufferSupported() { return false; }
+    virtual void downscale(bool front, int srcWidth, int srcHeight, int width, int height, bool box) {}
+    virtual void endDownscale() {}
+    virtual void createRenderTarget(unsigned int target, unsigned int texture, int width, int height) {}
+    virtual void deleteRenderTarget(unsigned int target) {}
+    virtual void bindRenderTarget(unsigned int target) {}
+
+public:
+
+    //Get Statistics
+    unsigned int getNumDrawCalls()      { return m_numDrawCalls;      }
+    unsigned int getNumVertices()       { return m_numVertices;       }
+    unsigned int getNumStateChanges()   { return m_numStateChanges;   }
+    unsigned int getNumClears()         { return m_numClears;         }
+    unsigned int getNumTextureUploads() { return m_numTextureUploads; }
+    unsigned int getNumTextureBinds()   { return m_numTextureBinds;   }
+    unsigned int getNumTextureBytes()   { return m_numTextureBytes;   }
+
+private:
+
+    //Reset counters and states
+    void _reset();
+
+private:
+
+    static const int MAX_CAPABILITIES  = 16;
+    static const unsigned int MAX_TEXTURE_UNITS = 8;
+
+    unsigned int m_capabilities[MAX_CAPABILITIES];  //!< Capabilities currently enabled
+    int          m_numCapabilities;                 //!< Number of capabilities currently enabled
+    bool         m_texture2D[MAX_TEXTURE_UNITS];    //!< Is GL_TEXTURE_2D enabled for texture unit?
+    unsigned int m_activeTextureUnit;               //!< Texture unit affected by texture calls
+    unsigned int m_lastTextureID;                   //!< Last texture id returned by generateTexture
+
+    unsigned int m_numDrawCalls;                    //!< Number of draw calls
+    unsigned int m_numVertices;                     //!< Number of vertices submitted
+    unsigned int m_numStateChanges;                 //!< Number of state changes
+    unsigned int m_numClears;                       //!< Number of buffer clears
+    unsigned int m_numTextureUploads;               //!< Number of texture uploads
+    unsigned int m_numTextureBinds;                 //!< Number of texture binds
+    unsigned int m_numTextureBytes;                 //!< Number of bytes uploaded to textures
+
+};
+
+#endif
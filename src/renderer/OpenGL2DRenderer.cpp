@@ -19,77 +19,81 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  *****************************************************************************/
 
-#include "OpenGL.h"
 #include "OpenGL2DRenderer.h"
-#include "VI.h"
-#include "m64p.h"
+#include "OpenGLRenderer.h"
 
 //-----------------------------------------------------------------------------
 //* Initialize
-//! Saves pointer to video interface
 //-----------------------------------------------------------------------------
-bool OpenGL2DRenderer::initialize(VI* vi)
+bool OpenGL2DRenderer::initialize()
 {
-    m_vi = vi;
     return true;
 }
 
+//-----------------------------------------------------------------------------
+//* Begin
+//! Has to be called before the states a quad is rendered with are updated.
+//! Renders batched quads if the new quad can not be added to them.
+//! @param textured Will the quad be textured?
+//! @param statesChanged Will texture or combiner states change?
+//-----------------------------------------------------------------------------
+void OpenGL2DRenderer::begin(bool textured, bool statesChanged)
+{
+    OpenGLRenderer& renderer = OpenGLRenderer::getSingleton();
+    VertexSpace space = textured ? VERTEX_SPACE_TEXTURED_SPRITE : VERTEX_SPACE_SPRITE;
+
+    if ( renderer.getNumVertices() > 0 && (statesChanged || renderer.getVertexSpace() != space) )
+    {
+        renderer.render();
+    }
+}
+
+//-----------------------------------------------------------------------------
+//* Flush
+//! Renders batched quads, used before clearing buffers
+//-----------------------------------------------------------------------------
+void OpenGL2DRenderer::flush()
+{
+    OpenGLRenderer& renderer = OpenGLRenderer::getSingleton();
+    if ( renderer.getNumVertices() > 0 )
+    {
+        renderer.render();
+    }
+}
+
 //-----------------------------------------------------------------------------
 //* Render Quad
-//! Renders a 2D rectangle in HUD.
-//! @todo Set Viewport
-//! @todo Reset Viewport
+//! Adds a 2D rectangle in HUD to the sprite batch.
 //-----------------------------------------------------------------------------
 void OpenGL2DRenderer::renderQuad( const float color[4], 
                                    float x0, float y0, 
                                    float x1, float y1,            
                                    float depth )
 {
-    //Get States
-    GLboolean scissor = glIsEnabled(GL_SCISSOR_TEST);
-    GLboolean cull    = glIsEnabled(GL_CULL_FACE);
-
-    //Set States
-    glDisable( GL_SCISSOR_TEST );
-    glDisable( GL_CULL_FACE );
-
-    //Set Othographic Projection Matrix
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    glOrtho(0, m_vi->getWidth(), m_vi->getHeight(), 0, 1.0f, -1.0f);
-
-    //TODO Set Viewport
-    //glViewport(0, glheightOffset, glwidth, glheight);
-    //glDepthRange( 0.0f, 1.0f );
-
-    //Render Quad
-    glColor4fv(color);
-    glBegin(GL_QUADS);
-        glVertex3f(x0, y0, depth);
-        glVertex3f(x1, y0, depth);
-        glVertex3f(x1, y1, depth);
-        glVertex3f(x0, y1, depth);
-    glEnd();
-
-    //Reset Projection Matrix
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-    glMatrixMode(GL_MODELVIEW);
-
-    //Reset States
-    if ( scissor ) glEnable(GL_SCISSOR_TEST);
-    if ( cull ) glEnable(GL_CULL_FACE);
-    
-    //TODO Reset viewport?    
+    _setVertex(0, x0, y0, depth, 0, 0, 0, 0);
+    _setVertex(1, x1, y0, depth, 0, 0, 0, 0);
+    _setVertex(2, x1, y1, depth, 0, 0, 0, 0);
+    _setVertex(3, x0, y1, depth, 0, 0, 0, 0);
+
+    for (int i=0; i<4; ++i)
+    {
+        m_quad[i].color.r = color[0];
+        m_quad[i].color.g = color[1];
+        m_quad[i].color.b = color[2];
+        m_quad[i].color.a = color[3];
+        m_quad[i].secondaryColor.r = 0.0f;
+        m_quad[i].secondaryColor.g = 0.0f;
+        m_quad[i].secondaryColor.b = 0.0f;
+        m_quad[i].secondaryColor.a = 1.0f;
+    }
+
+    OpenGLRenderer::getSingleton().addSprite(m_quad, false);
 }
 
 
 //-----------------------------------------------------------------------------
 //* Render Textured Quad
-//! Renders a textured 2D rectangle in HUD.
-//! @todo Set Viewport
-//! @todo Reset Viewport
+//! Adds a textured 2D rectangle in HUD to the sprite batch.
 //-----------------------------------------------------------------------------
 void OpenGL2DRenderer::renderTexturedQuad( const float color[4], 
                                            const float secondaryColor[4],
@@ -101,66 +105,30 @@ void OpenGL2DRenderer::renderTexturedQuad( const float color[4],
                                            float t1s0, float t1t0, 
                                            float t1s1, float t1t1 )
 {
-    //Get States
-    GLboolean cull = glIsEnabled(GL_CULL_FACE);
-    GLboolean fog  = glIsEnabled(GL_FOG);
-
-    //Set States
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_FOG);
-
-    //Set Orthographic Projection
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    glOrtho(0, m_vi->getWidth(), m_vi->getHeight(), 0, 1.0f, -1.0f);
-
-    //TODO Set Viewport
-    //glViewport(0, glheightOffset, glwidth, glheight);
-    //glDepthRange( 0.0f, 1.0f );
-
-    //Set Color
-    glColor4fv( color );
-
-    //Render Rectangle
-    glBegin(GL_QUADS);
-    {    
-        //Vertex 00
-        glTexCoord2f(t0s0, t0t0);    
-        glVertex3f(x0, y0, depth);   
-
-        //Vertex 10
-        glTexCoord2f(t0s1, t0t0);    
-        glVertex3f(x1, y0, depth);
-
-        //Vertex 11
-        glTexCoord2f(t0s1, t0t1 );   
-        glVertex3f(x1, y1, depth);
-
-        //Vertex 01
-        glTexCoord2f(t0s0, t0t1 );   
-        glVertex3f(x0, y1, depth);
+    _setVertex(0, x0, y0, depth, t0s0, t0t0, t1s0, t1t0);     //Vertex 00
+    _setVertex(1, x1, y0, depth, t0s1, t0t0, t1s1, t1t0);     //Vertex 10
+    _setVertex(2, x1, y1, depth, t0s1, t0t1, t1s1, t1t1);     //Vertex 11
+    _setVertex(3, x0, y1, depth, t0s0, t0t1, t1s0, t1t1);     //Vertex 01
+
+    for (int i=0; i<4; ++i)
+    {
+        m_quad[i].color.r = color[0];
+        m_quad[i].color.g = color[1];
+        m_quad[i].color.b = color[2];
+        m_quad[i].color.a = color[3];
+        m_quad[i].secondaryColor.r = secondaryColor[0];
+        m_quad[i].secondaryColor.g = secondaryColor[1];
+        m_quad[i].secondaryColor.b = secondaryColor[2];
+        m_quad[i].secondaryColor.a = secondaryColor[3];
     }
-    glEnd();
-    
-    //Reset Projection Matrix
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-    glMatrixMode(GL_MODELVIEW);
-
-    //Reset States
-    if ( cull ) glEnable(GL_CULL_FACE);
-    if ( fog ) glEnable(GL_FOG);
-
-    //TODO Reset viewport?    
+
+    OpenGLRenderer::getSingleton().addSprite(m_quad, true);
 }
 
 
 //-----------------------------------------------------------------------------
 //Render Flipped Textured Quad
-//! Renders a flipped textured 2D rectangle in HUD.
-//! @todo Set Viewport
-//! @todo Reset Viewport
+//! Adds a flipped textured 2D rectangle in HUD to the sprite batch.
 //-----------------------------------------------------------------------------
 void OpenGL2DRenderer::renderFlippedTexturedQuad( const float color[4], 
                                 const float secondaryColor[4],
@@ -172,57 +140,41 @@ void OpenGL2DRenderer::renderFlippedTexturedQuad( const float color[4],
                                 float t1s0, float t1t0, 
                                 float t1s1, float t1t1 )
 {
-    //Get States
-    GLboolean cull = glIsEnabled(GL_CULL_FACE);
-    GLboolean fog  = glIsEnabled(GL_FOG);
-
-    //Set States
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_FOG);
-
-    //Set Orthographic Projection
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    glOrtho(0, m_vi->getWidth(), m_vi->getHeight(), 0, 1.0f, -1.0f);
-
-    //TODO
-    //glViewport(0, glheightOffset, glwidth, glheight);
-    //glDepthRange( 0.0f, 1.0f );
-
-    //Set Color
-    glColor4fv( color );
-
-    //Render Rectangle
-    glBegin(GL_QUADS);
-    {    
-        //Vertex 00
-        glTexCoord2f(t0s0, t0t0);        //00
-        glVertex3f(x0, y0, depth);   
-
-        //Vertex 10
-        glTexCoord2f(t0s0, t0t1);        //01 !
-        glVertex3f(x1, y0, depth);
-
-        //Vertex 11
-        glTexCoord2f(t0s1, t0t1);        //11
-        glVertex3f(x1, y1, depth);
-
-        //Vertex 01
-        glTexCoord2f(t0s1, t0t0);        //10  !
-        glVertex3f(x0, y1, depth);
+    _setVertex(0, x0, y0, depth, t0s0, t0t0, t1s0, t1t0);     //Vertex 00
+    _setVertex(1, x1, y0, depth, t0s0, t0t1, t1s0, t1t1);     //Vertex 10 (01)
+    _setVertex(2, x1, y1, depth, t0s1, t0t1, t1s1, t1t1);     //Vertex 11
+    _setVertex(3, x0, y1, depth, t0s1, t0t0, t1s1, t1t0);     //Vertex 01 (10)
+
+    for (int i=0; i<4; ++i)
+    {
+        m_quad[i].color.r = color[0];
+        m_quad[i].color.g = color[1];
+        m_quad[i].color.b = color[2];
+        m_quad[i].color.a = color[3];
+        m_quad[i].secondaryColor.r = secondaryColor[0];
+        m_quad[i].secondaryColor.g = secondaryColor[1];
+        m_quad[i].secondaryColor.b = secondaryColor[2];
+        m_quad[i].secondaryColor.a = secondaryColor[3];
     }
-    glEnd();
-    
-    //Reset Projection Matrix
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-    glMatrixMode(GL_MODELVIEW);
-
-    //Reset States
-    if ( cull ) glEnable(GL_CULL_FACE);
-    if ( fog ) glEnable(GL_FOG);
-
-    //TODO Reset viewport?    
+
+    OpenGLRenderer::getSingleton().addSprite(m_quad, true);
 }
 
+//-----------------------------------------------------------------------------
+//* Set Vertex
+//! Sets position and texture coordinates of a corner in m_quad
+//-----------------------------------------------------------------------------
+void OpenGL2DRenderer::_setVertex( int index, float x, float y, float depth, 
+                                   float s0, float t0, float s1, float t1 )
+{
+    GLVertex& vertex = m_quad[index];
+    vertex.x   = x;
+    vertex.y   = y;
+    vertex.z   = depth;
+    vertex.w   = 1.0f;
+    vertex.s0  = s0;
+    vertex.t0  = t0;
+    vertex.s1  = s1;
+    vertex.t1  = t1;
+    vertex.fog = 0.0f;
+}
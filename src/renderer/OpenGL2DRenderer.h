@@ -22,20 +22,28 @@
 #ifndef OPEN_GL_2D_RENDERER_H_
 #define OPEN_GL_2D_RENDERER_H_
 
-//Forward declarations
-class VI;
+#include "OpenGLRenderer.h"
 
 //*****************************************************************************
 //* OpenGL 2D Renderer
 //! Class used to render HUD objects.
 //! @details Renders 2D quads, textured 2D quads and flipped textures 2D quads.
+//!          Quads are batched as sprites by OpenGLRenderer, a run of 2D
+//!          commands is rendered with one draw call until texture or
+//!          combiner states change.
 //*****************************************************************************
 class OpenGL2DRenderer
 {
 public:
 
     //Initialize
-    bool initialize(VI* vi);
+    bool initialize();
+
+    //Begin quad, renders batched quads that can not be continued
+    void begin(bool textured, bool statesChanged);
+
+    //Render batched quads
+    void flush();
 
     //Render Quad
     void renderQuad( const float color[4], 
@@ -66,10 +74,15 @@ public:
                                     float t1s0, float t1t0, 
                                     float t1s1, float t1t1 );
 
+private:
+
+    //Set vertex of quad
+    void _setVertex( int index, float x, float y, float depth, 
+                     float s0, float t0, float s1, float t1 );
 
 private:
 
-    VI* m_vi;  //!< Video interface
+    GLVertex m_quad[4];  //!< Quad being added to sprite batch
  
 };
 
@@ -0,0 +1,853 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "MultiTexturingExt.h"
+#include "OpenGL.h"
+#include "OpenGLRenderDevice.h"
+#include "OpenGLRenderer.h"
+#include "SecondaryColorExt.h"
+#include "m64p.h"
+
+#ifndef GL_GLEXT_VERSION
+    //Fog coordinate function is loaded by FogManager
+    typedef void (APIENTRY * PFNGLFOGCOORDPOINTEREXTPROC) (GLenum type, GLsizei stride, const GLvoid *pointer);
+    extern PFNGLFOGCOORDPOINTEREXTPROC glFogCoordPointerEXT;
+
+    //-----------------------------------------------------------------------------
+    //ARB_sync Definitions
+    //-----------------------------------------------------------------------------
+    typedef struct __GLsync *GLsync;
+    typedef unsigned long long GLuint64;
+    #define GL_SYNC_GPU_COMMANDS_COMPLETE     0x9117
+    #define GL_SYNC_FLUSH_COMMANDS_BIT        0x00000001
+    #define GL_TIMEOUT_EXPIRED                0x911B
+    typedef GLsync (APIENTRY * PFNGLFENCESYNCPROC) (GLenum condition, GLbitfield flags);
+    typedef void (APIENTRY * PFNGLDELETESYNCPROC) (GLsync sync);
+    typedef GLenum (APIENTRY * PFNGLCLIENTWAITSYNCPROC) (GLsync sync, GLbitfield flags, GLuint64 timeout);
+    static PFNGLFENCESYNCPROC      glFenceSync      = NULL;
+    static PFNGLDELETESYNCPROC     glDeleteSync     = NULL;
+    static PFNGLCLIENTWAITSYNCPROC glClientWaitSync = NULL;
+
+    //-----------------------------------------------------------------------------
+    //Pixel Buffer Object Definitions
+    //-----------------------------------------------------------------------------
+    typedef ptrdiff_t GLsizeiptr;
+    #define GL_PIXEL_PACK_BUFFER              0x88EB
+    #define GL_STREAM_READ                    0x88E1
+    #define GL_READ_ONLY                      0x88B8
+    typedef void (APIENTRY * PFNGLGENBUFFERSPROC) (GLsizei n, GLuint *buffers);
+    typedef void (APIENTRY * PFNGLDELETEBUFFERSPROC) (GLsizei n, const GLuint *buffers);
+    typedef void (APIENTRY * PFNGLBINDBUFFERPROC) (GLenum target, GLuint buffer);
+    typedef void (APIENTRY * PFNGLBUFFERDATAPROC) (GLenum target, GLsizeiptr size, const GLvoid *data, GLenum usage);
+    typedef GLvoid* (APIENTRY * PFNGLMAPBUFFERPROC) (GLenum target, GLenum access);
+    typedef GLboolean (APIENTRY * PFNGLUNMAPBUFFERPROC) (GLenum target);
+    static PFNGLGENBUFFERSPROC    glGenBuffers    = NULL;
+    static PFNGLDELETEBUFFERSPROC glDeleteBuffers = NULL;
+    static PFNGLBINDBUFFERPROC    glBindBuffer    = NULL;
+    static PFNGLBUFFERDATAPROC    glBufferData    = NULL;
+    static PFNGLMAPBUFFERPROC     glMapBuffer     = NULL;
+    static PFNGLUNMAPBUFFERPROC   glUnmapBuffer   = NULL;
+
+    //-----------------------------------------------------------------------------
+    //Framebuffer Object Definitions
+    //-----------------------------------------------------------------------------
+    #define GL_READ_FRAMEBUFFER               0x8CA8
+    #define GL_DRAW_FRAMEBUFFER               0x8CA9
+    #define GL_RENDERBUFFER                   0x8D41
+    #define GL_FRAMEBUFFER                    0x8D40
+    #define GL_COLOR_ATTACHMENT0              0x8CE0
+    #define GL_DEPTH_ATTACHMENT               0x8D00
+    #define GL_DEPTH_COMPONENT24              0x81A6
+    typedef void (APIENTRY * PFNGLGENFRAMEBUFFERSPROC) (GLsizei n, GLuint *framebuffers);
+    typedef void (APIENTRY * PFNGLDELETEFRAMEBUFFERSPROC) (GLsizei n, const GLuint *framebuffers);
+    typedef void (APIENTRY * PFNGLBINDFRAMEBUFFERPROC) (GLenum target, GLuint framebuffer);
+    typedef void (APIENTRY * PFNGLFRAMEBUFFERTEXTURE2DPROC) (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+    typedef void (APIENTRY * PFNGLFRAMEBUFFERRENDERBUFFERPROC) (GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer);
+    typedef void (APIENTRY * PFNGLGENRENDERBUFFERSPROC) (GLsizei n, GLuint *renderbuffers);
+    typedef void (APIENTRY * PFNGLDELETERENDERBUFFERSPROC) (GLsizei n, const GLuint *renderbuffers);
+    typedef void (APIENTRY * PFNGLBINDRENDERBUFFERPROC) (GLenum target, GLuint renderbuffer);
+    typedef void (APIENTRY * PFNGLRENDERBUFFERSTORAGEPROC) (GLenum target, GLenum internalformat, GLsizei width, GLsizei height);
+    typedef void (APIENTRY * PFNGLBLITFRAMEBUFFERPROC) (GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter);
+    static PFNGLGENFRAMEBUFFERSPROC         glGenFramebuffers         = NULL;
+    static PFNGLDELETEFRAMEBUFFERSPROC      glDeleteFramebuffers      = NULL;
+    static PFNGLBINDFRAMEBUFFERPROC         glBindFramebuffer         = NULL;
+    static PFNGLFRAMEBUFFERTEXTURE2DPROC    glFramebufferTexture2D    = NULL;
+    static PFNGLFRAMEBUFFERRENDERBUFFERPROC glFramebufferRenderbuffer = NULL;
+    static PFNGLGENRENDERBUFFERSPROC        glGenRenderbuffers        = NULL;
+    static PFNGLDELETERENDERBUFFERSPROC     glDeleteRenderbuffers     = NULL;
+    static PFNGLBINDRENDERBUFFERPROC        glBindRenderbuffer        = NULL;
+    static PFNGLRENDERBUFFERSTORAGEPROC     glRenderbufferStorage     = NULL;
+    static PFNGLBLITFRAMEBUFFERPROC         glBlitFramebuffer         = NULL;
+#endif
+
+#ifndef GL_SAMPLES
+    #define GL_SAMPLES                        0x80A9
+#endif
+
+//! Time glClientWaitSync blocks before it is called again (nanoseconds)
+#define FRAME_FENCE_TIMEOUT 1000000ULL
+
+//-----------------------------------------------------------------------------
+// Is GL Version
+//! Checks if the context is at least the given OpenGL version
+//-----------------------------------------------------------------------------
+static bool isGLVersion(int major, int minor)
+{
+    const char* version = (const char*)glGetString(GL_VERSION);
+    int contextMajor = 0, contextMinor = 0;
+    if ( !version || sscanf(version, "%d.%d", &contextMajor, &contextMinor) != 2 )
+    {
+        return false;
+    }
+    return contextMajor > major || (contextMajor == major && contextMinor >= minor);
+}
+
+//-----------------------------------------------------------------------------
+//! Constructor
+//-----------------------------------------------------------------------------
+OpenGLRenderDevice::OpenGLRenderDevice()
+{
+    m_extensionsChecked = false;
+    m_syncSupported     = false;
+    m_pboSupported      = false;
+    m_doubleBuffered    = true;
+    m_fboSupported      = false;
+    m_samples           = 0;
+    m_downscaleActive   = false;
+    m_renderTarget      = 0;
+    m_firstFence        = 0;
+    m_numFences         = 0;
+    memset(m_readbackBuffers, 0, sizeof(m_readbackBuffers));
+    memset(m_readbackSizes, 0, sizeof(m_readbackSizes));
+    memset(m_readbackRowBytes, 0, sizeof(m_readbackRowBytes));
+    memset(m_readbackFences, 0, sizeof(m_readbackFences));
+    memset(m_downscaleFramebuffers, 0, sizeof(m_downscaleFramebuffers));
+    memset(m_downscaleRenderbuffers, 0, sizeof(m_downscaleRenderbuffers));
+    memset(m_downscaleWidths, 0, sizeof(m_downscaleWidths));
+    memset(m_downscaleHeights, 0, sizeof(m_downscaleHeights));
+    memset(m_targetFramebuffers, 0, sizeof(m_targetFramebuffers));
+    memset(m_targetDepthbuffers, 0, sizeof(m_targetDepthbuffers));
+}
+
+//-----------------------------------------------------------------------------
+//! Initialize
+//-----------------------------------------------------------------------------
+bool OpenGLRenderDevice::initialize()
+{
+    //Context is not created yet, extensions are queried by first use
+    m_extensionsChecked = false;
+    m_firstFence        = 0;
+    m_numFences         = 0;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Dispose
+//-----------------------------------------------------------------------------
+void OpenGLRenderDevice::dispose()
+{
+    while ( m_numFences > 0 )
+    {
+        glDeleteSync((GLsync)m_frameFences[m_firstFence]);
+        m_firstFence = (m_firstFence + 1) % MAX_FRAME_FENCES;
+        m_numFences--;
+    }
+    m_firstFence = 0;
+
+    for (int i=0; i<MAX_READBACK_BUFFERS; ++i)
+    {
+        if ( m_readbackFences[i] )
+        {
+            glDeleteSync((GLsync)m_readbackFences[i]);
+            m_readbackFences[i] = 0;
+        }
+        if ( m_readbackBuffers[i] )
+        {
+            glDeleteBuffers(1, &m_readbackBuffers[i]);
+            m_readbackBuffers[i] = 0;
+        }
+        m_readbackSizes[i] = 0;
+    }
+
+    for (int i=0; i<MAX_DOWNSCALE_LEVELS; ++i)
+    {
+        if ( m_downscaleFramebuffers[i] )
+        {
+            glDeleteFramebuffers(1, &m_downscaleFramebuffers[i]);
+            glDeleteRenderbuffers(1, &m_downscaleRenderbuffers[i]);
+            m_downscaleFramebuffers[i] = m_downscaleRenderbuffers[i] = 0;
+        }
+        m_downscaleWidths[i] = m_downscaleHeights[i] = 0;
+    }
+    m_downscaleActive = false;
+
+    for (unsigned int i=1; i<=MAX_RENDER_TARGETS; ++i)
+    {
+        deleteRenderTarget(i);
+    }
+    m_renderTarget = 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Is Extension Supported
+//-----------------------------------------------------------------------------
+bool OpenGLRenderDevice::isExtensionSupported(const char* extension)
+{
+    const GLubyte *extensions = NULL;
+    const GLubyte *start;
+    GLubyte *where, *terminator;
+
+    where = (GLubyte *) strchr(extension, ' ');
+    if (where || *extension == '\0')
+        return false;
+
+    extensions = glGetString(GL_EXTENSIONS);
+    if ( !extensions )
+        return false;
+
+    start = extensions;
+    for (;;)
+    {
+        where = (GLubyte *) strstr((const char *) start, extension);
+        if (!where)
+            break;
+
+        terminator = where + strlen(extension);
+        if (where == start || *(where - 1) == ' ')
+            if (*terminator == ' ' || *terminator == '\0')
+                return true;
+
+        start = terminator;
+    }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+// Capabilities
+//-----------------------------------------------------------------------------
+void OpenGLRenderDevice::enable(unsigned int capability)           { glEnable(capability);                    }
+void OpenGLRenderDevice::disable(unsigned int capability)          { glDisable(capability);                   }
+bool OpenGLRenderDevice::isEnabled(unsigned int capability)        { return glIsEnabled(capability) == GL_TRUE; }
+void OpenGLRenderDevice::enableClientState(unsigned int array)     { glEnableClientState(array);              }
+void OpenGLRenderDevice::disableClientState(unsigned int array)    { glDisableClientState(array);             }
+
+//-----------------------------------------------------------------------------
+// States
+//-----------------------------------------------------------------------------
+void OpenGLRenderDevice::setBlendFunc(unsigned int sourceFactor, unsigned int destinationFactor)
+{
+    glBlendFunc(sourceFactor, destinationFactor);
+}
+
+void OpenGLRenderDevice::setDepthFunc(unsigned int func)               { glDepthFunc(func);                        }
+void OpenGLRenderDevice::setDepthMask(bool write)                      { glDepthMask(write ? GL_TRUE : GL_FALSE);  }
+void OpenGLRenderDevice::setDepthRange(float zNear, float zFar)        { glDepthRange(zNear, zFar);                }
+void OpenGLRenderDevice::setAlphaFunc(unsigned int func, float ref)    { glAlphaFunc(func, ref);                   }
+void OpenGLRenderDevice::setPolygonOffset(float factor, float units)   { glPolygonOffset(factor, units);           }
+void OpenGLRenderDevice::setPolygonMode(unsigned int face, unsigned int mode) { glPolygonMode(face, mode);         }
+void OpenGLRenderDevice::setCullFace(unsigned int face)                { glCullFace(face);                         }
+void OpenGLRenderDevice::setViewport(int x, int y, int width, int height) { glViewport(x, y, width, height);       }
+void OpenGLRenderDevice::setScissor(int x, int y, int width, int height)  { glScissor(x, y, width, height);        }
+
+//-----------------------------------------------------------------------------
+// Fog
+//-----------------------------------------------------------------------------
+void OpenGLRenderDevice::setFogParameteri(unsigned int name, int value)   { glFogi(name, value);  }
+void OpenGLRenderDevice::setFogParameterf(unsigned int name, float value) { glFogf(name, value);  }
+void OpenGLRenderDevice::setFogColor(const float color[4])                { glFogfv(GL_FOG_COLOR, color); }
+
+void OpenGLRenderDevice::setFogCoordPointer(unsigned int type, int stride, const void* pointer)
+{
+    glFogCoordPointerEXT(type, stride, pointer);
+}
+
+//-----------------------------------------------------------------------------
+// Clear
+//-----------------------------------------------------------------------------
+void OpenGLRenderDevice::setClearColor(float r, float g, float b, float a) { glClearColor(r, g, b, a); }
+void OpenGLRenderDevice::clear(unsigned int mask)                          { glClear(mask);            }
+
+//-----------------------------------------------------------------------------
+// Matrices
+//-----------------------------------------------------------------------------
+void OpenGLRenderDevice::setMatrixMode(unsigned int mode) { glMatrixMode(mode); }
+void OpenGLRenderDevice::loadIdentity()                   { glLoadIdentity();   }
+void OpenGLRenderDevice::pushMatrix()                     { glPushMatrix();     }
+void OpenGLRenderDevice::popMatrix()                      { glPopMatrix();      }
+
+void OpenGLRenderDevice::ortho(double left, double right, double bottom, double top, double zNear, double zFar)
+{
+    glOrtho(left, right, bottom, top, zNear, zFar);
+}
+
+//-----------------------------------------------------------------------------
+// Textures
+//-----------------------------------------------------------------------------
+void OpenGLRenderDevice::generateTexture(unsigned int* id)  { glGenTextures(1, (GLuint*)id);           }
+void OpenGLRenderDevice::deleteTexture(unsigned int* id)    { glDeleteTextures(1, (GLuint*)id);        }
+void OpenGLRenderDevice::bindTexture(unsigned int id)       { glBindTexture(GL_TEXTURE_2D, id);        }
+void OpenGLRenderDevice::setActiveTexture(unsigned int unit){ glActiveTextureARB(GL_TEXTURE0_ARB + unit); }
+
+void OpenGLRenderDevice::setTextureParameter(unsigned int name, int value)
+{
+    glTexParameteri(GL_TEXTURE_2D, name, value);
+}
+
+void OpenGLRenderDevice::uploadTexture(int internalFormat, int width, int height, unsigned int format, unsigned int type, 
+                                       const void* pixels, unsigned int numBytes)
+{
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, pixels);
+}
+
+void OpenGLRenderDevice::setTexEnv(unsigned int name, int value)  { glTexEnvi(GL_TEXTURE_ENV, name, value);                 }
+void OpenGLRenderDevice::setTexEnvColor(const float color[4])     { glTexEnvfv(GL_TEXTURE_ENV, GL_TEXTURE_ENV_COLOR, color); }
+
+//-----------------------------------------------------------------------------
+//* Set Vertex Arrays
+//! Points OpenGL vertex arrays to the renderers vertex buffer
+//-----------------------------------------------------------------------------
+void OpenGLRenderDevice::setVertexArrays(GLVertex* vertices, bool secondaryColor)
+{
+    //Vertices
+    glVertexPointer(4, GL_FLOAT, sizeof(GLVertex), &vertices[0].x );
+    glEnableClientState( GL_VERTEX_ARRAY );
+
+    //Colors
+    glColorPointer(4, GL_FLOAT, sizeof(GLVertex), &vertices[0].color.r);
+    glEnableClientState( GL_COLOR_ARRAY );
+
+    //Secondary Color
+    if ( secondaryColor )
+    {
+        glSecondaryColorPointerEXT( 3, GL_FLOAT, sizeof( GLVertex ), &vertices[0].secondaryColor.r );
+        glEnableClientState( GL_SECONDARY_COLOR_ARRAY_EXT );
+    }
+
+    //Textureing 0
+    glClientActiveTextureARB( GL_TEXTURE0_ARB ); 
+    glTexCoordPointer( 2, GL_FLOAT, sizeof( GLVertex ), &vertices[0].s0 );
+    glEnableClientState( GL_TEXTURE_COORD_ARRAY );
+
+    //Textureing 1
+    glClientActiveTextureARB( GL_TEXTURE1_ARB );
+    glTexCoordPointer( 2, GL_FLOAT, sizeof( GLVertex ), &vertices[0].s1 );
+    glEnableClientState( GL_TEXTURE_COORD_ARRAY );
+}
+
+//-----------------------------------------------------------------------------
+//! Draw Triangles
+//-----------------------------------------------------------------------------
+void OpenGLRenderDevice::drawTriangles(int numVertices)
+{
+    glDrawArrays(GL_TRIANGLES, 0, numVertices);
+}
+
+//-----------------------------------------------------------------------------
+//* Draw Quad
+//! Draws a rectangle using immediate mode
+//! @param secondaryColor Secondary color or 0 to leave it unchanged
+//! @param textured Send texture coordinates for first texture unit?
+//-----------------------------------------------------------------------------
+void OpenGLRenderDevice::drawQuad(const RenderQuadVertex vertices[4], const float color[4], const float* secondaryColor, bool textured)
+{
+    glColor4fv(color);
+    if ( secondaryColor )
+    {
+        glSecondaryColor3fEXT(secondaryColor[0], secondaryColor[1], secondaryColor[2]);
+    }
+
+    glBegin(GL_QUADS);
+    for (int i=0; i<4; ++i)
+    {
+        if ( textured )
+        {
+            glTexCoord2f(vertices[i].s, vertices[i].t);
+        }
+        glVertex3f(vertices[i].x, vertices[i].y, vertices[i].z);
+    }
+    glEnd();
+}
+
+//-----------------------------------------------------------------------------
+// Frame
+//-----------------------------------------------------------------------------
+void OpenGLRenderDevice::finish()
+{
+    glFinish();
+}
+
+void OpenGLRenderDevice::readPixels(void* dest, int width, int height, bool front)
+{
+    if ( !m_downscaleActive )
+    {
+        glReadBuffer( front ? GL_FRONT : GL_BACK );
+    }
+
+    //dest has no row padding
+    glPixelStorei( GL_PACK_ALIGNMENT, 1 );
+    glReadPixels( 0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, dest );
+    glPixelStorei( GL_PACK_ALIGNMENT, 4 );
+}
+
+void OpenGLRenderDevice::swapBuffers()
+{
+    CoreVideo_GL_SwapBuffers();
+}
+
+//-----------------------------------------------------------------------------
+//* Insert Frame Fence
+//! Marks the end of a frame's commands. Without sync objects the frame is
+//! finished here instead, like before fences were used.
+//-----------------------------------------------------------------------------
+void OpenGLRenderDevice::insertFrameFence()
+{
+    if ( !m_extensionsChecked )
+    {
+        _initializeExtensions();
+    }
+
+    if ( !m_syncSupported )
+    {
+        glFinish();
+        return;
+    }
+
+    //Never keep more fences than the ring holds
+    if ( m_numFences == MAX_FRAME_FENCES )
+    {
+        _waitOldestFence();
+    }
+
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    if ( !fence )
+    {
+        glFinish();
+        return;
+    }
+    m_frameFences[(m_firstFence + m_numFences) % MAX_FRAME_FENCES] = fence;
+    m_numFences++;
+}
+
+//-----------------------------------------------------------------------------
+//* Wait Frame Fence
+//! Blocks until at most maxPendingFrames fenced frames are still executing
+//! on the GPU. 0 waits for the last fenced frame.
+//-----------------------------------------------------------------------------
+void OpenGLRenderDevice::waitFrameFence(int maxPendingFrames)
+{
+    while ( m_numFences > maxPendingFrames )
+    {
+        _waitOldestFence();
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Wait Oldest Fence
+//-----------------------------------------------------------------------------
+void OpenGLRenderDevice::_waitOldestFence()
+{
+    GLsync fence = (GLsync)m_frameFences[m_firstFence];
+
+    //Flush once so the fence is guaranteed to signal, then poll in slices
+    GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FRAME_FENCE_TIMEOUT);
+    while ( result == GL_TIMEOUT_EXPIRED )
+    {
+        result = glClientWaitSync(fence, 0, FRAME_FENCE_TIMEOUT);
+    }
+
+    glDeleteSync(fence);
+    m_firstFence = (m_firstFence + 1) % MAX_FRAME_FENCES;
+    m_numFences--;
+}
+
+//-----------------------------------------------------------------------------
+//* Read Pixels Async
+//! Starts reading the frame about to be swapped into pixel pack buffer
+//! 'buffer'. The copy is done by the GPU, getAsyncPixels fetches it later.
+//-----------------------------------------------------------------------------
+void OpenGLRenderDevice::readPixelsAsync(unsigned int buffer, int width, int height)
+{
+    if ( !m_extensionsChecked )
+    {
+        _initializeExtensions();
+    }
+    if ( !m_pboSupported || buffer >= MAX_READBACK_BUFFERS )
+    {
+        return;
+    }
+
+    //Rows are packed without padding like readPixels, getAsyncPixels pads them to the stride it is asked for
+    unsigned int size = width * 3 * height;
+    m_readbackRowBytes[buffer] = width * 3;
+
+    if ( !m_readbackBuffers[buffer] )
+    {
+        glGenBuffers(1, &m_readbackBuffers[buffer]);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_readbackBuffers[buffer]);
+    if ( m_readbackSizes[buffer] != size )
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+        m_readbackSizes[buffer] = size;
+    }
+    if ( !m_downscaleActive )
+    {
+        glReadBuffer( m_doubleBuffered ? GL_BACK : GL_FRONT );
+    }
+    glPixelStorei( GL_PACK_ALIGNMENT, 1 );
+    glReadPixels( 0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, 0 );
+    glPixelStorei( GL_PACK_ALIGNMENT, 4 );
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if ( m_readbackFences[buffer] )
+    {
+        glDeleteSync((GLsync)m_readbackFences[buffer]);
+        m_readbackFences[buffer] = 0;
+    }
+    if ( m_syncSupported )
+    {
+        m_readbackFences[buffer] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//* Get Async Pixels
+//! Copies pixels read by readPixelsAsync to dest.
+//! @param wait   Wait for the copy to finish instead of failing if it has not
+//! @param stride Bytes between rows in dest, at least width * 3
+//! @return false if buffer holds no pixels or they are not ready yet
+//-----------------------------------------------------------------------------
+bool OpenGLRenderDevice::getAsyncPixels(unsigned int buffer, void* dest, bool wait, unsigned int stride)
+{
+    if ( !m_pboSupported || buffer >= MAX_READBACK_BUFFERS || m_readbackSizes[buffer] == 0 )
+    {
+        return false;
+    }
+
+    //Without sync objects mapping the buffer is the wait
+    GLsync fence = (GLsync)m_readbackFences[buffer];
+    if ( fence )
+    {
+        GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if ( result == GL_TIMEOUT_EXPIRED )
+        {
+            if ( !wait )
+            {
+                return false;
+            }
+            while ( result == GL_TIMEOUT_EXPIRED )
+            {
+                result = glClientWaitSync(fence, 0, FRAME_FENCE_TIMEOUT);
+            }
+        }
+        glDeleteSync(fence);
+        m_readbackFences[buffer] = 0;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_readbackBuffers[buffer]);
+    void* pixels = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if ( pixels )
+    {
+        unsigned int rowBytes = m_readbackRowBytes[buffer];
+        if ( stride == rowBytes )
+        {
+            memcpy(dest, pixels, m_readbackSizes[buffer]);
+        }
+        else
+        {
+            unsigned int height = m_readbackSizes[buffer] / rowBytes;
+            for (unsigned int y=0; y<height; ++y)
+            {
+                memcpy((unsigned char*)dest + y * stride, (unsigned char*)pixels + y * rowBytes, rowBytes);
+            }
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return pixels != 0;
+}
+
+//-----------------------------------------------------------------------------
+//* Is Framebuffer Supported
+//-----------------------------------------------------------------------------
+bool OpenGLRenderDevice::isFramebufferSupported()
+{
+    if ( !m_extensionsChecked )
+    {
+        _initializeExtensions();
+    }
+    return m_fboSupported;
+}
+
+//-----------------------------------------------------------------------------
+//* Downscale
+//! Scales the frame into a small framebuffer object on the GPU and makes it
+//! the source of readPixels and readPixelsAsync until endDownscale.
+//! @param front Scale front buffer (shown frame) instead of back buffer
+//! @param box   Halve the frame with 2x2 averages until it is less than twice
+//!              the requested size before the final bilinear step, so every
+//!              source pixel contributes. Otherwise one bilinear step.
+//-----------------------------------------------------------------------------
+void OpenGLRenderDevice::downscale(bool front, int srcWidth, int srcHeight, int width, int height, bool box)
+{
+    if ( !isFramebufferSupported() )
+    {
+        return;
+    }
+
+    //Blits are clipped by the scissor box
+    bool scissor = glIsEnabled(GL_SCISSOR_TEST) != GL_FALSE;
+    glDisable(GL_SCISSOR_TEST);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glReadBuffer( front || !m_doubleBuffered ? GL_FRONT : GL_BACK );
+
+    int level = 0;
+    int levelWidth = srcWidth, levelHeight = srcHeight;
+
+    //Multisampled buffers can only be blitted at same size
+    if ( m_samples > 0 )
+    {
+        _blitToLevel(level++, levelWidth, levelHeight, levelWidth, levelHeight, GL_NEAREST);
+    }
+
+    if ( box )
+    {
+        while ( levelWidth / 2 >= width && levelHeight / 2 >= height && level < MAX_DOWNSCALE_LEVELS - 1 )
+        {
+            _blitToLevel(level++, levelWidth, levelHeight, levelWidth / 2, levelHeight / 2, GL_LINEAR);
+            levelWidth  /= 2;
+            levelHeight /= 2;
+        }
+    }
+
+    if ( level == 0 || levelWidth != width || levelHeight != height )
+    {
+        _blitToLevel(level, levelWidth, levelHeight, width, height, GL_LINEAR);
+    }
+
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _getTargetFramebuffer());
+    if ( scissor )
+    {
+        glEnable(GL_SCISSOR_TEST);
+    }
+    m_downscaleActive = true;
+}
+
+//-----------------------------------------------------------------------------
+//* End Downscale
+//! Reads come from the window again
+//-----------------------------------------------------------------------------
+void OpenGLRenderDevice::endDownscale()
+{
+    if ( m_downscaleActive )
+    {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, _getTargetFramebuffer());
+        m_downscaleActive = false;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//* Create Render Target
+//! Allocates texture as color buffer of render target, with a depth buffer
+//! of the same size. Both are cleared. Existing target is resized.
+//! @param target  Render target, 1 to MAX_RENDER_TARGETS
+//! @param texture Texture name from generateTexture
+//-----------------------------------------------------------------------------
+void OpenGLRenderDevice::createRenderTarget(unsigned int target, unsigned int texture, int width, int height)
+{
+    if ( target == 0 || target > MAX_RENDER_TARGETS || !isFramebufferSupported() )
+    {
+        return;
+    }
+
+    GLint boundTexture = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &boundTexture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, boundTexture);
+
+    unsigned int index = target - 1;
+    if ( !m_targetFramebuffers[index] )
+    {
+        glGenFramebuffers(1, &m_targetFramebuffers[index]);
+        glGenRenderbuffers(1, &m_targetDepthbuffers[index]);
+    }
+    glBindRenderbuffer(GL_RENDERBUFFER, m_targetDepthbuffers[index]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_targetFramebuffers[index]);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_targetDepthbuffers[index]);
+
+    //Clear without changing scissor, clear color or depth mask
+    GLboolean depthMask = GL_TRUE;
+    GLfloat   clearColor[4];
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+    bool scissor = glIsEnabled(GL_SCISSOR_TEST) != GL_FALSE;
+    glDisable(GL_SCISSOR_TEST);
+    glDepthMask(GL_TRUE);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+    glDepthMask(depthMask);
+    if ( scissor )
+    {
+        glEnable(GL_SCISSOR_TEST);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, _getTargetFramebuffer());
+}
+
+//-----------------------------------------------------------------------------
+//* Delete Render Target
+//! Texture is deleted by its owner with deleteTexture
+//-----------------------------------------------------------------------------
+void OpenGLRenderDevice::deleteRenderTarget(unsigned int target)
+{
+    if ( target == 0 || target > MAX_RENDER_TARGETS || !m_targetFramebuffers[target - 1] )
+    {
+        return;
+    }
+    if ( m_renderTarget == target )
+    {
+        bindRenderTarget(0);
+    }
+
+    unsigned int index = target - 1;
+    glDeleteFramebuffers(1, &m_targetFramebuffers[index]);
+    glDeleteRenderbuffers(1, &m_targetDepthbuffers[index]);
+    m_targetFramebuffers[index] = m_targetDepthbuffers[index] = 0;
+}
+
+//-----------------------------------------------------------------------------
+//* Bind Render Target
+//! @param target Render target created with createRenderTarget, 0 for window
+//-----------------------------------------------------------------------------
+void OpenGLRenderDevice::bindRenderTarget(unsigned int target)
+{
+    if ( target > MAX_RENDER_TARGETS || (target != 0 && !m_targetFramebuffers[target - 1]) || target == m_renderTarget )
+    {
+        return;
+    }
+    m_renderTarget = target;
+    glBindFramebuffer(GL_FRAMEBUFFER, _getTargetFramebuffer());
+}
+
+//-----------------------------------------------------------------------------
+// Get Target Framebuffer
+//! @return Framebuffer object of bound render target, 0 for window
+//-----------------------------------------------------------------------------
+unsigned int OpenGLRenderDevice::_getTargetFramebuffer()
+{
+    return m_renderTarget ? m_targetFramebuffers[m_renderTarget - 1] : 0;
+}
+
+//-----------------------------------------------------------------------------
+// Blit To Level
+//! Copies the bound read framebuffer into downscale level 'level' and makes
+//! that level the read framebuffer.
+//-----------------------------------------------------------------------------
+void OpenGLRenderDevice::_blitToLevel(int level, int srcWidth, int srcHeight, int width, int height, unsigned int filter)
+{
+    if ( !m_downscaleFramebuffers[level] )
+    {
+        glGenFramebuffers(1, &m_downscaleFramebuffers[level]);
+        glGenRenderbuffers(1, &m_downscaleRenderbuffers[level]);
+    }
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_downscaleFramebuffers[level]);
+    if ( m_downscaleWidths[level] != width || m_downscaleHeights[level] != height )
+    {
+        glBindRenderbuffer(GL_RENDERBUFFER, m_downscaleRenderbuffers[level]);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        glFramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_downscaleRenderbuffers[level]);
+        m_downscaleWidths[level]  = width;
+        m_downscaleHeights[level] = height;
+    }
+
+    glBlitFramebuffer(0, 0, srcWidth, srcHeight, 0, 0, width, height, GL_COLOR_BUFFER_BIT, filter);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_downscaleFramebuffers[level]);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+}
+
+//-----------------------------------------------------------------------------
+// Initialize Extensions
+//! Queries sync object and pixel buffer object support, needs a context
+//-----------------------------------------------------------------------------
+void OpenGLRenderDevice::_initializeExtensions()
+{
+    m_extensionsChecked = true;
+    m_syncSupported = isGLVersion(3, 2) || isExtensionSupported("GL_ARB_sync");
+    m_pboSupported  = isGLVersion(2, 1) || isExtensionSupported("GL_ARB_pixel_buffer_object");
+    m_fboSupported  = isGLVersion(3, 0) || isExtensionSupported("GL_ARB_framebuffer_object");
+
+#ifndef GL_GLEXT_VERSION
+    if ( m_syncSupported )
+    {
+        glFenceSync      = (PFNGLFENCESYNCPROC)CoreVideo_GL_GetProcAddress("glFenceSync");
+        glDeleteSync     = (PFNGLDELETESYNCPROC)CoreVideo_GL_GetProcAddress("glDeleteSync");
+        glClientWaitSync = (PFNGLCLIENTWAITSYNCPROC)CoreVideo_GL_GetProcAddress("glClientWaitSync");
+        m_syncSupported  = glFenceSync && glDeleteSync && glClientWaitSync;
+    }
+    if ( m_pboSupported )
+    {
+        glGenBuffers    = (PFNGLGENBUFFERSPROC)CoreVideo_GL_GetProcAddress("glGenBuffers");
+        glDeleteBuffers = (PFNGLDELETEBUFFERSPROC)CoreVideo_GL_GetProcAddress("glDeleteBuffers");
+        glBindBuffer    = (PFNGLBINDBUFFERPROC)CoreVideo_GL_GetProcAddress("glBindBuffer");
+        glBufferData    = (PFNGLBUFFERDATAPROC)CoreVideo_GL_GetProcAddress("glBufferData");
+        glMapBuffer     = (PFNGLMAPBUFFERPROC)CoreVideo_GL_GetProcAddress("glMapBuffer");
+        glUnmapBuffer   = (PFNGLUNMAPBUFFERPROC)CoreVideo_GL_GetProcAddress("glUnmapBuffer");
+        m_pboSupported  = glGenBuffers && glDeleteBuffers && glBindBuffer && glBufferData && glMapBuffer && glUnmapBuffer;
+    }
+    if ( m_fboSupported )
+    {
+        glGenFramebuffers         = (PFNGLGENFRAMEBUFFERSPROC)CoreVideo_GL_GetProcAddress("glGenFramebuffers");
+        glDeleteFramebuffers      = (PFNGLDELETEFRAMEBUFFERSPROC)CoreVideo_GL_GetProcAddress("glDeleteFramebuffers");
+        glBindFramebuffer         = (PFNGLBINDFRAMEBUFFERPROC)CoreVideo_GL_GetProcAddress("glBindFramebuffer");
+        glFramebufferTexture2D    = (PFNGLFRAMEBUFFERTEXTURE2DPROC)CoreVideo_GL_GetProcAddress("glFramebufferTexture2D");
+        glFramebufferRenderbuffer = (PFNGLFRAMEBUFFERRENDERBUFFERPROC)CoreVideo_GL_GetProcAddress("glFramebufferRenderbuffer");
+        glGenRenderbuffers        = (PFNGLGENRENDERBUFFERSPROC)CoreVideo_GL_GetProcAddress("glGenRenderbuffers");
+        glDeleteRenderbuffers     = (PFNGLDELETERENDERBUFFERSPROC)CoreVideo_GL_GetProcAddress("glDeleteRenderbuffers");
+        glBindRenderbuffer        = (PFNGLBINDRENDERBUFFERPROC)CoreVideo_GL_GetProcAddress("glBindRenderbuffer");
+        glRenderbufferStorage     = (PFNGLRENDERBUFFERSTORAGEPROC)CoreVideo_GL_GetProcAddress("glRenderbufferStorage");
+        glBlitFramebuffer         = (PFNGLBLITFRAMEBUFFERPROC)CoreVideo_GL_GetProcAddress("glBlitFramebuffer");
+        m_fboSupported = glGenFramebuffers && glDeleteFramebuffers && glBindFramebuffer && glFramebufferTexture2D &&
+                         glFramebufferRenderbuffer && glGenRenderbuffers && glDeleteRenderbuffers && glBindRenderbuffer &&
+                         glRenderbufferStorage && glBlitFramebuffer;
+    }
+#endif
+
+    GLboolean doubleBuffered = GL_TRUE;
+    glGetBooleanv(GL_DOUBLEBUFFER, &doubleBuffered);
+    m_doubleBuffered = doubleBuffered != GL_FALSE;
+    glGetIntegerv(GL_SAMPLES, &m_samples);
+}
@@ -0,0 +1,157 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef OPEN_GL_RENDER_DEVICE_H_
+#define OPEN_GL_RENDER_DEVICE_H_
+
+#include "RenderDevice.h"
+
+//*****************************************************************************
+//* OpenGL Render Device
+//! Render device that forwards every call to OpenGL
+//*****************************************************************************
+class OpenGLRenderDevice : public RenderDevice
+{
+public:
+
+    static const int MAX_FRAME_FENCES     = 4;  //!< Frames that can be fenced at once
+    static const int MAX_READBACK_BUFFERS = 3;  //!< Pixel pack buffers for readPixelsAsync
+    static const int MAX_DOWNSCALE_LEVELS = 8;  //!< Framebuffers used by downscale
+    static const unsigned int MAX_RENDER_TARGETS = 8;  //!< Offscreen color images rendered to
+
+public:
+
+    //Constructor
+    OpenGLRenderDevice();
+
+    //Initialize / Dispose
+    virtual bool initialize();
+    virtual void dispose();
+
+    //Extensions
+    virtual bool isExtensionSupported(const char* extension);
+
+    //Capabilities
+    virtual void enable(unsigned int capability);
+    virtual void disable(unsigned int capability);
+    virtual bool isEnabled(unsigned int capability);
+    virtual void enableClientState(unsigned int array);
+    virtual void disableClientState(unsigned int array);
+
+    //States
+    virtual void setBlendFunc(unsigned int sourceFactor, unsigned int destinationFactor);
+    virtual void setDepthFunc(unsigned int func);
+    virtual void setDepthMask(bool write);
+    virtual void setDepthRange(float zNear, float zFar);
+    virtual void setAlphaFunc(unsigned int func, float reference);
+    virtual void setPolygonOffset(float factor, float units);
+    virtual void setPolygonMode(unsigned int face, unsigned int mode);
+    virtual void setCullFace(unsigned int face);
+    virtual void setViewport(int x, int y, int width, int height);
+    virtual void setScissor(int x, int y, int width, int height);
+
+    //Fog
+    virtual void setFogParameteri(unsigned int name, int value);
+    virtual void setFogParameterf(unsigned int name, float value);
+    virtual void setFogColor(const float color[4]);
+    virtual void setFogCoordPointer(unsigned int type, int stride, const void* pointer);
+
+    //Clear
+    virtual void setClearColor(float r, float g, float b, float a);
+    virtual void clear(unsigned int mask);
+
+    //Matrices
+    virtual void setMatrixMode(unsigned int mode);
+    virtual void loadIdentity();
+    virtual void pushMatrix();
+    virtual void popMatrix();
+    virtual void ortho(double left, double right, double bottom, double top, double zNear, double zFar);
+
+    //Textures
+    virtual void generateTexture(unsigned int* id);
+    virtual void deleteTexture(unsigned int* id);
+    virtual void bindTexture(unsigned int id);
+    virtual void setActiveTexture(unsigned int unit);
+    virtual void setTextureParameter(unsigned int name, int value);
+    virtual void uploadTexture(int internalFormat, int width, int height, unsigned int format, unsigned int type, 
+                               const void* pixels, unsigned int numBytes);
+    virtual void setTexEnv(unsigned int name, int value);
+    virtual void setTexEnvColor(const float color[4]);
+
+    //Geometry
+    virtual void setVertexArrays(GLVertex* vertices, bool secondaryColor);
+    virtual void drawTriangles(int numVertices);
+    virtual void drawQuad(const RenderQuadVertex vertices[4], const float color[4], const float* secondaryColor, bool textured);
+
+    //Frame
+    virtual void finish();
+    virtual void readPixels(void* dest, int width, int height, bool front);
+    virtual void callRenderingCallback(void (*callback)(int), int drawFlag) { callback(drawFlag); }
+    virtual void swapBuffers();
+    virtual void synchronize() {}
+    virtual void insertFrameFence();
+    virtual void waitFrameFence(int maxPendingFrames);
+    virtual void readPixelsAsync(unsigned int buffer, int width, int height);
+    virtual bool getAsyncPixels(unsigned int buffer, void* dest, bool wait, unsigned int stride);
+    virtual bool isFramebufferSupported();
+    virtual void downscale(bool front, int srcWidth, int srcHeight, int width, int height, bool box);
+    virtual void endDownscale();
+    virtual void createRenderTarget(unsigned int target, unsigned int texture, int width, int height);
+    virtual void deleteRenderTarget(unsigned int target);
+    virtual void bindRenderTarget(unsigned int target);
+
+private:
+
+    void _initializeExtensions();
+    void _waitOldestFence();
+    unsigned int _getTargetFramebuffer();
+    void _blitToLevel(int level, int srcWidth, int srcHeight, int width, int height, unsigned int filter);
+
+private:
+
+    bool  m_extensionsChecked;                  //!< Has extension support been queried?
+    bool  m_syncSupported;                      //!< ARB_sync (or GL 3.2) available?
+    bool  m_pboSupported;                       //!< ARB_pixel_buffer_object (or GL 2.1) available?
+    bool  m_doubleBuffered;                     //!< Does context have a back buffer?
+    bool  m_fboSupported;                       //!< ARB_framebuffer_object (or GL 3.0) available?
+    int   m_samples;                            //!< Samples per pixel of window, 0 if not multisampled
+    void* m_frameFences[MAX_FRAME_FENCES];      //!< Pending GLsync objects, oldest first at m_firstFence
+    int   m_firstFence;                         //!< Index of oldest pending fence
+    int   m_numFences;                          //!< Number of pending fences
+
+    unsigned int m_readbackBuffers[MAX_READBACK_BUFFERS];  //!< Pixel pack buffer names
+    unsigned int m_readbackSizes[MAX_READBACK_BUFFERS];    //!< Bytes read into each buffer, 0 if unused
+    unsigned int m_readbackRowBytes[MAX_READBACK_BUFFERS]; //!< Bytes per row in each buffer, rows are not padded
+    void*        m_readbackFences[MAX_READBACK_BUFFERS];   //!< GLsync signaled when each read is done
+
+    unsigned int m_downscaleFramebuffers[MAX_DOWNSCALE_LEVELS];   //!< Framebuffer of each downscale step
+    unsigned int m_downscaleRenderbuffers[MAX_DOWNSCALE_LEVELS];  //!< Color buffer of each downscale step
+    int          m_downscaleWidths[MAX_DOWNSCALE_LEVELS];         //!< Width of each downscale step
+    int          m_downscaleHeights[MAX_DOWNSCALE_LEVELS];        //!< Height of each downscale step
+    bool         m_downscaleActive;                               //!< Are reads done from last downscale step?
+
+    unsigned int m_targetFramebuffers[MAX_RENDER_TARGETS];        //!< Framebuffer object of each render target
+    unsigned int m_targetDepthbuffers[MAX_RENDER_TARGETS];        //!< Depth buffer of each render target
+    unsigned int m_renderTarget;                                  //!< Bound render target, 0 for window
+
+};
+
+#endif
@@ -22,6 +22,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdio>
 
 //#include "CombinerManager.h"
 #include "AdvancedCombinerManager.h"
@@ -37,6 +38,7 @@
 #include "RDP.h"
 #include "RSP.h"
 #include "RSPVertexManager.h"
+#include "RenderDevice.h"
 #include "SecondaryColorExt.h"
 #include "TextureCache.h"
 #include "TextureLoader.h"
@@ -59,7 +61,15 @@ bool EXT_secondary_color = false;
 //-----------------------------------------------------------------------------
 OpenGLRenderer::OpenGLRenderer()
 {
+    m_vertices = 0;
+    m_maxVertices = 0;
     m_numVertices = 0;
+    m_numOverflowFlushes = 0;
+    m_largestBatch = 0;
+    m_numDrawCalls = 0;
+    m_numSprites = 0;
+    m_numSpriteBatches = 0;
+    m_vertexSpace = VERTEX_SPACE_CLIP;
 }
 
 //-----------------------------------------------------------------------------
@@ -67,14 +77,14 @@ OpenGLRenderer::OpenGLRenderer()
 //-----------------------------------------------------------------------------
 OpenGLRenderer::~OpenGLRenderer()
 {
-
+    if ( m_vertices ) { delete[] m_vertices; m_vertices = 0; }
 }
 
 //-----------------------------------------------------------------------------
 //* Initialize
 //! Saves pointers and setup render OpenGl pointers to vertex data.
 //-----------------------------------------------------------------------------
-bool OpenGLRenderer::initialize(RSP* rsp, RDP* rdp, TextureCache* textureCache, VI* vi, FogManager* fogMgr)
+bool OpenGLRenderer::initialize(RSP* rsp, RDP* rdp, TextureCache* textureCache, VI* vi, FogManager* fogMgr, int vertexBufferSize)
 {
     m_rsp          = rsp;
     m_rdp          = rdp;
@@ -84,44 +94,43 @@ bool OpenGLRenderer::initialize(RSP* rsp, RDP* rdp, TextureCache* textureCache,
 
     m_numVertices  = 0;
     m_numTriangles = 0;
+    m_numOverflowFlushes = 0;
+    m_largestBatch = 0;
+    m_numDrawCalls = 0;
+    m_numSprites   = 0;
+    m_numSpriteBatches = 0;
+    m_vertexSpace  = VERTEX_SPACE_CLIP;
+
+    //Allocate vertex buffer (room for at least a few hundred triangles)
+    if ( m_vertices ) { delete[] m_vertices; m_vertices = 0; }
+    m_maxVertices = max(vertexBufferSize, 768) / 3 * 3;
+    m_vertices = new GLVertex[m_maxVertices];
 
     //Init multitexturing
     ARB_multitexture    = initializeMultiTexturingExtensions();
     EXT_secondary_color = initializeSecondaryColorExtension();
 
-    //Vertices
-    glVertexPointer(4, GL_FLOAT, sizeof(GLVertex), &m_vertices[0].x );
-    glEnableClientState( GL_VERTEX_ARRAY );
-
-    //Colors
-    glColorPointer(4, GL_FLOAT, sizeof(GLVertex), &m_vertices[0].color.r);
-    glEnableClientState( GL_COLOR_ARRAY );
-
-    //Secondary Color
-    if ( EXT_secondary_color)
-    {
-        glSecondaryColorPointerEXT( 3, GL_FLOAT, sizeof( GLVertex ), &m_vertices[0].secondaryColor.r );
-        glEnableClientState( GL_SECONDARY_COLOR_ARRAY_EXT );
-    }
-
-    //Textureing 0
-    glClientActiveTextureARB( GL_TEXTURE0_ARB ); 
-    glTexCoordPointer( 2, GL_FLOAT, sizeof( GLVertex ), &m_vertices[0].s0 );
-    glEnableClientState( GL_TEXTURE_COORD_ARRAY );
-
-    //Textureing 1
-    glClientActiveTextureARB( GL_TEXTURE1_ARB );
-    glTexCoordPointer( 2, GL_FLOAT, sizeof( GLVertex ), &m_vertices[0].s1 );
-    glEnableClientState( GL_TEXTURE_COORD_ARRAY );
+    //Vertex arrays
+    setVertexArrays();
 
     //Fog
-    m_fogMgr->setFogCoordPointer(GL_FLOAT, sizeof(GLVertex), &m_vertices[0].fog);
     m_fogMgr->enableFogCoordArray();
     m_fogMgr->setLinearFog();
 
     return true;
 }
 
+//-----------------------------------------------------------------------------
+//* Set Vertex Arrays
+//! Points render device to vertex buffer, has to be called again when
+//! another render device is selected
+//-----------------------------------------------------------------------------
+void OpenGLRenderer::setVertexArrays()
+{
+    RenderDevice::getSingleton().setVertexArrays(m_vertices, EXT_secondary_color);
+    m_fogMgr->setFogCoordPointer(GL_FLOAT, sizeof(GLVertex), &m_vertices[0].fog);
+}
+
 
 
 //-----------------------------------------------------------------------------
@@ -131,6 +140,17 @@ void OpenGLRenderer::addTriangle( SPVertex *vertices, int v0, int v1, int v2 )
 {
     int v[] = { v0, v1, v2 };
 
+    //Make room for triangle (render what is buffered before states are updated)
+    if ( m_numVertices + 3 > m_maxVertices )
+    {
+        m_numOverflowFlushes++;
+        render();
+    }
+    else if ( m_vertexSpace != VERTEX_SPACE_CLIP )
+    {
+        render();
+    }
+
     //Update States
     m_rdp->updateStates();
 
@@ -205,22 +225,204 @@ void OpenGLRenderer::addTriangle( SPVertex *vertices, int v0, int v1, int v2 )
         m_numVertices++;
     }
     m_numTriangles++;
+}
+
+//-----------------------------------------------------------------------------
+//* Add Screen Triangle
+//! Adds a triangle that has already been set up by the RDP. Positions are 
+//! in N64 screen coordinates with w used for perspective correction, 
+//! texture coordinates are in texels before the tile shift is applied.
+//! @param combinerColor Let the combiner change vertex colors? 
+//!                      (false when colors are the fill color)
+//-----------------------------------------------------------------------------
+void OpenGLRenderer::addScreenTriangle( GLVertex vertices[3], bool combinerColor )
+{
+    //Make room for triangle, screen and clip space triangles are not mixed
+    if ( m_numVertices + 3 > m_maxVertices )
+    {
+        m_numOverflowFlushes++;
+        render();
+    }
+    else if ( m_numVertices > 0 && m_vertexSpace != VERTEX_SPACE_SCREEN )
+    {
+        render();
+    }
+    m_vertexSpace = VERTEX_SPACE_SCREEN;
+
+    //Update States
+    m_rdp->updateStates();
+
+    bool usesTexture0 = m_rdp->getCombinerMgr()->getUsesTexture0();
+    bool usesTexture1 = m_rdp->getCombinerMgr()->getUsesTexture1();
+
+    for (int i=0; i<3; ++i)
+    {
+        GLVertex& vertex = m_vertices[m_numVertices];
+        vertex = vertices[i];
+
+        if ( combinerColor )
+        {
+            m_rdp->getCombinerMgr()->getCombinerColor( &vertex.color.r );
+        }
+
+        vertex.secondaryColor.r = 0.0f;
+        vertex.secondaryColor.g = 0.0f;
+        vertex.secondaryColor.b = 0.0f;
+        vertex.secondaryColor.a = 1.0f;
+        if ( EXT_secondary_color )
+        {
+            m_rdp->getCombinerMgr()->getSecondaryCombinerColor( &vertex.secondaryColor.r );
+        }
+        vertex.fog = 0.0f;
+
+        //Set TexCoords
+        if ( usesTexture0 )
+        {
+            CachedTexture* cache = m_textureCache->getCurrentTexture(0);
+            RDPTile* tile        = m_rsp->getTile(0);
+            if ( cache ) 
+            {
+                vertex.s0 = (vertices[i].s0 * cache->shiftScaleS - tile->fuls + cache->offsetS) * cache->scaleS; 
+                vertex.t0 = (vertices[i].t0 * cache->shiftScaleT - tile->fult + cache->offsetT) * cache->scaleT;
+            }
+            else
+            {
+                vertex.s0 = vertices[i].s0 - tile->fuls; 
+                vertex.t0 = vertices[i].t0 - tile->fult;
+            }
+        }
+
+        if ( usesTexture1 )
+        {
+            CachedTexture* cache = m_textureCache->getCurrentTexture(1);
+            RDPTile* tile        = m_rsp->getTile(1);
+            if ( cache && tile ) 
+            {
+                vertex.s1 = (vertices[i].s1 * cache->shiftScaleS - tile->fuls + cache->offsetS) * cache->scaleS; 
+                vertex.t1 = (vertices[i].t1 * cache->shiftScaleT - tile->fult + cache->offsetT) * cache->scaleT;
+            }
+        }
+
+        m_numVertices++;
+    }
+    m_numTriangles++;
+}
+
+//-----------------------------------------------------------------------------
+//* Add Sprite
+//! Adds a 2D rectangle as two triangles. Rectangles are batched until
+//! states change, the orthographic projection and 2D states are only set
+//! up once for each batch when it is rendered.
+//! @param vertices Corners in N64 screen coordinates, final colors and 
+//!                 texture coordinates
+//! @param textured Rendered without depth test and fog (texture rectangles)
+//-----------------------------------------------------------------------------
+void OpenGLRenderer::addSprite( const GLVertex vertices[4], bool textured )
+{
+    static const int corners[6] = { 0, 1, 2, 0, 2, 3 };
+    VertexSpace space = textured ? VERTEX_SPACE_TEXTURED_SPRITE : VERTEX_SPACE_SPRITE;
 
-    if ( m_numVertices >= 255 ) 
-    {    
-        
-        Logger::getSingleton().printMsg("RENDER VERTICES!!! :)", M64MSG_ERROR);
-        OpenGLRenderer::getSingleton().render();
-    }    
+    //Make room for rectangle, other kinds of vertices are rendered first
+    if ( m_numVertices + 6 > m_maxVertices )
+    {
+        m_numOverflowFlushes++;
+        render();
+    }
+    else if ( m_numVertices > 0 && m_vertexSpace != space )
+    {
+        render();
+    }
+    m_vertexSpace = space;
+
+    for (int i=0; i<6; ++i)
+    {
+        m_vertices[m_numVertices++] = vertices[corners[i]];
+    }
+    m_numTriangles += 2;
+    m_numSprites++;
 }
 
 //-----------------------------------------------------------------------------
 // Render
 //-----------------------------------------------------------------------------
 void OpenGLRenderer::render()
-{        
-    glDrawArrays(GL_TRIANGLES, 0, m_numVertices);
+{
+    //Fill rectangles that became clears leave nothing to draw
+    if ( m_numVertices == 0 )
+    {
+        return;
+    }
+
+    if ( m_numVertices > m_largestBatch )
+    {
+        m_largestBatch = m_numVertices;
+    }
+
+    RenderDevice& device = RenderDevice::getSingleton();
+    bool cull = false, scissor = false, depthTest = false, fog = false;
+
+    //Screen coordinates are mapped to the N64 screen
+    if ( m_vertexSpace != VERTEX_SPACE_CLIP )
+    {
+        cull = device.isEnabled( GL_CULL_FACE );
+        device.disable( GL_CULL_FACE );
+        device.setMatrixMode( GL_PROJECTION );
+        device.pushMatrix();
+        device.loadIdentity();
+        device.ortho( 0, m_vi->getWidth(), m_vi->getHeight(), 0, 1.0f, -1.0f );
+    }
+
+    //2D rectangles ignore scissor, textured ones also depth and fog
+    if ( m_vertexSpace == VERTEX_SPACE_SPRITE || m_vertexSpace == VERTEX_SPACE_TEXTURED_SPRITE )
+    {
+        scissor = device.isEnabled( GL_SCISSOR_TEST );
+        device.disable( GL_SCISSOR_TEST );
+        m_numSpriteBatches++;
+    }
+    if ( m_vertexSpace == VERTEX_SPACE_TEXTURED_SPRITE )
+    {
+        depthTest = device.isEnabled( GL_DEPTH_TEST );
+        fog       = device.isEnabled( GL_FOG );
+        device.disable( GL_DEPTH_TEST );
+        device.disable( GL_FOG );
+    }
+
+    device.drawTriangles(m_numVertices);
+    m_numDrawCalls++;
     m_numTriangles = m_numVertices = 0;  
+
+    //Restore states
+    if ( depthTest ) device.enable( GL_DEPTH_TEST );
+    if ( fog )       device.enable( GL_FOG );
+    if ( scissor )   device.enable( GL_SCISSOR_TEST );
+    if ( m_vertexSpace != VERTEX_SPACE_CLIP )
+    {
+        device.setMatrixMode( GL_PROJECTION );
+        device.popMatrix();
+        device.setMatrixMode( GL_MODELVIEW );
+        if ( cull ) device.enable( GL_CULL_FACE );
+        m_vertexSpace = VERTEX_SPACE_CLIP;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//* Dispose
+//! Reports buffer statistics so VertexBufferSize can be tuned
+//-----------------------------------------------------------------------------
+void OpenGLRenderer::dispose()
+{
+    if ( m_numOverflowFlushes > 0 )
+    {
+        char msg[256];
+        sprintf(msg, "OpenGLRenderer - Vertex buffer (%d vertices) was full %u times, largest batch %d vertices", 
+                m_maxVertices, m_numOverflowFlushes, m_largestBatch);
+        Logger::getSingleton().printMsg(msg, M64MSG_VERBOSE);
+    }
+
+    if ( m_vertices ) { delete[] m_vertices; m_vertices = 0; }
+    m_maxVertices = 0;
+    m_numVertices = 0;
+    m_numTriangles = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -271,16 +473,7 @@ void OpenGLRenderer::renderTexRect( float ulx, float uly,   //Upper left vertex
     rect[1].t1 = lrt;
     rect[1].fog = 0.0f;
 
-    glDisable( GL_CULL_FACE );
-    glMatrixMode( GL_PROJECTION );
-    glLoadIdentity();
-
-    //glOrtho( 0, m_vi->getWidth(), m_vi->getHeight(), 0, 1.0f, -1.0f );
-    glOrtho( 0, m_vi->getWidth(), m_vi->getHeight(), 0, 1.0f, -1.0f );
-    //glOrtho( 0, OpenGLManager::getSingleton().getWidth(), OpenGLManager::getSingleton().getHeight(), 0, 1.0f, -1.0f );
-    //glViewport( 0, 0, m_vi->getWidth(), m_vi->getHeight() );
-    //glViewport( 0, 0, 320, 240 );
-    //glViewport( 0, 0, OpenGLManager::getSingleton().getWidth(), OpenGLManager::getSingleton().getHeight());
+    RenderDevice& device = RenderDevice::getSingleton();
 
     if ( m_rdp->getCombinerMgr()->getUsesTexture0() )
     {
@@ -302,15 +495,25 @@ void OpenGLRenderer::renderTexRect( float ulx, float uly,   //Upper left vertex
         }
 //
 //        if (OGL.ARB_multitexture)
-            glActiveTextureARB( GL_TEXTURE0_ARB );
+            device.setActiveTexture( 0 );
 //
         if ((rect[0].s0 >= 0.0f) && (rect[1].s0 <= m_textureCache->getCurrentTexture(0)->width))
-            glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+            device.setTextureParameter( GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
 
         if ((rect[0].t0 >= 0.0f) && (rect[1].t0 <= m_textureCache->getCurrentTexture(0)->height))
-            glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+            device.setTextureParameter( GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
 
 //
+        //Color images rendered to textures start at the loaded texel
+        if ( m_textureCache->getCurrentTexture(0)->frameBufferTexture )
+        {
+            CachedTexture* texture = m_textureCache->getCurrentTexture(0);
+            rect[0].s0 += texture->offsetS;
+            rect[0].t0 += texture->offsetT;
+            rect[1].s0 += texture->offsetS;
+            rect[1].t0 += texture->offsetT;
+        }
+
         rect[0].s0 *= m_textureCache->getCurrentTexture(0)->scaleS;
         rect[0].t0 *= m_textureCache->getCurrentTexture(0)->scaleT;
         rect[1].s0 *= m_textureCache->getCurrentTexture(0)->scaleS;
@@ -336,13 +539,23 @@ void OpenGLRenderer::renderTexRect( float ulx, float uly,   //Upper left vertex
             rect[0].t1 = 0.0f;
         }
 
-        glActiveTextureARB( GL_TEXTURE1_ARB );
+        device.setActiveTexture( 1 );
 
         if ((rect[0].s1 == 0.0f) && (rect[1].s1 <= m_textureCache->getCurrentTexture(1)->width))
-            glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+            device.setTextureParameter( GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
 
         if ((rect[0].t1 == 0.0f) && (rect[1].t1 <= m_textureCache->getCurrentTexture(1)->height))
-            glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+            device.setTextureParameter( GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+
+        //Color images rendered to textures start at the loaded texel
+        if ( m_textureCache->getCurrentTexture(1)->frameBufferTexture )
+        {
+            CachedTexture* texture = m_textureCache->getCurrentTexture(1);
+            rect[0].s1 += texture->offsetS;
+            rect[0].t1 += texture->offsetT;
+            rect[1].s1 += texture->offsetS;
+            rect[1].t1 += texture->offsetT;
+        }
 
         rect[0].s1 *= m_textureCache->getCurrentTexture(1)->scaleS;
         rect[0].t1 *= m_textureCache->getCurrentTexture(1)->scaleT;
@@ -354,10 +567,10 @@ void OpenGLRenderer::renderTexRect( float ulx, float uly,   //Upper left vertex
     if ( m_rdp->m_otherMode.cycleType == G_CYC_COPY ) /*&& !OGL.forceBilinear  )*/
     {
         //if (OGL.ARB_multitexture)
-        glActiveTextureARB( GL_TEXTURE0_ARB );
+        device.setActiveTexture( 0 );
 
-        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
-        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+        device.setTextureParameter( GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+        device.setTextureParameter( GL_TEXTURE_MAG_FILTER, GL_NEAREST );
     }
 
 //    SetConstant( rect[0].color, combiner.vertex.color, combiner.vertex.alpha );
@@ -368,81 +581,23 @@ void OpenGLRenderer::renderTexRect( float ulx, float uly,   //Upper left vertex
     m_rdp->getCombinerMgr()->getSecondaryCombinerColor(&rect[0].secondaryColor.r);
     //    SetConstant( rect[0].secondaryColor, combiner.vertex.secondaryColor, combiner.vertex.alpha );
 
-    glBegin( GL_QUADS );
-
-        glColor4f( rect[0].color.r, rect[0].color.g, rect[0].color.b, rect[0].color.a );
-
-        //if (OGL.EXT_secondary_color)
-            glSecondaryColor3fEXT( rect[0].secondaryColor.r, rect[0].secondaryColor.g, rect[0].secondaryColor.b );
-
-        //if (OGL.ARB_multitexture)
-        //{
-        //    glMultiTexCoord2fARB( GL_TEXTURE0_ARB, rect[0].s0, rect[0].t0 );
-        //    glMultiTexCoord2fARB( GL_TEXTURE1_ARB, rect[0].s1, rect[0].t1 );
-        //    glVertex4f( rect[0].x, rect[0].y, rect[0].z, 1.0f );
-
-        //    glMultiTexCoord2fARB( GL_TEXTURE0_ARB, rect[1].s0, rect[0].t0 );
-        //    glMultiTexCoord2fARB( GL_TEXTURE1_ARB, rect[1].s1, rect[0].t1 );
-        //    glVertex4f( rect[1].x, rect[0].y, rect[0].z, 1.0f );
-
-        //    glMultiTexCoord2fARB( GL_TEXTURE0_ARB, rect[1].s0, rect[1].t0 );
-        //    glMultiTexCoord2fARB( GL_TEXTURE1_ARB, rect[1].s1, rect[1].t1 );
-        //    glVertex4f( rect[1].x, rect[1].y, rect[0].z, 1.0f );
-
-        //    glMultiTexCoord2fARB( GL_TEXTURE0_ARB, rect[0].s0, rect[1].t0 );
-        //    glMultiTexCoord2fARB( GL_TEXTURE1_ARB, rect[0].s1, rect[1].t1 );
-        //    glVertex4f( rect[0].x, rect[1].y, rect[0].z, 1.0f );
-        //}
-//        else
-        {
-
-            /*
-            Logger::getSingleton() << "\n\nTexRect x0=" << rect[0].x << " y0=" << rect[0].y << 
-                                                 " x1=" << rect[1].x <<  "y1=" << rect[1].y <<
-                                                    " t0u0=" << rect[0].s0 << " t0v0=" << rect[0].t0 << 
-                                                 " t0u1=" << rect[1].s0 << " t0v1=" << rect[1].t0 << "\n";
-            */
-
-            glTexCoord2f(rect[0].s0, rect[0].t0 );
-            //glTexCoord2f(rect[0].s1, rect[0].t1 );
-            glVertex4f( rect[0].x, rect[0].y, rect[0].z, 1.0f );
-
-            glTexCoord2f(rect[1].s0, rect[0].t0 );
-            //glTexCoord2f(rect[1].s1, rect[0].t1 );
-            glVertex4f( rect[1].x, rect[0].y, rect[0].z, 1.0f );
-
-            glTexCoord2f(rect[1].s0, rect[1].t0 );
-            //glTexCoord2f(rect[1].s1, rect[1].t1 );
-            glVertex4f( rect[1].x, rect[1].y, rect[0].z, 1.0f );
-
-            glTexCoord2f(rect[0].s0, rect[1].t0 );
-            //glTexCoord2f(rect[0].s1, rect[1].t1 );
-            glVertex4f( rect[0].x, rect[1].y, rect[0].z, 1.0f );
-
-
-
-    /*        glTexCoord2f( rect[0].s0, rect[0].t0 );
-            glVertex4f( rect[0].x, rect[0].y, rect[0].z, 1.0f );
-
-            if (flip)
-                glTexCoord2f( rect[1].s0, rect[0].t0 );
-            else
-                glTexCoord2f( rect[0].s0, rect[1].t0 );
-
-            glVertex4f( rect[1].x, rect[0].y, rect[0].z, 1.0f );
-
-            glTexCoord2f( rect[1].s0, rect[1].t0 );
-            glVertex4f( rect[1].x, rect[1].y, rect[0].z, 1.0f );
-
-            if (flip)
-                glTexCoord2f( rect[1].s0, rect[0].t0 );
-            else
-                glTexCoord2f( rect[1].s0, rect[0].t0 );
-            glVertex4f( rect[0].x, rect[1].y, rect[0].z, 1.0f );*/
-        }
-    glEnd();
-
-    glLoadIdentity();
-    //OGL_UpdateCullFace();
-    //OGL_UpdateViewport();
+    //Add rectangle to sprite batch
+    GLVertex quad[4];
+    for (int i=0; i<4; ++i)
+    {
+        quad[i] = rect[0];
+    }
+    quad[1].x  = rect[1].x;
+    quad[1].s0 = rect[1].s0;
+    quad[1].s1 = rect[1].s1;
+    quad[2].x  = rect[1].x;
+    quad[2].y  = rect[1].y;
+    quad[2].s0 = rect[1].s0;
+    quad[2].t0 = rect[1].t0;
+    quad[2].s1 = rect[1].s1;
+    quad[2].t1 = rect[1].t1;
+    quad[3].y  = rect[1].y;
+    quad[3].t0 = rect[1].t0;
+    quad[3].t1 = rect[1].t1;
+    addSprite(quad, true);
 }
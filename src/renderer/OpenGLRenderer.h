@@ -50,6 +50,19 @@ struct GLVertex
     float fog;                 //!< Vertex fog variable
 };
 
+//*****************************************************************************
+//* Vertex Space
+//! Coordinate system of the vertices in the vertex buffer, decides how the
+//! buffer is rendered. Vertices in different spaces are never mixed.
+//*****************************************************************************
+enum VertexSpace
+{
+    VERTEX_SPACE_CLIP,             //!< Transformed by the RSP (display lists)
+    VERTEX_SPACE_SCREEN,           //!< Set up by the RDP (low level RDP lists)
+    VERTEX_SPACE_SPRITE,           //!< 2D rectangles (fill rectangles)
+    VERTEX_SPACE_TEXTURED_SPRITE,  //!< Textured 2D rectangles, no depth test or fog
+};
+
 //*****************************************************************************
 //* OpenGL Renderer
 //! Class for rendering using OpenGL
@@ -68,17 +81,35 @@ public:
     //Destructor
     ~OpenGLRenderer();
 
-    //Initialize
-    bool initialize(RSP* rsp, RDP* rdp, TextureCache* textureCache, VI* vi, FogManager* fogMgr);
+    //Initialize / Dispose
+    bool initialize(RSP* rsp, RDP* rdp, TextureCache* textureCache, VI* vi, FogManager* fogMgr, int vertexBufferSize);
+    void dispose();
 
     //Flush Vertex buffer
     void render();
 
+    //Point render device to vertex buffer
+    void setVertexArrays();
+
     //Add triangle
     void addTriangle( SPVertex *vertices, int v0, int v1, int v2 );
 
+    //Add triangle in screen coordinates (low level RDP lists)
+    void addScreenTriangle( GLVertex vertices[3], bool combinerColor );
+
+    //Add rectangle in screen coordinates (vertices in clockwise order)
+    void addSprite( const GLVertex vertices[4], bool textured );
+
     //Get number of vertices
-    int getNumVertices() { return m_numVertices; }
+    int getNumVertices()          { return m_numVertices; }
+    VertexSpace getVertexSpace()  { return m_vertexSpace; }
+
+    //Statistics
+    unsigned int getNumOverflowFlushes() { return m_numOverflowFlushes; }
+    int getLargestBatch()                { return m_largestBatch;       }
+    unsigned int getNumDrawCalls()       { return m_numDrawCalls;       }
+    unsigned int getNumSprites()         { return m_numSprites;         }
+    unsigned int getNumSpriteBatches()   { return m_numSpriteBatches;   }
 
     //Render Tex Rect
     void renderTexRect( float ulx, float uly,   //Upper left vertex
@@ -94,12 +125,19 @@ private:
 
 private:
 
-    GLVertex m_vertices[256];              //!< Vertex buffer
-    unsigned char m_triangles[300][3];     //!< Triangles used to index vertices
+    GLVertex* m_vertices;                  //!< Vertex buffer
+    int m_maxVertices;                     //!< Capacity of vertex buffer
 
     int m_numVertices;                     //!< Number of vertices in vertex buffer
     int m_numTriangles;                    //!< Number of triangles
 
+    unsigned int m_numOverflowFlushes;     //!< Number of times buffer was rendered because it was full
+    int m_largestBatch;                    //!< Largest number of vertices rendered in one draw call
+    unsigned int m_numDrawCalls;           //!< Number of draw calls issued
+    unsigned int m_numSprites;             //!< Number of 2D rectangles added
+    unsigned int m_numSpriteBatches;       //!< Number of draw calls used for 2D rectangles
+    VertexSpace m_vertexSpace;             //!< Coordinate system of buffered vertices
+
     RSP* m_rsp;                            //!< Pointer to Reality Signal Processor
     RDP* m_rdp;                            //!< Pointer to Reality Drawing Processor
     VI* m_vi;                              //!< Pointer to Video Interface
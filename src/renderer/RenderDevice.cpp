@@ -0,0 +1,56 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#include "NullRenderDevice.h"
+#include "OpenGLRenderDevice.h"
+#include "RenderDevice.h"
+#include "ThreadedRenderDevice.h"
+
+//-----------------------------------------------------------------------------
+//! Static Variables
+//-----------------------------------------------------------------------------
+static OpenGLRenderDevice g_openGLRenderDevice;
+static NullRenderDevice   g_nullRenderDevice;
+static ThreadedRenderDevice g_threadedRenderDevice(&g_openGLRenderDevice);
+
+RenderDevice*    RenderDevice::m_activeDevice = &g_openGLRenderDevice;
+RenderDeviceType RenderDevice::m_activeType   = RENDER_DEVICE_OPENGL;
+
+//-----------------------------------------------------------------------------
+//* Select
+//! Selects which device is returned by getSingleton()
+//-----------------------------------------------------------------------------
+void RenderDevice::select(RenderDeviceType type)
+{
+    m_activeType = type;
+    if ( type == RENDER_DEVICE_NULL )
+    {
+        m_activeDevice = &g_nullRenderDevice;
+    }
+    else if ( type == RENDER_DEVICE_THREADED )
+    {
+        m_activeDevice = &g_threadedRenderDevice;
+    }
+    else
+    {
+        m_activeDevice = &g_openGLRenderDevice;
+    }
+}
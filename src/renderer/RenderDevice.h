@@ -0,0 +1,153 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef RENDER_DEVICE_H_
+#define RENDER_DEVICE_H_
+
+//Forward declarations
+struct GLVertex;
+
+//-----------------------------------------------------------------------------
+//! Available render devices
+//-----------------------------------------------------------------------------
+enum RenderDeviceType
+{
+    RENDER_DEVICE_OPENGL,    //!< Forwards everything to OpenGL
+    RENDER_DEVICE_NULL,      //!< Only counts submissions, used for benchmarking
+    RENDER_DEVICE_THREADED,  //!< Records calls and forwards them to OpenGL on a render thread
+};
+
+//*****************************************************************************
+//* Render Quad Vertex
+//! Vertex used when drawing rectangles
+//*****************************************************************************
+struct RenderQuadVertex
+{
+    float x, y, z;             //!< Vertex position
+    float s, t;                //!< Texture coordinate for first texture unit
+};
+
+//*****************************************************************************
+//* Render Device
+//! Thin interface between the plugin and the graphics API.
+//! @details Functions map closely to the OpenGL calls they replace and take
+//!          OpenGL enums as arguments. All rendering done while processing 
+//!          display lists goes through the active device, so it can be
+//!          replaced with a device that does not need OpenGL at all.
+//*****************************************************************************
+class RenderDevice
+{
+public:
+
+    //Get active render device
+    static RenderDevice& getSingleton() { return *m_activeDevice; }
+
+    //Select active render device
+    static void select(RenderDeviceType type);
+    static RenderDeviceType getType() { return m_activeType; }
+
+    //Destructor
+    virtual ~RenderDevice() {}
+
+    //Initialize / Dispose
+    virtual bool initialize() = 0;
+    virtual void dispose() = 0;
+
+    //Extensions
+    virtual bool isExtensionSupported(const char* extension) = 0;
+
+    //Capabilities
+    virtual void enable(unsigned int capability) = 0;
+    virtual void disable(unsigned int capability) = 0;
+    virtual bool isEnabled(unsigned int capability) = 0;
+    virtual void enableClientState(unsigned int array) = 0;
+    virtual void disableClientState(unsigned int array) = 0;
+
+    //States
+    virtual void setBlendFunc(unsigned int sourceFactor, unsigned int destinationFactor) = 0;
+    virtual void setDepthFunc(unsigned int func) = 0;
+    virtual void setDepthMask(bool write) = 0;
+    virtual void setDepthRange(float zNear, float zFar) = 0;
+    virtual void setAlphaFunc(unsigned int func, float reference) = 0;
+    virtual void setPolygonOffset(float factor, float units) = 0;
+    virtual void setPolygonMode(unsigned int face, unsigned int mode) = 0;
+    virtual void setCullFace(unsigned int face) = 0;
+    virtual void setViewport(int x, int y, int width, int height) = 0;
+    virtual void setScissor(int x, int y, int width, int height) = 0;
+
+    //Fog
+    virtual void setFogParameteri(unsigned int name, int value) = 0;
+    virtual void setFogParameterf(unsigned int name, float value) = 0;
+    virtual void setFogColor(const float color[4]) = 0;
+    virtual void setFogCoordPointer(unsigned int type, int stride, const void* pointer) = 0;
+
+    //Clear
+    virtual void setClearColor(float r, float g, float b, float a) = 0;
+    virtual void clear(unsigned int mask) = 0;
+
+    //Matrices
+    virtual void setMatrixMode(unsigned int mode) = 0;
+    virtual void loadIdentity() = 0;
+    virtual void pushMatrix() = 0;
+    virtual void popMatrix() = 0;
+    virtual void ortho(double left, double right, double bottom, double top, double zNear, double zFar) = 0;
+
+    //Textures
+    virtual void generateTexture(unsigned int* id) = 0;
+    virtual void deleteTexture(unsigned int* id) = 0;
+    virtual void bindTexture(unsigned int id) = 0;
+    virtual void setActiveTexture(unsigned int unit) = 0;
+    virtual void setTextureParameter(unsigned int name, int value) = 0;
+    virtual void uploadTexture(int internalFormat, int width, int height, unsigned int format, unsigned int type, 
+                               const void* pixels, unsigned int numBytes) = 0;
+    virtual void setTexEnv(unsigned int name, int value) = 0;
+    virtual void setTexEnvColor(const float color[4]) = 0;
+
+    //Geometry
+    virtual void setVertexArrays(GLVertex* vertices, bool secondaryColor) = 0;
+    virtual void drawTriangles(int numVertices) = 0;
+    virtual void drawQuad(const RenderQuadVertex vertices[4], const float color[4], const float* secondaryColor, bool textured) = 0;
+
+    //Frame
+    virtual void finish() = 0;
+    virtual void readPixels(void* dest, int width, int height, bool front) = 0;
+    virtual void callRenderingCallback(void (*callback)(int), int drawFlag) = 0;
+    virtual void swapBuffers() = 0;
+    virtual void synchronize() = 0;
+    virtual void insertFrameFence() = 0;
+    virtual void waitFrameFence(int maxPendingFrames) = 0;
+    virtual void readPixelsAsync(unsigned int buffer, int width, int height) = 0;
+    virtual bool getAsyncPixels(unsigned int buffer, void* dest, bool wait, unsigned int stride) = 0;
+    virtual bool isFramebufferSupported() = 0;
+    virtual void downscale(bool front, int srcWidth, int srcHeight, int width, int height, bool box) = 0;
+    virtual void endDownscale() = 0;
+    virtual void createRenderTarget(unsigned int target, unsigned int texture, int width, int height) = 0;
+    virtual void deleteRenderTarget(unsigned int target) = 0;
+    virtual void bindRenderTarget(unsigned int target) = 0;
+
+private:
+
+    static RenderDevice*    m_activeDevice;   //!< Device used by plugin
+    static RenderDeviceType m_activeType;     //!< Type of active device
+
+};
+
+#endif
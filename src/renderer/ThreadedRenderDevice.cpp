@@ -0,0 +1,941 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#include <string.h>
+
+#include "Logger.h"
+#include "OpenGL.h"
+#include "OpenGLRenderer.h"
+#include "ThreadedRenderDevice.h"
+
+//-----------------------------------------------------------------------------
+//! Recorded render device calls
+//-----------------------------------------------------------------------------
+enum RenderCommandType
+{
+    CMD_ENABLE,
+    CMD_DISABLE,
+    CMD_ENABLE_CLIENT_STATE,
+    CMD_DISABLE_CLIENT_STATE,
+    CMD_BLEND_FUNC,
+    CMD_DEPTH_FUNC,
+    CMD_DEPTH_MASK,
+    CMD_DEPTH_RANGE,
+    CMD_ALPHA_FUNC,
+    CMD_POLYGON_OFFSET,
+    CMD_POLYGON_MODE,
+    CMD_CULL_FACE,
+    CMD_VIEWPORT,
+    CMD_SCISSOR,
+    CMD_FOG_PARAMETERI,
+    CMD_FOG_PARAMETERF,
+    CMD_FOG_COLOR,
+    CMD_FOG_COORD_POINTER,
+    CMD_CLEAR_COLOR,
+    CMD_CLEAR,
+    CMD_MATRIX_MODE,
+    CMD_LOAD_IDENTITY,
+    CMD_PUSH_MATRIX,
+    CMD_POP_MATRIX,
+    CMD_ORTHO,
+    CMD_DELETE_TEXTURE,
+    CMD_BIND_TEXTURE,
+    CMD_ACTIVE_TEXTURE,
+    CMD_TEXTURE_PARAMETER,
+    CMD_UPLOAD_TEXTURE,
+    CMD_TEX_ENV,
+    CMD_TEX_ENV_COLOR,
+    CMD_DRAW_TRIANGLES,
+    CMD_DRAW_QUAD,
+    CMD_FINISH,
+    CMD_RENDERING_CALLBACK,
+    CMD_SWAP_BUFFERS,
+    CMD_INSERT_FRAME_FENCE,
+    CMD_WAIT_FRAME_FENCE,
+    CMD_READ_PIXELS_ASYNC,
+    CMD_DOWNSCALE,
+    CMD_END_DOWNSCALE,
+    CMD_CREATE_RENDER_TARGET,
+    CMD_DELETE_RENDER_TARGET,
+    CMD_BIND_RENDER_TARGET,
+    CMD_EXECUTE,
+};
+
+//! Arena size before it has to grow
+#define RENDER_ARENA_SIZE (1024 * 1024)
+
+//-----------------------------------------------------------------------------
+//! Constructor
+//-----------------------------------------------------------------------------
+RenderCommandArena::RenderCommandArena()
+{
+    m_data     = 0;
+    m_size     = 0;
+    m_capacity = 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Destructor
+//-----------------------------------------------------------------------------
+RenderCommandArena::~RenderCommandArena()
+{
+    dispose();
+}
+
+//-----------------------------------------------------------------------------
+//! Initialize
+//-----------------------------------------------------------------------------
+bool RenderCommandArena::initialize(unsigned int capacity)
+{
+    dispose();
+    m_data = new unsigned char[capacity];
+    m_capacity = capacity;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Dispose
+//-----------------------------------------------------------------------------
+void RenderCommandArena::dispose()
+{
+    if ( m_data ) { delete[] m_data; m_data = 0; }
+    m_size     = 0;
+    m_capacity = 0;
+}
+
+//-----------------------------------------------------------------------------
+//* Add
+//! Adds a command to the arena, growing it if needed
+//! @param dataSize Bytes needed for data following command
+//! @return Command, only valid until next command is added
+//-----------------------------------------------------------------------------
+RenderCommand* RenderCommandArena::add(unsigned int type, unsigned int dataSize)
+{
+    dataSize = (dataSize + 7) & ~7;
+    unsigned int size = sizeof(RenderCommand) + dataSize;
+
+    if ( m_size + size > m_capacity )
+    {
+        unsigned int capacity = m_capacity * 2;
+        if ( capacity < m_size + size )
+        {
+            capacity = m_size + size;
+        }
+        unsigned char* data = new unsigned char[capacity];
+        memcpy(data, m_data, m_size);
+        delete[] m_data;
+        m_data = data;
+        m_capacity = capacity;
+    }
+
+    RenderCommand* command = (RenderCommand*)(m_data + m_size);
+    command->type     = type;
+    command->dataSize = dataSize;
+    m_size += size;
+    return command;
+}
+
+//-----------------------------------------------------------------------------
+//! Constructor
+//! @param target Device executing the commands on the render thread
+//-----------------------------------------------------------------------------
+ThreadedRenderDevice::ThreadedRenderDevice(RenderDevice* target)
+{
+    m_target         = target;
+    m_recordArena    = 0;
+    m_submitted      = false;
+    m_submittedArena = 0;
+    m_quit           = false;
+    m_contextCurrent = false;
+    m_vertices       = 0;
+    m_secondaryColor = false;
+    m_fogCoordinates = false;
+    m_fogType        = 0;
+    m_fogStride      = 0;
+    m_fogOffset      = 0;
+    m_activeTextureUnit = 0;
+    m_numTextureNames = 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Destructor
+//-----------------------------------------------------------------------------
+ThreadedRenderDevice::~ThreadedRenderDevice()
+{
+    _stop();
+}
+
+//-----------------------------------------------------------------------------
+//* Initialize
+//! Moves the OpenGL context current on the calling thread to a new render
+//! thread. On failure the context is left on the calling thread.
+//-----------------------------------------------------------------------------
+bool ThreadedRenderDevice::initialize()
+{
+    m_arenas[0].initialize(RENDER_ARENA_SIZE);
+    m_arenas[1].initialize(RENDER_ARENA_SIZE);
+    m_recordArena    = 0;
+    m_submitted      = false;
+    m_quit           = false;
+    m_contextCurrent = false;
+    m_capabilities.clear();
+    m_activeTextureUnit = 0;
+    m_vertices       = 0;
+    m_secondaryColor = false;
+    m_fogCoordinates = false;
+    m_numTextureNames = 0;
+
+    if ( !m_context.capture() )
+    {
+        Logger::getSingleton().printMsg("Render thread: unknown OpenGL context", M64MSG_WARNING);
+        return false;
+    }
+
+    //Start render thread
+    m_context.release();
+    if ( !m_thread.start(_renderThread, this) )
+    {
+        m_context.makeCurrent();
+        return false;
+    }
+
+    //Wait for render thread to make context current
+    synchronize();
+    if ( !m_contextCurrent )
+    {
+        Logger::getSingleton().printMsg("Render thread: unable to make OpenGL context current", M64MSG_WARNING);
+        _stop();
+        return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//* Dispose
+//! Executes remaining commands and moves context back to calling thread
+//-----------------------------------------------------------------------------
+void ThreadedRenderDevice::dispose()
+{
+    _stop();
+    m_target->dispose();
+}
+
+//-----------------------------------------------------------------------------
+//* Stop
+//! Stops render thread and makes context current on calling thread again
+//-----------------------------------------------------------------------------
+void ThreadedRenderDevice::_stop()
+{
+    if ( m_thread.isRunning() )
+    {
+        synchronize();
+
+        m_mutex.lock();
+        m_quit = true;
+        m_submitCondition.signal();
+        m_mutex.unlock();
+
+        m_thread.join();
+        m_context.makeCurrent();
+    }
+
+    m_arenas[0].dispose();
+    m_arenas[1].dispose();
+    m_capabilities.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Extensions
+//-----------------------------------------------------------------------------
+struct ExtensionQuery
+{
+    const char* extension;
+    bool        supported;
+};
+
+static void queryExtension(RenderDevice* target, void* argument)
+{
+    ExtensionQuery* query = (ExtensionQuery*)argument;
+    query->supported = target->isExtensionSupported(query->extension);
+}
+
+bool ThreadedRenderDevice::isExtensionSupported(const char* extension)
+{
+    ExtensionQuery query = { extension, false };
+    _execute(queryExtension, &query);
+    return query.supported;
+}
+
+//-----------------------------------------------------------------------------
+// Capabilities
+//-----------------------------------------------------------------------------
+struct CapabilityQuery
+{
+    unsigned int capability;
+    bool         enabled;
+};
+
+static void queryCapability(RenderDevice* target, void* argument)
+{
+    CapabilityQuery* query = (CapabilityQuery*)argument;
+    query->enabled = target->isEnabled(query->capability);
+}
+
+//! Key of capability, texturing is enabled per texture unit
+#define CAPABILITY_KEY(capability) ( (capability) == GL_TEXTURE_2D ? (capability) | (m_activeTextureUnit << 16) : (capability) )
+
+void ThreadedRenderDevice::enable(unsigned int capability)
+{
+    m_capabilities[CAPABILITY_KEY(capability)] = true;
+    _add(CMD_ENABLE)->u[0] = capability;
+}
+
+void ThreadedRenderDevice::disable(unsigned int capability)
+{
+    m_capabilities[CAPABILITY_KEY(capability)] = false;
+    _add(CMD_DISABLE)->u[0] = capability;
+}
+
+bool ThreadedRenderDevice::isEnabled(unsigned int capability)
+{
+    std::map<unsigned int, bool>::iterator it = m_capabilities.find(CAPABILITY_KEY(capability));
+    if ( it != m_capabilities.end() )
+    {
+        return it->second;
+    }
+
+    //Not changed since render thread started, ask OpenGL once
+    CapabilityQuery query = { capability, false };
+    _execute(queryCapability, &query);
+    m_capabilities[CAPABILITY_KEY(capability)] = query.enabled;
+    return query.enabled;
+}
+
+void ThreadedRenderDevice::enableClientState(unsigned int array)  { _add(CMD_ENABLE_CLIENT_STATE)->u[0] = array;  }
+void ThreadedRenderDevice::disableClientState(unsigned int array) { _add(CMD_DISABLE_CLIENT_STATE)->u[0] = array; }
+
+//-----------------------------------------------------------------------------
+// States
+//-----------------------------------------------------------------------------
+void ThreadedRenderDevice::setBlendFunc(unsigned int sourceFactor, unsigned int destinationFactor)
+{
+    RenderCommand* command = _add(CMD_BLEND_FUNC);
+    command->u[0] = sourceFactor;
+    command->u[1] = destinationFactor;
+}
+
+void ThreadedRenderDevice::setDepthFunc(unsigned int func) { _add(CMD_DEPTH_FUNC)->u[0] = func;          }
+void ThreadedRenderDevice::setDepthMask(bool write)        { _add(CMD_DEPTH_MASK)->u[0] = write ? 1 : 0; }
+void ThreadedRenderDevice::setCullFace(unsigned int face)  { _add(CMD_CULL_FACE)->u[0] = face;           }
+
+void ThreadedRenderDevice::setDepthRange(float zNear, float zFar)
+{
+    RenderCommand* command = _add(CMD_DEPTH_RANGE);
+    command->f[0] = zNear;
+    command->f[1] = zFar;
+}
+
+void ThreadedRenderDevice::setAlphaFunc(unsigned int func, float reference)
+{
+    RenderCommand* command = _add(CMD_ALPHA_FUNC);
+    command->u[0] = func;
+    command->f[1] = reference;
+}
+
+void ThreadedRenderDevice::setPolygonOffset(float factor, float units)
+{
+    RenderCommand* command = _add(CMD_POLYGON_OFFSET);
+    command->f[0] = factor;
+    command->f[1] = units;
+}
+
+void ThreadedRenderDevice::setPolygonMode(unsigned int face, unsigned int mode)
+{
+    RenderCommand* command = _add(CMD_POLYGON_MODE);
+    command->u[0] = face;
+    command->u[1] = mode;
+}
+
+void ThreadedRenderDevice::setViewport(int x, int y, int width, int height)
+{
+    RenderCommand* command = _add(CMD_VIEWPORT);
+    command->i[0] = x;
+    command->i[1] = y;
+    command->i[2] = width;
+    command->i[3] = height;
+}
+
+void ThreadedRenderDevice::setScissor(int x, int y, int width, int height)
+{
+    RenderCommand* command = _add(CMD_SCISSOR);
+    command->i[0] = x;
+    command->i[1] = y;
+    command->i[2] = width;
+    command->i[3] = height;
+}
+
+//-----------------------------------------------------------------------------
+// Fog
+//-----------------------------------------------------------------------------
+void ThreadedRenderDevice::setFogParameteri(unsigned int name, int value)
+{
+    RenderCommand* command = _add(CMD_FOG_PARAMETERI);
+    command->u[0] = name;
+    command->i[1] = value;
+}
+
+void ThreadedRenderDevice::setFogParameterf(unsigned int name, float value)
+{
+    RenderCommand* command = _add(CMD_FOG_PARAMETERF);
+    command->u[0] = name;
+    command->f[1] = value;
+}
+
+void ThreadedRenderDevice::setFogColor(const float color[4])
+{
+    memcpy(_add(CMD_FOG_COLOR)->f, color, sizeof(float) * 4);
+}
+
+//-----------------------------------------------------------------------------
+//* Set Fog Coord Pointer
+//! Fog coordinates inside the vertex array are pointed to the copy of the
+//! vertices made by drawTriangles, other pointers are passed on as is.
+//-----------------------------------------------------------------------------
+void ThreadedRenderDevice::setFogCoordPointer(unsigned int type, int stride, const void* pointer)
+{
+    const unsigned char* base = (const unsigned char*)m_vertices;
+    if ( base && (const unsigned char*)pointer >= base && (const unsigned char*)pointer < base + sizeof(GLVertex) )
+    {
+        m_fogCoordinates = true;
+        m_fogType   = type;
+        m_fogStride = stride;
+        m_fogOffset = (unsigned int)((const unsigned char*)pointer - base);
+        return;
+    }
+
+    m_fogCoordinates = false;
+    RenderCommand* command = _add(CMD_FOG_COORD_POINTER);
+    command->u[0] = type;
+    command->i[1] = stride;
+    command->p[2] = (void*)pointer;
+}
+
+//-----------------------------------------------------------------------------
+// Clear
+//-----------------------------------------------------------------------------
+void ThreadedRenderDevice::setClearColor(float r, float g, float b, float a)
+{
+    RenderCommand* command = _add(CMD_CLEAR_COLOR);
+    command->f[0] = r;
+    command->f[1] = g;
+    command->f[2] = b;
+    command->f[3] = a;
+}
+
+void ThreadedRenderDevice::clear(unsigned int mask) { _add(CMD_CLEAR)->u[0] = mask; }
+
+//-----------------------------------------------------------------------------
+// Matrices
+//-----------------------------------------------------------------------------
+void ThreadedRenderDevice::setMatrixMode(unsigned int mode) { _add(CMD_MATRIX_MODE)->u[0] = mode; }
+void ThreadedRenderDevice::loadIdentity()                   { _add(CMD_LOAD_IDENTITY);            }
+void ThreadedRenderDevice::pushMatrix()                     { _add(CMD_PUSH_MATRIX);              }
+void ThreadedRenderDevice::popMatrix()                      { _add(CMD_POP_MATRIX);               }
+
+void ThreadedRenderDevice::ortho(double left, double right, double bottom, double top, double zNear, double zFar)
+{
+    RenderCommand* command = _add(CMD_ORTHO);
+    command->d[0] = left;
+    command->d[1] = right;
+    command->d[2] = bottom;
+    command->d[3] = top;
+    command->d[4] = zNear;
+    command->d[5] = zFar;
+}
+
+//-----------------------------------------------------------------------------
+// Textures
+//-----------------------------------------------------------------------------
+struct TextureNameQuery
+{
+    unsigned int* names;
+    unsigned int  numNames;
+};
+
+static void generateTextureNames(RenderDevice* target, void* argument)
+{
+    TextureNameQuery* query = (TextureNameQuery*)argument;
+    for (unsigned int i=0; i<query->numNames; ++i)
+    {
+        target->generateTexture(&query->names[i]);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//* Generate Texture
+//! Hands out a name generated in advance, names are generated on the render
+//! thread a block at a time.
+//-----------------------------------------------------------------------------
+void ThreadedRenderDevice::generateTexture(unsigned int* id)
+{
+    if ( m_numTextureNames == 0 )
+    {
+        TextureNameQuery query = { m_textureNames, NUM_TEXTURE_NAMES };
+        _execute(generateTextureNames, &query);
+        m_numTextureNames = NUM_TEXTURE_NAMES;
+    }
+    *id = m_textureNames[--m_numTextureNames];
+}
+
+void ThreadedRenderDevice::deleteTexture(unsigned int* id)      { _add(CMD_DELETE_TEXTURE)->u[0] = *id; }
+void ThreadedRenderDevice::bindTexture(unsigned int id)         { _add(CMD_BIND_TEXTURE)->u[0] = id;    }
+
+void ThreadedRenderDevice::setActiveTexture(unsigned int unit)
+{
+    m_activeTextureUnit = unit;
+    _add(CMD_ACTIVE_TEXTURE)->u[0] = unit;
+}
+
+void ThreadedRenderDevice::setTextureParameter(unsigned int name, int value)
+{
+    RenderCommand* command = _add(CMD_TEXTURE_PARAMETER);
+    command->u[0] = name;
+    command->i[1] = value;
+}
+
+void ThreadedRenderDevice::uploadTexture(int internalFormat, int width, int height, unsigned int format, unsigned int type, 
+                                         const void* pixels, unsigned int numBytes)
+{
+    RenderCommand* command = _add(CMD_UPLOAD_TEXTURE, numBytes);
+    command->i[0] = internalFormat;
+    command->i[1] = width;
+    command->i[2] = height;
+    command->u[3] = format;
+    command->u[4] = type;
+    command->u[5] = numBytes;
+    memcpy(command + 1, pixels, numBytes);
+}
+
+void ThreadedRenderDevice::setTexEnv(unsigned int name, int value)
+{
+    RenderCommand* command = _add(CMD_TEX_ENV);
+    command->u[0] = name;
+    command->i[1] = value;
+}
+
+void ThreadedRenderDevice::setTexEnvColor(const float color[4])
+{
+    memcpy(_add(CMD_TEX_ENV_COLOR)->f, color, sizeof(float) * 4);
+}
+
+//-----------------------------------------------------------------------------
+//* Set Vertex Arrays
+//! Only remembered, vertices are copied by every drawTriangles
+//-----------------------------------------------------------------------------
+void ThreadedRenderDevice::setVertexArrays(GLVertex* vertices, bool secondaryColor)
+{
+    m_vertices       = vertices;
+    m_secondaryColor = secondaryColor;
+}
+
+//-----------------------------------------------------------------------------
+//* Draw Triangles
+//! Records a copy of the vertices, the renderer reuses its buffer as soon
+//! as this returns.
+//-----------------------------------------------------------------------------
+void ThreadedRenderDevice::drawTriangles(int numVertices)
+{
+    RenderCommand* command = _add(CMD_DRAW_TRIANGLES, numVertices * sizeof(GLVertex));
+    command->i[0] = numVertices;
+    command->u[1] = m_secondaryColor ? 1 : 0;
+    command->u[2] = m_fogCoordinates ? 1 : 0;
+    command->u[3] = m_fogType;
+    command->i[4] = m_fogStride;
+    command->u[5] = m_fogOffset;
+    memcpy(command + 1, m_vertices, numVertices * sizeof(GLVertex));
+}
+
+//-----------------------------------------------------------------------------
+//* Draw Quad
+//! Data: vertices, color, secondary color. u[0] tells if secondary color is
+//! used, u[1] if quad is textured.
+//-----------------------------------------------------------------------------
+void ThreadedRenderDevice::drawQuad(const RenderQuadVertex vertices[4], const float color[4], const float* secondaryColor, bool textured)
+{
+    unsigned int verticesSize = sizeof(RenderQuadVertex) * 4;
+    RenderCommand* command = _add(CMD_DRAW_QUAD, verticesSize + sizeof(float) * 8);
+    command->u[0] = secondaryColor ? 1 : 0;
+    command->u[1] = textured ? 1 : 0;
+
+    unsigned char* data = (unsigned char*)(command + 1);
+    memcpy(data, vertices, verticesSize);
+    memcpy(data + verticesSize, color, sizeof(float) * 4);
+    if ( secondaryColor )
+    {
+        memcpy(data + verticesSize + sizeof(float) * 4, secondaryColor, sizeof(float) * 3);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Frame
+//-----------------------------------------------------------------------------
+void ThreadedRenderDevice::finish() { _add(CMD_FINISH); }
+
+struct ReadPixelsQuery
+{
+    void* dest;
+    int   width;
+    int   height;
+    bool  front;
+};
+
+static void readPixelsQuery(RenderDevice* target, void* argument)
+{
+    ReadPixelsQuery* query = (ReadPixelsQuery*)argument;
+    target->readPixels(query->dest, query->width, query->height, query->front);
+}
+
+//-----------------------------------------------------------------------------
+//* Read Pixels
+//! Sync point, waits for all recorded commands before reading
+//-----------------------------------------------------------------------------
+void ThreadedRenderDevice::readPixels(void* dest, int width, int height, bool front)
+{
+    ReadPixelsQuery query = { dest, width, height, front };
+    _execute(readPixelsQuery, &query);
+}
+
+//-----------------------------------------------------------------------------
+//* Call Rendering Callback
+//! Frontend callback renders with OpenGL, so it is called on render thread
+//-----------------------------------------------------------------------------
+void ThreadedRenderDevice::callRenderingCallback(void (*callback)(int), int drawFlag)
+{
+    RenderCommand* command = _add(CMD_RENDERING_CALLBACK);
+    command->p[0] = (void*)callback;
+    command->i[2] = drawFlag;
+}
+
+//-----------------------------------------------------------------------------
+//* Swap Buffers
+//! Ends the frame, the render thread replays it while the next frame is
+//! recorded.
+//-----------------------------------------------------------------------------
+void ThreadedRenderDevice::swapBuffers()
+{
+    _add(CMD_SWAP_BUFFERS);
+    _submit();
+}
+
+//-----------------------------------------------------------------------------
+//* Frame Fences
+//! Recorded like any other call, so fences are waited on by the render
+//! thread. The emulation thread is paced by the arena handoff in swapBuffers.
+//-----------------------------------------------------------------------------
+void ThreadedRenderDevice::insertFrameFence() { _add(CMD_INSERT_FRAME_FENCE); }
+
+void ThreadedRenderDevice::waitFrameFence(int maxPendingFrames)
+{
+    RenderCommand* command = _add(CMD_WAIT_FRAME_FENCE);
+    command->i[0] = maxPendingFrames;
+}
+
+//-----------------------------------------------------------------------------
+//* Read Pixels Async
+//! Recorded, the read is started when the render thread replays the frame
+//-----------------------------------------------------------------------------
+void ThreadedRenderDevice::readPixelsAsync(unsigned int buffer, int width, int height)
+{
+    RenderCommand* command = _add(CMD_READ_PIXELS_ASYNC);
+    command->u[0] = buffer;
+    command->i[1] = width;
+    command->i[2] = height;
+}
+
+struct AsyncPixelsQuery
+{
+    unsigned int buffer;
+    void*        dest;
+    bool         wait;
+    unsigned int stride;
+    bool         result;
+};
+
+static void asyncPixelsQuery(RenderDevice* target, void* argument)
+{
+    AsyncPixelsQuery* query = (AsyncPixelsQuery*)argument;
+    query->result = target->getAsyncPixels(query->buffer, query->dest, query->wait, query->stride);
+}
+
+//-----------------------------------------------------------------------------
+//* Get Async Pixels
+//! Sync point like readPixels, but the pixels were copied while the render
+//! thread replayed earlier frames.
+//-----------------------------------------------------------------------------
+bool ThreadedRenderDevice::getAsyncPixels(unsigned int buffer, void* dest, bool wait, unsigned int stride)
+{
+    AsyncPixelsQuery query = { buffer, dest, wait, stride, false };
+    _execute(asyncPixelsQuery, &query);
+    return query.result;
+}
+
+struct FramebufferQuery
+{
+    bool result;
+};
+
+static void framebufferQuery(RenderDevice* target, void* argument)
+{
+    ((FramebufferQuery*)argument)->result = target->isFramebufferSupported();
+}
+
+//-----------------------------------------------------------------------------
+//* Is Framebuffer Supported
+//! Sync point, only asked when readback or framebuffer textures are set up
+//-----------------------------------------------------------------------------
+bool ThreadedRenderDevice::isFramebufferSupported()
+{
+    FramebufferQuery query = { false };
+    _execute(framebufferQuery, &query);
+    return query.result;
+}
+
+//-----------------------------------------------------------------------------
+//* Downscale
+//! Recorded, scaled frame is read by the readPixels calls recorded after it
+//-----------------------------------------------------------------------------
+void ThreadedRenderDevice::downscale(bool front, int srcWidth, int srcHeight, int width, int height, bool box)
+{
+    RenderCommand* command = _add(CMD_DOWNSCALE);
+    command->i[0] = front ? 1 : 0;
+    command->i[1] = srcWidth;
+    command->i[2] = srcHeight;
+    command->i[3] = width;
+    command->i[4] = height;
+    command->i[5] = box ? 1 : 0;
+}
+
+void ThreadedRenderDevice::endDownscale() { _add(CMD_END_DOWNSCALE); }
+
+//-----------------------------------------------------------------------------
+//* Create Render Target
+//! Recorded, texture name was handed out by generateTexture
+//-----------------------------------------------------------------------------
+void ThreadedRenderDevice::createRenderTarget(unsigned int target, unsigned int texture, int width, int height)
+{
+    RenderCommand* command = _add(CMD_CREATE_RENDER_TARGET);
+    command->u[0] = target;
+    command->u[1] = texture;
+    command->i[2] = width;
+    command->i[3] = height;
+}
+
+void ThreadedRenderDevice::deleteRenderTarget(unsigned int target) { _add(CMD_DELETE_RENDER_TARGET)->u[0] = target; }
+void ThreadedRenderDevice::bindRenderTarget(unsigned int target)   { _add(CMD_BIND_RENDER_TARGET)->u[0] = target;   }
+
+//-----------------------------------------------------------------------------
+//* Synchronize
+//! Sync point, waits until render thread has executed all recorded commands
+//-----------------------------------------------------------------------------
+void ThreadedRenderDevice::synchronize()
+{
+    if ( !m_thread.isRunning() )
+    {
+        return;
+    }
+
+    _submit();
+
+    m_mutex.lock();
+    while ( m_submitted )
+    {
+        m_doneCondition.wait(m_mutex);
+    }
+    m_mutex.unlock();
+}
+
+//-----------------------------------------------------------------------------
+//* Submit
+//! Hands recorded arena to render thread and starts recording the other
+//! one, waits if the render thread is still busy with it.
+//-----------------------------------------------------------------------------
+void ThreadedRenderDevice::_submit()
+{
+    m_mutex.lock();
+    while ( m_submitted )
+    {
+        m_doneCondition.wait(m_mutex);
+    }
+    m_submittedArena = m_recordArena;
+    m_submitted = true;
+    m_submitCondition.signal();
+    m_mutex.unlock();
+
+    m_recordArena ^= 1;
+    m_arenas[m_recordArena].clear();
+}
+
+//-----------------------------------------------------------------------------
+//* Execute
+//! Runs function on render thread after all recorded commands and waits
+//! for it to return.
+//-----------------------------------------------------------------------------
+void ThreadedRenderDevice::_execute(void (*function)(RenderDevice* target, void* argument), void* argument)
+{
+    RenderCommand* command = _add(CMD_EXECUTE);
+    command->p[0] = (void*)function;
+    command->p[1] = argument;
+    synchronize();
+}
+
+//-----------------------------------------------------------------------------
+//* Render Thread
+//! Makes context current and replays submitted arenas until told to quit
+//-----------------------------------------------------------------------------
+void ThreadedRenderDevice::_renderThread(void* device)
+{
+    ThreadedRenderDevice* self = (ThreadedRenderDevice*)device;
+    bool current = self->m_context.makeCurrent();
+
+    self->m_mutex.lock();
+    self->m_contextCurrent = current;
+    for (;;)
+    {
+        while ( !self->m_submitted && !self->m_quit )
+        {
+            self->m_submitCondition.wait(self->m_mutex);
+        }
+        if ( !self->m_submitted )
+        {
+            break;
+        }
+        RenderCommandArena* arena = &self->m_arenas[self->m_submittedArena];
+        self->m_mutex.unlock();
+
+        //Without context commands are dropped, initialize fails anyway
+        if ( current )
+        {
+            self->_replay(arena);
+        }
+
+        self->m_mutex.lock();
+        self->m_submitted = false;
+        self->m_doneCondition.broadcast();
+    }
+    self->m_mutex.unlock();
+
+    if ( current )
+    {
+        self->m_context.release();
+    }
+}
+
+//-----------------------------------------------------------------------------
+//* Replay
+//! Executes recorded commands with target device
+//-----------------------------------------------------------------------------
+void ThreadedRenderDevice::_replay(RenderCommandArena* arena)
+{
+    RenderDevice* target = m_target;
+    unsigned char* data = arena->getData();
+    unsigned char* end  = data + arena->getSize();
+
+    while ( data < end )
+    {
+        RenderCommand* command = (RenderCommand*)data;
+        void* payload = command + 1;
+
+        switch ( command->type )
+        {
+            case CMD_ENABLE               : target->enable(command->u[0]);                                    break;
+            case CMD_DISABLE              : target->disable(command->u[0]);                                   break;
+            case CMD_ENABLE_CLIENT_STATE  : target->enableClientState(command->u[0]);                         break;
+            case CMD_DISABLE_CLIENT_STATE : target->disableClientState(command->u[0]);                        break;
+            case CMD_BLEND_FUNC           : target->setBlendFunc(command->u[0], command->u[1]);               break;
+            case CMD_DEPTH_FUNC           : target->setDepthFunc(command->u[0]);                              break;
+            case CMD_DEPTH_MASK           : target->setDepthMask(command->u[0] != 0);                         break;
+            case CMD_DEPTH_RANGE          : target->setDepthRange(command->f[0], command->f[1]);              break;
+            case CMD_ALPHA_FUNC           : target->setAlphaFunc(command->u[0], command->f[1]);               break;
+            case CMD_POLYGON_OFFSET       : target->setPolygonOffset(command->f[0], command->f[1]);           break;
+            case CMD_POLYGON_MODE         : target->setPolygonMode(command->u[0], command->u[1]);             break;
+            case CMD_CULL_FACE            : target->setCullFace(command->u[0]);                               break;
+            case CMD_VIEWPORT             : target->setViewport(command->i[0], command->i[1], command->i[2], command->i[3]); break;
+            case CMD_SCISSOR              : target->setScissor(command->i[0], command->i[1], command->i[2], command->i[3]);  break;
+            case CMD_FOG_PARAMETERI       : target->setFogParameteri(command->u[0], command->i[1]);           break;
+            case CMD_FOG_PARAMETERF       : target->setFogParameterf(command->u[0], command->f[1]);           break;
+            case CMD_FOG_COLOR            : target->setFogColor(command->f);                                  break;
+            case CMD_FOG_COORD_POINTER    : target->setFogCoordPointer(command->u[0], command->i[1], command->p[2]); break;
+            case CMD_CLEAR_COLOR          : target->setClearColor(command->f[0], command->f[1], command->f[2], command->f[3]); break;
+            case CMD_CLEAR                : target->clear(command->u[0]);                                     break;
+            case CMD_MATRIX_MODE          : target->setMatrixMode(command->u[0]);                             break;
+            case CMD_LOAD_IDENTITY        : target->loadIdentity();                                           break;
+            case CMD_PUSH_MATRIX          : target->pushMatrix();                                             break;
+            case CMD_POP_MATRIX           : target->popMatrix();                                              break;
+            case CMD_ORTHO                : target->ortho(command->d[0], command->d[1], command->d[2], command->d[3], command->d[4], command->d[5]); break;
+            case CMD_DELETE_TEXTURE       : target->deleteTexture(&command->u[0]);                            break;
+            case CMD_BIND_TEXTURE         : target->bindTexture(command->u[0]);                               break;
+            case CMD_ACTIVE_TEXTURE       : target->setActiveTexture(command->u[0]);                          break;
+            case CMD_TEXTURE_PARAMETER    : target->setTextureParameter(command->u[0], command->i[1]);        break;
+            case CMD_TEX_ENV              : target->setTexEnv(command->u[0], command->i[1]);                  break;
+            case CMD_TEX_ENV_COLOR        : target->setTexEnvColor(command->f);                               break;
+            case CMD_FINISH               : target->finish();                                                 break;
+            case CMD_SWAP_BUFFERS         : target->swapBuffers();                                            break;
+            case CMD_INSERT_FRAME_FENCE   : target->insertFrameFence();                                       break;
+            case CMD_WAIT_FRAME_FENCE     : target->waitFrameFence(command->i[0]);                            break;
+            case CMD_READ_PIXELS_ASYNC    : target->readPixelsAsync(command->u[0], command->i[1], command->i[2]); break;
+            case CMD_DOWNSCALE            : target->downscale(command->i[0] != 0, command->i[1], command->i[2], command->i[3], command->i[4], command->i[5] != 0); break;
+            case CMD_END_DOWNSCALE        : target->endDownscale();                                           break;
+            case CMD_CREATE_RENDER_TARGET : target->createRenderTarget(command->u[0], command->u[1], command->i[2], command->i[3]); break;
+            case CMD_DELETE_RENDER_TARGET : target->deleteRenderTarget(command->u[0]);                        break;
+            case CMD_BIND_RENDER_TARGET   : target->bindRenderTarget(command->u[0]);                          break;
+
+            case CMD_UPLOAD_TEXTURE :
+                target->uploadTexture(command->i[0], command->i[1], command->i[2], command->u[3], command->u[4], payload, command->u[5]);
+                break;
+
+            case CMD_DRAW_TRIANGLES :
+                target->setVertexArrays((GLVertex*)payload, command->u[1] != 0);
+                if ( command->u[2] )
+                {
+                    target->setFogCoordPointer(command->u[3], command->i[4], (unsigned char*)payload + command->u[5]);
+                }
+                target->drawTriangles(command->i[0]);
+                break;
+
+            case CMD_DRAW_QUAD :
+            {
+                float* color = (float*)((unsigned char*)payload + sizeof(RenderQuadVertex) * 4);
+                target->drawQuad((RenderQuadVertex*)payload, color, command->u[0] ? color + 4 : 0, command->u[1] != 0);
+                break;
+            }
+
+            case CMD_RENDERING_CALLBACK :
+                target->callRenderingCallback((void (*)(int))command->p[0], command->i[2]);
+                break;
+
+            case CMD_EXECUTE :
+                ((void (*)(RenderDevice*, void*))command->p[0])(target, command->p[1]);
+                break;
+        }
+
+        data += sizeof(RenderCommand) + command->dataSize;
+    }
+}
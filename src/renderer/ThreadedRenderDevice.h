@@ -0,0 +1,226 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef THREADED_RENDER_DEVICE_H_
+#define THREADED_RENDER_DEVICE_H_
+
+#include <map>
+
+#include "GLContext.h"
+#include "RenderDevice.h"
+#include "Thread.h"
+
+//*****************************************************************************
+//* Render Command
+//! One recorded render device call. Calls passing arrays (vertices, pixels)
+//! are followed by a copy of the data in the arena.
+//*****************************************************************************
+struct RenderCommand
+{
+    unsigned int type;             //!< RenderCommandType
+    unsigned int dataSize;         //!< Size of data following command (aligned)
+    union
+    {
+        int          i[6];
+        unsigned int u[6];
+        float        f[6];
+        double       d[6];
+        void*        p[6];
+    };
+};
+
+//*****************************************************************************
+//* Render Command Arena
+//! Growing buffer commands are recorded into, reused every frame
+//*****************************************************************************
+class RenderCommandArena
+{
+public:
+
+    //Constructor / Destructor
+    RenderCommandArena();
+    ~RenderCommandArena();
+
+    bool initialize(unsigned int capacity);
+    void dispose();
+
+    //Add command with room for dataSize bytes after it
+    RenderCommand* add(unsigned int type, unsigned int dataSize=0);
+
+    //! Remove all commands
+    void clear() { m_size = 0; }
+
+    //! Get recorded commands
+    unsigned char* getData()  { return m_data; }
+    unsigned int   getSize()  { return m_size; }
+
+private:
+
+    unsigned char* m_data;         //!< Recorded commands
+    unsigned int   m_size;         //!< Bytes used
+    unsigned int   m_capacity;     //!< Bytes allocated
+
+};
+
+//*****************************************************************************
+//* Threaded Render Device
+//! Render device that records calls on the emulation thread and replays
+//! them on a render thread owning the OpenGL context.
+//! @details Commands are recorded into one of two arenas. swapBuffers ends
+//!          the frame and hands the arena to the render thread, waiting only
+//!          if the render thread has not finished the previous frame yet.
+//!          Calls returning data (readPixels, extension and state queries)
+//!          are synchronous. Texture names are generated in blocks so
+//!          generateTexture does not have to wait.
+//*****************************************************************************
+class ThreadedRenderDevice : public RenderDevice
+{
+public:
+
+    //Constructor / Destructor
+    ThreadedRenderDevice(RenderDevice* target);
+    virtual ~ThreadedRenderDevice();
+
+    //Initialize / Dispose
+    virtual bool initialize();
+    virtual void dispose();
+
+    //Extensions
+    virtual bool isExtensionSupported(const char* extension);
+
+    //Capabilities
+    virtual void enable(unsigned int capability);
+    virtual void disable(unsigned int capability);
+    virtual bool isEnabled(unsigned int capability);
+    virtual void enableClientState(unsigned int array);
+    virtual void disableClientState(unsigned int array);
+
+    //States
+    virtual void setBlendFunc(unsigned int sourceFactor, unsigned int destinationFactor);
+    virtual void setDepthFunc(unsigned int func);
+    virtual void setDepthMask(bool write);
+    virtual void setDepthRange(float zNear, float zFar);
+    virtual void setAlphaFunc(unsigned int func, float reference);
+    virtual void setPolygonOffset(float factor, float units);
+    virtual void setPolygonMode(unsigned int face, unsigned int mode);
+    virtual void setCullFace(unsigned int face);
+    virtual void setViewport(int x, int y, int width, int height);
+    virtual void setScissor(int x, int y, int width, int height);
+
+    //Fog
+    virtual void setFogParameteri(unsigned int name, int value);
+    virtual void setFogParameterf(unsigned int name, float value);
+    virtual void setFogColor(const float color[4]);
+    virtual void setFogCoordPointer(unsigned int type, int stride, const void* pointer);
+
+    //Clear
+    virtual void setClearColor(float r, float g, float b, float a);
+    virtual void clear(unsigned int mask);
+
+    //Matrices
+    virtual void setMatrixMode(unsigned int mode);
+    virtual void loadIdentity();
+    virtual void pushMatrix();
+    virtual void popMatrix();
+    virtual void ortho(double left, double right, double bottom, double top, double zNear, double zFar);
+
+    //Textures
+    virtual void generateTexture(unsigned int* id);
+    virtual void deleteTexture(unsigned int* id);
+    virtual void bindTexture(unsigned int id);
+    virtual void setActiveTexture(unsigned int unit);
+    virtual void setTextureParameter(unsigned int name, int value);
+    virtual void uploadTexture(int internalFormat, int width, int height, unsigned int format, unsigned int type, 
+                               const void* pixels, unsigned int numBytes);
+    virtual void setTexEnv(unsigned int name, int value);
+    virtual void setTexEnvColor(const float color[4]);
+
+    //Geometry
+    virtual void setVertexArrays(GLVertex* vertices, bool secondaryColor);
+    virtual void drawTriangles(int numVertices);
+    virtual void drawQuad(const RenderQuadVertex vertices[4], const float color[4], const float* secondaryColor, bool textured);
+
+    //Frame
+    virtual void finish();
+    virtual void readPixels(void* dest, int width, int height, bool front);
+    virtual void callRenderingCallback(void (*callback)(int), int drawFlag);
+    virtual void swapBuffers();
+    virtual void synchronize();
+    virtual void insertFrameFence();
+    virtual void waitFrameFence(int maxPendingFrames);
+    virtual void readPixelsAsync(unsigned int buffer, int width, int height);
+    virtual bool getAsyncPixels(unsigned int buffer, void* dest, bool wait, unsigned int stride);
+    virtual bool isFramebufferSupported();
+    virtual void downscale(bool front, int srcWidth, int srcHeight, int width, int height, bool box);
+    virtual void endDownscale();
+    virtual void createRenderTarget(unsigned int target, unsigned int texture, int width, int height);
+    virtual void deleteRenderTarget(unsigned int target);
+    virtual void bindRenderTarget(unsigned int target);
+
+private:
+
+    void _stop();
+
+    //Commands
+    RenderCommand* _add(unsigned int type, unsigned int dataSize=0) { return m_arenas[m_recordArena].add(type, dataSize); }
+    void _submit();
+    void _execute(void (*function)(RenderDevice* target, void* argument), void* argument);
+
+    //Render thread
+    static void _renderThread(void* device);
+    void _replay(RenderCommandArena* arena);
+
+private:
+
+    static const unsigned int NUM_TEXTURE_NAMES = 64;   //!< Texture names generated at a time
+
+    RenderDevice* m_target;                 //!< Device executing commands on render thread
+    GLContext     m_context;                //!< Context moved to render thread
+    Thread        m_thread;                 //!< Render thread
+
+    //Arenas
+    RenderCommandArena m_arenas[2];         //!< Command arenas, recorded and replayed in turn
+    unsigned int  m_recordArena;            //!< Arena recorded by emulation thread
+
+    //Shared with render thread
+    Mutex         m_mutex;                  //!< Protects members below
+    Condition     m_submitCondition;        //!< Signaled when an arena is submitted
+    Condition     m_doneCondition;          //!< Signaled when render thread is done with arena
+    bool          m_submitted;              //!< Arena is waiting for or being replayed
+    unsigned int  m_submittedArena;         //!< Arena replayed by render thread
+    bool          m_quit;                   //!< Render thread should exit
+    bool          m_contextCurrent;         //!< Render thread made context current
+
+    //State kept on emulation thread
+    std::map<unsigned int, bool> m_capabilities;  //!< Enabled capabilities, queried once
+    unsigned int  m_activeTextureUnit;      //!< Texture unit GL_TEXTURE_2D is enabled for
+    GLVertex*     m_vertices;               //!< Vertex array set by renderer
+    bool          m_secondaryColor;         //!< Vertex array has secondary color
+    bool          m_fogCoordinates;         //!< Fog coordinates are read from vertex array
+    unsigned int  m_fogType;                //!< Type of fog coordinates
+    int           m_fogStride;              //!< Stride of fog coordinates
+    unsigned int  m_fogOffset;              //!< Offset of fog coordinates in vertex
+    unsigned int  m_textureNames[NUM_TEXTURE_NAMES];  //!< Generated texture names not handed out yet
+    unsigned int  m_numTextureNames;        //!< Number of names left
+
+};
+
+#endif
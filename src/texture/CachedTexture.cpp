@@ -22,6 +22,7 @@
 #include "CachedTexture.h"
 
 #include "OpenGL.h"
+#include "RenderDevice.h"
 #include "m64p.h"
 
 //-----------------------------------------------------------------------------
@@ -47,6 +48,7 @@ CachedTexture::CachedTexture()
     realWidth = realHeight = 0;    // Actual texture size
     scaleS = scaleT  = 0;          // Scale to map to 0.0-1.0
     shiftScaleS = shiftScaleT = 0; // Scale to shift
+    frameBufferTexture = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -62,8 +64,8 @@ CachedTexture::~CachedTexture()
 //-----------------------------------------------------------------------------
 void CachedTexture::activate()
 {
-    glEnable(GL_TEXTURE_2D);
-    glBindTexture( GL_TEXTURE_2D, m_id );
+    RenderDevice::getSingleton().enable(GL_TEXTURE_2D);
+    RenderDevice::getSingleton().bindTexture( m_id );
 }
 
 //-----------------------------------------------------------------------------
@@ -71,8 +73,8 @@ void CachedTexture::activate()
 //-----------------------------------------------------------------------------
 void CachedTexture::deactivate()
 {
-    glDisable(GL_TEXTURE_2D);
-    glBindTexture( GL_TEXTURE_2D, 0 );    
+    RenderDevice::getSingleton().disable(GL_TEXTURE_2D);
+    RenderDevice::getSingleton().bindTexture( 0 );    
 }
 
 //-----------------------------------------------------------------------------
@@ -71,7 +71,7 @@ public:
     float         scaleS, scaleT;            //!< Scale to map to 0.0-1.0
     float         shiftScaleS, shiftScaleT;  //!< Scale to shift
 //    unsigned int lastDList;
-//    unsigned int frameBufferTexture;
+    bool          frameBufferTexture;        //!< Color image rendered by FrameBufferCache?
 
 };
 
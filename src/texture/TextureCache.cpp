@@ -22,13 +22,16 @@
 #include <algorithm>
 
 #include "CachedTexture.h"
+#include "FrameBufferCache.h"
 #include "GBIDefs.h"
 #include "MathLib.h"
 #include "OpenGL.h"
 #include "RDP.h"
 #include "RSP.h"
+#include "RenderDevice.h"
 #include "TextureCache.h"
 #include "TextureLoader.h"
+#include "ThreadPool.h"
 
     using std::min;
 #include "Memory.h"
@@ -52,6 +55,14 @@ TextureCache::TextureCache()
 {
     m_currentTextures[0] = 0;
     m_currentTextures[1] = 0;
+    m_frameBufferCache = 0;
+    m_numHits = 0;
+    m_numMisses = 0;
+    for (int i=0; i<NUM_ROWS_MATRICES; ++i)
+    {
+        m_rowsMatrices[i].bpl = 0;
+        m_rowsMatrices[i].numRows = 0;
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -72,6 +83,8 @@ bool TextureCache::initialize(RSP* rsp, RDP* rdp, Memory* memory, unsigned int t
     m_memory   = memory;
     m_bitDepth = textureBitDepth;
     m_maxBytes = cacheSize;
+    m_numHits = 0;
+    m_numMisses = 0;
     
     return true;
 }
@@ -94,6 +107,7 @@ void TextureCache::update(unsigned int tile)
     }
     else if ( m_rdp->getTextureMode() == TM_FRAMEBUFFER )
     {
+        _activateFrameBuffer(tile);
         return;
     }
 
@@ -101,10 +115,65 @@ void TextureCache::update(unsigned int tile)
     CachedTexture temp;    
     unsigned int maskWidth = 0, maskHeight = 0;
     _calculateTextureSize(tile, &temp, maskWidth, maskHeight);
+    temp.crc = _calculateCRC(tile, temp.width, temp.height);
 
-    static int hits = 0;
-    static int misses = 0;
+    _useTexture(tile, temp, maskWidth, maskHeight);
+}
 
+//-----------------------------------------------------------------------------
+//* Update Both
+//! Same as update(0) followed by update(1), but tile 1 is hashed by a worker
+//! thread while tile 0 is hashed on this thread. Neither tile depends on
+//! the other being activated, so the textures found are the same.
+//-----------------------------------------------------------------------------
+void TextureCache::updateBoth()
+{
+    //Special textures?
+    if ( m_rdp->getTextureMode() == TM_BGIMAGE )
+    {
+        return;
+    }
+    else if ( m_rdp->getTextureMode() == TM_FRAMEBUFFER )
+    {
+        _activateFrameBuffer(0);
+        _activateFrameBuffer(1);
+        return;
+    }
+
+    CachedTexture temp[2];
+    unsigned int maskWidth[2] = { 0, 0 };
+    unsigned int maskHeight[2] = { 0, 0 };
+    _calculateTextureSize(0, &temp[0], maskWidth[0], maskHeight[0]);
+    _calculateTextureSize(1, &temp[1], maskWidth[1], maskHeight[1]);
+
+    CRCTile job;
+    job.cache   = this;
+    job.tile    = 1;
+    job.texture = &temp[1];
+
+    TaskGroup group;
+    if ( ThreadPool::getSingleton().getNumThreads() > 1 &&
+         _getCRCBytes(1, temp[1].width, temp[1].height) >= DUAL_CRC_BYTES )
+    {
+        group.run(_calculateCRCTile, &job);
+    }
+    else
+    {
+        _calculateCRCTile(&job);
+    }
+    temp[0].crc = _calculateCRC(0, temp[0].width, temp[0].height);
+    group.wait();
+
+    _useTexture(0, temp[0], maskWidth[0], maskHeight[0]);
+    _useTexture(1, temp[1], maskWidth[1], maskHeight[1]);
+}
+
+//-----------------------------------------------------------------------------
+//* Use Texture
+//! Activates texture from cache, or loads it when it is not cached
+//-----------------------------------------------------------------------------
+void TextureCache::_useTexture(unsigned int tile, CachedTexture& temp, unsigned int maskWidth, unsigned int maskHeight)
+{
     //For each texture in texture cache
     for (TextureList::iterator it=m_cachedTextures.begin(); it!=m_cachedTextures.end(); ++it)
       {
@@ -113,15 +182,15 @@ void TextureCache::update(unsigned int tile)
         if ( *temp2 == temp )
         {
             _activateTexture( tile, (*it) );
-            hits++;
+            m_numHits++;
             return;
         }
     }
-    misses++;
+    m_numMisses++;
 
     // If multitexturing, set the appropriate texture
     //if (OGL.ARB_multitexture)
-    glActiveTextureARB( GL_TEXTURE0_ARB + tile );
+    RenderDevice::getSingleton().setActiveTexture( tile );
 
     //Add new texture to cache
     m_currentTextures[tile] = addTop();
@@ -236,7 +305,7 @@ CachedTexture* TextureCache::addTop()
     CachedTexture* newTexture = new CachedTexture();
 
     //Generate a texture
-    glGenTextures(1, &newTexture->m_id);
+    RenderDevice::getSingleton().generateTexture(&newTexture->m_id);
 
     //Add Texture to cache
     m_cachedTextures.push_front(newTexture);
@@ -260,7 +329,7 @@ void TextureCache::removeBottom()
     //    FrameBuffer_RemoveBuffer( cache.bottom->address );
 
     //Delete texture
-    glDeleteTextures(1, &lastTexture->m_id);
+    RenderDevice::getSingleton().deleteTexture(&lastTexture->m_id);
 
     delete lastTexture;
 }
@@ -404,9 +473,11 @@ void TextureCache::_loadTexture(CachedTexture* texture)
     }
 
     //Send Texture to OpenGL
-    glTexImage2D( GL_TEXTURE_2D, 0, internalFormat, texture->realWidth, texture->realHeight, 0, GL_RGBA, imageType, dest );
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    RenderDevice& device = RenderDevice::getSingleton();
+    device.uploadTexture( internalFormat, texture->realWidth, texture->realHeight, GL_RGBA, imageType, dest, 
+                          texture->realWidth * texture->realHeight * (internalFormat == GL_RGBA8 ? 4 : 2) );
+    device.setTextureParameter( GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    device.setTextureParameter( GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     delete[] dest;
 }
 
@@ -530,16 +601,21 @@ void TextureCache::_calculateTextureSize(unsigned int tile, CachedTexture* out,
     out->clampT      = m_rsp->getTile(tile)->clampt;
     out->format      = m_rsp->getTile(tile)->format;
     out->size        = m_rsp->getTile(tile)->size; 
-    out->crc         = _calculateCRC(tile, width, height );
 }
 
-unsigned int TextureCache::_calculateCRC(unsigned int t, unsigned int width, unsigned int height)
+//-----------------------------------------------------------------------------
+//* Calculate CRC
+//! Hashes texture memory used by tile. Large tiles are split in row ranges
+//! hashed by worker threads, then combined into the same value as when
+//! rows are hashed in order (see CRCCalculator2::calcRowsMatrix).
+//! @param split Split rows between threads? Only one thread may split at once.
+//-----------------------------------------------------------------------------
+unsigned int TextureCache::_calculateCRC(unsigned int t, unsigned int width, unsigned int height, bool split)
 {
     RDPTile* tile = m_rsp->getTile(t);
 
     unsigned int crc;
-    unsigned int y, bpl, line;
-    unsigned long long *src;
+    unsigned int bpl, line;
 
     //TODO: remove if new works
     //src = m_memory->getTextureMemory(tile->tmem);
@@ -549,13 +625,32 @@ unsigned int TextureCache::_calculateCRC(unsigned int t, unsigned int width, uns
      if (tile->size == G_IM_SIZ_32b)
         line <<= 1;
 
-    crc = 0xFFFFFFFF;
-     for (y=0; y<height; ++y)
+    ThreadPool& pool = ThreadPool::getSingleton();
+    if ( split && pool.getNumThreads() > 1 && height > 1 && bpl * height >= PARALLEL_CRC_BYTES )
     {
-        src = m_memory->getTextureMemory((tile->tmem + (y * line)) & 511);
-        crc = m_crcCalculator.calcCRC( crc, src, bpl );
-        //TODO: remove if new works
-        //src += line;
+        unsigned int numParts = pool.getNumThreads();
+        if ( numParts > MAX_CRC_PARTS ) numParts = MAX_CRC_PARTS;
+        if ( numParts > height )        numParts = height;
+
+        CRCRows rows;
+        rows.cache       = this;
+        rows.tile        = tile;
+        rows.bpl         = bpl;
+        rows.line        = line;
+        rows.rowsPerPart = (height + numParts - 1) / numParts;
+        pool.parallelFor(0, height, rows.rowsPerPart, _calculateCRCRows, &rows);
+
+        //Parts are hashed from zero, shift earlier rows past them
+        crc = 0xFFFFFFFF;
+        for (unsigned int first=0; first<height; first+=rows.rowsPerPart)
+        {
+            unsigned int numRows = min( rows.rowsPerPart, height - first );
+            crc = CRCCalculator2::multiplyMatrix( _getRowsMatrix(bpl, numRows), crc ) ^ rows.crc[first / rows.rowsPerPart];
+        }
+    }
+    else
+    {
+        crc = _calculateCRC(0xFFFFFFFF, tile, bpl, line, 0, height);
     }
 
        if ( tile->format == G_IM_FMT_CI )
@@ -568,11 +663,72 @@ unsigned int TextureCache::_calculateCRC(unsigned int t, unsigned int width, uns
     return crc;
 }
 
+//-----------------------------------------------------------------------------
+//* Calculate CRC
+//! Hashes rows [firstRow, endRow) of tile
+//-----------------------------------------------------------------------------
+unsigned int TextureCache::_calculateCRC(unsigned int crc, RDPTile* tile, unsigned int bpl, unsigned int line, unsigned int firstRow, unsigned int endRow)
+{
+    for (unsigned int y=firstRow; y<endRow; ++y)
+    {
+        unsigned long long* src = m_memory->getTextureMemory((tile->tmem + (y * line)) & 511);
+        crc = m_crcCalculator.calcCRC( crc, src, bpl );
+    }
+    return crc;
+}
+
+//-----------------------------------------------------------------------------
+//* Calculate CRC
+//! Called by thread pool to hash a part of the rows, starting from zero
+//-----------------------------------------------------------------------------
+void TextureCache::_calculateCRCRows(void* rows, unsigned int begin, unsigned int end)
+{
+    CRCRows* job = (CRCRows*)rows;
+    job->crc[begin / job->rowsPerPart] = job->cache->_calculateCRC(0, job->tile, job->bpl, job->line, begin, end);
+}
+
+//-----------------------------------------------------------------------------
+//* Calculate CRC
+//! Called by thread pool to hash a whole tile
+//-----------------------------------------------------------------------------
+void TextureCache::_calculateCRCTile(void* tile)
+{
+    CRCTile* job = (CRCTile*)tile;
+    job->texture->crc = job->cache->_calculateCRC(job->tile, job->texture->width, job->texture->height, false);
+}
+
+//-----------------------------------------------------------------------------
+//* Get CRC Bytes
+//! Number of bytes hashed for tile
+//-----------------------------------------------------------------------------
+unsigned int TextureCache::_getCRCBytes(unsigned int t, unsigned int width, unsigned int height)
+{
+    return (width << m_rsp->getTile(t)->size >> 1) * height;
+}
+
+//-----------------------------------------------------------------------------
+//* Get Rows Matrix
+//! Matrix combining hashes of row ranges, kept since tile sizes repeat
+//-----------------------------------------------------------------------------
+const unsigned int* TextureCache::_getRowsMatrix(unsigned int bpl, unsigned int numRows)
+{
+    RowsMatrix& entry = m_rowsMatrices[(bpl * 31 + numRows) % NUM_ROWS_MATRICES];
+    if ( entry.bpl != bpl || entry.numRows != numRows )
+    {
+        m_crcCalculator.calcRowsMatrix(bpl, numRows, entry.matrix);
+        entry.bpl = bpl;
+        entry.numRows = numRows;
+    }
+    return entry.matrix;
+}
+
 void TextureCache::_activateTexture( unsigned int t, CachedTexture *texture )
 {
+    RenderDevice& device = RenderDevice::getSingleton();
+
     // If multitexturing, set the appropriate texture
     //if (OGL.ARB_multitexture)
-        glActiveTextureARB( GL_TEXTURE0_ARB + t );
+        device.setActiveTexture( t );
 
     // Bind the cached texture
     texture->activate();
@@ -586,39 +742,39 @@ void TextureCache::_activateTexture( unsigned int t, CachedTexture *texture )
             // Set Mipmap
             if(m_mipmap == 1)    // nearest
             {
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+                device.setTextureParameter( GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
             }
             else if(m_mipmap == 2)    // bilinear
             {
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+                device.setTextureParameter( GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
             }
             else if(m_mipmap == 3)    // trilinear
             {
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+                device.setTextureParameter( GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
             }
             
             // Tell to hardware to generate mipmap (himself) when glTexImage2D is called
-            glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE);
+            device.setTextureParameter( GL_GENERATE_MIPMAP, GL_TRUE);
         }
         else    // no mipmapping
         {
-            glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
-            glTexParameteri( GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_FALSE );
+            device.setTextureParameter( GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+            device.setTextureParameter( GL_GENERATE_MIPMAP, GL_FALSE );
         }
-        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+        device.setTextureParameter( GL_TEXTURE_MAG_FILTER, GL_LINEAR );
         
     }
     else
     {
-        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
-        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+        device.setTextureParameter( GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+        device.setTextureParameter( GL_TEXTURE_MAG_FILTER, GL_NEAREST );
     }
 
     
 
     // Set clamping modes
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, texture->clampS ? GL_CLAMP_TO_EDGE : GL_REPEAT );
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, texture->clampT ? GL_CLAMP_TO_EDGE : GL_REPEAT );
+    device.setTextureParameter( GL_TEXTURE_WRAP_S, texture->clampS ? GL_CLAMP_TO_EDGE : GL_REPEAT );
+    device.setTextureParameter( GL_TEXTURE_WRAP_T, texture->clampT ? GL_CLAMP_TO_EDGE : GL_REPEAT );
 
     //texture->lastDList = RSP.DList;
 
@@ -626,3 +782,45 @@ void TextureCache::_activateTexture( unsigned int t, CachedTexture *texture )
 
     m_currentTextures[t] = texture;
 }
+
+//-----------------------------------------------------------------------------
+//* Activate Frame Buffer
+//! Binds color image the texture was loaded from, no RDRAM is read. Falls
+//! back to the texels loaded from RDRAM if the buffer is no longer cached.
+//-----------------------------------------------------------------------------
+void TextureCache::_activateFrameBuffer( unsigned int t )
+{
+    CachedTexture* texture = m_frameBufferCache ? m_frameBufferCache->getTexture( m_rsp->getTile(t) ) : 0;
+    if ( !texture )
+    {
+        m_rdp->setTextureMode(TM_NORMAL);
+
+        CachedTexture temp;
+        unsigned int maskWidth = 0, maskHeight = 0;
+        _calculateTextureSize(t, &temp, maskWidth, maskHeight);
+        temp.crc = _calculateCRC(t, temp.width, temp.height);
+        _useTexture(t, temp, maskWidth, maskHeight);
+        return;
+    }
+
+    RenderDevice& device = RenderDevice::getSingleton();
+    device.setActiveTexture( t );
+    texture->activate();
+
+    //No mipmaps, and texture never repeats
+    unsigned int textureFiltering = m_rdp->getTextureFiltering();
+    if ( textureFiltering == G_TF_BILERP || textureFiltering == G_TF_AVERAGE )
+    {
+        device.setTextureParameter( GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+        device.setTextureParameter( GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    }
+    else
+    {
+        device.setTextureParameter( GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+        device.setTextureParameter( GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+    }
+    device.setTextureParameter( GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+    device.setTextureParameter( GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+
+    m_currentTextures[t] = texture;
+}
@@ -30,9 +30,11 @@
 
 //Forward declarations
 class CachedTexture;
+class FrameBufferCache;
 class Memory;
 class RDP;
 class RSP;
+struct RDPTile;
 
 //*****************************************************************************
 //* Texture Cache
@@ -50,10 +52,14 @@ public:
     //Functions
     bool initialize(RSP* rsp, RDP* rdp, Memory* memory, unsigned int textureBitDepth, unsigned int cacheSize=(32 * 1048576));
     void update(unsigned int tile);
+    void updateBoth();
     void dispose();
 
     void setMipmap( int value ) { m_mipmap = value; } 
 
+    //! Sample color images rendered by cache when texture mode is TM_FRAMEBUFFER
+    void setFrameBufferCache(FrameBufferCache* frameBufferCache) { m_frameBufferCache = frameBufferCache; }
+
     //Add and Remove
     CachedTexture* addTop();
     void removeBottom();
@@ -64,13 +70,60 @@ public:
 
     //Get Current Texture
     CachedTexture* getCurrentTexture(int index) { return m_currentTextures[index]; }
+
+    //Statistics
+    unsigned int getNumHits()   { return m_numHits;   }
+    unsigned int getNumMisses() { return m_numMisses; }
     
 private:
 
     void _loadTexture(CachedTexture* texture);
     void _calculateTextureSize(unsigned int tile, CachedTexture* out, unsigned int& maskWidth, unsigned int& maskHeight);
     void _activateTexture( unsigned int t, CachedTexture *texture );
-    unsigned int _calculateCRC(unsigned int t, unsigned int width, unsigned int height);
+    void _activateFrameBuffer( unsigned int t );
+    void _useTexture(unsigned int tile, CachedTexture& temp, unsigned int maskWidth, unsigned int maskHeight);
+
+    //Hashing
+    unsigned int _calculateCRC(unsigned int t, unsigned int width, unsigned int height, bool split=true);
+    unsigned int _calculateCRC(unsigned int crc, RDPTile* tile, unsigned int bpl, unsigned int line, unsigned int firstRow, unsigned int endRow);
+    static void _calculateCRCRows(void* rows, unsigned int begin, unsigned int end);
+    static void _calculateCRCTile(void* tile);
+    unsigned int _getCRCBytes(unsigned int t, unsigned int width, unsigned int height);
+    const unsigned int* _getRowsMatrix(unsigned int bpl, unsigned int numRows);
+
+private:
+
+    static const unsigned int PARALLEL_CRC_BYTES = 2048;  //!< Smaller tiles are hashed by one thread
+    static const unsigned int DUAL_CRC_BYTES = 512;       //!< Smaller second tiles are not hashed by a worker
+    static const unsigned int MAX_CRC_PARTS = 8;          //!< Most row ranges a tile is split in
+    static const int NUM_ROWS_MATRICES = 16;              //!< Row combination matrices kept
+
+    //! Row ranges of a tile hashed by worker threads
+    struct CRCRows
+    {
+        TextureCache* cache;
+        RDPTile*      tile;
+        unsigned int  bpl;                  //!< Bytes hashed per row
+        unsigned int  line;                 //!< Row pitch in TMEM words
+        unsigned int  rowsPerPart;          //!< Rows hashed by each task
+        unsigned int  crc[MAX_CRC_PARTS];   //!< Hash of every part, starting from zero
+    };
+
+    //! Tile hashed by a worker thread
+    struct CRCTile
+    {
+        TextureCache*  cache;
+        unsigned int   tile;
+        CachedTexture* texture;             //!< Size of texture, receives crc
+    };
+
+    //! Matrix combining hashes of row ranges
+    struct RowsMatrix
+    {
+        unsigned int bpl;
+        unsigned int numRows;
+        unsigned int matrix[32];
+    };
 
 private:
 //public:
@@ -78,6 +131,7 @@ private:
     RSP*    m_rsp;                         //!< Pointer to Reality Signal Processor 
     RDP*    m_rdp;                         //!< Pointer to Reality Drawing Processor 
     Memory* m_memory;                      //!< Pointer to Memory manager (handles RDRAM, Texture Memory...)
+    FrameBufferCache* m_frameBufferCache;  //!< Color images rendered to textures, 0 if disabled
 
     ImageFormatSelector m_formatSelector;  //!< Image Format Selector used when decoding textures
     CRCCalculator2      m_crcCalculator;   //!< Hash value calculator for textures
@@ -93,6 +147,11 @@ private:
 
     //Pointers to current textures
     CachedTexture* m_currentTextures[2];   //!< Two textures for multi-texturing.
+
+    RowsMatrix m_rowsMatrices[NUM_ROWS_MATRICES];  //!< Recently used row combination matrices
+
+    unsigned int m_numHits;                //!< Number of lookups found in cache
+    unsigned int m_numMisses;              //!< Number of lookups that had to load a texture
     
 };
 
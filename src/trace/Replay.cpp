@@ -0,0 +1,649 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+//*****************************************************************************
+//* Arachnoid Replay
+//! Standalone front-end that replays a trace written by TraceWriter through
+//! the plugin as fast as possible, using an offscreen EGL context instead of
+//! an emulator core. Reports per-frame CPU time, draw calls, texture misses
+//! and total frames per second. With NullRenderDevice=True no OpenGL context
+//! is created at all, which measures the plugin without the driver.
+//*****************************************************************************
+
+#define M64P_PLUGIN_PROTOTYPES 1
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include "Config.h"
+#include "DisplayListParser.h"
+#include "GraphicsPlugin.h"
+#include "Logger.h"
+#include "Memory.h"
+#include "NullRenderDevice.h"
+#include "OpenGLManager.h"
+#include "OpenGLRenderer.h"
+#include "RDPCommandParser.h"
+#include "RSPVertexCache.h"
+#include "TextureCache.h"
+#include "TraceReader.h"
+#include "m64p.h"
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+//Plugin state defined in main.cpp
+extern GraphicsPlugin g_graphicsPlugin;
+extern Config         g_config;
+
+//Plugin API functions defined in main.cpp
+extern "C"
+{
+    EXPORT BOOL CALL InitiateGFX(GFX_INFO Gfx_Info);
+    EXPORT int  CALL RomOpen();
+    EXPORT void CALL RomClosed();
+    EXPORT void CALL ProcessDList();
+    EXPORT void CALL ProcessRDPList();
+    EXPORT void CALL UpdateScreen();
+}
+
+//-----------------------------------------------------------------------------
+// Configuration
+//-----------------------------------------------------------------------------
+
+#define MAX_SECTIONS   8
+#define MAX_PARAMETERS 64
+
+//*****************************************************************************
+//* Replay Parameter
+//! Configuration value stored as a string, like the core does in its file
+//*****************************************************************************
+struct ReplayParameter
+{
+    int  section;         //!< Index of section, or -1 for command line overrides
+    char name[64];        //!< Name of parameter
+    char value[256];      //!< Value of parameter
+};
+
+static char            g_sectionNames[MAX_SECTIONS][64];
+static int             g_numSections = 0;
+static ReplayParameter g_parameters[MAX_PARAMETERS];
+static int             g_numParameters = 0;
+
+//-----------------------------------------------------------------------------
+//* Find Parameter
+//! Command line overrides are used before values set by the plugin
+//-----------------------------------------------------------------------------
+static ReplayParameter* findParameter(m64p_handle section, const char* name)
+{
+    int index = (int)(size_t)section - 1;
+    ReplayParameter* found = 0;
+    for (int i=0; i<g_numParameters; ++i)
+    {
+        if ( strcmp(g_parameters[i].name, name) != 0 )
+        {
+            continue;
+        }
+        if ( g_parameters[i].section == -1 )
+        {
+            return &g_parameters[i];
+        }
+        if ( g_parameters[i].section == index )
+        {
+            found = &g_parameters[i];
+        }
+    }
+    return found;
+}
+
+//-----------------------------------------------------------------------------
+//* Add Parameter
+//-----------------------------------------------------------------------------
+static bool addParameter(int section, const char* name, const char* value)
+{
+    if ( g_numParameters >= MAX_PARAMETERS )
+    {
+        return false;
+    }
+    ReplayParameter* parameter = &g_parameters[g_numParameters++];
+    parameter->section = section;
+    strncpy(parameter->name, name, sizeof(parameter->name) - 1);
+    parameter->name[sizeof(parameter->name) - 1] = 0;
+    strncpy(parameter->value, value, sizeof(parameter->value) - 1);
+    parameter->value[sizeof(parameter->value) - 1] = 0;
+    return true;
+}
+
+static m64p_error replayOpenSection(const char* name, m64p_handle* handle)
+{
+    for (int i=0; i<g_numSections; ++i)
+    {
+        if ( strcmp(g_sectionNames[i], name) == 0 )
+        {
+            *handle = (m64p_handle)(size_t)(i + 1);
+            return M64ERR_SUCCESS;
+        }
+    }
+    if ( g_numSections >= MAX_SECTIONS )
+    {
+        return M64ERR_NO_MEMORY;
+    }
+    strncpy(g_sectionNames[g_numSections], name, sizeof(g_sectionNames[0]) - 1);
+    *handle = (m64p_handle)(size_t)(++g_numSections);
+    return M64ERR_SUCCESS;
+}
+
+static m64p_error replaySetDefaultString(m64p_handle section, const char* name, const char* value, const char* help)
+{
+    if ( findParameter(section, name) )
+    {
+        return M64ERR_SUCCESS;
+    }
+    return addParameter((int)(size_t)section - 1, name, value) ? M64ERR_SUCCESS : M64ERR_NO_MEMORY;
+}
+
+static m64p_error replaySetDefaultInt(m64p_handle section, const char* name, int value, const char* help)
+{
+    char text[32];
+    sprintf(text, "%d", value);
+    return replaySetDefaultString(section, name, text, help);
+}
+
+static m64p_error replaySetDefaultFloat(m64p_handle section, const char* name, float value, const char* help)
+{
+    char text[32];
+    sprintf(text, "%f", value);
+    return replaySetDefaultString(section, name, text, help);
+}
+
+static m64p_error replaySetDefaultBool(m64p_handle section, const char* name, int value, const char* help)
+{
+    return replaySetDefaultString(section, name, value ? "True" : "False", help);
+}
+
+static const char* replayGetParamString(m64p_handle section, const char* name)
+{
+    ReplayParameter* parameter = findParameter(section, name);
+    return parameter ? parameter->value : "";
+}
+
+static int replayGetParamInt(m64p_handle section, const char* name)
+{
+    return atoi(replayGetParamString(section, name));
+}
+
+static float replayGetParamFloat(m64p_handle section, const char* name)
+{
+    return (float)atof(replayGetParamString(section, name));
+}
+
+static int replayGetParamBool(m64p_handle section, const char* name)
+{
+    const char* value = replayGetParamString(section, name);
+    return strcmp(value, "True") == 0 || strcmp(value, "true") == 0 || atoi(value) != 0;
+}
+
+//-----------------------------------------------------------------------------
+// Video Extension (offscreen EGL context)
+//-----------------------------------------------------------------------------
+
+static EGLDisplay g_eglDisplay = EGL_NO_DISPLAY;
+static EGLSurface g_eglSurface = EGL_NO_SURFACE;
+static EGLContext g_eglContext = EGL_NO_CONTEXT;
+static bool       g_headless   = false;      //!< No context needed by null render device
+
+static m64p_error replayVideoInit()
+{
+    if ( g_headless )
+    {
+        return M64ERR_SUCCESS;
+    }
+
+    //Prefer a surfaceless display so no window system is needed
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = 
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if ( getPlatformDisplay )
+    {
+        g_eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    }
+    if ( g_eglDisplay == EGL_NO_DISPLAY )
+    {
+        g_eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    if ( g_eglDisplay == EGL_NO_DISPLAY || !eglInitialize(g_eglDisplay, NULL, NULL) )
+    {
+        fprintf(stderr, "arachnoid-replay: could not initialize EGL display\n");
+        return M64ERR_SYSTEM_FAIL;
+    }
+    if ( !eglBindAPI(EGL_OPENGL_API) )
+    {
+        fprintf(stderr, "arachnoid-replay: EGL does not support desktop OpenGL\n");
+        return M64ERR_SYSTEM_FAIL;
+    }
+    return M64ERR_SUCCESS;
+}
+
+static m64p_error replayVideoQuit()
+{
+    if ( g_eglDisplay != EGL_NO_DISPLAY )
+    {
+        eglMakeCurrent(g_eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if ( g_eglContext != EGL_NO_CONTEXT ) { eglDestroyContext(g_eglDisplay, g_eglContext); g_eglContext = EGL_NO_CONTEXT; }
+        if ( g_eglSurface != EGL_NO_SURFACE ) { eglDestroySurface(g_eglDisplay, g_eglSurface); g_eglSurface = EGL_NO_SURFACE; }
+        eglTerminate(g_eglDisplay);
+        g_eglDisplay = EGL_NO_DISPLAY;
+    }
+    return M64ERR_SUCCESS;
+}
+
+static m64p_error replaySetVideoMode(int width, int height, int bitsPerPixel, m64p_video_mode mode, m64p_video_flags flags)
+{
+    if ( g_headless )
+    {
+        return M64ERR_SUCCESS;
+    }
+
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE,    EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE,        8,
+        EGL_GREEN_SIZE,      8,
+        EGL_BLUE_SIZE,       8,
+        EGL_ALPHA_SIZE,      8,
+        EGL_DEPTH_SIZE,      24,
+        EGL_NONE
+    };
+    const EGLint surfaceAttributes[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+
+    EGLConfig config;
+    EGLint numConfigs = 0;
+    if ( !eglChooseConfig(g_eglDisplay, configAttributes, &config, 1, &numConfigs) || numConfigs == 0 )
+    {
+        fprintf(stderr, "arachnoid-replay: no suitable EGL config\n");
+        return M64ERR_SYSTEM_FAIL;
+    }
+
+    g_eglSurface = eglCreatePbufferSurface(g_eglDisplay, config, surfaceAttributes);
+    g_eglContext = eglCreateContext(g_eglDisplay, config, EGL_NO_CONTEXT, NULL);
+    if ( g_eglSurface == EGL_NO_SURFACE || g_eglContext == EGL_NO_CONTEXT ||
+         !eglMakeCurrent(g_eglDisplay, g_eglSurface, g_eglSurface, g_eglContext) )
+    {
+        fprintf(stderr, "arachnoid-replay: could not create offscreen context\n");
+        return M64ERR_SYSTEM_FAIL;
+    }
+    return M64ERR_SUCCESS;
+}
+
+static m64p_error replayListFullscreenModes(m64p_2d_size* sizes, int* numSizes) { *numSizes = 0; return M64ERR_SUCCESS; }
+static m64p_error replaySetCaption(const char* title)                           { return M64ERR_SUCCESS; }
+static m64p_error replayToggleFullScreen()                                      { return M64ERR_SUCCESS; }
+static m64p_error replayResizeWindow(int width, int height)                     { return M64ERR_SUCCESS; }
+static m64p_error replaySetAttribute(m64p_GLattr attribute, int value)          { return M64ERR_SUCCESS; }
+static m64p_function replayGetProcAddress(const char* name)                     { return (m64p_function)eglGetProcAddress(name); }
+
+static m64p_error replaySwapBuffers()
+{
+    if ( !g_headless )
+    {
+        eglSwapBuffers(g_eglDisplay, g_eglSurface);
+    }
+    return M64ERR_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+// Logging
+//-----------------------------------------------------------------------------
+
+static int g_logLevel = M64MSG_WARNING;
+
+static void replayDebugCallback(void* context, int level, const char* message)
+{
+    if ( level <= g_logLevel )
+    {
+        fprintf(stderr, "arachnoid: %s\n", message);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Timing
+//-----------------------------------------------------------------------------
+
+static double getTime(clockid_t clock)
+{
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void printUsage()
+{
+    printf("Usage: arachnoid-replay [options] tracefile\n");
+    printf("  -q               Only print summary\n");
+    printf("  -v               Print plugin log messages\n");
+    printf("  -r               Read screen with ReadScreen2 after every frame\n");
+    printf("  -c               Print checksum of pixels in last frame\n");
+    printf("  -s Name=Value    Override plugin configuration parameter\n");
+}
+
+//-----------------------------------------------------------------------------
+//* Main
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    const char* filename = 0;
+    bool quiet = false;
+    bool readScreen = false;
+    bool frameChecksum = false;
+
+    for (int i=1; i<argc; ++i)
+    {
+        if ( strcmp(argv[i], "-q") == 0 )
+        {
+            quiet = true;
+        }
+        else if ( strcmp(argv[i], "-v") == 0 )
+        {
+            g_logLevel = M64MSG_VERBOSE;
+        }
+        else if ( strcmp(argv[i], "-r") == 0 )
+        {
+            readScreen = true;
+        }
+        else if ( strcmp(argv[i], "-c") == 0 )
+        {
+            frameChecksum = true;
+        }
+        else if ( strcmp(argv[i], "-s") == 0 && i + 1 < argc )
+        {
+            char name[64];
+            const char* value = strchr(argv[++i], '=');
+            if ( !value || value - argv[i] >= (int)sizeof(name) )
+            {
+                printUsage();
+                return 1;
+            }
+            memcpy(name, argv[i], value - argv[i]);
+            name[value - argv[i]] = 0;
+            addParameter(-1, name, value + 1);
+        }
+        else if ( argv[i][0] != '-' && !filename )
+        {
+            filename = argv[i];
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+    if ( !filename )
+    {
+        printUsage();
+        return 1;
+    }
+
+    //Connect plugin to replay front-end
+    ConfigOpenSection      = replayOpenSection;
+    ConfigSetDefaultInt    = replaySetDefaultInt;
+    ConfigSetDefaultFloat  = replaySetDefaultFloat;
+    ConfigSetDefaultBool   = replaySetDefaultBool;
+    ConfigSetDefaultString = replaySetDefaultString;
+    ConfigGetParamInt      = replayGetParamInt;
+    ConfigGetParamFloat    = replayGetParamFloat;
+    ConfigGetParamBool     = replayGetParamBool;
+    ConfigGetParamString   = replayGetParamString;
+
+    CoreVideo_Init                = replayVideoInit;
+    CoreVideo_Quit                = replayVideoQuit;
+    CoreVideo_ListFullscreenModes = replayListFullscreenModes;
+    CoreVideo_SetVideoMode        = replaySetVideoMode;
+    CoreVideo_SetCaption          = replaySetCaption;
+    CoreVideo_ToggleFullScreen    = replayToggleFullScreen;
+    CoreVideo_ResizeWindow        = replayResizeWindow;
+    CoreVideo_GL_GetProcAddress   = replayGetProcAddress;
+    CoreVideo_GL_SetAttribute     = replaySetAttribute;
+    CoreVideo_GL_SwapBuffers      = replaySwapBuffers;
+
+    //Never capture while replaying
+    addParameter(-1, "TraceCapture", "False");
+
+    Logger::getSingleton().initialize(replayDebugCallback, 0);
+    if ( !g_config.initialize() )
+    {
+        return 1;
+    }
+    g_config.load();
+    g_graphicsPlugin.setConfig(g_config.getConfig());
+    g_headless = g_config.getConfig()->nullRenderDevice;
+
+    TraceReader reader;
+    if ( !reader.initialize(filename) )
+    {
+        fprintf(stderr, "arachnoid-replay: could not open trace '%s'\n", filename);
+        return 1;
+    }
+
+    //Header and memory size are read before the first event
+    TraceEvent event = reader.readEvent();
+    InitiateGFX(*reader.getGraphicsInfo());
+    if ( !RomOpen() )
+    {
+        fprintf(stderr, "arachnoid-replay: could not initialize plugin\n");
+        return 1;
+    }
+
+    OpenGLRenderer& renderer = OpenGLRenderer::getSingleton();
+    TextureCache* textureCache = g_graphicsPlugin.getTextureCache();
+
+    unsigned int numFrames = 0;
+    unsigned int numDisplayLists = 0;
+    double frameCPUTime = 0.0, frameWallTime = 0.0;
+    double totalCPUTime = 0.0, totalWallTime = 0.0;
+    double maxFrameWallTime = 0.0;
+    unsigned int frameDrawCalls = renderer.getNumDrawCalls();
+    unsigned int frameTextureMisses = textureCache->getNumMisses();
+
+    //Frontends recording or streaming frames read every one of them
+    unsigned char* screen = 0;
+    int screenWidth = 0, screenHeight = 0;
+    double totalReadTime = 0.0;
+    if ( readScreen )
+    {
+        ReadScreen2(0, &screenWidth, &screenHeight, 1);
+        screen = new unsigned char[screenWidth * 3 * screenHeight];
+    }
+
+    if ( !quiet )
+    {
+        printf("frame,displaylists,cpu_ms,wall_ms,draw_calls,texture_misses,wait_ms\n");
+    }
+
+    for (; event != TRACE_EVENT_END; event = reader.readEvent())
+    {
+        double cpuStart  = getTime(CLOCK_PROCESS_CPUTIME_ID);
+        double wallStart = getTime(CLOCK_MONOTONIC);
+
+        if ( event == TRACE_EVENT_DISPLAY_LIST )
+        {
+            //Restore segment table as it was when list was captured
+            for (int i=0; i<TRACE_NUM_SEGMENTS; ++i)
+            {
+                g_graphicsPlugin.getMemory()->setSegment(i, reader.getSegments()[i]);
+            }
+            ProcessDList();
+            numDisplayLists++;
+        }
+        else if ( event == TRACE_EVENT_RDP_LIST )
+        {
+            ProcessRDPList();
+        }
+        else
+        {
+            UpdateScreen();
+        }
+
+        frameCPUTime  += getTime(CLOCK_PROCESS_CPUTIME_ID) - cpuStart;
+        frameWallTime += getTime(CLOCK_MONOTONIC) - wallStart;
+
+        if ( event == TRACE_EVENT_UPDATE_SCREEN )
+        {
+            if ( !quiet )
+            {
+                printf("%u,%u,%.3f,%.3f,%u,%u,%.3f\n", numFrames, numDisplayLists,
+                       frameCPUTime * 1000.0, frameWallTime * 1000.0,
+                       renderer.getNumDrawCalls() - frameDrawCalls,
+                       textureCache->getNumMisses() - frameTextureMisses,
+                       OpenGLManager::getSingleton().getFrameWaitTime());
+            }
+            numFrames++;
+            numDisplayLists = 0;
+            totalCPUTime  += frameCPUTime;
+            totalWallTime += frameWallTime;
+            if ( frameWallTime > maxFrameWallTime ) maxFrameWallTime = frameWallTime;
+            frameCPUTime = frameWallTime = 0.0;
+            frameDrawCalls = renderer.getNumDrawCalls();
+            frameTextureMisses = textureCache->getNumMisses();
+
+            if ( screen )
+            {
+                double readStart = getTime(CLOCK_MONOTONIC);
+                ReadScreen2(screen, &screenWidth, &screenHeight, 1);
+                totalReadTime += getTime(CLOCK_MONOTONIC) - readStart;
+            }
+        }
+    }
+    if ( screen ) { delete[] screen; screen = 0; }
+
+    unsigned int totalDrawCalls = renderer.getNumDrawCalls();
+    unsigned int totalSprites = renderer.getNumSprites();
+    unsigned int totalSpriteBatches = renderer.getNumSpriteBatches();
+    RDP* rdp = g_graphicsPlugin.getRDP();
+    unsigned int totalClears = rdp->getNumClears();
+    unsigned int totalScissoredClears = rdp->getNumScissoredClears();
+    unsigned int totalSkippedClears = rdp->getNumSkippedClears();
+    FrameBufferCache* frameBufferCache = g_graphicsPlugin.getFrameBufferCache();
+    unsigned int frameBuffers = frameBufferCache->getNumBuffers();
+    unsigned int frameBufferLoads = frameBufferCache->getNumTextureLoads();
+    unsigned int totalHits = textureCache->getNumHits();
+    unsigned int totalMisses = textureCache->getNumMisses();
+    DisplayListParser* displayListParser = g_graphicsPlugin.getDisplayListParser();
+    unsigned int totalInstructions = displayListParser->getNumInstructions();
+    unsigned int cachedListHits = displayListParser->getCache()->getNumHits();
+    unsigned int cachedListMisses = displayListParser->getCache()->getNumMisses();
+    unsigned int cachedListInvalidations = displayListParser->getCache()->getNumInvalidations();
+    RSPVertexCache* vertexCache = g_graphicsPlugin.getRSP()->getVertexMgr()->getVertexCache();
+    unsigned int vertexHits = vertexCache ? vertexCache->getNumHits() : 0;
+    unsigned int vertexMisses = vertexCache ? vertexCache->getNumMisses() : 0;
+    RDPCommandParser* rdpCommandParser = g_graphicsPlugin.getRDPCommandParser();
+    unsigned int rdpCommands = rdpCommandParser->getNumCommands();
+    unsigned int rdpBytes = rdpCommandParser->getNumBytes();
+    unsigned int rdpTriangles = rdpCommandParser->getNumTriangles();
+    unsigned int rdpRectangles = rdpCommandParser->getNumRectangles();
+    unsigned int rdpBatches = rdpCommandParser->getNumBatches();
+    unsigned int rdpUnknown = rdpCommandParser->getNumUnknownCommands();
+    bool writeTracking = g_graphicsPlugin.getMemory()->getWriteTracking();
+    unsigned int writeFaults = g_graphicsPlugin.getMemory()->getNumWriteFaults();
+
+    //Read null device statistics before RomClosed disposes it
+    if ( RenderDevice::getType() == RENDER_DEVICE_NULL )
+    {
+        NullRenderDevice& device = static_cast<NullRenderDevice&>(RenderDevice::getSingleton());
+        printf("null device: %u draw calls, %u vertices, %u state changes, %u clears\n", 
+               device.getNumDrawCalls(), device.getNumVertices(), device.getNumStateChanges(), device.getNumClears());
+        printf("null device: %u texture uploads (%u bytes), %u texture binds\n", 
+               device.getNumTextureUploads(), device.getNumTextureBytes(), device.getNumTextureBinds());
+    }
+
+    //Pixels of last frame, lets tests compare output of a trace with a known result
+    unsigned int checksum = 0;
+    int checksumWidth = 0, checksumHeight = 0;
+    if ( frameChecksum )
+    {
+        ReadScreen2(0, &checksumWidth, &checksumHeight, 1);
+        unsigned char* pixels = new unsigned char[checksumWidth * 3 * checksumHeight];
+        ReadScreen2(pixels, &checksumWidth, &checksumHeight, 1);
+        for (int i=0; i<checksumWidth * checksumHeight * 3; ++i)
+        {
+            checksum = checksum * 31 + pixels[i];
+        }
+        delete[] pixels;
+    }
+
+    RomClosed();
+    reader.dispose();
+
+    printf("frames: %u\n", numFrames);
+    if ( frameChecksum )
+    {
+        printf("frame checksum: %08x (%dx%d)\n", checksum, checksumWidth, checksumHeight);
+    }
+    printf("display lists: %u\n", reader.getNumDisplayLists());
+    printf("draw calls: %u\n", totalDrawCalls);
+    if ( totalSprites > 0 )
+    {
+        printf("sprites: %u batches: %u\n", totalSprites, totalSpriteBatches);
+    }
+    if ( totalClears + totalSkippedClears > 0 )
+    {
+        printf("fill rect clears: %u scissored: %u skipped: %u\n", totalClears, totalScissoredClears, totalSkippedClears);
+    }
+    printf("texture hits: %u misses: %u\n", totalHits, totalMisses);
+    if ( frameBuffers > 0 )
+    {
+        printf("frame buffers: %u textures sampled: %u\n", frameBuffers, frameBufferLoads);
+    }
+    printf("instructions: %u\n", totalInstructions);
+    printf("display list cache hits: %u misses: %u invalidations: %u\n", cachedListHits, cachedListMisses, cachedListInvalidations);
+    printf("vertex cache hits: %u misses: %u\n", vertexHits, vertexMisses);
+    if ( reader.getNumRDPLists() > 0 )
+    {
+        printf("rdp lists: %u commands: %u (%u bytes) unknown: %u\n", reader.getNumRDPLists(), rdpCommands, rdpBytes, rdpUnknown);
+        printf("rdp triangles: %u rectangles: %u batches: %u\n", rdpTriangles, rdpRectangles, rdpBatches);
+    }
+    if ( writeTracking )
+    {
+        printf("rdram write faults: %u\n", writeFaults);
+    }
+    if ( numFrames > 0 && totalWallTime > 0.0 )
+    {
+        printf("cpu ms/frame: %.3f\n", totalCPUTime * 1000.0 / numFrames);
+        printf("wall ms/frame: %.3f (worst %.3f)\n", totalWallTime * 1000.0 / numFrames, maxFrameWallTime * 1000.0);
+        printf("fence wait ms/frame: %.3f\n", OpenGLManager::getSingleton().getTotalWaitTime() / numFrames);
+        if ( readScreen )
+        {
+            printf("read screen ms/frame: %.3f (latency %u frames)\n", totalReadTime * 1000.0 / numFrames, 
+                   g_graphicsPlugin.getScreenReadback()->getLatency());
+            printf("read screen size: %dx%d, capture ms/frame: %.3f\n", screenWidth, screenHeight,
+                   g_graphicsPlugin.getScreenReadback()->getCaptureTime());
+        }
+        printf("fps: %.1f\n", numFrames / totalWallTime);
+        printf("instructions/s: %.0f\n", totalInstructions / totalWallTime);
+        if ( rdpCommands > 0 )
+        {
+            printf("rdp commands/s: %.0f\n", rdpCommands / totalWallTime);
+        }
+    }
+    return 0;
+}
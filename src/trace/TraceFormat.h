@@ -0,0 +1,80 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef TRACE_FORMAT_H_
+#define TRACE_FORMAT_H_
+
+//*****************************************************************************
+//* Trace File Format
+//! A trace is a sequence of chunks that recreate the state the plugin sees
+//! when display lists are processed, so frames can be replayed offline.
+//!
+//! File:   "ARACHTRC" | version (u32) | chunks...
+//! Chunk:  type (u32) | size of payload in bytes (u32) | payload
+//!
+//! Low level RDP lists are stored like display lists, with the DP registers
+//! saved before the marker.
+//!
+//! Memory chunks (DMEM and RDRAM pages) are delta encoded against the
+//! content written earlier in the file. Their payload is the address of the
+//! block (u32) followed by runs: words to skip (u16) | words to copy (u16) |
+//! words (u32 each). Memory not covered by any run is unchanged.
+//! All values are stored in host byte order.
+//*****************************************************************************
+
+#define TRACE_MAGIC          "ARACHTRC"
+#define TRACE_MAGIC_SIZE     8
+#define TRACE_VERSION        1
+
+#define TRACE_PAGE_SIZE      4096    //!< Size of RDRAM blocks compared between frames
+#define TRACE_DMEM_SIZE      4096    //!< Size of RSP data memory
+#define TRACE_ROM_HEADER_SIZE 64     //!< Size of rom header
+#define TRACE_NUM_VI_REGS    14      //!< VI_STATUS_REG ... VI_Y_SCALE_REG
+#define TRACE_NUM_SEGMENTS   16      //!< Number of segments in Memory
+#define TRACE_NUM_DPC_REGS   4       //!< DPC_START_REG ... DPC_STATUS_REG
+
+//-----------------------------------------------------------------------------
+//! Chunk types
+//-----------------------------------------------------------------------------
+enum TraceChunkType
+{
+    TRACE_CHUNK_ROM_HEADER    = 1,   //!< Rom header, 64 bytes
+    TRACE_CHUNK_RDRAM_SIZE    = 2,   //!< Size of RDRAM (u32)
+    TRACE_CHUNK_VI_REGISTERS  = 3,   //!< VI registers (14 x u32)
+    TRACE_CHUNK_SEGMENTS      = 4,   //!< Segment table (16 x u32)
+    TRACE_CHUNK_DMEM          = 5,   //!< Delta encoded DMEM
+    TRACE_CHUNK_RDRAM_PAGE    = 6,   //!< Delta encoded RDRAM page
+    TRACE_CHUNK_DISPLAY_LIST  = 7,   //!< ProcessDList was called, no payload
+    TRACE_CHUNK_UPDATE_SCREEN = 8,   //!< UpdateScreen was called, no payload
+    TRACE_CHUNK_DPC_REGISTERS = 9,   //!< DPC registers (4 x u32)
+    TRACE_CHUNK_RDP_LIST      = 10,  //!< ProcessRDPList was called, no payload
+};
+
+//-----------------------------------------------------------------------------
+//! Chunk header
+//-----------------------------------------------------------------------------
+struct TraceChunkHeader
+{
+    unsigned int type;   //!< TraceChunkType
+    unsigned int size;   //!< Size of payload in bytes
+};
+
+#endif
@@ -0,0 +1,260 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#include <cstring>
+
+#include "Logger.h"
+#include "TraceReader.h"
+#include "m64p_types.h"
+
+//-----------------------------------------------------------------------------
+//! Constructor
+//-----------------------------------------------------------------------------
+TraceReader::TraceReader()
+{
+    m_file = 0;
+    m_rdram = 0;
+    m_rdramSize = 0;
+    m_numDisplayLists = 0;
+    m_numRDPLists = 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Destructor
+//-----------------------------------------------------------------------------
+TraceReader::~TraceReader()
+{
+    dispose();
+}
+
+//-----------------------------------------------------------------------------
+//* Initialize
+//! Opens trace, reads file header and sets up graphics info
+//-----------------------------------------------------------------------------
+bool TraceReader::initialize(const char* filename)
+{
+    dispose();
+
+    m_file = fopen(filename, "rb");
+    if ( !m_file )
+    {
+        Logger::getSingleton().printMsg("TraceReader - Unable to open trace file", M64MSG_ERROR);
+        return false;
+    }
+
+    char magic[TRACE_MAGIC_SIZE];
+    unsigned int version = 0;
+    if ( fread(magic, 1, TRACE_MAGIC_SIZE, m_file) != TRACE_MAGIC_SIZE ||
+         fread(&version, sizeof(version), 1, m_file) != 1 ||
+         memcmp(magic, TRACE_MAGIC, TRACE_MAGIC_SIZE) != 0 ||
+         version != TRACE_VERSION )
+    {
+        Logger::getSingleton().printMsg("TraceReader - Not a trace file, or unsupported version", M64MSG_ERROR);
+        dispose();
+        return false;
+    }
+
+    //Default to 8 MB, changed by RDRAM size chunk
+    m_rdramSize = 0x800000;
+    m_rdram = new unsigned char[m_rdramSize];
+    memset(m_rdram, 0, m_rdramSize);
+    memset(m_dmem, 0, sizeof(m_dmem));
+    memset(m_romHeader, 0, sizeof(m_romHeader));
+    memset(m_viRegisters, 0, sizeof(m_viRegisters));
+    memset(m_segments, 0, sizeof(m_segments));
+    memset(m_registers, 0, sizeof(m_registers));
+    m_numDisplayLists = 0;
+    m_numRDPLists = 0;
+
+    //Setup graphics info
+    memset(&m_graphicsInfo, 0, sizeof(m_graphicsInfo));
+    m_graphicsInfo.HEADER                = m_romHeader;
+    m_graphicsInfo.RDRAM                 = m_rdram;
+    m_graphicsInfo.DMEM                  = m_dmem;
+    m_graphicsInfo.IMEM                  = 0;
+    m_graphicsInfo.MI_INTR_REG           = &m_registers[0];
+    m_graphicsInfo.DPC_START_REG         = &m_registers[1];
+    m_graphicsInfo.DPC_END_REG           = &m_registers[2];
+    m_graphicsInfo.DPC_CURRENT_REG       = &m_registers[3];
+    m_graphicsInfo.DPC_STATUS_REG        = &m_registers[4];
+    m_graphicsInfo.DPC_CLOCK_REG         = &m_registers[5];
+    m_graphicsInfo.DPC_BUFBUSY_REG       = &m_registers[6];
+    m_graphicsInfo.DPC_PIPEBUSY_REG      = &m_registers[7];
+    m_graphicsInfo.DPC_TMEM_REG          = &m_registers[8];
+    m_graphicsInfo.SP_STATUS_REG         = &m_registers[9];
+    m_graphicsInfo.VI_STATUS_REG         = &m_viRegisters[0];
+    m_graphicsInfo.VI_ORIGIN_REG         = &m_viRegisters[1];
+    m_graphicsInfo.VI_WIDTH_REG          = &m_viRegisters[2];
+    m_graphicsInfo.VI_INTR_REG           = &m_viRegisters[3];
+    m_graphicsInfo.VI_V_CURRENT_LINE_REG = &m_viRegisters[4];
+    m_graphicsInfo.VI_TIMING_REG         = &m_viRegisters[5];
+    m_graphicsInfo.VI_V_SYNC_REG         = &m_viRegisters[6];
+    m_graphicsInfo.VI_H_SYNC_REG         = &m_viRegisters[7];
+    m_graphicsInfo.VI_LEAP_REG           = &m_viRegisters[8];
+    m_graphicsInfo.VI_H_START_REG        = &m_viRegisters[9];
+    m_graphicsInfo.VI_V_START_REG        = &m_viRegisters[10];
+    m_graphicsInfo.VI_V_BURST_REG        = &m_viRegisters[11];
+    m_graphicsInfo.VI_X_SCALE_REG        = &m_viRegisters[12];
+    m_graphicsInfo.VI_Y_SCALE_REG        = &m_viRegisters[13];
+    m_graphicsInfo.CheckInterrupts       = &TraceReader::_checkInterrupts;
+    m_graphicsInfo.RDRAM_SIZE            = &m_rdramSize;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//* Dispose
+//-----------------------------------------------------------------------------
+void TraceReader::dispose()
+{
+    if ( m_file ) { fclose(m_file); m_file = 0; }
+    if ( m_rdram ) { delete[] m_rdram; m_rdram = 0; }
+}
+
+//-----------------------------------------------------------------------------
+//* Read Event
+//! Applies chunks to memory until a display list, RDP list or screen update is found
+//! @return Event found, or TRACE_EVENT_END at end of file
+//-----------------------------------------------------------------------------
+TraceEvent TraceReader::readEvent()
+{
+    if ( !m_file ) {
+        return TRACE_EVENT_END;
+    }
+
+    TraceChunkHeader header;
+    while ( fread(&header, sizeof(header), 1, m_file) == 1 )
+    {
+        //Read payload
+        m_buffer.resize(header.size + 4);
+        if ( header.size > 0 && fread(&m_buffer[0], 1, header.size, m_file) != header.size )
+        {
+            Logger::getSingleton().printMsg("TraceReader - Unexpected end of trace", M64MSG_WARNING);
+            return TRACE_EVENT_END;
+        }
+        const unsigned char* data = &m_buffer[0];
+
+        switch ( header.type )
+        {
+            case TRACE_CHUNK_ROM_HEADER:
+                memcpy(m_romHeader, data, header.size < sizeof(m_romHeader) ? header.size : sizeof(m_romHeader));
+                break;
+
+            case TRACE_CHUNK_RDRAM_SIZE:
+            {
+                unsigned int size = *(const unsigned int*)data;
+                if ( size != m_rdramSize && size > 0 && size <= 0x800000 )
+                {
+                    delete[] m_rdram;
+                    m_rdramSize = size;
+                    m_rdram = new unsigned char[m_rdramSize];
+                    memset(m_rdram, 0, m_rdramSize);
+                    m_graphicsInfo.RDRAM = m_rdram;
+                }
+                break;
+            }
+
+            case TRACE_CHUNK_VI_REGISTERS:
+                memcpy(m_viRegisters, data, header.size < sizeof(m_viRegisters) ? header.size : sizeof(m_viRegisters));
+                break;
+
+            case TRACE_CHUNK_SEGMENTS:
+                memcpy(m_segments, data, header.size < sizeof(m_segments) ? header.size : sizeof(m_segments));
+                break;
+
+            case TRACE_CHUNK_DMEM:
+                if ( !_applyDelta(data, header.size, m_dmem, TRACE_DMEM_SIZE) ) {
+                    return TRACE_EVENT_END;
+                }
+                break;
+
+            case TRACE_CHUNK_RDRAM_PAGE:
+                if ( !_applyDelta(data, header.size, m_rdram, m_rdramSize) ) {
+                    return TRACE_EVENT_END;
+                }
+                break;
+
+            case TRACE_CHUNK_DISPLAY_LIST:
+                m_numDisplayLists++;
+                return TRACE_EVENT_DISPLAY_LIST;
+
+            case TRACE_CHUNK_UPDATE_SCREEN:
+                return TRACE_EVENT_UPDATE_SCREEN;
+
+            case TRACE_CHUNK_DPC_REGISTERS:
+                //DPC_START_REG ... DPC_STATUS_REG
+                memcpy(&m_registers[1], data, header.size < TRACE_NUM_DPC_REGS * 4 ? header.size : TRACE_NUM_DPC_REGS * 4);
+                break;
+
+            case TRACE_CHUNK_RDP_LIST:
+                m_numRDPLists++;
+                return TRACE_EVENT_RDP_LIST;
+
+            default:
+                //Unknown chunks are skipped
+                break;
+        }
+    }
+
+    return TRACE_EVENT_END;
+}
+
+//-----------------------------------------------------------------------------
+//* Apply Delta
+//! Decodes a delta encoded block (see TraceFormat.h) into memory
+//-----------------------------------------------------------------------------
+bool TraceReader::_applyDelta(const unsigned char* data, unsigned int size, unsigned char* memory, unsigned int memorySize)
+{
+    if ( size < 4 ) {
+        return false;
+    }
+
+    unsigned int address = *(const unsigned int*)data;
+    unsigned int pos = 4;
+
+    while ( pos + 4 <= size )
+    {
+        const unsigned short* run = (const unsigned short*)(data + pos);
+        unsigned int skip = run[0] * 4;
+        unsigned int count = run[1] * 4;
+        pos += 4;
+
+        address += skip;
+        if ( address + count > memorySize || pos + count > size )
+        {
+            Logger::getSingleton().printMsg("TraceReader - Corrupt memory chunk", M64MSG_WARNING);
+            return false;
+        }
+
+        memcpy(memory + address, data + pos, count);
+        address += count;
+        pos += count;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//* Check Interrupts
+//! Interrupts have no meaning without an emulator
+//-----------------------------------------------------------------------------
+void TraceReader::_checkInterrupts()
+{
+}
@@ -0,0 +1,91 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef TRACE_READER_H_
+#define TRACE_READER_H_
+
+#include <cstdio>
+#include <vector>
+
+#include "TraceFormat.h"
+#include "m64p_plugin.h"
+
+//-----------------------------------------------------------------------------
+//! Events found in trace
+//-----------------------------------------------------------------------------
+enum TraceEvent
+{
+    TRACE_EVENT_END,             //!< End of trace (or error)
+    TRACE_EVENT_DISPLAY_LIST,    //!< Process display list
+    TRACE_EVENT_UPDATE_SCREEN,   //!< Update screen
+    TRACE_EVENT_RDP_LIST,        //!< Process low level RDP list
+};
+
+//*****************************************************************************
+//* Trace Reader
+//! Reads a trace written by TraceWriter and recreates emulator memory, so
+//! GraphicsPlugin can be driven without an emulator core. The graphics info
+//! points to memory owned by the reader.
+//*****************************************************************************
+class TraceReader
+{
+public:
+
+    //Constructor / Destructor
+    TraceReader();
+    ~TraceReader();
+
+    //Initialize / Dispose
+    bool initialize(const char* filename);
+    void dispose();
+
+    //Read chunks until next event
+    TraceEvent readEvent();
+
+    //Get state
+    GFX_INFO* getGraphicsInfo()        { return &m_graphicsInfo; }
+    const unsigned int* getSegments()  { return m_segments;      }
+    unsigned int getNumDisplayLists()  { return m_numDisplayLists; }
+    unsigned int getNumRDPLists()      { return m_numRDPLists;     }
+
+private:
+
+    bool _applyDelta(const unsigned char* data, unsigned int size, unsigned char* memory, unsigned int memorySize);
+    static void _checkInterrupts();
+
+private:
+
+    FILE*          m_file;                              //!< Trace file
+    GFX_INFO       m_graphicsInfo;                      //!< Graphics info handed to plugin
+    unsigned char* m_rdram;                             //!< Recreated RDRAM
+    unsigned int   m_rdramSize;                         //!< Size of RDRAM
+    unsigned char  m_dmem[TRACE_DMEM_SIZE];             //!< Recreated DMEM
+    unsigned char  m_romHeader[TRACE_ROM_HEADER_SIZE];  //!< Rom header
+    unsigned int   m_viRegisters[TRACE_NUM_VI_REGS];    //!< VI registers
+    unsigned int   m_segments[TRACE_NUM_SEGMENTS];      //!< Segment table when display list was captured
+    unsigned int   m_registers[10];                     //!< MI, DPC and SP registers the plugin may write to
+    std::vector<unsigned char> m_buffer;                //!< Buffer for chunk payload
+    unsigned int   m_numDisplayLists;                   //!< Number of display lists read
+    unsigned int   m_numRDPLists;                       //!< Number of RDP lists read
+
+};
+
+#endif
@@ -0,0 +1,264 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#include <cstring>
+
+#include "Logger.h"
+#include "Memory.h"
+#include "TraceWriter.h"
+#include "m64p_types.h"
+
+//-----------------------------------------------------------------------------
+//! Constructor
+//-----------------------------------------------------------------------------
+TraceWriter::TraceWriter()
+{
+    m_file = 0;
+    m_graphicsInfo = 0;
+    m_memory = 0;
+    m_rdramShadow = 0;
+    m_rdramSize = 0;
+    m_numDisplayLists = 0;
+    m_numRDPLists = 0;
+    m_numBytesWritten = 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Destructor
+//-----------------------------------------------------------------------------
+TraceWriter::~TraceWriter()
+{
+    dispose();
+}
+
+//-----------------------------------------------------------------------------
+//* Initialize
+//! Creates trace file and writes information that does not change
+//! @param filename Name of trace file to create
+//! @param graphicsInfo Access to emulator data (RDRAM, DMEM, VI registers)
+//! @param memory Memory with segment table
+//-----------------------------------------------------------------------------
+bool TraceWriter::initialize(const char* filename, GFX_INFO* graphicsInfo, Memory* memory)
+{
+    dispose();
+
+    m_file = fopen(filename, "wb");
+    if ( !m_file )
+    {
+        Logger::getSingleton().printMsg("TraceWriter - Unable to create trace file", M64MSG_WARNING);
+        return false;
+    }
+
+    m_graphicsInfo = graphicsInfo;
+    m_memory = memory;
+    m_rdramSize = memory->getRDRAMSize();
+    m_numDisplayLists = 0;
+    m_numRDPLists = 0;
+    m_numBytesWritten = 0;
+
+    //Shadow memory starts out cleared, so the first frame only stores non-zero memory
+    m_rdramShadow = new unsigned char[m_rdramSize];
+    memset(m_rdramShadow, 0, m_rdramSize);
+    memset(m_dmemShadow, 0, TRACE_DMEM_SIZE);
+
+    //File header
+    unsigned int version = TRACE_VERSION;
+    fwrite(TRACE_MAGIC, 1, TRACE_MAGIC_SIZE, m_file);
+    fwrite(&version, sizeof(version), 1, m_file);
+    m_numBytesWritten += TRACE_MAGIC_SIZE + sizeof(version);
+
+    _writeChunk(TRACE_CHUNK_ROM_HEADER, m_graphicsInfo->HEADER, TRACE_ROM_HEADER_SIZE);
+    _writeChunk(TRACE_CHUNK_RDRAM_SIZE, &m_rdramSize, sizeof(m_rdramSize));
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//* Dispose
+//-----------------------------------------------------------------------------
+void TraceWriter::dispose()
+{
+    if ( m_file )
+    {
+        char msg[256];
+        sprintf(msg, "TraceWriter - Captured %u display lists, %u RDP lists, %u bytes", m_numDisplayLists, m_numRDPLists, m_numBytesWritten);
+        Logger::getSingleton().printMsg(msg, M64MSG_INFO);
+
+        fclose(m_file);
+        m_file = 0;
+    }
+
+    if ( m_rdramShadow ) { delete[] m_rdramShadow; m_rdramShadow = 0; }
+}
+
+//-----------------------------------------------------------------------------
+//* Capture Display List
+//! Writes VI registers, segments and changed memory, followed by a marker
+//! telling the reader to process a display list. Call before the display
+//! list is processed.
+//-----------------------------------------------------------------------------
+void TraceWriter::captureDisplayList()
+{
+    if ( !m_file ) {
+        return;
+    }
+
+    _writeMemory();
+    _writeChunk(TRACE_CHUNK_DISPLAY_LIST, 0, 0);
+    m_numDisplayLists++;
+}
+
+//-----------------------------------------------------------------------------
+//* Capture RDP List
+//! Writes the same state as captureDisplayList and the DP registers, 
+//! followed by a marker telling the reader to process an RDP list.
+//-----------------------------------------------------------------------------
+void TraceWriter::captureRDPList()
+{
+    if ( !m_file ) {
+        return;
+    }
+
+    _writeMemory();
+
+    unsigned int dpcValues[TRACE_NUM_DPC_REGS] = {
+        *m_graphicsInfo->DPC_START_REG, *m_graphicsInfo->DPC_END_REG, 
+        *m_graphicsInfo->DPC_CURRENT_REG, *m_graphicsInfo->DPC_STATUS_REG 
+    };
+    _writeChunk(TRACE_CHUNK_DPC_REGISTERS, dpcValues, sizeof(dpcValues));
+
+    _writeChunk(TRACE_CHUNK_RDP_LIST, 0, 0);
+    m_numRDPLists++;
+}
+
+//-----------------------------------------------------------------------------
+//* Write Memory
+//! Writes VI registers, segments and memory changed since previous capture
+//-----------------------------------------------------------------------------
+void TraceWriter::_writeMemory()
+{
+    //VI Registers
+    unsigned int* viRegisters[TRACE_NUM_VI_REGS] = {
+        m_graphicsInfo->VI_STATUS_REG,   m_graphicsInfo->VI_ORIGIN_REG,         m_graphicsInfo->VI_WIDTH_REG,
+        m_graphicsInfo->VI_INTR_REG,     m_graphicsInfo->VI_V_CURRENT_LINE_REG, m_graphicsInfo->VI_TIMING_REG,
+        m_graphicsInfo->VI_V_SYNC_REG,   m_graphicsInfo->VI_H_SYNC_REG,         m_graphicsInfo->VI_LEAP_REG,
+        m_graphicsInfo->VI_H_START_REG,  m_graphicsInfo->VI_V_START_REG,        m_graphicsInfo->VI_V_BURST_REG,
+        m_graphicsInfo->VI_X_SCALE_REG,  m_graphicsInfo->VI_Y_SCALE_REG
+    };
+    unsigned int viValues[TRACE_NUM_VI_REGS];
+    for (int i=0; i<TRACE_NUM_VI_REGS; ++i)
+    {
+        viValues[i] = viRegisters[i] ? *viRegisters[i] : 0;
+    }
+    _writeChunk(TRACE_CHUNK_VI_REGISTERS, viValues, sizeof(viValues));
+
+    //Segments
+    unsigned int segments[TRACE_NUM_SEGMENTS];
+    for (unsigned int i=0; i<TRACE_NUM_SEGMENTS; ++i)
+    {
+        segments[i] = m_memory->getSegment(i);
+    }
+    _writeChunk(TRACE_CHUNK_SEGMENTS, segments, sizeof(segments));
+
+    //DMEM (task header, ucode data)
+    _writeDelta(TRACE_CHUNK_DMEM, 0, m_graphicsInfo->DMEM, m_dmemShadow, TRACE_DMEM_SIZE);
+
+    //RDRAM pages that changed since previous display list
+    for (unsigned int address=0; address<m_rdramSize; address+=TRACE_PAGE_SIZE)
+    {
+        _writeDelta(TRACE_CHUNK_RDRAM_PAGE, address, m_graphicsInfo->RDRAM + address, m_rdramShadow + address, TRACE_PAGE_SIZE);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//* Capture Update Screen
+//-----------------------------------------------------------------------------
+void TraceWriter::captureUpdateScreen()
+{
+    if ( !m_file ) {
+        return;
+    }
+
+    _writeChunk(TRACE_CHUNK_UPDATE_SCREEN, 0, 0);
+    fflush(m_file);
+}
+
+//-----------------------------------------------------------------------------
+//* Write Chunk
+//-----------------------------------------------------------------------------
+void TraceWriter::_writeChunk(unsigned int type, const void* data, unsigned int size)
+{
+    TraceChunkHeader header;
+    header.type = type;
+    header.size = size;
+    fwrite(&header, sizeof(header), 1, m_file);
+    if ( size > 0 )
+    {
+        fwrite(data, 1, size, m_file);
+    }
+    m_numBytesWritten += sizeof(header) + size;
+}
+
+//-----------------------------------------------------------------------------
+//* Write Delta
+//! Writes the words in a block of memory that differ from the shadow copy,
+//! then updates the shadow copy. Nothing is written if block is unchanged.
+//-----------------------------------------------------------------------------
+void TraceWriter::_writeDelta(unsigned int type, unsigned int address, const unsigned char* data, unsigned char* shadow, unsigned int size)
+{
+    if ( memcmp(data, shadow, size) == 0 ) {
+        return;
+    }
+
+    const unsigned int* words = (const unsigned int*)data;
+    const unsigned int* shadowWords = (const unsigned int*)shadow;
+    unsigned int numWords = size / 4;
+
+    m_buffer.clear();
+    m_buffer.insert(m_buffer.end(), (unsigned char*)&address, (unsigned char*)&address + 4);
+
+    unsigned int i = 0;
+    while ( i < numWords )
+    {
+        //Count unchanged words
+        unsigned int skip = i;
+        while ( i < numWords && words[i] == shadowWords[i] ) ++i;
+        skip = i - skip;
+        if ( i == numWords ) {
+            break;
+        }
+
+        //Count changed words (short unchanged gaps are cheaper to copy than to split)
+        unsigned int start = i;
+        while ( i < numWords && i - start < 0xFFFF )
+        {
+            if ( words[i] != shadowWords[i] ) { ++i; continue; }
+            if ( i + 1 < numWords && words[i + 1] != shadowWords[i + 1] ) { ++i; continue; }
+            break;
+        }
+
+        unsigned short run[2] = { (unsigned short)skip, (unsigned short)(i - start) };
+        m_buffer.insert(m_buffer.end(), (unsigned char*)run, (unsigned char*)run + sizeof(run));
+        m_buffer.insert(m_buffer.end(), (unsigned char*)&words[start], (unsigned char*)&words[i]);
+    }
+
+    _writeChunk(type, &m_buffer[0], (unsigned int)m_buffer.size());
+    memcpy(shadow, data, size);
+}
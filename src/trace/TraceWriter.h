@@ -0,0 +1,83 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef TRACE_WRITER_H_
+#define TRACE_WRITER_H_
+
+#include <cstdio>
+#include <vector>
+
+#include "TraceFormat.h"
+#include "m64p_plugin.h"
+
+//Forward declarations
+class Memory;
+
+//*****************************************************************************
+//* Trace Writer
+//! Captures display lists and the memory they use into a trace file.
+//! Only memory that changed since the previous capture is written.
+//*****************************************************************************
+class TraceWriter
+{
+public:
+
+    //Constructor / Destructor
+    TraceWriter();
+    ~TraceWriter();
+
+    //Initialize / Dispose
+    bool initialize(const char* filename, GFX_INFO* graphicsInfo, Memory* memory);
+    void dispose();
+
+    //Capture
+    void captureDisplayList();
+    void captureRDPList();
+    void captureUpdateScreen();
+
+    //Statistics
+    unsigned int getNumDisplayLists() { return m_numDisplayLists; }
+    unsigned int getNumRDPLists()     { return m_numRDPLists;     }
+    unsigned int getNumBytesWritten() { return m_numBytesWritten; }
+
+private:
+
+    void _writeMemory();
+    void _writeChunk(unsigned int type, const void* data, unsigned int size);
+    void _writeDelta(unsigned int type, unsigned int address, const unsigned char* data, unsigned char* shadow, unsigned int size);
+
+private:
+
+    FILE*          m_file;               //!< Trace file
+    GFX_INFO*      m_graphicsInfo;       //!< Access to emulator data (RDRAM, DMEM, VI registers)
+    Memory*        m_memory;             //!< Memory with segment table
+    unsigned char* m_rdramShadow;        //!< RDRAM as it is stored in trace
+    unsigned char  m_dmemShadow[TRACE_DMEM_SIZE];  //!< DMEM as it is stored in trace
+    unsigned int   m_rdramSize;          //!< Size of RDRAM
+    std::vector<unsigned char> m_buffer; //!< Buffer used to encode chunks
+
+    unsigned int   m_numDisplayLists;    //!< Number of display lists captured
+    unsigned int   m_numRDPLists;        //!< Number of RDP lists captured
+    unsigned int   m_numBytesWritten;    //!< Size of trace file
+
+};
+
+#endif
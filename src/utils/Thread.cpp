@@ -0,0 +1,141 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#include "Thread.h"
+
+//-----------------------------------------------------------------------------
+// Mutex
+//-----------------------------------------------------------------------------
+#ifdef WIN32
+
+Mutex::Mutex()       { InitializeCriticalSection(&m_mutex); }
+Mutex::~Mutex()      { DeleteCriticalSection(&m_mutex);     }
+void Mutex::lock()   { EnterCriticalSection(&m_mutex);      }
+void Mutex::unlock() { LeaveCriticalSection(&m_mutex);      }
+
+#else
+
+Mutex::Mutex()       { pthread_mutex_init(&m_mutex, 0);  }
+Mutex::~Mutex()      { pthread_mutex_destroy(&m_mutex);  }
+void Mutex::lock()   { pthread_mutex_lock(&m_mutex);     }
+void Mutex::unlock() { pthread_mutex_unlock(&m_mutex);   }
+
+#endif
+
+//-----------------------------------------------------------------------------
+// Condition
+//-----------------------------------------------------------------------------
+#ifdef WIN32
+
+Condition::Condition()           { InitializeConditionVariable(&m_condition);                         }
+Condition::~Condition()          {                                                                    }
+void Condition::wait(Mutex& mut) { SleepConditionVariableCS(&m_condition, &mut.m_mutex, INFINITE);   }
+void Condition::signal()         { WakeConditionVariable(&m_condition);                               }
+void Condition::broadcast()      { WakeAllConditionVariable(&m_condition);                            }
+
+#else
+
+Condition::Condition()           { pthread_cond_init(&m_condition, 0);          }
+Condition::~Condition()          { pthread_cond_destroy(&m_condition);          }
+void Condition::wait(Mutex& mut) { pthread_cond_wait(&m_condition, &mut.m_mutex); }
+void Condition::signal()         { pthread_cond_signal(&m_condition);           }
+void Condition::broadcast()      { pthread_cond_broadcast(&m_condition);        }
+
+#endif
+
+//-----------------------------------------------------------------------------
+//! Constructor
+//-----------------------------------------------------------------------------
+Thread::Thread()
+{
+    m_function = 0;
+    m_argument = 0;
+    m_running  = false;
+}
+
+//-----------------------------------------------------------------------------
+//! Destructor
+//-----------------------------------------------------------------------------
+Thread::~Thread()
+{
+    join();
+}
+
+//-----------------------------------------------------------------------------
+//* Start
+//! Starts a new thread executing function
+//! @return False if thread could not be created
+//-----------------------------------------------------------------------------
+bool Thread::start(Function function, void* argument)
+{
+    if ( m_running )
+    {
+        return false;
+    }
+
+    m_function = function;
+    m_argument = argument;
+
+#ifdef WIN32
+    m_thread = CreateThread(0, 0, _run, this, 0, 0);
+    m_running = ( m_thread != 0 );
+#else
+    m_running = ( pthread_create(&m_thread, 0, _run, this) == 0 );
+#endif
+    return m_running;
+}
+
+//-----------------------------------------------------------------------------
+//* Join
+//! Waits until thread has finished
+//-----------------------------------------------------------------------------
+void Thread::join()
+{
+    if ( !m_running )
+    {
+        return;
+    }
+
+#ifdef WIN32
+    WaitForSingleObject(m_thread, INFINITE);
+    CloseHandle(m_thread);
+#else
+    pthread_join(m_thread, 0);
+#endif
+    m_running = false;
+}
+
+//-----------------------------------------------------------------------------
+//! Thread entry point
+//-----------------------------------------------------------------------------
+#ifdef WIN32
+DWORD WINAPI Thread::_run(LPVOID thread)
+{
+    ((Thread*)thread)->m_function(((Thread*)thread)->m_argument);
+    return 0;
+}
+#else
+void* Thread::_run(void* thread)
+{
+    ((Thread*)thread)->m_function(((Thread*)thread)->m_argument);
+    return 0;
+}
+#endif
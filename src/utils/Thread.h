@@ -0,0 +1,172 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef THREAD_H_
+#define THREAD_H_
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+//*****************************************************************************
+//* Mutex
+//! Lock protecting data shared between threads
+//*****************************************************************************
+class Mutex
+{
+public:
+
+    //Constructor / Destructor
+    Mutex();
+    ~Mutex();
+
+    void lock();
+    void unlock();
+
+private:
+
+    friend class Condition;
+
+#ifdef WIN32
+    CRITICAL_SECTION m_mutex;
+#else
+    pthread_mutex_t m_mutex;
+#endif
+
+};
+
+//*****************************************************************************
+//* Condition
+//! Condition variable used to wait for another thread, always used with
+//! the mutex protecting the data it signals about
+//*****************************************************************************
+class Condition
+{
+public:
+
+    //Constructor / Destructor
+    Condition();
+    ~Condition();
+
+    void wait(Mutex& mutex);
+    void signal();
+    void broadcast();
+
+private:
+
+#ifdef WIN32
+    CONDITION_VARIABLE m_condition;
+#else
+    pthread_cond_t m_condition;
+#endif
+
+};
+
+//*****************************************************************************
+//* Atomic Integer
+//! Integer shared between threads without a lock. Changes are full memory
+//! barriers and loads acquire, so data written by a thread before it changes
+//! the value is visible to a thread that loads the changed value.
+//*****************************************************************************
+class AtomicInt
+{
+public:
+
+    //Constructor
+    AtomicInt() : m_value(0) {}
+
+#ifdef WIN32
+    int  load() const         { return (int)InterlockedCompareExchange((volatile LONG*)&m_value, 0, 0); }
+    void store(int value)     { InterlockedExchange(&m_value, value); }
+    int  increment()          { return (int)InterlockedIncrement(&m_value); }
+    int  decrement()          { return (int)InterlockedDecrement(&m_value); }
+#else
+    int  load() const         { return __atomic_load_n(&m_value, __ATOMIC_ACQUIRE); }
+    void store(int value)     { __atomic_store_n(&m_value, value, __ATOMIC_SEQ_CST); }
+    int  increment()          { return __atomic_add_fetch(&m_value, 1, __ATOMIC_SEQ_CST); }
+    int  decrement()          { return __atomic_sub_fetch(&m_value, 1, __ATOMIC_SEQ_CST); }
+#endif
+
+private:
+
+    //Not copyable
+    AtomicInt(const AtomicInt&);
+    AtomicInt& operator=(const AtomicInt&);
+
+private:
+
+#ifdef WIN32
+    volatile LONG m_value;
+#else
+    int m_value;
+#endif
+
+};
+
+//*****************************************************************************
+//* Thread
+//! Runs a function on a new thread
+//*****************************************************************************
+class Thread
+{
+public:
+
+    //! Function executed by thread
+    typedef void (*Function)(void* argument);
+
+public:
+
+    //Constructor / Destructor
+    Thread();
+    ~Thread();
+
+    //Start / Wait for thread to finish
+    bool start(Function function, void* argument);
+    void join();
+
+    //! Is thread started and not joined?
+    bool isRunning() { return m_running; }
+
+private:
+
+#ifdef WIN32
+    static DWORD WINAPI _run(LPVOID thread);
+#else
+    static void* _run(void* thread);
+#endif
+
+private:
+
+    Function m_function;       //!< Function executed by thread
+    void*    m_argument;       //!< Argument passed to function
+    bool     m_running;        //!< Thread has been started
+
+#ifdef WIN32
+    HANDLE m_thread;
+#else
+    pthread_t m_thread;
+#endif
+
+};
+
+#endif
@@ -0,0 +1,497 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#include "ThreadPool.h"
+
+#ifndef WIN32
+#include <unistd.h>  //sysconf
+#endif
+#ifdef __SSE__
+#include <xmmintrin.h>  //_mm_pause
+#endif
+
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+//! Index of worker running on this thread, -1 on other threads
+static THREAD_LOCAL int g_workerIndex = -1;
+
+//-----------------------------------------------------------------------------
+//! Spin wait hint
+//-----------------------------------------------------------------------------
+static inline void cpuPause()
+{
+#ifdef __SSE__
+    _mm_pause();
+#endif
+}
+
+//-----------------------------------------------------------------------------
+//! Constructor
+//-----------------------------------------------------------------------------
+TaskGroup::TaskGroup()
+{
+}
+
+//-----------------------------------------------------------------------------
+//! Destructor
+//-----------------------------------------------------------------------------
+TaskGroup::~TaskGroup()
+{
+    wait();
+}
+
+//-----------------------------------------------------------------------------
+//* Run
+//! Adds task to group, executes it immediately if no workers are running
+//-----------------------------------------------------------------------------
+void TaskGroup::run(Function function, void* argument)
+{
+    ThreadPool::getSingleton().run(this, function, argument);
+}
+
+//-----------------------------------------------------------------------------
+//* Wait
+//! Returns when all tasks in group are finished
+//-----------------------------------------------------------------------------
+void TaskGroup::wait()
+{
+    ThreadPool::getSingleton().wait(this);
+}
+
+//-----------------------------------------------------------------------------
+//! Constructor
+//-----------------------------------------------------------------------------
+ThreadPool::ThreadPool()
+{
+    m_workers    = 0;
+    m_numWorkers = 0;
+    m_sleeping   = 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Destructor
+//-----------------------------------------------------------------------------
+ThreadPool::~ThreadPool()
+{
+    dispose();
+}
+
+//-----------------------------------------------------------------------------
+//* Initialize
+//! Starts worker threads
+//! @param numThreads Threads sharing work including the calling thread,
+//!                   0 uses one thread for every processor
+//! @return False if worker threads could not be created
+//-----------------------------------------------------------------------------
+bool ThreadPool::initialize(int numThreads)
+{
+    dispose();
+
+    if ( numThreads <= 0 )
+    {
+        numThreads = getNumProcessors();
+        if ( numThreads > MAX_THREADS )
+        {
+            numThreads = MAX_THREADS;
+        }
+    }
+
+    //Calling thread does its share of the work
+    if ( numThreads <= 1 )
+    {
+        return true;
+    }
+
+    m_quit.store(0);
+    m_queued.store(0);
+    m_sleeping = 0;
+    m_nextWorker.store(0);
+    m_numWorkers = numThreads - 1;
+    m_workers = new Worker[m_numWorkers];
+    for (int i=0; i<m_numWorkers; ++i)
+    {
+        m_workers[i].pool  = this;
+        m_workers[i].index = i;
+        m_workers[i].head  = 0;
+        m_workers[i].tail  = 0;
+    }
+
+    for (int i=0; i<m_numWorkers; ++i)
+    {
+        if ( !m_workers[i].thread.start(_workerMain, &m_workers[i]) )
+        {
+            dispose();
+            return false;
+        }
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//* Dispose
+//! Stops worker threads. Tasks already queued are finished first, so groups
+//! being waited for are completed. Afterwards tasks run on calling thread.
+//! Must not be called from a task.
+//-----------------------------------------------------------------------------
+void ThreadPool::dispose()
+{
+    if ( !m_workers )
+    {
+        return;
+    }
+
+    //Workers exit when no tasks are left
+    m_mutex.lock();
+    m_quit.store(1);
+    m_wake.broadcast();
+    m_mutex.unlock();
+
+    for (int i=0; i<m_numWorkers; ++i)
+    {
+        m_workers[i].thread.join();
+    }
+
+    //Tasks queued after last worker exited
+    while ( _runQueued() );
+
+    delete[] m_workers;
+    m_workers = 0;
+    m_numWorkers = 0;
+    m_queued.store(0);
+}
+
+//-----------------------------------------------------------------------------
+//* Run
+//! Adds task to group, executes it immediately if no workers are running
+//-----------------------------------------------------------------------------
+void ThreadPool::run(TaskGroup* group, TaskGroup::Function function, void* argument)
+{
+    if ( m_numWorkers == 0 )
+    {
+        function(argument);
+        return;
+    }
+
+    Task task;
+    task.function      = function;
+    task.rangeFunction = 0;
+    task.argument      = argument;
+    task.begin         = 0;
+    task.end           = 0;
+    task.group         = group;
+    _submit(task);
+}
+
+//-----------------------------------------------------------------------------
+//* Wait
+//! Runs queued tasks until all tasks in group are finished. Polls for a
+//! while before sleeping, since waking a thread takes longer than most tasks.
+//-----------------------------------------------------------------------------
+void ThreadPool::wait(TaskGroup* group)
+{
+    for (;;)
+    {
+        if ( _runQueued() )
+        {
+            continue;
+        }
+
+        for (int i=0; i<SPIN_COUNT && group->m_remaining.load() > 0 && m_queued.load() <= 0; ++i)
+        {
+            cpuPause();
+        }
+
+        m_mutex.lock();
+        while ( group->m_remaining.load() > 0 && m_queued.load() <= 0 )
+        {
+            m_sleeping++;
+            m_wake.wait(m_mutex);
+            m_sleeping--;
+        }
+        bool finished = ( group->m_remaining.load() <= 0 );
+        m_mutex.unlock();
+
+        if ( finished )
+        {
+            return;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//* Parallel For
+//! Runs function for range [begin, end) split in parts of grain elements.
+//! Parts start at begin plus a multiple of grain, so functions processing
+//! groups of elements see the same groups as when the range is not split.
+//! Returns when all parts are finished.
+//-----------------------------------------------------------------------------
+void ThreadPool::parallelFor(unsigned int begin, unsigned int end, unsigned int grain, RangeFunction function, void* argument)
+{
+    if ( grain == 0 )
+    {
+        grain = 1;
+    }
+
+    //Not worth splitting
+    if ( m_numWorkers == 0 || end - begin <= grain )
+    {
+        function(argument, begin, end);
+        return;
+    }
+
+    //First part is left for calling thread
+    TaskGroup group;
+    Task task;
+    task.function      = 0;
+    task.rangeFunction = function;
+    task.argument      = argument;
+    task.group         = &group;
+    for (unsigned int first = begin + grain; first < end; first += grain)
+    {
+        task.begin = first;
+        task.end   = ( end - first > grain ) ? first + grain : end;
+        _submit(task);
+    }
+
+    function(argument, begin, begin + grain);
+    wait(&group);
+}
+
+//-----------------------------------------------------------------------------
+//* Get Number Of Processors
+//-----------------------------------------------------------------------------
+int ThreadPool::getNumProcessors()
+{
+#ifdef WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long numProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+    return ( numProcessors > 0 ) ? (int)numProcessors : 1;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+//* Worker Main
+//! Runs tasks until pool is stopped and no tasks are left. Idle workers poll
+//! for a while before sleeping, since vertex loads are split many times every
+//! frame and waking a sleeping thread takes longer than processing a load.
+//-----------------------------------------------------------------------------
+void ThreadPool::_workerMain(void* worker)
+{
+    Worker* self = (Worker*)worker;
+    ThreadPool* pool = self->pool;
+    g_workerIndex = self->index;
+
+    for (;;)
+    {
+        if ( pool->_runQueued() )
+        {
+            continue;
+        }
+
+        for (int i=0; i<SPIN_COUNT && pool->m_queued.load() <= 0 && !pool->m_quit.load(); ++i)
+        {
+            cpuPause();
+        }
+
+        pool->m_mutex.lock();
+        while ( pool->m_queued.load() <= 0 && !pool->m_quit.load() )
+        {
+            pool->m_sleeping++;
+            pool->m_wake.wait(pool->m_mutex);
+            pool->m_sleeping--;
+        }
+        bool quit = pool->m_quit.load() && pool->m_queued.load() <= 0;
+        pool->m_mutex.unlock();
+
+        if ( quit )
+        {
+            break;
+        }
+    }
+
+    g_workerIndex = -1;
+}
+
+//-----------------------------------------------------------------------------
+//* Submit
+//! Queues task in deque of current worker, or next worker when called from
+//! another thread. Task is counted before it is queued so it can not finish
+//! before its group knows about it.
+//-----------------------------------------------------------------------------
+void ThreadPool::_submit(const Task& task)
+{
+    m_mutex.lock();
+    task.group->m_remaining.increment();
+    m_queued.increment();
+    if ( m_sleeping > 0 )
+    {
+        m_wake.broadcast();
+    }
+    m_mutex.unlock();
+
+    Worker* worker;
+    if ( g_workerIndex >= 0 )
+    {
+        worker = &m_workers[g_workerIndex];
+    }
+    else
+    {
+        unsigned int next = (unsigned int)m_nextWorker.increment();
+        worker = &m_workers[next % m_numWorkers];
+    }
+
+    //Deque is full
+    if ( !_push(worker, task) )
+    {
+        m_mutex.lock();
+        m_queued.decrement();
+        m_mutex.unlock();
+        _run(task);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//* Push
+//! Adds task to back of worker deque
+//! @return False if deque is full
+//-----------------------------------------------------------------------------
+bool ThreadPool::_push(Worker* worker, const Task& task)
+{
+    bool pushed = false;
+    worker->mutex.lock();
+    if ( worker->tail - worker->head < MAX_TASKS )
+    {
+        worker->tasks[worker->tail % MAX_TASKS] = task;
+        worker->tail++;
+        pushed = true;
+    }
+    worker->mutex.unlock();
+    return pushed;
+}
+
+//-----------------------------------------------------------------------------
+//* Pop
+//! Takes most recently pushed task from back of worker's own deque
+//-----------------------------------------------------------------------------
+bool ThreadPool::_pop(Worker* worker, Task& task)
+{
+    bool popped = false;
+    worker->mutex.lock();
+    if ( worker->tail != worker->head )
+    {
+        worker->tail--;
+        task = worker->tasks[worker->tail % MAX_TASKS];
+        popped = true;
+    }
+    worker->mutex.unlock();
+
+    if ( popped )
+    {
+        m_mutex.lock();
+        m_queued.decrement();
+        m_mutex.unlock();
+    }
+    return popped;
+}
+
+//-----------------------------------------------------------------------------
+//* Steal
+//! Takes oldest task from front of another worker's deque
+//! @param thief Index of worker stealing, -1 when not called by a worker
+//-----------------------------------------------------------------------------
+bool ThreadPool::_steal(int thief, Task& task)
+{
+    for (int i=1; i<=m_numWorkers; ++i)
+    {
+        int victim = ( thief + i ) % m_numWorkers;
+        if ( victim == thief )
+        {
+            continue;
+        }
+
+        Worker* worker = &m_workers[victim];
+        bool stolen = false;
+        worker->mutex.lock();
+        if ( worker->tail != worker->head )
+        {
+            task = worker->tasks[worker->head % MAX_TASKS];
+            worker->head++;
+            stolen = true;
+        }
+        worker->mutex.unlock();
+
+        if ( stolen )
+        {
+            m_mutex.lock();
+            m_queued.decrement();
+            m_mutex.unlock();
+            return true;
+        }
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//* Run Queued
+//! Runs one task, from own deque when called by a worker or stolen otherwise
+//! @return False if no task was queued
+//-----------------------------------------------------------------------------
+bool ThreadPool::_runQueued()
+{
+    Task task;
+    int self = g_workerIndex;
+    if ( ( self >= 0 && _pop(&m_workers[self], task) ) || _steal(self, task) )
+    {
+        _run(task);
+        return true;
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//* Run
+//! Executes task and wakes waiting threads when its group is finished
+//-----------------------------------------------------------------------------
+void ThreadPool::_run(const Task& task)
+{
+    if ( task.rangeFunction )
+    {
+        task.rangeFunction(task.argument, task.begin, task.end);
+    }
+    else
+    {
+        task.function(task.argument);
+    }
+
+    m_mutex.lock();
+    if ( task.group->m_remaining.decrement() == 0 && m_sleeping > 0 )
+    {
+        m_wake.broadcast();
+    }
+    m_mutex.unlock();
+}
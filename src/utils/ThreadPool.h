@@ -0,0 +1,158 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include "Thread.h"
+
+//*****************************************************************************
+//* Task Group
+//! Tasks that are waited for together. Tasks are added with run() and
+//! wait() returns when all of them are finished, the waiting thread runs
+//! queued tasks meanwhile. Destroying a group waits for its tasks.
+//*****************************************************************************
+class TaskGroup
+{
+public:
+
+    //! Function executed by task
+    typedef void (*Function)(void* argument);
+
+public:
+
+    //Constructor / Destructor
+    TaskGroup();
+    ~TaskGroup();
+
+    //Add task / Wait for all tasks
+    void run(Function function, void* argument);
+    void wait();
+
+private:
+
+    friend class ThreadPool;
+
+    AtomicInt m_remaining;          //!< Tasks not yet finished
+
+};
+
+//*****************************************************************************
+//* Thread Pool
+//! Job system with persistent worker threads shared by all subsystems.
+//! Every worker owns a deque of tasks. It takes tasks from the back of its
+//! own deque and steals from the front of other deques when it runs out.
+//! Tasks added by a worker go to its own deque, other tasks are spread
+//! over all workers. Threads waiting for tasks help out instead of blocking.
+//! When no worker threads are running tasks are executed immediately.
+//*****************************************************************************
+class ThreadPool
+{
+public:
+
+    //! Function executed for a part [begin, end) of a range
+    typedef void (*RangeFunction)(void* argument, unsigned int begin, unsigned int end);
+
+public:
+
+    //Destructor
+    ~ThreadPool();
+
+    //Singleton Instance
+    static ThreadPool& getSingleton()
+    {
+        static ThreadPool instance;
+        return instance;
+    }
+
+    //Start / Stop worker threads
+    bool initialize(int numThreads);
+    void dispose();
+
+    //! Number of threads sharing work, including the calling thread
+    int getNumThreads() { return m_numWorkers + 1; }
+
+    //Add task to group / Wait for tasks in group
+    void run(TaskGroup* group, TaskGroup::Function function, void* argument);
+    void wait(TaskGroup* group);
+
+    //Run function for range split in parts of grain elements
+    void parallelFor(unsigned int begin, unsigned int end, unsigned int grain, RangeFunction function, void* argument);
+
+    //Get number of processors in system
+    static int getNumProcessors();
+
+private:
+
+    //Constructor
+    ThreadPool();
+
+    //! Task queued in a worker deque
+    struct Task
+    {
+        TaskGroup::Function function;       //!< Function to execute, or
+        RangeFunction       rangeFunction;  //!< Function to execute for range
+        void*               argument;       //!< Argument passed to function
+        unsigned int        begin;          //!< First element of range
+        unsigned int        end;            //!< One past last element of range
+        TaskGroup*          group;          //!< Group task belongs to
+    };
+
+    static const unsigned int MAX_TASKS = 256;  //!< Size of worker deques (power of two)
+    static const int MAX_THREADS = 16;          //!< Most threads used when number is detected
+    static const int SPIN_COUNT = 4000;         //!< Polls for new tasks before thread sleeps
+
+    //! Worker thread and the tasks it owns
+    struct Worker
+    {
+        ThreadPool*  pool;          //!< Pool worker belongs to
+        int          index;         //!< Index of worker in pool
+        Thread       thread;        //!< Thread executing tasks
+        Mutex        mutex;         //!< Protects deque
+        Task         tasks[MAX_TASKS];
+        unsigned int head;          //!< Front of deque, where tasks are stolen
+        unsigned int tail;          //!< Back of deque, where tasks are pushed and popped
+    };
+
+private:
+
+    static void _workerMain(void* worker);
+    void _submit(const Task& task);
+    bool _push(Worker* worker, const Task& task);
+    bool _pop(Worker* worker, Task& task);
+    bool _steal(int thief, Task& task);
+    bool _runQueued();
+    void _run(const Task& task);
+
+private:
+
+    Worker*       m_workers;        //!< Worker threads
+    int           m_numWorkers;     //!< Number of worker threads
+    AtomicInt     m_nextWorker;     //!< Worker receiving next task from other threads
+    Mutex         m_mutex;          //!< Changes of counters below are made while locked
+    Condition     m_wake;           //!< Signaled when tasks are queued, groups finish or pool is stopped
+    AtomicInt     m_queued;         //!< Tasks in all deques, polled without lock
+    int           m_sleeping;       //!< Threads waiting for m_wake
+    AtomicInt     m_quit;           //!< Non-zero when workers should exit, polled without lock
+
+};
+
+#endif
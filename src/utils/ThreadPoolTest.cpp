@@ -0,0 +1,229 @@
+/******************************************************************************
+ * Arachnoid Graphics Plugin for Mupen64Plus
+ * https://github.com/mupen64plus/mupen64plus-video-arachnoid/
+ *
+ * Copyright (C) 2007 Kristofer Karlsson, Rickard Niklasson
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *****************************************************************************/
+//*****************************************************************************
+//* Arachnoid Thread Pool Test
+//! Exercises the job system with several thread counts: task groups, task
+//! groups and parallelFor nested inside tasks, deque overflow, and dispose()
+//! while tasks are still queued. Every element records which task handled
+//! it with a plain store, so the checks after wait() also verify that writes
+//! made by tasks are visible to the waiting thread. Returns non-zero if a
+//! check fails.
+//*****************************************************************************
+
+#include <cstdio>
+#include <cstring>
+
+#include "ThreadPool.h"
+
+#define NUM_ELEMENTS  4096
+#define NUM_ROUNDS    50
+
+static unsigned int g_numFailures = 0;
+static int g_elements[NUM_ELEMENTS];   //!< Number of times each element was processed
+static AtomicInt g_numTasks;           //!< Tasks executed
+
+static void check(bool passed, const char* name, int numThreads)
+{
+    if ( !passed )
+    {
+        printf("FAIL %s (%d threads)\n", name, numThreads);
+        g_numFailures++;
+    }
+}
+
+static bool allElementsProcessedOnce(unsigned int count)
+{
+    for (unsigned int i=0; i<count; ++i)
+    {
+        if ( g_elements[i] != 1 )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//Busy work so tasks overlap and are stolen
+static void spin(unsigned int amount)
+{
+    volatile unsigned int sink = 0;
+    for (unsigned int i=0; i<amount; ++i)
+    {
+        sink += i;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Tasks
+//-----------------------------------------------------------------------------
+
+static void elementTask(void* argument)
+{
+    int* element = (int*)argument;
+    spin(200);
+    (*element)++;
+    g_numTasks.increment();
+}
+
+static void elementRange(void* argument, unsigned int begin, unsigned int end)
+{
+    for (unsigned int i=begin; i<end; ++i)
+    {
+        g_elements[i]++;
+    }
+    spin(100);
+}
+
+//Outer part of nested parallelFor, splits its part again
+static void nestedRange(void* argument, unsigned int begin, unsigned int end)
+{
+    ThreadPool::getSingleton().parallelFor(begin, end, 4, elementRange, argument);
+}
+
+//Task that runs a group of its own and waits for it
+static void nestedGroupTask(void* argument)
+{
+    int* elements = (int*)argument;
+    TaskGroup group;
+    for (int i=0; i<16; ++i)
+    {
+        group.run(elementTask, &elements[i]);
+    }
+    group.wait();
+}
+
+//-----------------------------------------------------------------------------
+// Checks
+//-----------------------------------------------------------------------------
+
+static void checkTaskGroups(int numThreads)
+{
+    for (int round=0; round<NUM_ROUNDS; ++round)
+    {
+        memset(g_elements, 0, sizeof(g_elements));
+        g_numTasks.store(0);
+
+        //More tasks than fit in worker deques, overflow runs on calling thread
+        TaskGroup group;
+        for (int i=0; i<NUM_ELEMENTS; ++i)
+        {
+            group.run(elementTask, &g_elements[i]);
+        }
+        group.wait();
+
+        check(g_numTasks.load() == NUM_ELEMENTS, "task group ran every task", numThreads);
+        check(allElementsProcessedOnce(NUM_ELEMENTS), "task group writes visible after wait", numThreads);
+    }
+}
+
+static void checkNestedGroups(int numThreads)
+{
+    for (int round=0; round<NUM_ROUNDS; ++round)
+    {
+        memset(g_elements, 0, sizeof(g_elements));
+        g_numTasks.store(0);
+
+        TaskGroup group;
+        for (int i=0; i<64; ++i)
+        {
+            group.run(nestedGroupTask, &g_elements[i * 16]);
+        }
+        group.wait();
+
+        check(g_numTasks.load() == 64 * 16, "nested task groups ran every task", numThreads);
+        check(allElementsProcessedOnce(64 * 16), "nested task group writes visible after wait", numThreads);
+    }
+}
+
+static void checkNestedParallelFor(int numThreads)
+{
+    for (int round=0; round<NUM_ROUNDS; ++round)
+    {
+        memset(g_elements, 0, sizeof(g_elements));
+
+        //Uneven end so last part is shorter than grain
+        unsigned int count = NUM_ELEMENTS - round;
+        ThreadPool::getSingleton().parallelFor(0, count, 64, nestedRange, 0);
+
+        check(allElementsProcessedOnce(count), "nested parallelFor processed every element once", numThreads);
+        check(g_elements[count] == 0 || count == NUM_ELEMENTS, "nested parallelFor stayed in range", numThreads);
+    }
+}
+
+static void checkDisposeWithQueuedTasks(int numThreads)
+{
+    for (int round=0; round<NUM_ROUNDS; ++round)
+    {
+        memset(g_elements, 0, sizeof(g_elements));
+        g_numTasks.store(0);
+
+        //Stop pool while most tasks are still queued, they must be finished
+        ThreadPool::getSingleton().initialize(numThreads);
+        TaskGroup group;
+        for (int i=0; i<512; ++i)
+        {
+            group.run(elementTask, &g_elements[i]);
+        }
+        ThreadPool::getSingleton().dispose();
+
+        check(g_numTasks.load() == 512, "dispose finished queued tasks", numThreads);
+        check(allElementsProcessedOnce(512), "dispose made task writes visible", numThreads);
+
+        //Pool without workers runs tasks immediately
+        group.run(elementTask, &g_elements[512]);
+        group.wait();
+        check(g_elements[512] == 1, "task after dispose ran on calling thread", numThreads);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Main
+//-----------------------------------------------------------------------------
+int main()
+{
+    static const int threadCounts[] = { 1, 2, 4, 8 };
+
+    for (unsigned int i=0; i<sizeof(threadCounts) / sizeof(threadCounts[0]); ++i)
+    {
+        int numThreads = threadCounts[i];
+        unsigned int failures = g_numFailures;
+
+        if ( !ThreadPool::getSingleton().initialize(numThreads) )
+        {
+            printf("FAIL could not start %d threads\n", numThreads);
+            return 1;
+        }
+
+        checkTaskGroups(numThreads);
+        checkNestedGroups(numThreads);
+        checkNestedParallelFor(numThreads);
+        ThreadPool::getSingleton().dispose();
+
+        checkDisposeWithQueuedTasks(numThreads);
+
+        if ( g_numFailures == failures )
+        {
+            printf("ok   %d threads\n", numThreads);
+        }
+    }
+
+    return g_numFailures > 0 ? 1 : 0;
+}
@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+#
+# Writes f3d-clears.trace, 2 frames of fill cycle rectangles in a Fast3D
+# display list, used by "make replay-test" to check which rectangles are
+# cleared with glClear and which are dropped. Each frame:
+#
+#   - clears the depth image twice, the second clear is dropped
+#   - clears the left and the right half of the screen black and the left
+#     half again, which is dropped
+#   - fills a red box in the right half twice, the second fill is dropped
+#   - sets another color image and the screen again, then clears the left
+#     half black once more. The other image may have been drawn to, so this
+#     clear is not dropped.
+#
+# That is 5 clears per frame, 4 of them scissored, and 3 dropped clears.
+#
+# Usage: make-f3d-clears.py f3d-clears.trace
+
+import sys
+from tracefile import TraceFile, string_words
+
+UCODE        = 0x4000
+UCODE_DATA   = 0x5000
+DISPLAY_LIST = 0x10000
+COLOR_IMAGE  = 0x100000
+OTHER_IMAGE  = 0x200000
+DEPTH_IMAGE  = 0x300000
+
+BLACK = 0x00010001
+RED   = 0xF801F801
+
+trace = TraceFile(sys.argv[1], rom_header=bytes((0x80, 0x37, 0x12, 0x40)))
+trace.vi[2]  = 320                                  # width
+trace.vi[9]  = (0x6C << 16) | 0x2EC                 # h start
+trace.vi[10] = (0x25 << 16) | 0x1FF                 # v start
+trace.vi[12] = 0x200                                # x scale
+trace.vi[13] = 0x400                                # y scale
+
+#Fast3D, found by its version string
+trace.write(UCODE, [0x12345678])
+trace.write(UCODE_DATA + 0x100, string_words("RSP SW Version: 2.0D, 04-01-96"))
+
+commands = []
+def add(*words):
+    commands.extend(w & 0xFFFFFFFF for w in words)
+
+def color_image(address):
+    add(0xFF100000 | 319, address)                  # RGBA16, 320 wide
+
+def fill(color, x0, y0, x1, y1):
+    """Fill rectangle, lower right corner inclusive in fill cycle"""
+    add(0xF7000000, color)
+    add(0xF6000000 | (x1 << 14) | (y1 << 2), (x0 << 14) | (y0 << 2))
+
+add(0xBA001402, 0x00300000)                         # fill cycle
+add(0xFE000000, DEPTH_IMAGE)                        # depth image
+color_image(DEPTH_IMAGE)
+fill(0xFFFCFFFC, 0, 0, 319, 239)                    # depth clear
+fill(0xFFFCFFFC, 0, 0, 319, 239)                    # dropped
+color_image(COLOR_IMAGE)
+fill(BLACK, 0, 0, 159, 239)                         # left half
+fill(BLACK, 160, 0, 319, 239)                       # right half
+fill(BLACK, 0, 0, 159, 239)                         # dropped
+fill(RED, 200, 40, 239, 79)                         # box
+fill(RED, 200, 40, 239, 79)                         # dropped
+color_image(OTHER_IMAGE)
+color_image(COLOR_IMAGE)
+fill(BLACK, 0, 0, 159, 239)                         # left half again
+add(0xB8000000, 0)                                  # end
+trace.write(DISPLAY_LIST, commands)
+trace.task(UCODE, UCODE_DATA, DISPLAY_LIST, 4 * len(commands))
+
+for frame in range(2):
+    trace.capture_display_list()
+    trace.update_screen()
+trace.close()
@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+#
+# Writes f3d-display-lists.trace, 8 frames of a Fast3D display list that
+# calls three display lists with G_DL, used by "make replay-test" to check
+# the display list cache, the vertex cache and the matrix and light
+# generations. Each frame:
+#
+#   - clears the screen
+#   - loads an orthographic projection, the modelview matrix, one
+#     directional light and the ambient light
+#   - calls a static list of 20 unlit triangles, one vertex block each
+#   - turns on lighting and calls a list of 8 lit triangles
+#   - turns off lighting and calls a list of 4 triangles
+#
+# The matrices and lights are loaded again every frame with the same
+# content, which must not make cached vertices stale. Changes:
+#
+#   frame 3   the last list draws its triangles with another winding, so
+#             its cache entry is invalidated
+#   frame 5   the directional light turns red, vertices are stale
+#   frame 6   the modelview matrix moves everything, all vertices are stale
+#
+# Usage: make-f3d-display-lists.py f3d-display-lists.trace
+
+import sys
+from tracefile import TraceFile, string_words
+
+UCODE         = 0x4000
+UCODE_DATA    = 0x5000
+MAIN_LIST     = 0x10000
+STATIC_LIST   = 0x11000
+LIT_LIST      = 0x12000
+CHANGING_LIST = 0x13000
+PROJECTION    = 0x20000
+MODELVIEW     = 0x20040
+LIGHTS        = 0x20100
+VIEWPORT      = 0x20200
+VERTICES      = 0x30000
+COLOR_IMAGE   = 0x100000
+
+G_MTX         = 0x01
+G_MOVEMEM     = 0x03
+G_VTX         = 0x04
+G_DL          = 0x06
+G_CLEARGEOMETRYMODE = 0xB6
+G_SETGEOMETRYMODE   = 0xB7
+G_ENDDL       = 0xB8
+G_MOVEWORD    = 0xBC
+G_TRI1        = 0xBF
+G_LIGHTING    = 0x00020000
+G_SHADE       = 0x00000004
+G_SHADING_SMOOTH = 0x00000200
+
+def matrix(rows):
+    """4x4 s15.16 matrix, integer halves followed by fraction halves"""
+    raw = [int(round(v * 65536)) & 0xFFFFFFFF for row in rows for v in row]
+    ints  = [((raw[i] >> 16) << 16) | (raw[i + 1] >> 16) for i in range(0, 16, 2)]
+    fracs = [((raw[i] & 0xFFFF) << 16) | (raw[i + 1] & 0xFFFF) for i in range(0, 16, 2)]
+    return ints + fracs
+
+def vertex(x, y, rgba):
+    """Vertex at (x, y, 0) with color, or normal and alpha when lit"""
+    return [((x & 0xFFFF) << 16) | (y & 0xFFFF), 0, 0, rgba]
+
+def light(r, g, b, x, y, z):
+    color = (r << 24) | (g << 16) | (b << 8)
+    return [color, color, ((x & 0xFF) << 24) | ((y & 0xFF) << 16) | ((z & 0xFF) << 8), 0]
+
+def triangle(v0, v1, v2):
+    return [G_TRI1 << 24, (v0 * 10 << 16) | (v1 * 10 << 8) | v2 * 10]
+
+def vertices(address, count):
+    return [(G_VTX << 24) | ((count - 1) << 20) | (16 * count), address]
+
+def call(address):
+    return [G_DL << 24, address]
+
+trace = TraceFile(sys.argv[1], rom_header=bytes((0x80, 0x37, 0x12, 0x40)))
+trace.vi[2]  = 320                                  # width
+trace.vi[9]  = (0x6C << 16) | 0x2EC                 # h start
+trace.vi[10] = (0x25 << 16) | 0x1FF                 # v start
+trace.vi[12] = 0x200                                # x scale
+trace.vi[13] = 0x400                                # y scale
+
+#Fast3D, found by its version string
+trace.write(UCODE, [0x12345678])
+trace.write(UCODE_DATA + 0x100, string_words("RSP SW Version: 2.0D, 04-01-96"))
+
+trace.write(PROJECTION, matrix(((1 / 160.0, 0, 0, 0), (0, 1 / 120.0, 0, 0), (0, 0, 1 / 1024.0, 0), (0, 0, 0, 1))))
+trace.write(VIEWPORT, [(640 << 16) | 480, 511 << 16, (640 << 16) | 480, 511 << 16])
+
+def modelview(dx):
+    trace.write(MODELVIEW, matrix(((1, 0, 0, 0), (0, 1, 0, 0), (0, 0, 1, 0), (dx, 0, 0, 1))))
+
+def lights(r, g, b):
+    trace.write(LIGHTS, light(r, g, b, 0, 0, 127) + light(40, 40, 40, 0, 0, 0))
+
+modelview(0)
+lights(255, 255, 255)
+
+#Static list: 5 x 4 grid of triangles in the top of the screen
+static = []
+colors = (0xFF0000FF, 0x00FF00FF, 0x0000FFFF, 0xFFFF00FF)
+for i in range(20):
+    x, y = -140 + (i % 5) * 60, 100 - (i // 5) * 40
+    address = VERTICES + i * 48
+    trace.write(address, vertex(x, y, colors[i % 4]) + vertex(x + 40, y, colors[(i + 1) % 4]) +
+                         vertex(x, y - 30, colors[(i + 2) % 4]))
+    static += vertices(address, 3) + triangle(0, 1, 2)
+trace.write(STATIC_LIST, static + [G_ENDDL << 24, 0])
+
+#Lit list: row of triangles facing the light
+lit = []
+for i in range(8):
+    x = -150 + i * 38
+    address = VERTICES + 0x400 + i * 48
+    trace.write(address, vertex(x, -70, 0x00007FFF) + vertex(x + 30, -70, 0x00007FFF) + vertex(x, -100, 0x00007FFF))
+    lit += vertices(address, 3) + triangle(0, 1, 2)
+trace.write(LIT_LIST, lit + [G_ENDDL << 24, 0])
+
+#Changing list: four triangles from one vertex block
+address = VERTICES + 0x800
+trace.write(address, vertex(-40, -110, 0xFFFFFFFF) + vertex(40, -110, 0xFF00FFFF) +
+                     vertex(-40, -118, 0x00FFFFFF) + vertex(40, -118, 0xFFFFFFFF))
+def changing(flip):
+    order = (lambda a, b, c: (a, c, b)) if flip else (lambda a, b, c: (a, b, c))
+    words = vertices(address, 4)
+    for a, b, c in ((0, 1, 2), (1, 3, 2), (0, 2, 3), (0, 1, 3)):
+        words += triangle(*order(a, b, c))
+    trace.write(CHANGING_LIST, words + [G_ENDDL << 24, 0])
+changing(False)
+
+main = ([0xFF100000 | 319, COLOR_IMAGE] +                          # color image, 320 wide
+        [0xBA001402, 0x00300000] +                                  # fill cycle
+        [0xF7000000, 0x00010001] +                                  # fill color black
+        [0xF6000000 | (319 << 14) | (239 << 2), 0] +                # clear
+        [0xBA001402, 0] +                                           # 1 cycle
+        [0xFCFFFFFF, 0xFFFE793C] +                                  # combine shade
+        [(G_MOVEMEM << 24) | (0x80 << 16) | 16, VIEWPORT] +
+        [(G_SETGEOMETRYMODE << 24), G_SHADE | G_SHADING_SMOOTH] +
+        [(G_MTX << 24) | (0x03 << 16) | 64, PROJECTION] +           # load projection
+        [(G_MTX << 24) | (0x02 << 16) | 64, MODELVIEW] +            # load modelview
+        [(G_MOVEWORD << 24) | 0x02, 0x80000000 + 2 * 32] +          # one light
+        [(G_MOVEMEM << 24) | (0x86 << 16) | 16, LIGHTS] +           # light
+        [(G_MOVEMEM << 24) | (0x88 << 16) | 16, LIGHTS + 16] +      # ambient
+        call(STATIC_LIST) +
+        [(G_SETGEOMETRYMODE << 24), G_LIGHTING] +
+        call(LIT_LIST) +
+        [(G_CLEARGEOMETRYMODE << 24), G_LIGHTING] +
+        call(CHANGING_LIST) +
+        [G_ENDDL << 24, 0])
+trace.write(MAIN_LIST, main)
+trace.task(UCODE, UCODE_DATA, MAIN_LIST, 4 * len(main))
+
+for frame in range(8):
+    if frame == 3:
+        changing(True)
+    if frame == 5:
+        lights(255, 0, 0)
+    if frame == 6:
+        modelview(20)
+    trace.capture_display_list()
+    trace.update_screen()
+trace.close()
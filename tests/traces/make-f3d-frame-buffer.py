@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+#
+# Writes f3d-frame-buffer.trace, 2 frames of a Fast3D display list that
+# renders to a color image narrower than the screen and then draws it as
+# a texture, used by "make replay-test" with FrameBufferTextures on (see
+# f3d-frame-buffer.options). Each frame:
+#
+#   - sets the scissor, then the 160 pixel wide color image, like games
+#     do, and fills it green with a blue box
+#   - sets the screen as color image and clears it black
+#   - loads 32x32 texels from the top left of the color image and draws
+#     them with a texture rectangle
+#
+# The texels are sampled from the rendered buffer only if it knows which
+# rows were drawn, which comes from the scissor set before the image.
+#
+# Usage: make-f3d-frame-buffer.py f3d-frame-buffer.trace
+
+import sys
+from tracefile import TraceFile, string_words
+
+UCODE        = 0x4000
+UCODE_DATA   = 0x5000
+DISPLAY_LIST = 0x10000
+COLOR_IMAGE  = 0x100000
+OFFSCREEN    = 0x200000
+
+BLACK = 0x00010001
+GREEN = 0x07C107C1
+BLUE  = 0x003F003F
+
+trace = TraceFile(sys.argv[1], rom_header=bytes((0x80, 0x37, 0x12, 0x40)))
+trace.vi[2]  = 320                                  # width
+trace.vi[9]  = (0x6C << 16) | 0x2EC                 # h start
+trace.vi[10] = (0x25 << 16) | 0x1FF                 # v start
+trace.vi[12] = 0x200                                # x scale
+trace.vi[13] = 0x400                                # y scale
+
+#Fast3D, found by its version string
+trace.write(UCODE, [0x12345678])
+trace.write(UCODE_DATA + 0x100, string_words("RSP SW Version: 2.0D, 04-01-96"))
+
+commands = []
+def add(*words):
+    commands.extend(w & 0xFFFFFFFF for w in words)
+
+def color_image(address, width):
+    add(0xFF100000 | (width - 1), address)          # RGBA16
+
+def fill(color, x0, y0, x1, y1):
+    """Fill rectangle, lower right corner inclusive in fill cycle"""
+    add(0xF7000000, color)
+    add(0xF6000000 | (x1 << 14) | (y1 << 2), (x0 << 14) | (y0 << 2))
+
+add(0xED000000, (320 << 14) | (240 << 2))           # scissor
+color_image(OFFSCREEN, 160)
+add(0xBA001402, 0x00300000)                         # fill cycle
+fill(GREEN, 0, 0, 159, 239)
+fill(BLUE, 8, 8, 23, 23)
+color_image(COLOR_IMAGE, 320)
+fill(BLACK, 0, 0, 319, 239)
+add(0xBA001402, 0)                                  # 1 cycle
+add(0xFC121824, 0xFF33FFFF)                         # combine texel 0
+add(0xFD100000 | 159, OFFSCREEN)                    # texture image, 160 wide
+add(0xF5100000 | (8 << 9), 0x07000000)              # load tile, 8 words a line
+add(0xF4000000, 0x07000000 | (124 << 12) | 124)     # load 32x32
+add(0xF5100000 | (8 << 9), 0)                       # render tile
+add(0xF2000000, (124 << 12) | 124)
+add(0xE4000000 | (232 << 14) | (132 << 2), (200 << 14) | (100 << 2))
+add(0xB4000000, 0)                                  # s t
+add(0xB3000000, (1 << 26) | (1 << 10))              # dsdx dtdy
+add(0xB8000000, 0)                                  # end
+trace.write(DISPLAY_LIST, commands)
+trace.task(UCODE, UCODE_DATA, DISPLAY_LIST, 4 * len(commands))
+
+for frame in range(2):
+    trace.capture_display_list()
+    trace.update_screen()
+trace.close()
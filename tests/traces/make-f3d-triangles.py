@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+#
+# Writes f3d-triangles.trace, 60 frames of the same Fast3D display list,
+# used by "make replay-test". Each frame loads identity matrices and then
+# 40 blocks of three vertices, each followed by one triangle. The vertex
+# blocks are identical, so all but the first load of a frame hit the
+# vertex cache.
+#
+# Usage: make-f3d-triangles.py f3d-triangles.trace
+
+import sys
+from tracefile import TraceFile
+
+MATRIX       = 0x1000
+VERTICES     = 0x2000
+DISPLAY_LIST = 0x3000
+COLOR_IMAGE  = 0x100000
+
+trace = TraceFile(sys.argv[1], rom_header=bytes((0x80, 0x37, 0x12, 0x40)))
+trace.vi[2]  = 320                                  # width
+trace.vi[3]  = 0x100
+trace.vi[9]  = (0x6C << 16) | 0x2EC                 # h start
+trace.vi[10] = (0x25 << 16) | 0x1FF                 # v start
+trace.vi[12] = 0x200                                # x scale
+trace.vi[13] = 0x400                                # y scale
+
+#Identity matrix, integer parts followed by fractions
+trace.write(MATRIX, [1 << 16, 0, 1, 0, 0, 1 << 16, 0, 1])
+
+commands = []
+def add(*words):
+    commands.extend(w & 0xFFFFFFFF for w in words)
+
+add(0xFF100000 | 319, COLOR_IMAGE)                  # color image, 320 wide
+add(0xFCFFFFFF, 0xFFFE793C)                         # combine shade
+add(0x01020040, MATRIX)                             # load projection
+add(0x01000040, MATRIX)                             # load modelview
+for block in range(40):
+    address = VERTICES + block * 48
+    trace.write(address, [0, 0, 0, 0xFF0000FF,      # x y, z flag, s t, rgba
+                          1 << 16, 0, 0, 0x00FF00FF,
+                          1, 0, 0, 0x0000FFFF])
+    add(0x04000000 | (2 << 20) | 48, address)       # 3 vertices
+    add(0xBF000000, (10 << 8) | 20)                 # triangle 0 1 2
+add(0xB8000000, 0)                                  # end
+trace.write(DISPLAY_LIST, commands)
+
+trace.task(0x4000, 0x5000, DISPLAY_LIST, 4 * len(commands))
+
+for frame in range(60):
+    trace.capture_display_list()
+    trace.update_screen()
+trace.close()
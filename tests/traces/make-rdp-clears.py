@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+#
+# Writes rdp-clears.trace, a hand-built trace of low level RDP lists
+# (ProcessRDPList) used by "make replay-test" to check fill rectangles
+# that become clears. Each frame:
+#
+#   - sets the depth image as color image and clears it twice
+#   - clears the left half of the screen red and the right half green
+#   - clears the left half red again and a red box inside it
+#   - fills a blue box
+#
+# Usage: make-rdp-clears.py rdp-clears.trace
+
+import sys
+from tracefile import TraceFile
+
+COMMANDS    = 0x100000
+COLOR_IMAGE = 0x200000
+DEPTH_IMAGE = 0x300000
+
+commands = []
+def add(*words):
+    commands.extend(w & 0xFFFFFFFF for w in words)
+
+def rectangle(x0, y0, x1, y1):
+    """Fill rectangle, lower right corner inclusive in fill cycle"""
+    add(0xF6000000 | (x1 << 14) | (y1 << 2), (x0 << 14) | (y0 << 2))
+
+def fill(color, x0, y0, x1, y1):
+    add(0xF7000000, color)
+    rectangle(x0, y0, x1, y1)
+
+add(0xEF300000, 0)                                  # fill cycle
+add(0xED000000, (320 << 14) | (240 << 2))           # scissor
+add(0xFF10013F, DEPTH_IMAGE)                        # depth image as color image
+add(0xFE000000, DEPTH_IMAGE)
+fill(0xFFFCFFFC, 0, 0, 319, 239)
+rectangle(0, 0, 319, 239)                           # same fill color
+add(0xFF10013F, COLOR_IMAGE)                        # color image, 320 wide
+fill(0xF801F801, 0, 0, 159, 239)                    # red
+fill(0x07C107C1, 160, 0, 319, 239)                  # green
+fill(0xF801F801, 0, 0, 159, 239)
+rectangle(10, 10, 100, 100)                         # same fill color
+fill(0x003F003F, 20, 20, 59, 59)                    # blue
+add(0xE9000000, 0)                                  # full sync
+
+trace = TraceFile(sys.argv[1])
+trace.vi_registers()
+trace.segment_table()
+trace.memory(COMMANDS, commands)
+
+end = COMMANDS + 4 * len(commands)
+for frame in range(2):
+    trace.rdp_list(COMMANDS, end)
+    trace.update_screen()
+trace.close()
@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+#
+# Writes rdp-rectangles.trace, a hand-built trace of low level RDP lists
+# (ProcessRDPList) used by "make replay-test". Each frame has three fill
+# rectangles in fill mode and a Gouraud shaded triangle. The first frame
+# is sent as one list, the second frame is split in the middle of the
+# triangle to test commands cut off between lists.
+#
+# Usage: make-rdp-rectangles.py rdp-rectangles.trace
+
+import sys
+from tracefile import TraceFile
+
+COMMANDS    = 0x100000
+COLOR_IMAGE = 0x200000
+DEPTH_IMAGE = 0x300000
+
+commands = []
+def add(*words):
+    commands.extend(w & 0xFFFFFFFF for w in words)
+
+add(0xFF10013F, COLOR_IMAGE)                        # color image, 320 wide
+add(0xFE000000, DEPTH_IMAGE)                        # depth image
+add(0xEF300000, 0)                                  # fill cycle
+add(0xF7000000, 0xF801F801)                         # fill color red
+for x0 in (10, 60, 110):
+    x1, y0, y1 = x0 + 39, 10, 49
+    add(0xF6000000 | (x1 << 14) | (y1 << 2), (x0 << 14) | (y0 << 2))
+add(0xE7000000, 0)                                  # pipe sync
+add(0xEF000000, 0)                                  # 1 cycle
+add(0xFCFFFFFF, 0xFFFE793C)                         # combine shade
+
+#Shaded triangle: edges, then shade coefficients of solid green
+triangle = [0xCC800370, 0x025800F0, 0x012C0000, 0xFFFE2492,
+            0x00C80000, 0xFFFFD000, 0x00C80000, 0x00011C72]
+add(*triangle)
+add(0x000000FF, 0x000000FF, *([0] * 14))
+add(0xE9000000, 0)                                  # full sync
+
+trace = TraceFile(sys.argv[1])
+trace.vi_registers()
+trace.segment_table()
+trace.memory(COMMANDS, commands)
+
+#Frame 1: one list
+end = COMMANDS + 4 * len(commands)
+trace.rdp_list(COMMANDS, end)
+trace.update_screen()
+
+#Frame 2: split inside triangle
+middle = COMMANDS + 4 * 29
+trace.rdp_list(COMMANDS, middle)
+trace.rdp_list(middle, end)
+trace.update_screen()
+trace.close()
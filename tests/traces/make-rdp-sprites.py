@@ -0,0 +1,57 @@
+#!/usr/bin/env python3
+#
+# Writes rdp-sprites.trace, a hand-built trace of low level RDP lists
+# (ProcessRDPList) used by "make replay-test" to check how rectangles are
+# batched. Each frame has four rectangles in the primitive color drawn in
+# 1 cycle mode, followed by three texture rectangles sampling a 4x4
+# RGBA16 texture loaded with LoadBlock.
+#
+# Usage: make-rdp-sprites.py rdp-sprites.trace
+
+import sys
+from tracefile import TraceFile
+
+COMMANDS    = 0x100000
+TEXTURE     = 0x110000
+COLOR_IMAGE = 0x200000
+DEPTH_IMAGE = 0x300000
+
+commands = []
+def add(*words):
+    commands.extend(w & 0xFFFFFFFF for w in words)
+
+add(0xFF10013F, COLOR_IMAGE)                        # color image, 320 wide
+add(0xFE000000, DEPTH_IMAGE)                        # depth image
+add(0xEF000000, 0)                                  # 1 cycle
+add(0xED000000, (320 << 14) | (240 << 2))           # scissor
+add(0xFCFFFFFF, 0xFFFDFCFE)                         # combine primitive color
+add(0xFA000000, 0x00FF00FF)                         # primitive color green
+for x0 in (10, 60, 110, 160):
+    x1, y0, y1 = x0 + 39, 10, 49
+    add(0xF6000000 | (x1 << 14) | (y1 << 2), (x0 << 14) | (y0 << 2))
+add(0xE7000000, 0)                                  # pipe sync
+add(0xFD100003, TEXTURE)                            # texture image, 4 wide
+add(0xF5100000, 7 << 24)                            # load tile
+add(0xE6000000, 0)                                  # load sync
+add(0xF3000000, (7 << 24) | (15 << 12) | 0x800)     # load block, 16 texels
+add(0xE7000000, 0)                                  # pipe sync
+add(0xF5100000 | (1 << 9), 0)                       # render tile 0
+add(0xF2000000, (12 << 12) | 12)                    # tile size 4x4
+add(0xFCFFFFFF, 0xFFFCF279)                         # combine texel 0
+for x0 in (20, 80, 140):
+    x1, y0, y1 = x0 + 40, 100, 140
+    add(0xE4000000 | (x1 << 14) | (y1 << 2), (x0 << 14) | (y0 << 2))
+    add(0, (1 << 26) | (1 << 10))                   # s t, dsdx dtdy
+add(0xE9000000, 0)                                  # full sync
+
+trace = TraceFile(sys.argv[1])
+trace.vi_registers()
+trace.segment_table()
+trace.memory(COMMANDS, commands)
+trace.memory(TEXTURE, [0x003F003F] * 8)             # blue
+
+end = COMMANDS + 4 * len(commands)
+for frame in range(2):
+    trace.rdp_list(COMMANDS, end)
+    trace.update_screen()
+trace.close()
@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+#
+# Writes rdp-triangles.trace, a hand-built trace of low level RDP lists
+# (ProcessRDPList) used by "make replay-test". Each frame has:
+#
+#   - three fill rectangles in fill mode           (one batch)
+#   - a Gouraud shaded triangle                     (one batch)
+#   - a triangle textured with a 16x16 RGBA16 checkerboard loaded with
+#     LoadBlock, without perspective correction     (one batch)
+#   - the same texture on a triangle with perspective correction, W goes
+#     from 0.9 to 0.45 across it                    (one batch)
+#
+# The first frame is sent as one list, the second frame is split in the
+# middle of the shaded triangle to test commands cut off between lists.
+#
+# Usage: make-rdp-triangles.py rdp-triangles.trace
+
+import sys
+from tracefile import TraceFile
+
+COLOR_IMAGE   = 0x200000
+DEPTH_IMAGE   = 0x300000
+TEXTURE       = 0x180000
+COMMANDS      = 0x100000
+
+def fixed(value):
+    """s15.16 fixed point word"""
+    return int(round(value * 65536)) & 0xFFFFFFFF
+
+def coefficients(values):
+    """Shade/texture coefficients: integer parts of four components in two
+    words, followed by the fractions in two words"""
+    ints, fracs = [], []
+    for v in values:
+        raw = int(round(v * 65536))
+        ints.append((raw >> 16) & 0xFFFF)
+        fracs.append(raw & 0xFFFF)
+    return [(ints[0] << 16) | ints[1], (ints[2] << 16) | ints[3],
+            (fracs[0] << 16) | fracs[1], (fracs[2] << 16) | fracs[3]]
+
+def edges(yh, ym, yl, xh, dxhdy, xm, dxmdy, xl, dxldy):
+    """Edge coefficients of a left major triangle, y in pixels"""
+    return [(1 << 23) | ((yl * 4) & 0x3FFF), (((ym * 4) & 0x3FFF) << 16) | ((yh * 4) & 0x3FFF),
+            fixed(xl), fixed(dxldy), fixed(xh), fixed(dxhdy), fixed(xm), fixed(dxmdy)]
+
+def attributes(start, dx, de):
+    """16 words of shade (r, g, b, a) or texture (s, t, w, 0) coefficients:
+    start, d/dx, d/de and unused d/dy. Units are 0-255 for colors, s10.5
+    for s and t and s.15 for w"""
+    s, x, e, y = coefficients(start), coefficients(dx), coefficients(de), coefficients((0, 0, 0, 0))
+    return s[0:2] + x[0:2] + s[2:4] + x[2:4] + e[0:2] + y[0:2] + e[2:4] + y[2:4]
+
+def triangle(command, tile, edge_words):
+    """Triangle command with tile index in first word"""
+    return [(command << 24) | (tile << 16) | edge_words[0]] + edge_words[1:]
+
+def combine(d_rgb, d_alpha):
+    """Combiner that outputs (0 - 0) * 0 + d in both cycles"""
+    w0 = 0xFC000000 | (15 << 20) | (31 << 15) | (7 << 12) | (7 << 9) | (15 << 5) | 31
+    w1 = ((15 << 28) | (15 << 24) | (7 << 21) | (7 << 18) | (d_rgb << 15) | (7 << 12) |
+          (d_alpha << 9) | (d_rgb << 6) | (7 << 3) | d_alpha)
+    return [w0, w1]
+
+commands = []
+def add(*words):
+    commands.extend(w & 0xFFFFFFFF for w in words)
+
+#Fill rectangles
+add(0xFF10013F, COLOR_IMAGE)                        # color image, 320 wide
+add(0xFE000000, DEPTH_IMAGE)                        # depth image
+add(0xEF300000, 0)                                  # fill cycle
+add(0xF7000000, 0xF801F801)                         # fill color red
+for x0 in (10, 60, 110):
+    x1, y0, y1 = x0 + 39, 10, 49
+    add(0xF6000000 | (x1 << 14) | (y1 << 2), (x0 << 14) | (y0 << 2))
+add(0xE7000000, 0)                                  # pipe sync
+
+#Shaded triangle
+add(0xEF000000, 0)                                  # 1 cycle, point sampled, no perspective
+add(*combine(4, 4))                                 # shade
+add(*triangle(0x0C, 0, edges(60, 150, 220, 300, -130 / 70.0, 200, -30 / 160.0, 200, 100 / 90.0)))
+add(*attributes((0, 255, 0, 255), (0, 0, 0, 0), (0, 0, 0, 0)))   # green
+shade_end = len(commands)
+add(0xE7000000, 0)                                  # pipe sync
+
+#Texture: 16x16 RGBA16, 4x4 white and blue squares
+add(0xFD000000 | (0 << 21) | (2 << 19) | 15, TEXTURE)            # texture image
+add(0xF5000000 | (0 << 21) | (2 << 19) | (4 << 9), 7 << 24)      # load tile
+add(0xE6000000, 0)                                                # load sync
+add(0xF3000000, (7 << 24) | (255 << 12) | 512)                    # load block, 256 texels
+add(0xE8000000, 0)                                                # tile sync
+add(0xF5000000 | (0 << 21) | (2 << 19) | (4 << 9), (4 << 14) | (4 << 4))   # render tile 0, wrap 16
+add(0xF2000000, (15 << 14) | (15 << 2))                          # tile size 16x16
+add(*combine(1, 1))                                               # texel 0
+
+#Textured triangle (20,120) (20,200) (100,200), s and t cover 16 texels
+add(*triangle(0x0A, 0, edges(120, 200, 200, 20, 0, 20, 1, 100, 0)))
+add(*attributes((0, 0, 0, 0), (16 / 80.0 * 32, 0, 0, 0), (0, 16 / 80.0 * 32, 0, 0)))
+add(0xE7000000, 0)                                  # pipe sync
+
+#Perspective textured triangle (200,120) (200,200) (280,200), s/w and t/w
+#are linear in screen space, s and t reach 16 texels at the far corner
+add(0xEF080000, 0)                                  # 1 cycle, perspective correction
+w0, w1 = 0.9, 0.45
+dwdx = (w1 - w0) / 80.0 * 32768
+dsdx = 16 * w1 * 32 / 80.0
+dtde = 16 * w0 * 32 / 80.0
+dtdx = (16 * w1 * 32 - dtde * 80) / 80.0
+add(*triangle(0x0A, 0, edges(120, 200, 200, 200, 0, 200, 1, 280, 0)))
+add(*attributes((0, 0, w0 * 32768, 0), (dsdx, dtdx, dwdx, 0), (0, dtde, 0, 0)))
+add(0xE9000000, 0)                                  # full sync
+
+#Checkerboard texels, two texels per word
+texels = []
+for t in range(16):
+    for s in range(16):
+        texels.append(0xFFFF if ((s >> 2) ^ (t >> 2)) & 1 else 0x003F)
+texture = [(texels[i] << 16) | texels[i + 1] for i in range(0, len(texels), 2)]
+
+trace = TraceFile(sys.argv[1])
+trace.vi_registers()
+trace.segment_table()
+trace.memory(COMMANDS, commands)
+trace.memory(TEXTURE, texture)
+
+#Frame 1: one list
+end = COMMANDS + 4 * len(commands)
+trace.rdp_list(COMMANDS, end)
+trace.update_screen()
+
+#Frame 2: split inside shaded triangle
+middle = COMMANDS + 4 * (shade_end - 11)
+trace.rdp_list(COMMANDS, middle)
+trace.rdp_list(middle, end)
+trace.update_screen()
+trace.close()
@@ -0,0 +1,32 @@
+#!/bin/sh
+#
+# Replays every trace in this directory and compares the counters and the
+# checksum of the last frame with the .expected file next to the trace,
+# used by "make replay-test". A .options file next to a trace holds extra
+# arachnoid-replay options for it. Every trace is also replayed with the
+# other frame pacing settings and with FrameBufferTextures on, none of
+# which may change the result.
+#
+# Usage: replay-test.sh arachnoid-replay
+
+replay=$1
+dir=$(dirname "$0")
+counters='^(frames|frame checksum|display lists|draw calls|sprites|fill rect clears|texture hits|frame buffers|instructions|display list cache hits|vertex cache hits|rdp lists|rdp triangles):'
+
+status=0
+for trace in "$dir"/*.trace; do
+    name=${trace%.trace}
+    options=
+    if [ -f "$name.options" ]; then
+        options=$(cat "$name.options")
+    fi
+
+    for variant in "" "-s LowLatency=1" "-s FramesInFlight=1" "-s FramesInFlight=3" \
+                   "-s ThreadedRendering=1 -s LowLatency=1" "-s FrameBufferTextures=1"; do
+        echo "replay $trace${options:+ $options}${variant:+ $variant}"
+        if ! "$replay" -q -c $options $variant "$trace" | grep -E "$counters" | diff -u "$name.expected" -; then
+            status=1
+        fi
+    done
+done
+exit $status
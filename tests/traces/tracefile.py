@@ -0,0 +1,140 @@
+#
+# Writes arachnoid trace files (see src/trace/TraceFormat.h) for the
+# make-*.py scripts in this directory.
+#
+# Memory is kept in host byte order like RDRAM in the emulator. Traces are
+# either captured like TraceWriter does it (capture_display_list writes the
+# VI registers, segments and every changed page before each display list)
+# or built chunk by chunk (memory, rdp_list) for low level RDP lists.
+
+import struct
+from array import array
+
+RDRAM_SIZE = 0x800000
+PAGE_SIZE  = 4096
+DMEM_SIZE  = 4096
+
+CHUNK_ROM_HEADER    = 1
+CHUNK_RDRAM_SIZE    = 2
+CHUNK_VI_REGISTERS  = 3
+CHUNK_SEGMENTS      = 4
+CHUNK_DMEM          = 5
+CHUNK_RDRAM_PAGE    = 6
+CHUNK_DISPLAY_LIST  = 7
+CHUNK_UPDATE_SCREEN = 8
+CHUNK_DPC_REGISTERS = 9
+CHUNK_RDP_LIST      = 10
+
+def pack(words):
+    return b"".join(struct.pack("<I", w & 0xFFFFFFFF) for w in words)
+
+def string_words(text):
+    """RDRAM words holding text, as the ucode string search reads it"""
+    data = text.encode().ljust((len(text) + 4) & ~3, b"\0")
+    return [int.from_bytes(data[i:i + 4], "big") for i in range(0, len(data), 4)]
+
+def delta(address, data, shadow):
+    """Payload of a memory chunk with the words of data that differ from
+    shadow, same runs as TraceWriter::_writeDelta. None if unchanged."""
+    if data == shadow:
+        return None
+    words, old = array("I", data), array("I", shadow)
+    payload = [struct.pack("<I", address)]
+    i, n = 0, len(words)
+    while i < n:
+        skip = i
+        while i < n and words[i] == old[i]:
+            i += 1
+        skip = i - skip
+        if i == n:
+            break
+
+        #Short unchanged gaps are cheaper to copy than to split
+        start = i
+        while i < n and i - start < 0xFFFF:
+            if words[i] != old[i]:
+                i += 1
+                continue
+            if i + 1 < n and words[i + 1] != old[i + 1]:
+                i += 1
+                continue
+            break
+        payload.append(struct.pack("<HH", skip, i - start) + words[start:i].tobytes())
+    return b"".join(payload)
+
+class TraceFile:
+
+    def __init__(self, filename, rom_header=b"", rdram_size=RDRAM_SIZE):
+        self.out = open(filename, "wb")
+        self.out.write(b"ARACHTRC" + struct.pack("<I", 1))
+        self.rdram = bytearray(rdram_size)
+        self.rdram_shadow = bytearray(rdram_size)
+        self.dmem = bytearray(DMEM_SIZE)
+        self.dmem_shadow = bytearray(DMEM_SIZE)
+        self.vi = [0] * 14
+        self.segments = [0] * 16
+        self.chunk(CHUNK_ROM_HEADER, rom_header.ljust(64, b"\0"))
+        self.chunk(CHUNK_RDRAM_SIZE, struct.pack("<I", rdram_size))
+
+    def close(self):
+        self.out.close()
+
+    def chunk(self, type, data=b""):
+        self.out.write(struct.pack("<II", type, len(data)) + data)
+
+    #Memory, written to the file by capture_display_list
+
+    def write(self, address, words):
+        self.rdram[address:address + 4 * len(words)] = pack(words)
+
+    def write_dmem(self, address, words):
+        self.dmem[address:address + 4 * len(words)] = pack(words)
+
+    def task(self, ucode, ucode_data, data, data_size):
+        """Graphics task header at the end of DMEM"""
+        self.write_dmem(0xFC0, [1])
+        self.write_dmem(0xFD0, [ucode, 0x1000, ucode_data, 0x800])
+        self.write_dmem(0xFF0, [data, data_size])
+
+    #Hand built traces
+
+    def vi_registers(self):
+        self.chunk(CHUNK_VI_REGISTERS, pack(self.vi))
+
+    def segment_table(self):
+        self.chunk(CHUNK_SEGMENTS, pack(self.segments))
+
+    def memory(self, address, words):
+        """One run copying all words, whether they changed or not"""
+        self.write(address, words)
+        self.rdram_shadow[address:address + 4 * len(words)] = pack(words)
+        self.chunk(CHUNK_RDRAM_PAGE, struct.pack("<IHH", address, 0, len(words)) + pack(words))
+
+    def rdp_list(self, start, end):
+        """DP registers of a list and a ProcessRDPList marker"""
+        self.chunk(CHUNK_DPC_REGISTERS, pack((start, end, start, 0)))
+        self.chunk(CHUNK_RDP_LIST)
+
+    def update_screen(self):
+        self.chunk(CHUNK_UPDATE_SCREEN)
+
+    #Captured traces
+
+    def capture_memory(self):
+        """VI registers, segments and memory changed since last capture"""
+        self.vi_registers()
+        self.segment_table()
+        payload = delta(0, bytes(self.dmem), bytes(self.dmem_shadow))
+        if payload:
+            self.chunk(CHUNK_DMEM, payload)
+            self.dmem_shadow[:] = self.dmem
+        for address in range(0, len(self.rdram), PAGE_SIZE):
+            page = bytes(self.rdram[address:address + PAGE_SIZE])
+            payload = delta(address, page, bytes(self.rdram_shadow[address:address + PAGE_SIZE]))
+            if payload:
+                self.chunk(CHUNK_RDRAM_PAGE, payload)
+                self.rdram_shadow[address:address + PAGE_SIZE] = page
+
+    def capture_display_list(self):
+        self.capture_memory()
+        self.chunk(CHUNK_DISPLAY_LIST)